@@ -21,7 +21,12 @@
 
 #include "audiovisualwaveform.h"
 
+#include <algorithm>
+#include <QDataStream>
 #include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
 #include <QtGlobal>
 
 #include "config/config.h"
@@ -64,10 +69,13 @@ void AudioVisualWaveform::OverwriteSamplesFromBuffer(
 			size_t(qRound64((double(i + channels_) * chunk_size))) / channels_,
 			samples.sample_count());
 
-		Sample summary = SumSamples(samples, src_start, src_end - src_start);
-
-		memcpy(&data.data()[i + start_index], summary.data(),
-			   summary.size() * sizeof(SamplePerChannel));
+		if (src_end > src_start) {
+			SumSamples(samples, src_start, src_end - src_start,
+					   &data.data()[i + start_index]);
+		} else {
+			std::fill_n(&data.data()[i + start_index], channels_,
+						SamplePerChannel{ 0, 0 });
+		}
 	}
 }
 
@@ -90,12 +98,9 @@ void AudioVisualWaveform::OverwriteSamplesFromMipmap(
 	size_t chunk_size = input_sample_rate / output_rate;
 
 	for (size_t i = 0; i < samples_length; i += channels_) {
-		Sample summary =
-			ReSumSamples(&input.data()[input_start + (i * chunk_size)],
-						 chunk_size * channels_, channels_);
-
-		memcpy(&output_data.data()[i + start_index], summary.data(),
-			   summary.size() * sizeof(SamplePerChannel));
+		ReSumSamples(&input.data()[input_start + (i * chunk_size)],
+					 chunk_size * channels_, channels_,
+					 &output_data.data()[i + start_index]);
 	}
 
 	input_start = start_index;
@@ -335,70 +340,80 @@ AudioVisualWaveform::GetSummaryFromTime(const rational &start,
 	return AudioVisualWaveform::Sample(channel_count(), { 0, 0 });
 }
 
-void ExpandMinMaxChannel(const float *a, size_t length, float &min_val,
-						 float &max_val)
+static void ExpandMinMaxChannel(const float *a, size_t length,
+								float &min_val, float &max_val)
 {
+	size_t i = 0;
+
 #if defined(Q_PROCESSOR_X86) || defined(Q_PROCESSOR_ARM)
 	// SSE optimized
+	if (length >= 4) {
+		// load the first 4 elements of 'a' into min and max (they are 4 * 32 = 128 bits)
+		__m128 max = _mm_loadu_ps(a);
+		__m128 min = max;
+
+		// loop over 'a' and compare current elements with min and max 4 by 4.
+		for (i = 4; i + 4 <= length; i += 4) {
+			__m128 cur = _mm_loadu_ps(a + i);
+			max = _mm_max_ps(max, cur);
+			min = _mm_min_ps(min, cur);
+		}
+
+		// if 'a' length isn't mod. 4, read the last 4 elements instead. This overlaps up to 3
+		// elements we've already compared but that's not an issue.
+		if (i < length) {
+			__m128 cur = _mm_loadu_ps(a + length - 4);
+			max = _mm_max_ps(max, cur);
+			min = _mm_min_ps(min, cur);
+			i = length;
+		}
+
+		// min and max will contain 4 min and max. To get the absolute min and max
+		// we need to compare the 4 values over themselves by shuffling each time.
+		for (int j = 0; j < 3; j++) {
+			max = _mm_max_ps(max, _mm_shuffle_ps(max, max, 0x93));
+			min = _mm_min_ps(min, _mm_shuffle_ps(min, min, 0x93));
+		}
+		// now min and max contain 4 identical items each representing min and max value respectively.
+
+		float chunk_min, chunk_max;
+		_mm_store_ss(&chunk_max, max);
+		_mm_store_ss(&chunk_min, min);
+
+		min_val = std::min(min_val, chunk_min);
+		max_val = std::max(max_val, chunk_max);
+	}
+#endif
 
-	// load the first 4 elements of 'a' into min and max (they are 4 * 32 = 128 bits)
-	__m128 max = _mm_loadu_ps(a);
-	__m128 min = _mm_loadu_ps(a);
-
-	// loop over 'a' and compare current elements with min and max 4 by 4.
-	// we need to make sure we don't read out of boundaries should 'a' length be not mod. 4
-	for (size_t i = 4; i < length - 4; i += 4) {
-		__m128 cur = _mm_loadu_ps(a + i);
-		max = _mm_max_ps(max, cur);
-		min = _mm_min_ps(min, cur);
-	}
-	// so we read the last 4 (or less) elements in a safe manner.
-	__m128 cur = _mm_loadu_ps(a + length - 4);
-	max = _mm_max_ps(max, cur);
-	min = _mm_min_ps(min, cur);
-	// this potentially overlaps up to the last 3 elements but it's not an issue.
-
-	// min and max will contain 4 min and max. To get the absolute min and max
-	// we need to compare the 4 values over themselves by shuffling each time.
-	for (size_t i = 0; i < 3; i++) {
-		max = _mm_max_ps(max, _mm_shuffle_ps(max, max, 0x93));
-		min = _mm_min_ps(min, _mm_shuffle_ps(min, min, 0x93));
-	}
-	// now min and max contain 4 identical items each representing min and max value respectively.
-
-	// and we store the first one into a float variable.
-	_mm_store_ss(&max_val, max);
-	_mm_store_ss(&min_val, min);
-	// I bet you don't find annotated low level code very often.
-#else
-	// Standard unoptimized function
-	for (size_t i = 0; i < length; i++) {
+	// Standard unoptimized function (or whatever is too short for SSE)
+	for (; i < length; i++) {
 		min_val = std::min(min_val, a[i]);
 		max_val = std::max(max_val, a[i]);
 	}
-#endif
 }
 
 AudioVisualWaveform::Sample
 AudioVisualWaveform::SumSamples(const SampleBuffer &samples, size_t start_index,
 								size_t length)
 {
-	int channels = samples.audio_params().channel_count();
-	AudioVisualWaveform::Sample summed_samples(channels);
+	AudioVisualWaveform::Sample summed_samples(
+		samples.audio_params().channel_count());
+
+	SumSamples(samples, start_index, length, summed_samples.data());
 
+	return summed_samples;
+}
+
+void AudioVisualWaveform::SumSamples(const SampleBuffer &samples,
+									 size_t start_index, size_t length,
+									 SamplePerChannel *out)
+{
 	for (int channel = 0; channel < samples.audio_params().channel_count();
 		 channel++) {
+		out[channel] = { 0, 0 };
 		ExpandMinMaxChannel(samples.data(channel) + start_index, length,
-							summed_samples[channel].min,
-							summed_samples[channel].max);
+							out[channel].min, out[channel].max);
 	}
-
-	// for reference: this approximation is n x faster (and less accurate) for a n-tracks clip
-	// for (size_t i=start_index; i<end_index; i++) {
-	//   ExpandMinMax(summed_samples[i%channels], samples->data(i%channels)[i]);
-	// }
-
-	return summed_samples;
 }
 
 AudioVisualWaveform::Sample
@@ -407,22 +422,91 @@ AudioVisualWaveform::ReSumSamples(const SamplePerChannel *samples,
 {
 	AudioVisualWaveform::Sample summed_samples(nb_channels);
 
-	for (size_t i = 0; i < nb_samples; i += nb_channels) {
+	ReSumSamples(samples, nb_samples, nb_channels, summed_samples.data());
+
+	return summed_samples;
+}
+
+void AudioVisualWaveform::ReSumSamples(const SamplePerChannel *samples,
+									   size_t nb_samples, int nb_channels,
+									   SamplePerChannel *out)
+{
+	for (int j = 0; j < nb_channels; j++) {
+		out[j] = { 0, 0 };
+	}
+
+	size_t i = 0;
+
+#if defined(Q_PROCESSOR_X86) || defined(Q_PROCESSOR_ARM)
+	// Sums are interleaved min/max pairs for each channel, so which channel and which of min/max a
+	// float belongs to repeats every `floats_per_sample` floats. Over a period that's also a multiple
+	// of 4 floats, every lane of every vector always holds the same one, so whole periods can be
+	// reduced with SSE without any shuffling.
+	const size_t kMaximumVectors = 8;
+
+	size_t floats_per_sample = size_t(nb_channels) * 2;
+	size_t period = floats_per_sample;
+	while (period % 4) {
+		period += floats_per_sample;
+	}
+
+	size_t vectors = period / 4;
+	size_t nb_floats = nb_samples * 2;
+	if (vectors <= kMaximumVectors && nb_floats >= period) {
+		const float *f = reinterpret_cast<const float *>(samples);
+		size_t end = nb_floats - nb_floats % period;
+
+		__m128 min[kMaximumVectors];
+		__m128 max[kMaximumVectors];
+		for (size_t v = 0; v < vectors; v++) {
+			min[v] = _mm_setzero_ps();
+			max[v] = _mm_setzero_ps();
+		}
+
+		for (size_t p = 0; p < end; p += period) {
+			for (size_t v = 0; v < vectors; v++) {
+				__m128 cur = _mm_loadu_ps(f + p + v * 4);
+				min[v] = _mm_min_ps(min[v], cur);
+				max[v] = _mm_max_ps(max[v], cur);
+			}
+		}
+
+		float min_lanes[kMaximumVectors * 4];
+		float max_lanes[kMaximumVectors * 4];
+		for (size_t v = 0; v < vectors; v++) {
+			_mm_storeu_ps(min_lanes + v * 4, min[v]);
+			_mm_storeu_ps(max_lanes + v * 4, max[v]);
+		}
+
+		// Odd floats are maximums, even floats are minimums
+		for (size_t l = 0; l < period; l++) {
+			SamplePerChannel &s = out[(l % floats_per_sample) / 2];
+			if (l % 2) {
+				s.max = std::max(s.max, max_lanes[l]);
+			} else {
+				s.min = std::min(s.min, min_lanes[l]);
+			}
+		}
+
+		// Periods are a whole number of samples for every channel
+		i = end / 2;
+	}
+#endif
+
+	for (; i < nb_samples; i += nb_channels) {
 		for (int j = 0; j < nb_channels; j++) {
 			const AudioVisualWaveform::SamplePerChannel &sample =
 				samples[i + j];
 
-			if (sample.min < summed_samples[j].min) {
-				summed_samples[j].min = sample.min;
+			if (sample.min < out[j].min) {
+				out[j].min = sample.min;
 			}
 
-			if (sample.max > summed_samples[j].max) {
-				summed_samples[j].max = sample.max;
+			if (sample.max > out[j].max) {
+				out[j].max = sample.max;
 			}
 		}
 	}
-
-	return summed_samples;
 }
 
 template <typename T> inline int round_away_from_zero(T t)
@@ -493,7 +577,8 @@ void AudioVisualWaveform::DrawWaveform(QPainter *painter, const QRect &rect,
 	size_t next_sample_index = start_sample_index;
 	size_t sample_index;
 
-	Sample summary;
+	// Reused for every pixel, ReSumSamples() writes into it in place
+	Sample summary(samples.channel_count());
 	size_t summary_index = -1;
 
 	const QRect &viewport = painter->viewport();
@@ -519,11 +604,11 @@ void AudioVisualWaveform::DrawWaveform(QPainter *painter, const QRect &rect,
 					   samples.channel_count()));
 
 		if (summary_index != sample_index) {
-			summary = AudioVisualWaveform::ReSumSamples(
+			AudioVisualWaveform::ReSumSamples(
 				&arr.at(sample_index),
 				qMax(size_t(samples.channel_count()),
 					 next_sample_index - sample_index),
-				samples.channel_count());
+				samples.channel_count(), summary.data());
 			summary_index = sample_index;
 		}
 
@@ -531,6 +616,174 @@ void AudioVisualWaveform::DrawWaveform(QPainter *painter, const QRect &rect,
 	}
 }
 
+// Bump whenever the layout written by Save() changes
+static const quint32 kWaveformFileVersion = 3;
+
+// Quantized sums are scaled so the file's peak maps to this
+static const float kWaveformQuantizeRange = 32767.0f;
+
+bool AudioVisualWaveform::Save(const QString &filename) const
+{
+	QSaveFile file(filename);
+	if (!file.open(QFile::WriteOnly)) {
+		return false;
+	}
+
+	QDataStream stream(&file);
+
+	return Save(stream) && file.commit();
+}
+
+bool AudioVisualWaveform::Save(QDataStream &stream) const
+{
+	if (channels_ <= 0) {
+		return false;
+	}
+
+	// Audio can go past 1.0, so scale by the loudest sum rather than clipping it
+	float peak = 1.0f;
+	for (auto it = mipmapped_data_.cbegin(); it != mipmapped_data_.cend();
+		 it++) {
+		for (const SamplePerChannel &s : it->second) {
+			peak = std::max(peak, std::max(-s.min, s.max));
+		}
+	}
+	float scale = kWaveformQuantizeRange / peak;
+
+	stream << kWaveformFileVersion << qint32(channels_)
+		   << qint64(length_.numerator()) << qint64(length_.denominator())
+		   << qint64(virtual_start_.numerator())
+		   << qint64(virtual_start_.denominator())
+		   << quint32(mipmapped_data_.size()) << peak;
+
+	std::vector<qint16> plane;
+
+	for (auto it = mipmapped_data_.cbegin(); it != mipmapped_data_.cend();
+		 it++) {
+		const Sample &data = it->second;
+		size_t count = data.size() / channels_;
+
+		stream << qint64(it->first.numerator())
+			   << qint64(it->first.denominator()) << quint64(count);
+
+		// One plane of minimums and one of maximums per channel. Minimums round down and maximums
+		// round up so the quantized waveform always encloses the original. The planes are written
+		// raw, so they're always little-endian regardless of the host, like the stream's own fields
+		// have a fixed byte order.
+		plane.resize(count);
+		qint64 bytes = qint64(count * sizeof(qint16));
+		for (int c = 0; c < channels_; c++) {
+			for (size_t i = 0; i < count; i++) {
+				plane[i] = qToLittleEndian(qint16(std::max(
+					-kWaveformQuantizeRange,
+					std::floor(data[i * channels_ + c].min * scale))));
+			}
+			if (stream.writeRawData(reinterpret_cast<const char *>(plane.data()),
+									bytes) != bytes) {
+				return false;
+			}
+
+			for (size_t i = 0; i < count; i++) {
+				plane[i] = qToLittleEndian(qint16(std::min(
+					kWaveformQuantizeRange,
+					std::ceil(data[i * channels_ + c].max * scale))));
+			}
+			if (stream.writeRawData(reinterpret_cast<const char *>(plane.data()),
+									bytes) != bytes) {
+				return false;
+			}
+		}
+	}
+
+	return stream.status() == QDataStream::Ok;
+}
+
+bool AudioVisualWaveform::Load(const QString &filename)
+{
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) {
+		return false;
+	}
+
+	QDataStream stream(&file);
+
+	return Load(stream);
+}
+
+bool AudioVisualWaveform::Load(QDataStream &stream)
+{
+	quint32 version;
+	stream >> version;
+	if (stream.status() != QDataStream::Ok ||
+		version != kWaveformFileVersion) {
+		return false;
+	}
+
+	qint32 channels;
+	qint64 length_num, length_den, start_num, start_den;
+	quint32 mipmap_count;
+	float peak;
+	stream >> channels >> length_num >> length_den >> start_num >> start_den >>
+		mipmap_count >> peak;
+	if (stream.status() != QDataStream::Ok || channels <= 0 || !length_den ||
+		!start_den || mipmap_count != mipmapped_data_.size() ||
+		!(peak >= 1.0f)) {
+		return false;
+	}
+
+	float scale = peak / kWaveformQuantizeRange;
+	qint64 device_size = stream.device() ? stream.device()->size() : 0;
+
+	std::map<rational, Sample> mipmaps;
+	std::vector<qint16> plane;
+	for (quint32 i = 0; i < mipmap_count; i++) {
+		qint64 rate_num, rate_den;
+		quint64 count;
+		stream >> rate_num >> rate_den >> count;
+
+		// Each mipmap can't be larger than the file
+		if (stream.status() != QDataStream::Ok || !rate_den ||
+			count > quint64(device_size) ||
+			count * channels * 2 * sizeof(qint16) > quint64(device_size)) {
+			return false;
+		}
+
+		rational rate(rate_num, rate_den);
+		if (!mipmapped_data_.count(rate)) {
+			return false;
+		}
+
+		Sample &data = mipmaps[rate];
+		data.resize(count * channels);
+		plane.resize(count);
+		qint64 bytes = qint64(count * sizeof(qint16));
+		for (int c = 0; c < channels; c++) {
+			if (stream.readRawData(reinterpret_cast<char *>(plane.data()),
+								   bytes) != bytes) {
+				return false;
+			}
+			for (size_t j = 0; j < count; j++) {
+				data[j * channels + c].min = qFromLittleEndian(plane[j]) * scale;
+			}
+
+			if (stream.readRawData(reinterpret_cast<char *>(plane.data()),
+								   bytes) != bytes) {
+				return false;
+			}
+			for (size_t j = 0; j < count; j++) {
+				data[j * channels + c].max = qFromLittleEndian(plane[j]) * scale;
+			}
+		}
+	}
+
+	channels_ = channels;
+	length_ = rational(length_num, length_den);
+	virtual_start_ = rational(start_num, start_den);
+	mipmapped_data_ = std::move(mipmaps);
+
+	return true;
+}
+
 size_t AudioVisualWaveform::time_to_samples(const rational &time,
 											double sample_rate) const
 {
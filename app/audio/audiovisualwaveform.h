@@ -23,6 +23,7 @@
 #define SUMSAMPLES_H
 
 #include <olive/core/core.h>
+#include <QDataStream>
 #include <QPainter>
 #include <QVector>
 
@@ -111,9 +112,24 @@ public:
 	static Sample SumSamples(const SampleBuffer &samples, size_t start_index,
 							 size_t length);
 
+	/**
+   * @brief Sum `length` samples from each channel into `out`, which must hold one sample per channel
+   *
+   * Unlike the overload above, this doesn't allocate, so it can write straight into a mipmap.
+   */
+	static void SumSamples(const SampleBuffer &samples, size_t start_index,
+						   size_t length, SamplePerChannel *out);
+
 	static Sample ReSumSamples(const SamplePerChannel *samples,
 							   size_t nb_samples, int nb_channels);
 
+	/**
+   * @brief Sum interleaved sums into `out`, which must hold `nb_channels` samples
+   */
+	static void ReSumSamples(const SamplePerChannel *samples,
+							 size_t nb_samples, int nb_channels,
+							 SamplePerChannel *out);
+
 	static void DrawSample(QPainter *painter, const Sample &sample, int x,
 						   int y, int height, bool rectified);
 
@@ -122,6 +138,19 @@ public:
 							 const AudioVisualWaveform &samples,
 							 const rational &start_time);
 
+	/**
+   * @brief Write all mipmaps to a file so they can be loaded later without the audio
+   *
+   * Each mipmap is written as one array of minimums and one of maximums per channel, quantized to
+   * 16-bit. Quantizing rounds outwards so a loaded waveform never looks quieter than the original.
+   * The quantized planes are little-endian and the rest follows the stream's byte order.
+   */
+	bool Save(const QString &filename) const;
+	bool Save(QDataStream &stream) const;
+
+	bool Load(const QString &filename);
+	bool Load(QDataStream &stream);
+
 	// Must be a power of 2
 	static const rational kMinimumSampleRate;
 	static const rational kMaximumSampleRate;
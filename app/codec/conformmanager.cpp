@@ -18,8 +18,10 @@
 
 #include "conformmanager.h"
 
+#include <QDebug>
 #include <QDir>
 
+#include "audio/audiovisualwaveform.h"
 #include "task/taskmanager.h"
 
 namespace olive
@@ -34,54 +36,89 @@ ConformManager::Conform ConformManager::GetConformState(
 	// Mutex because we'll need to check the status of a conform task
 	QMutexLocker locker(&mutex_);
 
-	// Return existing conform if exists
 	QVector<QString> filenames =
 		GetConformedFilename(cache_path, stream, params);
-	if (AllConformsExist(filenames)) {
-		return { kConformExists, filenames, nullptr };
-	}
 
-	ConformTask *conforming_task = nullptr;
+	while (true) {
+		// Return existing conform if exists
+		if (AllConformsExist(filenames)) {
+			return { kConformExists, filenames, nullptr };
+		}
+
+		ConformTask *conforming_task = nullptr;
 
-	foreach (const ConformData &data, conforming_) {
-		if (data.stream == stream && data.params == params) {
-			// Already creating conform in a task
-			conforming_task = data.task;
-			break;
+		foreach (const ConformData &data, conforming_) {
+			if (data.filename == stream.filename() && data.params == params) {
+				// Already creating conform in a task
+				conforming_task = data.task;
+				break;
+			}
 		}
-	}
 
-	if (!conforming_task) {
-		// Not conforming yet, create a task to do so
+		if (!conforming_task) {
+			foreach (const ConformData &data, failed_) {
+				if (data.filename == stream.filename() &&
+					data.params == params) {
+					return { kConformFailed, QVector<QString>(), nullptr };
+				}
+			}
+
+			// Not conforming yet, create a task to do so. This also handles a task for this file having
+			// finished without this stream, in which case it's always included in the new one.
+			conforming_task =
+				new ConformTask(decoder_id, stream, params, cache_path);
+			// Direct so the task's outputs can still be read when it finishes
+			connect(conforming_task, &ConformTask::Finished, this,
+					&ConformManager::ConformTaskFinished,
+					Qt::DirectConnection);
+			conforming_task->moveToThread(TaskManager::instance()->thread());
+			QMetaObject::invokeMethod(TaskManager::instance(), "AddTask",
+									  Qt::QueuedConnection,
+									  Q_ARG(Task *, conforming_task));
+
+			conforming_.append({ stream.filename(), params, conforming_task });
+		}
 
-		// We conform to a different filename until it's done to make it clear even across sessions
-		// whether this conform is ready or not
-		QVector<QString> working_filenames = filenames;
-		for (int i = 0; i < working_filenames.size(); i++) {
-			working_filenames[i].append(QStringLiteral(".working"));
+		if (!wait) {
+			return { kConformGenerating, QVector<QString>(), conforming_task };
 		}
 
-		conforming_task =
-			new ConformTask(decoder_id, stream, params, working_filenames);
-		connect(conforming_task, &ConformTask::Finished, this,
-				&ConformManager::ConformTaskFinished);
-		conforming_task->moveToThread(TaskManager::instance()->thread());
-		QMetaObject::invokeMethod(TaskManager::instance(), "AddTask",
-								  Qt::QueuedConnection,
-								  Q_ARG(Task *, conforming_task));
-
-		conforming_.append(
-			{ stream, params, conforming_task, working_filenames, filenames });
+		conform_done_condition_.wait(&mutex_);
 	}
+}
 
-	if (wait) {
-		do {
-			conform_done_condition_.wait(&mutex_);
-		} while (!AllConformsExist(filenames));
-		return { kConformExists, filenames, nullptr };
+std::shared_ptr<const AudioVisualWaveform>
+ConformManager::GetConformedWaveform(const QString &cache_path,
+									 const Decoder::CodecStream &stream,
+									 const AudioParams &params)
+{
+	QString filename = GetWaveformFilename(cache_path, stream, params);
+
+	QMutexLocker locker(&waveform_mutex_);
+
+	// Failed loads are remembered too so a bad file isn't read over and over
+	auto it = waveforms_.constFind(filename);
+	if (it != waveforms_.constEnd()) {
+		return it.value();
 	}
 
-	return { kConformGenerating, QVector<QString>(), conforming_task };
+	if (!QFileInfo::exists(filename)) {
+		return nullptr;
+	}
+
+	auto waveform = std::make_shared<AudioVisualWaveform>();
+	if (!waveform->Load(filename)) {
+		qWarning() << "Failed to load conformed waveform" << filename;
+		waveform = nullptr;
+	}
+
+	// Waveforms of long files are large, so only keep a handful around
+	if (waveforms_.size() >= kMaximumCachedWaveforms) {
+		waveforms_.clear();
+	}
+	waveforms_.insert(filename, waveform);
+
+	return waveform;
 }
 
 QVector<QString>
@@ -107,6 +144,19 @@ ConformManager::GetConformedFilename(const QString &cache_path,
 	return filenames;
 }
 
+QString ConformManager::GetWaveformFilename(const QString &cache_path,
+											const Decoder::CodecStream &stream,
+											const AudioParams &params)
+{
+	return QDir(cache_path).filePath(
+		QStringLiteral("%1-%2.%3.%4.%5.waveform")
+			.arg(FileFunctions::GetUniqueFileIdentifier(stream.filename()),
+				 QString::number(stream.stream()),
+				 QString::number(params.sample_rate()),
+				 QString::number(params.format()),
+				 QString::number(params.channel_layout().u.mask)));
+}
+
 bool ConformManager::AllConformsExist(const QVector<QString> &filenames)
 {
 	foreach (const QString &fn, filenames) {
@@ -134,14 +184,34 @@ void ConformManager::ConformTaskFinished(Task *task, bool succeeded)
 		}
 	}
 
+	QVector<QString> finished_filenames;
+	if (data.task) {
+		for (const Decoder::ConformOutput &output : data.task->outputs()) {
+			finished_filenames.append(output.filenames);
+			if (!output.waveform_filename.isEmpty()) {
+				finished_filenames.append(output.waveform_filename);
+			}
+		}
+	}
+
 	if (succeeded) {
 		// Move file to standard conform name, making it clear this conform is ready for use
-		for (int i = 0; i < data.finished_filename.size(); i++) {
-			const QString &finished = data.finished_filename.at(i);
-			const QString &working = data.working_filename.at(i);
+		for (const QString &finished : finished_filenames) {
+			QString working = GetWorkingFilename(finished);
+
+			// Waveforms are optional, so not every output necessarily exists
+			if (QFileInfo::exists(working)) {
+				QFile::remove(finished);
+				QFile::rename(working, finished);
+			}
+		}
 
-			QFile::remove(finished);
-			QFile::rename(working, finished);
+		{
+			// Drop anything we loaded from a previous conform of these files
+			QMutexLocker waveform_locker(&waveform_mutex_);
+			for (const QString &finished : finished_filenames) {
+				waveforms_.remove(finished);
+			}
 		}
 
 		conform_done_condition_.wakeAll();
@@ -149,9 +219,16 @@ void ConformManager::ConformTaskFinished(Task *task, bool succeeded)
 		emit ConformReady();
 	} else {
 		// Failed, just delete the working filename if exists
-		for (int i = 0; i < data.working_filename.size(); i++) {
-			QFile::remove(data.working_filename.at(i));
+		for (const QString &finished : finished_filenames) {
+			QFile::remove(GetWorkingFilename(finished));
 		}
+
+		// Remember the failure so waiting threads (and later requests) don't start the same conform again
+		if (data.task) {
+			failed_.append({ data.filename, data.params, nullptr });
+		}
+
+		conform_done_condition_.wakeAll();
 	}
 }
 
@@ -19,8 +19,10 @@
 #ifndef CONFORMMANAGER_H
 #define CONFORMMANAGER_H
 
+#include <QHash>
 #include <QMutex>
 #include <QObject>
+#include <memory>
 
 #include "decoder.h"
 #include "task/conform/conform.h"
@@ -49,7 +51,7 @@ public:
 		return instance_;
 	}
 
-	enum ConformState { kConformExists, kConformGenerating };
+	enum ConformState { kConformExists, kConformGenerating, kConformFailed };
 
 	struct Conform {
 		ConformState state;
@@ -60,13 +62,49 @@ public:
 	/**
      * @brief Get conform state, and start conforming if no conform exists
      *
-     * Thread-safe.
+     * If a conform of this file to these parameters has already failed this session, kConformFailed is
+     * returned instead of trying again. Thread-safe.
      */
 	Conform GetConformState(const QString &decoder_id,
 							const QString &cache_path,
 							const Decoder::CodecStream &stream,
 							const AudioParams &params, bool wait);
 
+	/**
+     * @brief Get the visual waveform generated alongside a finished conform
+     *
+     * Returns nullptr if the conform doesn't exist or was made without a waveform. Recently used waveforms are
+     * kept in memory. Thread-safe.
+     */
+	std::shared_ptr<const AudioVisualWaveform>
+	GetConformedWaveform(const QString &cache_path,
+						 const Decoder::CodecStream &stream,
+						 const AudioParams &params);
+
+	/**
+     * @brief Get the destination filename of an audio stream conformed to a set of parameters
+     */
+	static QVector<QString>
+	GetConformedFilename(const QString &cache_path,
+						 const Decoder::CodecStream &stream,
+						 const AudioParams &params);
+
+	static QString GetWaveformFilename(const QString &cache_path,
+									   const Decoder::CodecStream &stream,
+									   const AudioParams &params);
+
+	/**
+     * @brief Filename a conform is written to until it's finished
+     *
+     * This makes it clear, even across sessions, whether a conform is ready or not.
+     */
+	static QString GetWorkingFilename(const QString &filename)
+	{
+		return filename + QStringLiteral(".working");
+	}
+
+	static bool AllConformsExist(const QVector<QString> &filenames);
+
 signals:
 	void ConformReady();
 
@@ -79,25 +117,23 @@ private:
 
 	QWaitCondition conform_done_condition_;
 
+	// Tasks conform every audio stream of a file at once, so they're tracked per file rather than per stream
 	struct ConformData {
-		Decoder::CodecStream stream;
+		QString filename;
 		AudioParams params;
 		ConformTask *task;
-		QVector<QString> working_filename;
-		QVector<QString> finished_filename;
 	};
 
 	QVector<ConformData> conforming_;
 
-	/**
-     * @brief Get the destination filename of an audio stream conformed to a set of parameters
-     */
-	static QVector<QString>
-	GetConformedFilename(const QString &cache_path,
-						 const Decoder::CodecStream &stream,
-						 const AudioParams &params);
+	// Files whose conform failed or was cancelled, task is always nullptr
+	QVector<ConformData> failed_;
 
-	static bool AllConformsExist(const QVector<QString> &filenames);
+	static const int kMaximumCachedWaveforms = 4;
+
+	QMutex waveform_mutex_;
+
+	QHash<QString, std::shared_ptr<const AudioVisualWaveform>> waveforms_;
 
 private slots:
 	void ConformTaskFinished(Task *task, bool succeeded);
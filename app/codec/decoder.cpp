@@ -25,6 +25,7 @@
 #include <QDebug>
 #include <QHash>
 
+#include "audio/audiovisualwaveform.h"
 #include "codec/ffmpeg/ffmpegdecoder.h"
 #include "codec/planarfiledevice.h"
 #include "codec/oiio/oiiodecoder.h"
@@ -155,6 +156,8 @@ Decoder::RetrieveAudio(SampleBuffer &dest, const TimeRange &range,
 	if (conform.state == ConformManager::kConformGenerating) {
 		// If we need the task, it's available in `conform.task`
 		return kWaitingForConform;
+	} else if (conform.state == ConformManager::kConformFailed) {
+		return kUnknownError;
 	}
 
 	// See if we got the conform
@@ -166,11 +169,32 @@ Decoder::RetrieveAudio(SampleBuffer &dest, const TimeRange &range,
 	}
 }
 
+void Decoder::PrepareVideo(const rational &time, int divider,
+						   CancelAtom *cancelled)
+{
+	QMutexLocker locker(&mutex_);
+
+	UpdateLastAccessed();
+
+	if (!stream_.IsValid() || !SupportsVideo()) {
+		return;
+	}
+
+	PrepareVideoInternal(time, divider, cancelled);
+}
+
 qint64 Decoder::GetLastAccessedTime()
 {
 	return last_accessed_;
 }
 
+qint64 Decoder::GetMemoryUsage()
+{
+	QMutexLocker locker(&mutex_);
+
+	return GetMemoryUsageInternal();
+}
+
 void Decoder::Close()
 {
 	QMutexLocker locker(&mutex_);
@@ -187,10 +211,56 @@ void Decoder::Close()
 	}
 }
 
-bool Decoder::ConformAudio(const QVector<QString> &output_filenames,
+Decoder::RetrieveAudioStatus
+Decoder::RetrieveWaveform(AudioVisualWaveform &dest, const TimeRange &range,
+						  const AudioParams &params, const QString &cache_path)
+{
+	QMutexLocker locker(&mutex_);
+
+	UpdateLastAccessed();
+
+	if (!stream_.IsValid() || !SupportsAudio() || params.sample_rate() <= 0 ||
+		params.channel_count() <= 0) {
+		return kInvalid;
+	}
+
+	ConformManager::Conform conform =
+		ConformManager::instance()->GetConformState(id(), cache_path, stream_,
+													params, false);
+	if (conform.state == ConformManager::kConformGenerating) {
+		return kWaitingForConform;
+	} else if (conform.state == ConformManager::kConformFailed) {
+		return kUnknownError;
+	}
+
+	std::shared_ptr<const AudioVisualWaveform> waveform =
+		ConformManager::instance()->GetConformedWaveform(cache_path, stream_,
+														 params);
+	if (!waveform) {
+		return kUnknownError;
+	}
+
+	// Same offset RetrieveAudioFromConform() applies, with silence before the audio starts
+	rational in = range.in() - GetAudioStartOffset();
+	rational silence =
+		qMin(qMax(rational(0), rational(0) - in), range.length());
+
+	dest.set_channel_count(waveform->channel_count());
+	if (silence > 0) {
+		dest.OverwriteSilence(0, silence);
+	}
+	if (silence < range.length()) {
+		dest.OverwriteSums(*waveform, silence, in + silence,
+						   range.length() - silence);
+	}
+
+	return kOK;
+}
+
+bool Decoder::ConformAudio(const QVector<ConformOutput> &outputs,
 						   const AudioParams &params, CancelAtom *cancelled)
 {
-	return ConformAudioInternal(output_filenames, params, cancelled);
+	return ConformAudioInternal(outputs, params, cancelled);
 }
 
 /*
@@ -291,11 +361,11 @@ TexturePtr Decoder::RetrieveVideoInternal(const RetrieveVideoParams &p)
 	return nullptr;
 }
 
-bool Decoder::ConformAudioInternal(const QVector<QString> &filenames,
+bool Decoder::ConformAudioInternal(const QVector<ConformOutput> &outputs,
 								   const AudioParams &params,
 								   CancelAtom *cancelled)
 {
-	Q_UNUSED(filenames)
+	Q_UNUSED(outputs)
 	Q_UNUSED(cancelled)
 	Q_UNUSED(params)
 	return false;
@@ -369,8 +439,8 @@ void Decoder::UpdateLastAccessed()
 
 uint qHash(Decoder::CodecStream stream, uint seed)
 {
-	return qHash(stream.filename(), seed) ^ ::qHash(stream.stream(), seed) ^
-		   qHash(stream.block(), seed);
+	// Block is deliberately left out to match operator==, decoders are shared between blocks
+	return qHash(stream.filename(), seed) ^ ::qHash(stream.stream(), seed);
 }
 
 }
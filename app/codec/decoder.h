@@ -40,6 +40,7 @@ extern "C" {
 namespace olive
 {
 
+class AudioVisualWaveform;
 class Decoder;
 using DecoderPtr = std::shared_ptr<Decoder>;
 
@@ -181,6 +182,17 @@ public:
    */
 	TexturePtr RetrieveVideo(const RetrieveVideoParams &p);
 
+	/**
+   * @brief Get ready to decode video from `time` without producing a frame
+   *
+   * Used to warm up decoders before playback reaches them so the first RetrieveVideo() doesn't have
+   * to seek and decode from the previous keyframe. Decoders that have nothing to prepare do nothing.
+   *
+   * This function is thread safe and can only run while the decoder is open. \see Open()
+   */
+	void PrepareVideo(const rational &time, int divider,
+					  CancelAtom *cancelled = nullptr);
+
 	enum RetrieveAudioStatus {
 		kInvalid = -1,
 		kOK,
@@ -206,6 +218,13 @@ public:
    */
 	qint64 GetLastAccessedTime();
 
+	/**
+   * @brief Approximate number of bytes this decoder is holding onto (cached frames, buffers, etc.)
+   *
+   * This function is thread safe.
+   */
+	qint64 GetMemoryUsage();
+
 	/**
    * @brief Generate a Footage object from a file
    *
@@ -228,9 +247,36 @@ public:
 	void Close();
 
 	/**
-   * @brief Conform audio stream
+   * @brief Retrieve the visual waveform of a range of audio footage
+   *
+   * Waveforms are generated alongside audio conforms, so this returns kWaitingForConform (and starts conforming)
+   * in the same situations RetrieveAudio() would. kUnknownError means no waveform was stored with the conform and
+   * it must be generated from the audio instead.
+   *
+   * This function is thread safe and can only run while the decoder is open. \see Open()
+   */
+	RetrieveAudioStatus RetrieveWaveform(AudioVisualWaveform &dest,
+										 const TimeRange &range,
+										 const AudioParams &params,
+										 const QString &cache_path);
+
+	struct ConformOutput {
+		/// Index of the stream in the open file
+		int stream;
+
+		/// One file per channel
+		QVector<QString> filenames;
+
+		/// Where to write the visual waveform, or empty to not generate one
+		QString waveform_filename;
+	};
+
+	/**
+   * @brief Conform any number of audio streams from the open file to `params`
+   *
+   * Decoders that can should read the file once for all of `outputs`.
    */
-	bool ConformAudio(const QVector<QString> &output_filenames,
+	bool ConformAudio(const QVector<ConformOutput> &outputs,
 					  const AudioParams &params,
 					  CancelAtom *cancelled = nullptr);
 
@@ -283,10 +329,34 @@ protected:
    */
 	virtual TexturePtr RetrieveVideoInternal(const RetrieveVideoParams &p);
 
-	virtual bool ConformAudioInternal(const QVector<QString> &filenames,
+	/**
+   * @brief Internal video preparation function
+   *
+   * Sub-classes that benefit from seeking ahead of time should override this. Function is already
+   * mutexed.
+   */
+	virtual void PrepareVideoInternal(const rational &time, int divider,
+									  CancelAtom *cancelled)
+	{
+		Q_UNUSED(time)
+		Q_UNUSED(divider)
+		Q_UNUSED(cancelled)
+	}
+
+	virtual bool ConformAudioInternal(const QVector<ConformOutput> &outputs,
 									  const AudioParams &params,
 									  CancelAtom *cancelled);
 
+	/**
+   * @brief Internal memory usage function
+   *
+   * Sub-classes that cache frames should override this. Function is already mutexed.
+   */
+	virtual qint64 GetMemoryUsageInternal() const
+	{
+		return 0;
+	}
+
 	void SignalProcessingProgress(int64_t ts, int64_t duration);
 
 	/**
@@ -339,6 +339,17 @@ public:
 		return error_;
 	}
 
+	/**
+   * @brief Whether WriteFrame() accepts frames in any order
+   *
+   * Encoders writing each frame to its own file don't need frames to arrive chronologically, so
+   * ExportTask can pass them on as soon as they're rendered instead of holding them back.
+   */
+	virtual bool WritesFramesInAnyOrder() const
+	{
+		return false;
+	}
+
 	QString GetFilenameForFrame(const rational &frame);
 
 	static int GetImageSequencePlaceholderDigitCount(const QString &filename);
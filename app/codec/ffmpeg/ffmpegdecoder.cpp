@@ -26,15 +26,20 @@ extern "C" {
 #include <libavformat/avformat.h>
 #include <libavutil/avutil.h>
 #include <libavutil/frame.h>
+#include <libavutil/opt.h>
 }
 
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QString>
+#include <QtConcurrent/QtConcurrent>
 #include <QtMath>
 #include <QThread>
+#include <memory>
 
+#include "audio/audiovisualwaveform.h"
 #include "codec/planarfiledevice.h"
 #include "common/ffmpegutils.h"
 #include "common/filefunctions.h"
@@ -83,6 +88,297 @@ void DiscardSubtitleStreams(AVFormatContext *ctx)
 	}
 }
 
+// Packets demuxed before the streams are decoded in parallel. Large enough that dispatching the work is cheap
+// compared to doing it, small enough that it doesn't take much memory.
+const int kConformPacketBatchSize = 256;
+
+/**
+ * @brief Decodes, resamples and writes a single audio stream for FFmpegDecoder::ConformAudioInternal()
+ *
+ * Each conformer has its own codec context and resampler so several can run at once on packets from the same
+ * demuxer. It also builds the stream's visual waveform from the resampled audio.
+ */
+class AudioConformer {
+public:
+	AudioConformer(const Decoder::ConformOutput &output,
+				   const AudioParams &params)
+		: output_(output)
+		, params_(params)
+		, codec_ctx_(nullptr)
+		, resampler_(nullptr)
+		, frame_(nullptr)
+		, failed_(false)
+		, generate_waveform_(false)
+		, waveform_block_index_(0)
+		, waveform_block_fill_(0)
+	{
+	}
+
+	~AudioConformer()
+	{
+		for (AVPacket *p : pending_) {
+			av_packet_free(&p);
+		}
+
+		wave_out_.close();
+		swr_free(&resampler_);
+		av_frame_free(&frame_);
+		avcodec_free_context(&codec_ctx_);
+	}
+
+	bool Open(AVStream *stream, const AVChannelLayout &channel_layout)
+	{
+		const AVCodec *codec =
+			avcodec_find_decoder(stream->codecpar->codec_id);
+		if (!codec) {
+			return false;
+		}
+
+		codec_ctx_ = avcodec_alloc_context3(codec);
+		if (!codec_ctx_ ||
+			avcodec_parameters_to_context(codec_ctx_, stream->codecpar) < 0) {
+			return false;
+		}
+
+		// Streams are decoded in parallel with each other so one thread each is enough
+		codec_ctx_->thread_count = 1;
+		codec_ctx_->pkt_timebase = stream->time_base;
+
+		if (avcodec_open2(codec_ctx_, codec, nullptr) < 0) {
+			return false;
+		}
+
+		AVChannelLayout layout = params_.channel_layout();
+		int r = swr_alloc_set_opts2(
+			&resampler_, &layout,
+			FFmpegUtils::GetFFmpegSampleFormat(params_.format()),
+			params_.sample_rate(), &channel_layout,
+			static_cast<AVSampleFormat>(stream->codecpar->format),
+			stream->codecpar->sample_rate, 0, nullptr);
+		av_channel_layout_uninit(&layout);
+		if (r < 0 || swr_init(resampler_) < 0) {
+			return false;
+		}
+
+		frame_ = av_frame_alloc();
+		if (!frame_ || !wave_out_.open(output_.filenames, QFile::WriteOnly)) {
+			return false;
+		}
+
+		// Waveforms are summed straight from the buffer, which has to be planar float for that
+		if (!output_.waveform_filename.isEmpty() &&
+			params_.format() == SampleFormat::F32P) {
+			generate_waveform_ = true;
+			waveform_.set_channel_count(params_.channel_count());
+			waveform_block_.set_audio_params(params_);
+			waveform_block_.set_sample_count(GetWaveformBlockSampleCount());
+			waveform_block_.allocate();
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Take ownership of the data in `pkt` to be decoded by the next Process()
+	 */
+	void QueuePacket(AVPacket *pkt)
+	{
+		AVPacket *copy = av_packet_alloc();
+		av_packet_move_ref(copy, pkt);
+		pending_.push_back(copy);
+	}
+
+	/**
+	 * @brief Decode all queued packets, and flush everything if the file has ended
+	 */
+	void Process(bool eof)
+	{
+		for (AVPacket *p : pending_) {
+			if (!failed_) {
+				failed_ = !Decode(p);
+			}
+			av_packet_free(&p);
+		}
+		pending_.clear();
+
+		if (eof && !failed_) {
+			failed_ = !Decode(nullptr) || !Resample(nullptr, 0);
+		}
+	}
+
+	bool failed() const
+	{
+		return failed_;
+	}
+
+	void Close(bool success)
+	{
+		wave_out_.close();
+
+		if (success && generate_waveform_) {
+			FlushWaveformBlock();
+
+			// The waveform is a nicety, the conform is still usable without it
+			if (!waveform_.Save(output_.waveform_filename)) {
+				qWarning() << "Failed to save conformed waveform"
+						   << output_.waveform_filename;
+			}
+		}
+	}
+
+private:
+	bool Decode(AVPacket *pkt)
+	{
+		int ret = avcodec_send_packet(codec_ctx_, pkt);
+		if (ret < 0 && ret != AVERROR_EOF) {
+			qWarning() << "Failed to decode audio for conform:" << ret;
+			return false;
+		}
+
+		while ((ret = avcodec_receive_frame(codec_ctx_, frame_)) >= 0) {
+			bool ok = Resample(const_cast<const uint8_t **>(frame_->data),
+							   frame_->nb_samples);
+			av_frame_unref(frame_);
+			if (!ok) {
+				return false;
+			}
+		}
+
+		return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+	}
+
+	bool Resample(const uint8_t **in, int nb_in_samples)
+	{
+		int nb_samples = swr_get_out_samples(resampler_, nb_in_samples);
+		if (nb_samples <= 0) {
+			return nb_samples == 0;
+		}
+
+		if (!convert_buffer_.is_allocated() ||
+			convert_buffer_.sample_count() < size_t(nb_samples)) {
+			convert_buffer_.destroy();
+			convert_buffer_.set_audio_params(params_);
+			convert_buffer_.set_sample_count(nb_samples);
+			convert_buffer_.allocate();
+		}
+
+		// Resample audio to our destination parameters
+		nb_samples = swr_convert(
+			resampler_,
+			reinterpret_cast<uint8_t **>(convert_buffer_.to_raw_ptrs().data()),
+			nb_samples, in, nb_in_samples);
+		if (nb_samples < 0) {
+			char err_str[512];
+			av_strerror(nb_samples, err_str, 512);
+			qWarning() << "libswresample failed with error:" << nb_samples
+					   << err_str;
+			return false;
+		}
+
+		// Write to files
+		wave_out_.write(const_cast<const char **>(reinterpret_cast<char **>(
+							convert_buffer_.to_raw_ptrs().data())),
+						params_.samples_to_bytes(nb_samples) /
+							params_.channel_count());
+
+		if (generate_waveform_) {
+			AppendToWaveform(nb_samples);
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief Waveforms are written in blocks the length of one sample of the smallest mipmap
+	 *
+	 * Writing smaller pieces would leave the smaller mipmaps summarizing only the last piece written to them.
+	 */
+	size_t GetWaveformBlockSampleCount() const
+	{
+		return size_t(qRound64(
+			AudioVisualWaveform::kMinimumSampleRate.flipped().toDouble() *
+			params_.sample_rate()));
+	}
+
+	void AppendToWaveform(int nb_samples)
+	{
+		size_t block_size = GetWaveformBlockSampleCount();
+		size_t read = 0;
+
+		while (read < size_t(nb_samples)) {
+			size_t count = qMin(size_t(nb_samples) - read,
+								block_size - waveform_block_fill_);
+
+			for (int i = 0; i < params_.channel_count(); i++) {
+				memcpy(waveform_block_.data(i) + waveform_block_fill_,
+					   convert_buffer_.data(i) + read, count * sizeof(float));
+			}
+
+			read += count;
+			waveform_block_fill_ += count;
+
+			if (waveform_block_fill_ == block_size) {
+				waveform_.OverwriteSamples(waveform_block_,
+										   params_.sample_rate(),
+										   GetWaveformBlockStart());
+				waveform_block_index_++;
+				waveform_block_fill_ = 0;
+			}
+		}
+	}
+
+	void FlushWaveformBlock()
+	{
+		if (!waveform_block_fill_) {
+			return;
+		}
+
+		SampleBuffer tail(params_, waveform_block_fill_);
+		for (int i = 0; i < params_.channel_count(); i++) {
+			memcpy(tail.data(i), waveform_block_.data(i),
+				   waveform_block_fill_ * sizeof(float));
+		}
+
+		waveform_.OverwriteSamples(tail, params_.sample_rate(),
+								   GetWaveformBlockStart());
+		waveform_block_fill_ = 0;
+	}
+
+	rational GetWaveformBlockStart() const
+	{
+		return AudioVisualWaveform::kMinimumSampleRate.flipped() *
+			   rational(waveform_block_index_);
+	}
+
+	Decoder::ConformOutput output_;
+
+	AudioParams params_;
+
+	AVCodecContext *codec_ctx_;
+
+	SwrContext *resampler_;
+
+	AVFrame *frame_;
+
+	PlanarFileDevice wave_out_;
+
+	std::vector<AVPacket *> pending_;
+
+	SampleBuffer convert_buffer_;
+
+	bool failed_;
+
+	bool generate_waveform_;
+
+	AudioVisualWaveform waveform_;
+
+	SampleBuffer waveform_block_;
+
+	int64_t waveform_block_index_;
+
+	size_t waveform_block_fill_;
+};
+
 } // namespace
 
 FFmpegDecoder::FFmpegDecoder()
@@ -90,13 +386,22 @@ FFmpegDecoder::FFmpegDecoder()
 	, working_packet_(nullptr)
 	, cache_at_zero_(false)
 	, cache_at_eof_(false)
+	, instance_(nullptr)
+	, lowres_(0)
+	, lowres_updates_(0)
 {
 }
 
 bool FFmpegDecoder::OpenInternal()
 {
-	if (instance_.Open(stream().filename().toUtf8(), stream().stream())) {
-		AVStream *s = instance_.avstream();
+	lowres_ = 0;
+	lowres_updates_ = 0;
+
+	instance_ = new Instance();
+	instances_[0].instance.reset(instance_);
+
+	if (instance_->Open(stream().filename().toUtf8(), stream().stream())) {
+		AVStream *s = instance_->avstream();
 
 		// Store one second in the source's timebase
 		second_ts_ = qRound64(av_q2d(av_inv_q(s->time_base)));
@@ -118,11 +423,16 @@ TexturePtr FFmpegDecoder::ProcessFrameIntoTexture(AVFramePtr f,
 	PixelFormat native_fmt = GetNativePixelFormat(ideal_fmt);
 	int native_channels = GetNativeChannelCount(ideal_fmt);
 
-	// Set up video params
-	VideoParams vp(original->width, original->height, native_fmt,
+	// Set up video params. If the codec decoded at a reduced resolution (see UpdateLowres()), the params still
+	// describe the full resolution image and the divider accounts for the difference.
+	int full_width = lowres_ ? instance_->avstream()->codecpar->width :
+							   original->width;
+	int full_height = lowres_ ? instance_->avstream()->codecpar->height :
+								original->height;
+	VideoParams vp(full_width, full_height, native_fmt,
 				   native_channels,
-				   av_guess_sample_aspect_ratio(instance_.fmt_ctx(),
-												instance_.avstream(), nullptr),
+				   av_guess_sample_aspect_ratio(instance_->fmt_ctx(),
+												instance_->avstream(), nullptr),
 				   VideoParams::kInterlaceNone, p.divider);
 
 	// Create texture
@@ -261,7 +571,7 @@ TexturePtr FFmpegDecoder::ProcessFrameIntoTexture(AVFramePtr f,
 		}
 
 		rational frame_rate_tb = av_guess_frame_rate(
-			instance_.fmt_ctx(), instance_.avstream(), original.get());
+			instance_->fmt_ctx(), instance_->avstream(), original.get());
 
 		// Double frame rate for interlaced fields
 		frame_rate_tb *= 2;
@@ -270,10 +580,10 @@ TexturePtr FFmpegDecoder::ProcessFrameIntoTexture(AVFramePtr f,
 		frame_rate_tb.flip();
 
 		int64_t req = Timecode::time_to_timestamp(
-			p.time + rational(instance_.fmt_ctx()->start_time, AV_TIME_BASE),
+			p.time + rational(instance_->fmt_ctx()->start_time, AV_TIME_BASE),
 			frame_rate_tb);
 		int64_t frm = Timecode::rescale_timestamp(
-			original->pts, instance_.avstream()->time_base, frame_rate_tb);
+			original->pts, instance_->avstream()->time_base, frame_rate_tb);
 
 		bool first = (req == frm);
 		bool top_first =
@@ -289,7 +599,7 @@ TexturePtr FFmpegDecoder::ProcessFrameIntoTexture(AVFramePtr f,
 		job.Insert(QStringLiteral("interlacing"),
 				   NodeValue(NodeValue::kInt, interlacing));
 		job.Insert(QStringLiteral("pixel_height"),
-				   NodeValue(NodeValue::kInt, original->height));
+				   NodeValue(NodeValue::kInt, full_height));
 
 		p.renderer->BlitToTexture(DeinterlaceShader, job, deinterlaced.get(),
 								  false);
@@ -302,6 +612,10 @@ TexturePtr FFmpegDecoder::ProcessFrameIntoTexture(AVFramePtr f,
 
 TexturePtr FFmpegDecoder::RetrieveVideoInternal(const RetrieveVideoParams &p)
 {
+	if (!UpdateLowres(p.divider)) {
+		return nullptr;
+	}
+
 	if (AVFramePtr f = RetrieveFrame(p.time, p.cancelled)) {
 		if (p.cancelled && p.cancelled->IsCancelled()) {
 			return nullptr;
@@ -335,6 +649,16 @@ TexturePtr FFmpegDecoder::RetrieveVideoInternal(const RetrieveVideoParams &p)
 	return nullptr;
 }
 
+void FFmpegDecoder::PrepareVideoInternal(const rational &time, int divider,
+										 CancelAtom *cancelled)
+{
+	// Seeking and decoding up to `time` leaves the frame in the cache and the demuxer positioned
+	// right after it, which is all RetrieveVideoInternal() will need when it's called for real
+	if (UpdateLowres(divider)) {
+		RetrieveFrame(time, cancelled);
+	}
+}
+
 void FFmpegDecoder::CloseInternal()
 {
 	if (working_packet_) {
@@ -345,17 +669,30 @@ void FFmpegDecoder::CloseInternal()
 	ClearFrameCache();
 	FreeScaler();
 
-	instance_.Close();
+	instances_.clear();
+	instance_ = nullptr;
+}
+
+qint64 FFmpegDecoder::GetMemoryUsageInternal() const
+{
+	qint64 bytes = 0;
+
+	for (const AVFramePtr &f : cached_frames_) {
+		for (int i = 0; i < AV_NUM_DATA_POINTERS && f->buf[i]; i++) {
+			bytes += f->buf[i]->size;
+		}
+	}
+
+	return bytes;
 }
 
 rational FFmpegDecoder::GetAudioStartOffset() const
 {
-	auto f = instance_.fmt_ctx();
-	if (f) {
+	if (instance_ && instance_->fmt_ctx()) {
 		rational fmt_start =
-			rational(instance_.fmt_ctx()->start_time, AV_TIME_BASE);
-		rational str_start = rational(instance_.avstream()->time_base) *
-							 instance_.avstream()->start_time;
+			rational(instance_->fmt_ctx()->start_time, AV_TIME_BASE);
+		rational str_start = rational(instance_->avstream()->time_base) *
+							 instance_->avstream()->start_time;
 		return str_start - fmt_start;
 	} else {
 		return 0;
@@ -617,127 +954,117 @@ QString FFmpegDecoder::FFmpegError(int error_code)
 	return QStringLiteral("%1 %2").arg(QString::number(error_code), err);
 }
 
-bool FFmpegDecoder::ConformAudioInternal(const QVector<QString> &filenames,
+bool FFmpegDecoder::ConformAudioInternal(const QVector<ConformOutput> &outputs,
 										 const AudioParams &params,
 										 CancelAtom *cancelled)
 {
-	// Iterate through each audio frame and extract the PCM data
+	AVFormatContext *fmt_ctx = instance_->fmt_ctx();
+
+	// Set up a decoder, resampler and output for every stream we're conforming
+	std::vector<std::unique_ptr<AudioConformer>> conformers;
+	QHash<int, AudioConformer *> stream_conformers;
+	for (const ConformOutput &output : outputs) {
+		if (output.stream < 0 || output.stream >= int(fmt_ctx->nb_streams)) {
+			qCritical() << "Invalid stream for conform:" << output.stream;
+			return false;
+		}
 
-	// Seek to starting point
-	instance_.Seek(0);
+		AVStream *stream = fmt_ctx->streams[output.stream];
 
-	// Handle NULL channel layout
-	AVChannelLayout channel_layout =
-		ValidateChannelLayout(instance_.avstream());
-	if (!av_channel_layout_check(&channel_layout)) {
-		qCritical()
-			<< "Failed to determine channel layout of audio file, could not conform";
-		return false;
-	}
-	// Create resampling context
-	AVChannelLayout layout = params.channel_layout();
-	SwrContext *resampler=NULL;
-	swr_alloc_set_opts2(
-		&resampler, &layout,
-		FFmpegUtils::GetFFmpegSampleFormat(params.format()),
-		params.sample_rate(), &channel_layout,
-		static_cast<AVSampleFormat>(instance_.avstream()->codecpar->format),
-		instance_.avstream()->codecpar->sample_rate, 0, nullptr);
-	av_channel_layout_uninit(&layout);
-	swr_init(resampler);
+		// Handle NULL channel layout
+		AVChannelLayout channel_layout = ValidateChannelLayout(stream);
+		if (!av_channel_layout_check(&channel_layout)) {
+			qCritical() << "Failed to determine channel layout of audio stream"
+						<< output.stream << "- could not conform";
+			return false;
+		}
 
-	AVPacket *pkt = av_packet_alloc();
-	AVFrame *frame = av_frame_alloc();
-	int ret;
+		auto conformer = std::make_unique<AudioConformer>(output, params);
+		if (!conformer->Open(stream, channel_layout)) {
+			qCritical() << "Failed to set up conform of audio stream"
+						<< output.stream;
+			return false;
+		}
 
-	bool success = false;
+		stream_conformers.insert(output.stream, conformer.get());
+		conformers.push_back(std::move(conformer));
+	}
+
+	// Seek to starting point
+	instance_->Seek(0);
 
-	int64_t duration = instance_.avstream()->duration;
+	int64_t duration = instance_->avstream()->duration;
 	if (duration == 0 || duration == AV_NOPTS_VALUE) {
-		duration = instance_.fmt_ctx()->duration;
+		duration = instance_->fmt_ctx()->duration;
 		if (!(duration == 0 || duration == AV_NOPTS_VALUE)) {
 			// Rescale from AVFormatContext timebase to AVStream timebase
 			duration = av_rescale_q_rnd(duration, { 1, AV_TIME_BASE },
-										instance_.avstream()->time_base,
+										instance_->avstream()->time_base,
 										AV_ROUND_UP);
 		}
 	}
 
-	PlanarFileDevice wave_out;
-	if (wave_out.open(filenames, QFile::WriteOnly)) {
-		int nb_channels = params.channel_count();
-		SampleBuffer data;
-		data.set_audio_params(params);
-
-		while (true) {
-			// Check if we have a `cancelled` ptr and its value
-			if (cancelled && cancelled->IsCancelled()) {
-				break;
-			}
+	AVPacket *pkt = av_packet_alloc();
+	bool success = false;
 
-			ret = instance_.GetFrame(pkt, frame);
+	while (true) {
+		// Check if we have a `cancelled` ptr and its value
+		if (cancelled && cancelled->IsCancelled()) {
+			break;
+		}
 
-			if (ret < 0) {
-				if (ret == AVERROR_EOF) {
-					success = true;
-				} else {
-					char err_str[512];
-					av_strerror(ret, err_str, 512);
-					qWarning() << "Failed to conform:" << ret << err_str;
+		// Demux a batch of packets for all streams at once...
+		int ret = 0;
+		int queued = 0;
+		int64_t progress = AV_NOPTS_VALUE;
+		while (queued < kConformPacketBatchSize &&
+			   (ret = av_read_frame(fmt_ctx, pkt)) >= 0) {
+			if (AudioConformer *c = stream_conformers.value(pkt->stream_index)) {
+				if (pkt->stream_index == instance_->avstream()->index) {
+					progress = pkt->pts;
 				}
-				break;
-			}
 
-			// Allocate buffers
-			int nb_samples = swr_get_out_samples(resampler, frame->nb_samples);
-			int nb_bytes_per_channel =
-				params.samples_to_bytes(nb_samples) / nb_channels;
-			data.set_sample_count(nb_bytes_per_channel);
-			data.allocate();
-
-			// Resample audio to our destination parameters
-			nb_samples = swr_convert(
-				resampler,
-				reinterpret_cast<uint8_t **>(data.to_raw_ptrs().data()),
-				nb_samples, const_cast<const uint8_t **>(frame->data),
-				frame->nb_samples);
-
-			// If no error, write to files
-			if (nb_samples > 0) {
-				// Update byte count for the number of samples we actually received
-				nb_bytes_per_channel =
-					params.samples_to_bytes(nb_samples) / nb_channels;
-
-				// Write to files
-				wave_out.write(
-					const_cast<const char **>(
-						reinterpret_cast<char **>(data.to_raw_ptrs().data())),
-					nb_bytes_per_channel);
+				c->QueuePacket(pkt);
+				queued++;
 			}
 
-			// Free buffer
-			data.destroy();
+			av_packet_unref(pkt);
+		}
 
-			// Handle error now after freeing
-			if (nb_samples < 0) {
-				char err_str[512];
-				av_strerror(nb_samples, err_str, 512);
-				qWarning() << "libswresample failed with error:" << nb_samples
-						   << err_str;
-				break;
-			}
+		bool eof = (ret == AVERROR_EOF);
+		if (ret < 0 && !eof) {
+			qWarning() << "Failed to conform:" << FFmpegError(ret);
+			break;
+		}
+
+		// ...then decode and resample each stream's share of it in parallel
+		QtConcurrent::blockingMap(
+			conformers, [eof](std::unique_ptr<AudioConformer> &c) {
+				c->Process(eof);
+			});
+
+		bool failed = false;
+		for (const auto &c : conformers) {
+			failed |= c->failed();
+		}
+		if (failed) {
+			break;
+		}
 
-			SignalProcessingProgress(frame->best_effort_timestamp, duration);
+		if (progress != AV_NOPTS_VALUE) {
+			SignalProcessingProgress(progress, duration);
 		}
 
-		wave_out.close();
-	} else {
-		qWarning() << "Failed to open WAVE output for indexing";
+		if (eof) {
+			success = true;
+			break;
+		}
 	}
 
-	swr_free(&resampler);
+	for (const auto &c : conformers) {
+		c->Close(success);
+	}
 
-	av_frame_free(&frame);
 	av_packet_free(&pkt);
 
 	return success;
@@ -829,26 +1156,33 @@ AVFramePtr FFmpegDecoder::PreProcessFrame(AVFramePtr f,
 	//   - If a divider is being used, scale down the image
 	//   - If a pixel format is not compatible with the GLSL shader, convert it to RGBA ourselves
 
-	if (p.divider == 1 &&
+	int dst_width = f->width;
+	int dst_height = f->height;
+	if (p.divider > 1) {
+		// Frames decoded with lowres are already smaller than the stream, so size relative to the stream
+		int full_width = lowres_ ? instance_->avstream()->codecpar->width : f->width;
+		int full_height =
+			lowres_ ? instance_->avstream()->codecpar->height : f->height;
+		dst_width = VideoParams::GetScaledDimension(full_width, p.divider);
+		dst_height = VideoParams::GetScaledDimension(full_height, p.divider);
+	}
+
+	if (f->width == dst_width && f->height == dst_height &&
 		IsPixelFormatGLSLCompatible(static_cast<AVPixelFormat>(f->format))) {
-		// No CPU processing required, the user wants this in full resolution and the pixel format can
-		// be converted on the GPU
+		// No CPU processing required, the frame is already the size we want (either full resolution or
+		// decoded with lowres) and the pixel format can be converted on the GPU
 		return f;
 	}
 
 	// Some scaling and/or format conversion needs to be done
 	AVFramePtr dest = CreateAVFramePtr();
 
-	dest->width = f->width;
-	dest->height = f->height;
+	dest->width = dst_width;
+	dest->height = dst_height;
 	dest->format = f->format;
 	dest->color_range = f->color_range;
 	dest->colorspace = f->colorspace;
 	dest->hw_frames_ctx = nullptr;
-	if (p.divider > 1) {
-		dest->width = VideoParams::GetScaledDimension(dest->width, p.divider);
-		dest->height = VideoParams::GetScaledDimension(dest->height, p.divider);
-	}
 
 	if (!IsPixelFormatGLSLCompatible(
 			static_cast<AVPixelFormat>(dest->format))) {
@@ -880,11 +1214,32 @@ AVFramePtr FFmpegDecoder::PreProcessFrame(AVFramePtr f,
 		sws_colrange_ = dest->color_range;
 		sws_colspace_ = dest->colorspace;
 
-		// Create new scaler
-		sws_ctx_ = sws_getContext(sws_src_width_, sws_src_height_,
-								  sws_src_format_, sws_dst_width_,
-								  sws_dst_height_, sws_dst_format_, SWS_POINT,
-								  nullptr, nullptr, nullptr);
+		// Create new scaler. Point sampling aliases badly when shrinking so use a box filter for that, and
+		// let swscale slice the work across as many threads as it sees fit.
+		bool scaling =
+			(sws_src_width_ != sws_dst_width_ || sws_src_height_ != sws_dst_height_);
+
+		sws_ctx_ = sws_alloc_context();
+		if (!sws_ctx_) {
+			return nullptr;
+		}
+
+		av_opt_set_int(sws_ctx_, "srcw", sws_src_width_, 0);
+		av_opt_set_int(sws_ctx_, "srch", sws_src_height_, 0);
+		av_opt_set_int(sws_ctx_, "src_format", sws_src_format_, 0);
+		av_opt_set_int(sws_ctx_, "dstw", sws_dst_width_, 0);
+		av_opt_set_int(sws_ctx_, "dsth", sws_dst_height_, 0);
+		av_opt_set_int(sws_ctx_, "dst_format", sws_dst_format_, 0);
+		av_opt_set_int(sws_ctx_, "sws_flags", scaling ? SWS_AREA : SWS_POINT,
+					   0);
+		av_opt_set_int(sws_ctx_, "threads", 0, 0);
+
+		r = sws_init_context(sws_ctx_, nullptr, nullptr);
+		if (r < 0) {
+			FreeScaler();
+			FFmpegError(r);
+			return nullptr;
+		}
 
 		// Set swscale's colorspace details
 		sws_setColorspaceDetails(
@@ -907,16 +1262,93 @@ AVFramePtr FFmpegDecoder::PreProcessFrame(AVFramePtr f,
 	return dest;
 }
 
+int FFmpegDecoder::GetLowresForDivider(int divider)
+{
+	int max_lowres = instance_->codec_ctx()->codec->max_lowres;
+
+	int lowres = 0;
+	while (lowres < max_lowres && (2 << lowres) <= divider) {
+		lowres++;
+	}
+
+	return lowres;
+}
+
+bool FFmpegDecoder::UpdateLowres(int divider)
+{
+	if (!instance_ || !instance_->IsOpen()) {
+		return false;
+	}
+
+	lowres_updates_++;
+
+	int lowres = GetLowresForDivider(divider);
+	if (lowres != lowres_) {
+		Instance *instance = OpenLowres(lowres);
+		if (!instance && lowres != 0) {
+			// Fall back to full resolution so the decoder remains usable
+			qWarning() << "Failed to open lowres level" << lowres
+					   << "for" << stream().filename();
+			lowres = 0;
+			instance = OpenLowres(lowres);
+		}
+
+		if (!instance) {
+			return false;
+		}
+
+		if (lowres != lowres_) {
+			// Cached frames were decoded at the old resolution. The other instance is wherever it last decoded,
+			// RetrieveFrame() seeks it since the cache is empty.
+			ClearFrameCache();
+			FreeScaler();
+
+			instance_ = instance;
+			lowres_ = lowres;
+		}
+	}
+
+	instances_[lowres_].last_used = lowres_updates_;
+
+	// Close levels we've moved away from
+	for (auto it = instances_.begin(); it != instances_.end();) {
+		if (it->first != lowres_ &&
+			lowres_updates_ - it->second.last_used > kLowresIdleFrames) {
+			it = instances_.erase(it);
+		} else {
+			it++;
+		}
+	}
+
+	return true;
+}
+
+FFmpegDecoder::Instance *FFmpegDecoder::OpenLowres(int lowres)
+{
+	LowresInstance &level = instances_[lowres];
+
+	if (!level.instance) {
+		level.instance.reset(new Instance());
+		if (!level.instance->Open(stream().filename().toUtf8(),
+								  stream().stream(), lowres)) {
+			instances_.erase(lowres);
+			return nullptr;
+		}
+	}
+
+	return level.instance.get();
+}
+
 AVFramePtr FFmpegDecoder::RetrieveFrame(const rational &time,
 										CancelAtom *cancelled)
 {
 	int64_t target_ts =
-		Timecode::time_to_timestamp(time, instance_.avstream()->time_base);
+		Timecode::time_to_timestamp(time, instance_->avstream()->time_base);
 
-	if (instance_.fmt_ctx()->start_time != AV_NOPTS_VALUE) {
-		target_ts += av_rescale_q(instance_.fmt_ctx()->start_time,
+	if (instance_->fmt_ctx()->start_time != AV_NOPTS_VALUE) {
+		target_ts += av_rescale_q(instance_->fmt_ctx()->start_time,
 								  { 1, AV_TIME_BASE },
-								  instance_.avstream()->time_base);
+								  instance_->avstream()->time_base);
 	}
 
 	const int64_t min_seek = 0;
@@ -930,7 +1362,7 @@ AVFramePtr FFmpegDecoder::RetrieveFrame(const rational &time,
 			 target_ts > cached_frames_.back()->pts + 2 * second_ts_)) {
 			ClearFrameCache();
 
-			instance_.Seek(seek_ts);
+			instance_->Seek(seek_ts);
 			if (seek_ts == min_seek) {
 				cache_at_zero_ = true;
 			}
@@ -961,7 +1393,7 @@ AVFramePtr FFmpegDecoder::RetrieveFrame(const rational &time,
 		}
 
 		// Pull from the decoder
-		ret = instance_.GetFrame(working_packet_, filtered.get());
+		ret = instance_->GetFrame(working_packet_, filtered.get());
 
 		if (cancelled && cancelled->IsCancelled()) {
 			break;
@@ -980,7 +1412,7 @@ AVFramePtr FFmpegDecoder::RetrieveFrame(const rational &time,
 				(ret == AVERROR_EOF ||
 				 filtered->best_effort_timestamp > target_ts)) {
 				seek_ts = qMax(min_seek, seek_ts - second_ts_);
-				instance_.Seek(seek_ts);
+				instance_->Seek(seek_ts);
 				if (seek_ts == min_seek) {
 					cache_at_zero_ = true;
 				}
@@ -999,7 +1431,7 @@ AVFramePtr FFmpegDecoder::RetrieveFrame(const rational &time,
 				if (!retried_after_eof) {
 					retried_after_eof = true;
 					ClearFrameCache();
-					instance_.Seek(min_seek);
+					instance_->Seek(min_seek);
 					cache_at_zero_ = true;
 					still_seeking = true;
 					continue;
@@ -1118,7 +1550,8 @@ FFmpegDecoder::Instance::Instance()
 {
 }
 
-bool FFmpegDecoder::Instance::Open(const char *filename, int stream_index)
+bool FFmpegDecoder::Instance::Open(const char *filename, int stream_index,
+								   int lowres)
 {
 	// Open file in a format context
 	AVDictionary *format_opts = nullptr;
@@ -1183,6 +1616,12 @@ bool FFmpegDecoder::Instance::Open(const char *filename, int stream_index)
 		qCritical() << "Failed to set codec options, performance may suffer";
 	}
 
+	// Decode at reduced resolution if requested and the codec can
+	lowres = qMin(lowres, int(codec->max_lowres));
+	if (lowres > 0) {
+		av_dict_set_int(&opts_, "lowres", lowres, 0);
+	}
+
 	// Open codec
 	error_code = avcodec_open2(codec_ctx_, codec, &opts_);
 	if (error_code < 0) {
@@ -33,6 +33,8 @@ extern "C" {
 #include <libswresample/swresample.h>
 }
 
+#include <map>
+#include <memory>
 #include <QTimer>
 #include <QVector>
 #include <QWaitCondition>
@@ -87,11 +89,15 @@ protected:
 	virtual bool OpenInternal() override;
 	virtual TexturePtr
 	RetrieveVideoInternal(const RetrieveVideoParams &p) override;
-	virtual bool ConformAudioInternal(const QVector<QString> &filenames,
+	virtual void PrepareVideoInternal(const rational &time, int divider,
+									  CancelAtom *cancelled) override;
+	virtual bool ConformAudioInternal(const QVector<ConformOutput> &outputs,
 									  const AudioParams &params,
 									  CancelAtom *cancelled) override;
 	virtual void CloseInternal() override;
 
+	virtual qint64 GetMemoryUsageInternal() const override;
+
 	virtual rational GetAudioStartOffset() const override;
 
 private:
@@ -104,7 +110,13 @@ private:
 			Close();
 		}
 
-		bool Open(const char *filename, int stream_index);
+		/**
+     * @brief Open a stream for decoding
+     *
+     * `lowres` asks the codec to decode at 1/2^lowres of the full resolution. Codecs that can't do this
+     * (AVCodec::max_lowres) ignore values higher than they support.
+     */
+		bool Open(const char *filename, int stream_index, int lowres = 0);
 
 		bool IsOpen() const
 		{
@@ -151,6 +163,16 @@ private:
 		AVDictionary *opts_;
 	};
 
+	struct LowresInstance {
+		std::unique_ptr<Instance> instance;
+
+		/// Value of `lowres_updates_` when this level was last used
+		int64_t last_used = 0;
+	};
+
+	/// Levels that haven't been used for this many frames are closed
+	static const int kLowresIdleFrames = 120;
+
 	/**
    * @brief Handle an FFmpeg error code
    *
@@ -173,6 +195,27 @@ private:
 
 	static bool IsPixelFormatGLSLCompatible(AVPixelFormat f);
 
+	/**
+   * @brief Get the largest lowres level the stream's codec supports that isn't smaller than `divider`
+   */
+	int GetLowresForDivider(int divider);
+
+	/**
+   * @brief Switch to the instance decoding at the lowres level that suits `divider`
+   *
+   * Levels stay open for kLowresIdleFrames after they were last used, so alternating dividers (e.g. a paused
+   * full-resolution frame between reduced-resolution playback) only costs a seek rather than re-opening the
+   * file, but levels playback has moved away from don't hold a demuxer and codec until Close().
+   */
+	bool UpdateLowres(int divider);
+
+	/**
+   * @brief Get the instance for a lowres level, opening it if necessary
+   *
+   * Returns nullptr if it couldn't be opened.
+   */
+	Instance *OpenLowres(int lowres);
+
 	AVFramePtr GetFrameFromCache(const int64_t &t) const;
 
 	void ClearFrameCache();
@@ -208,7 +251,16 @@ private:
 	bool cache_at_zero_;
 	bool cache_at_eof_;
 
-	Instance instance_;
+	/// Instance decoding at `lowres_`, owned by `instances_`
+	Instance *instance_;
+
+	/// Instances currently open for this stream, keyed on lowres level
+	std::map<int, LowresInstance> instances_;
+
+	int lowres_;
+
+	/// Number of UpdateLowres() calls, used to find idle levels
+	int64_t lowres_updates_;
 };
 
 }
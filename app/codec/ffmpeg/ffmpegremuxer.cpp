@@ -0,0 +1,323 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "ffmpegremuxer.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+#include <QCoreApplication>
+#include <QVector>
+#include <algorithm>
+
+namespace olive
+{
+
+namespace
+{
+
+QString AVError(int error_code)
+{
+	char err[1024];
+	av_strerror(error_code, err, 512);
+	return QStringLiteral("%1 %2").arg(QString::number(error_code), err);
+}
+
+class InputFile {
+public:
+	~InputFile()
+	{
+		Close();
+	}
+
+	bool Open(const QString &filename, QString *error)
+	{
+		Close();
+
+		int r = avformat_open_input(&ctx, filename.toUtf8(), nullptr, nullptr);
+		if (r >= 0) {
+			r = avformat_find_stream_info(ctx, nullptr);
+		}
+
+		if (r < 0) {
+			*error = QCoreApplication::translate("FFmpegRemuxer",
+												 "Failed to open \"%1\": %2")
+						 .arg(filename, AVError(r));
+			return false;
+		}
+
+		return true;
+	}
+
+	void Close()
+	{
+		if (ctx) {
+			avformat_close_input(&ctx);
+		}
+	}
+
+	AVFormatContext *ctx = nullptr;
+};
+
+}
+
+bool FFmpegRemuxer::Concat(const QStringList &segments, const QString &streams,
+						   const QString &output, QString *error)
+{
+	if (segments.isEmpty()) {
+		*error = QCoreApplication::translate("FFmpegRemuxer",
+											 "No segments to concatenate");
+		return false;
+	}
+
+	InputFile segment;
+	if (!segment.Open(segments.first(), error)) {
+		return false;
+	}
+
+	int segment_video = av_find_best_stream(segment.ctx, AVMEDIA_TYPE_VIDEO, -1,
+											-1, nullptr, 0);
+	if (segment_video < 0) {
+		*error = QCoreApplication::translate("FFmpegRemuxer",
+											 "No video stream in \"%1\"")
+					 .arg(segments.first());
+		return false;
+	}
+
+	InputFile extra;
+	if (!streams.isEmpty() && !extra.Open(streams, error)) {
+		return false;
+	}
+
+	AVFormatContext *out = nullptr;
+	int r = avformat_alloc_output_context2(&out, nullptr, nullptr,
+										   output.toUtf8());
+	if (r < 0) {
+		*error = AVError(r);
+		return false;
+	}
+
+	// Video is described by the first segment, the rest are expected to match it
+	AVStream *video_out = avformat_new_stream(out, nullptr);
+	{
+		AVStream *in = segment.ctx->streams[segment_video];
+		avcodec_parameters_copy(video_out->codecpar, in->codecpar);
+		video_out->codecpar->codec_tag = 0;
+		video_out->time_base = in->time_base;
+		video_out->avg_frame_rate = in->avg_frame_rate;
+	}
+
+	// Map every non-video stream of the extra file to a new output stream
+	QVector<int> extra_map;
+	if (extra.ctx) {
+		extra_map.fill(-1, extra.ctx->nb_streams);
+		for (unsigned int i = 0; i < extra.ctx->nb_streams; i++) {
+			AVStream *in = extra.ctx->streams[i];
+			if (in->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+				continue;
+			}
+
+			AVStream *s = avformat_new_stream(out, nullptr);
+			avcodec_parameters_copy(s->codecpar, in->codecpar);
+			s->codecpar->codec_tag = 0;
+			s->time_base = in->time_base;
+			extra_map[i] = s->index;
+		}
+	}
+
+	if (!(out->oformat->flags & AVFMT_NOFILE)) {
+		r = avio_open(&out->pb, output.toUtf8(), AVIO_FLAG_WRITE);
+		if (r < 0) {
+			*error = QCoreApplication::translate("FFmpegRemuxer",
+												 "Failed to open \"%1\": %2")
+						 .arg(output, AVError(r));
+			avformat_free_context(out);
+			return false;
+		}
+	}
+
+	r = avformat_write_header(out, nullptr);
+	if (r < 0) {
+		*error = AVError(r);
+		avio_closep(&out->pb);
+		avformat_free_context(out);
+		return false;
+	}
+
+	AVPacket *video_pkt = av_packet_alloc();
+	AVPacket *extra_pkt = av_packet_alloc();
+
+	int segment_index = 0;
+	int64_t segment_start = 0;
+	int64_t offset = 0;
+	int64_t segment_end = 0;
+	bool read_error = false;
+
+	auto segment_started = [&] {
+		AVStream *in = segment.ctx->streams[segment_video];
+		segment_start = (in->start_time == AV_NOPTS_VALUE) ?
+							0 :
+							av_rescale_q(in->start_time, in->time_base,
+										 video_out->time_base);
+	};
+
+	// Next video packet across all segments, shifted to follow the end of the previous segment
+	auto next_video = [&]() -> bool {
+		forever {
+			r = av_read_frame(segment.ctx, video_pkt);
+
+			if (r == AVERROR_EOF) {
+				segment_index++;
+				if (segment_index == segments.size()) {
+					return false;
+				}
+
+				if (!segment.Open(segments.at(segment_index), error)) {
+					read_error = true;
+					return false;
+				}
+
+				segment_video = av_find_best_stream(
+					segment.ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+				if (segment_video < 0) {
+					*error = QCoreApplication::translate(
+								 "FFmpegRemuxer", "No video stream in \"%1\"")
+								 .arg(segments.at(segment_index));
+					read_error = true;
+					return false;
+				}
+
+				offset = segment_end;
+				segment_started();
+				continue;
+			} else if (r < 0) {
+				*error = AVError(r);
+				read_error = true;
+				return false;
+			}
+
+			if (video_pkt->stream_index != segment_video) {
+				av_packet_unref(video_pkt);
+				continue;
+			}
+
+			av_packet_rescale_ts(
+				video_pkt, segment.ctx->streams[segment_video]->time_base,
+				video_out->time_base);
+
+			if (video_pkt->pts != AV_NOPTS_VALUE) {
+				video_pkt->pts += offset - segment_start;
+				segment_end = std::max(segment_end,
+									   video_pkt->pts + video_pkt->duration);
+			}
+			if (video_pkt->dts != AV_NOPTS_VALUE) {
+				video_pkt->dts += offset - segment_start;
+			}
+
+			video_pkt->stream_index = video_out->index;
+			video_pkt->pos = -1;
+			return true;
+		}
+	};
+
+	auto next_extra = [&]() -> bool {
+		if (!extra.ctx) {
+			return false;
+		}
+
+		forever {
+			r = av_read_frame(extra.ctx, extra_pkt);
+
+			if (r == AVERROR_EOF) {
+				return false;
+			} else if (r < 0) {
+				*error = AVError(r);
+				read_error = true;
+				return false;
+			}
+
+			int mapped = extra_map.at(extra_pkt->stream_index);
+			if (mapped == -1) {
+				av_packet_unref(extra_pkt);
+				continue;
+			}
+
+			av_packet_rescale_ts(
+				extra_pkt, extra.ctx->streams[extra_pkt->stream_index]->time_base,
+				out->streams[mapped]->time_base);
+			extra_pkt->stream_index = mapped;
+			extra_pkt->pos = -1;
+			return true;
+		}
+	};
+
+	segment_started();
+
+	bool have_video = next_video();
+	bool have_extra = !read_error && next_extra();
+	bool success = !read_error;
+
+	// Write whichever packet comes first so the muxer never has to buffer a whole stream
+	while (success && (have_video || have_extra)) {
+		bool write_video =
+			have_video &&
+			(!have_extra ||
+			 av_compare_ts(video_pkt->dts, video_out->time_base, extra_pkt->dts,
+						   out->streams[extra_pkt->stream_index]->time_base) <=
+				 0);
+
+		r = av_interleaved_write_frame(out, write_video ? video_pkt : extra_pkt);
+		if (r < 0) {
+			*error = AVError(r);
+			success = false;
+			break;
+		}
+
+		if (write_video) {
+			have_video = next_video();
+		} else {
+			have_extra = next_extra();
+		}
+
+		success = !read_error;
+	}
+
+	if (success) {
+		r = av_write_trailer(out);
+		if (r < 0) {
+			*error = AVError(r);
+			success = false;
+		}
+	}
+
+	av_packet_free(&video_pkt);
+	av_packet_free(&extra_pkt);
+
+	if (!(out->oformat->flags & AVFMT_NOFILE)) {
+		avio_closep(&out->pb);
+	}
+	avformat_free_context(out);
+
+	return success;
+}
+
+}
@@ -0,0 +1,50 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef FFMPEGREMUXER_H
+#define FFMPEGREMUXER_H
+
+#include <QStringList>
+
+namespace olive
+{
+
+/**
+ * @brief Joins separately encoded files into one without re-encoding
+ */
+class FFmpegRemuxer {
+public:
+	/**
+   * @brief Concatenate the video of `segments` and mux the rest of the streams from `streams` alongside it
+   *
+   * Packets are copied as is, so every segment must have been encoded with the same parameters and must start
+   * with a keyframe. Timestamps of each segment are offset by the length of the segments before it, the same
+   * way FFmpeg's concat demuxer does. `streams` may be empty if there's nothing to add.
+   *
+   * Returns false and sets `error` on failure.
+   */
+	static bool Concat(const QStringList &segments, const QString &streams,
+					   const QString &output, QString *error);
+};
+
+}
+
+#endif // FFMPEGREMUXER_H
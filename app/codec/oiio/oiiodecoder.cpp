@@ -21,6 +21,7 @@
 
 #include "oiiodecoder.h"
 
+#include <OpenImageIO/imagebufalgo.h>
 #include <QDebug>
 #include <QDir>
 #include <QFileInfo>
@@ -123,44 +124,84 @@ bool OIIODecoder::OpenInternal()
 
 TexturePtr OIIODecoder::RetrieveVideoInternal(const RetrieveVideoParams &p)
 {
-	VideoParams vp = GetVideoParamsFromImageSpec(image_->spec());
-	vp.set_divider(p.divider);
-
 	if (!buffer_.is_allocated() || last_params_.divider != p.divider) {
 		last_params_ = p;
 
 		buffer_.destroy();
-		buffer_.set_video_params(vp);
-		buffer_.allocate();
-
-		if (p.divider == 1) {
-			// Just upload straight to the buffer
-			image_->read_image(0, 0, 0, -1, oiio_pix_fmt_, buffer_.data());
-		} else {
-			OIIO::ImageBuf buf(image_->spec());
-			image_->read_image(0, 0, 0, -1, image_->spec().format,
+
+		if (!ReadImage(image_.get(), p.divider, &buffer_)) {
+			buffer_.destroy();
+			return nullptr;
+		}
+	}
+
+	return p.renderer->CreateTexture(buffer_.video_params(), buffer_.data(),
+									 buffer_.linesize_pixels());
+}
+
+bool OIIODecoder::ReadImage(OIIO::ImageInput *image, int divider, Frame *dest)
+{
+	VideoParams vp = GetVideoParamsFromImageSpec(image->spec());
+	vp.set_divider(divider);
+
+	OIIO::TypeDesc::BASETYPE oiio_pix_fmt =
+		OIIOUtils::GetOIIOBaseTypeFromFormat(vp.format());
+	if (oiio_pix_fmt == OIIO::TypeDesc::UNKNOWN) {
+		return false;
+	}
+
+	dest->set_video_params(vp);
+	if (!dest->allocate()) {
+		return false;
+	}
+
+	// Formats with MIP levels (e.g. tiled EXR and TIFF) already store reduced resolution copies of the image.
+	// Read the smallest one that's still at least as large as what we need.
+	int subimage = image->current_subimage();
+	int miplevel = 0;
+	if (divider > 1) {
+		while (image->seek_subimage(subimage, miplevel + 1) &&
+			   image->spec().width >= dest->width() &&
+			   image->spec().height >= dest->height()) {
+			miplevel++;
+		}
+
+		image->seek_subimage(subimage, miplevel);
+	}
+
+	OIIO::ImageSpec spec = image->spec();
+	bool ok;
+
+	if (spec.width == dest->width() && spec.height == dest->height()) {
+		// Just upload straight to the buffer
+		ok = image->read_image(subimage, miplevel, 0, -1, oiio_pix_fmt,
+							   dest->data(), OIIO::AutoStride,
+							   dest->linesize_bytes());
+	} else {
+		OIIO::ImageBuf buf(spec);
+		ok = image->read_image(subimage, miplevel, 0, -1, spec.format,
 							   buf.localpixels(), buf.pixel_stride(),
 							   buf.scanline_stride(), buf.z_stride());
 
-			// Roughly downsample image for divider (for some reason OIIO::ImageBufAlgo::resample failed here)
-			int px_sz = vp.GetBytesPerPixel();
-			for (int dst_y = 0; dst_y < buffer_.height(); dst_y++) {
-				int src_y = dst_y * buf.spec().height / buffer_.height();
-
-				for (int dst_x = 0; dst_x < buffer_.width(); dst_x++) {
-					int src_x = dst_x * buf.spec().width / buffer_.width();
-					memcpy(buffer_.data() + buffer_.linesize_bytes() * dst_y +
-							   px_sz * dst_x,
-						   static_cast<uint8_t *>(buf.localpixels()) +
-							   buf.scanline_stride() * src_y + px_sz * src_x,
-						   px_sz);
-				}
-			}
+		if (ok) {
+			// Average each block of source pixels into one destination pixel, picking single pixels aliases
+			// badly on fine detail
+			OIIO::ImageBuf resized;
+			ok = OIIO::ImageBufAlgo::resize(
+					 resized, buf, "box", 0.0f,
+					 OIIO::ROI(0, dest->width(), 0, dest->height(), 0, 1, 0,
+							   spec.nchannels)) &&
+				 resized.get_pixels(resized.roi(), oiio_pix_fmt, dest->data(),
+									OIIO::AutoStride, dest->linesize_bytes());
 		}
 	}
 
-	return p.renderer->CreateTexture(vp, buffer_.data(),
-									 buffer_.linesize_pixels());
+	// Leave the input where we found it so its spec() describes the full resolution image again
+	if (miplevel != 0) {
+		image->seek_subimage(subimage, 0);
+	}
+
+	return ok;
 }
 
 void OIIODecoder::CloseInternal()
@@ -168,6 +209,11 @@ void OIIODecoder::CloseInternal()
 	CloseImageHandle();
 }
 
+qint64 OIIODecoder::GetMemoryUsageInternal() const
+{
+	return buffer_.allocated_size();
+}
+
 bool OIIODecoder::FileTypeIsSupported(const QString &fn)
 {
 	// We prioritize OIIO over FFmpeg to pick up still images more effectively, but some OIIO decoders (notably OpenJPEG)
@@ -47,12 +47,22 @@ public:
 	virtual FootageDescription Probe(const QString &filename,
 									 CancelAtom *cancelled) const override;
 
+	/**
+   * @brief Read the current subimage of `image` into `dest`, downsampled by `divider`
+   *
+   * If the image has MIP levels, the smallest one that's at least the requested size is read instead of the
+   * full resolution image. Returns FALSE if the image couldn't be read.
+   */
+	static bool ReadImage(OIIO::ImageInput *image, int divider, Frame *dest);
+
 protected:
 	virtual bool OpenInternal() override;
 	virtual TexturePtr
 	RetrieveVideoInternal(const RetrieveVideoParams &p) override;
 	virtual void CloseInternal() override;
 
+	virtual qint64 GetMemoryUsageInternal() const override;
+
 private:
 	std::unique_ptr<OIIO::ImageInput> image_;
 
@@ -21,6 +21,10 @@
 
 #include "oiioencoder.h"
 
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+
 #include "common/oiioutils.h"
 
 namespace olive
@@ -29,19 +33,34 @@ namespace olive
 OIIOEncoder::OIIOEncoder(const EncodingParams &params)
 	: Encoder(params)
 {
+	int threads = params.video_threads();
+	if (threads <= 0) {
+		threads = QThread::idealThreadCount();
+	}
+
+	pool_.setMaxThreadCount(threads);
+	pending_.release(threads * kMaximumPendingPerThread);
 }
 
-bool OIIOEncoder::Open()
+OIIOEncoder::~OIIOEncoder()
 {
-	return true;
+	pool_.waitForDone();
 }
 
-bool OIIOEncoder::WriteFrame(FramePtr frame, rational time)
+OIIOEncoder::WriteStats OIIOEncoder::GetWriteStats() const
 {
-	std::string filename = GetFilenameForFrame(time).toStdString();
+	QMutexLocker locker(&lock_);
+
+	return stats_;
+}
 
+bool OIIOEncoder::WriteImage(const Frame *frame, const std::string &filename,
+							 const QString &compression, QString *error)
+{
 	auto output = OIIO::ImageOutput::create(filename);
 	if (!output) {
+		*error = tr("Failed to create output for %1")
+					 .arg(QString::fromStdString(filename));
 		return false;
 	}
 
@@ -49,19 +68,48 @@ bool OIIOEncoder::WriteFrame(FramePtr frame, rational time)
 	OIIO::ImageSpec spec(frame->width(), frame->height(),
 						 frame->channel_count(), type);
 
-	if (!output->open(filename, spec)) {
-		return false;
+	if (!compression.isEmpty()) {
+		spec.attribute("compression", compression.toStdString());
 	}
 
-	if (!output->write_image(type, frame->data(), OIIO::AutoStride,
-							 frame->linesize_bytes())) {
+	if (!output->open(filename, spec) ||
+		!output->write_image(type, frame->const_data(), OIIO::AutoStride,
+							 frame->linesize_bytes()) ||
+		!output->close()) {
+		*error = QString::fromStdString(output->geterror());
 		return false;
 	}
 
-	if (!output->close()) {
+	return true;
+}
+
+bool OIIOEncoder::Open()
+{
+	return true;
+}
+
+bool OIIOEncoder::WriteFrame(FramePtr frame, rational time)
+{
+	if (TakeWriteError()) {
 		return false;
 	}
 
+	std::string filename = GetFilenameForFrame(time).toStdString();
+	QString compression = params().video_option(QStringLiteral("compression"));
+
+	// Hold back the renderer once enough frames are waiting to be written
+	pending_.acquire();
+
+	pool_.start([this, frame, filename, compression] {
+		QElapsedTimer timer;
+		timer.start();
+
+		QString error;
+		bool success = WriteImage(frame.get(), filename, compression, &error);
+
+		FrameWritten(success, error, timer.elapsed());
+	});
+
 	return true;
 }
 
@@ -78,7 +126,47 @@ bool OIIOEncoder::WriteSubtitle(const SubtitleBlock *sub_block)
 
 void OIIOEncoder::Close()
 {
-	// Do nothing
+	pool_.waitForDone();
+
+	TakeWriteError();
+
+	WriteStats s = GetWriteStats();
+	if (s.frames > 0) {
+		qInfo() << "Wrote" << s.frames << "images, average"
+				<< s.total_latency / s.frames << "ms, longest"
+				<< s.maximum_latency << "ms per image";
+	}
+}
+
+void OIIOEncoder::FrameWritten(bool success, const QString &error,
+							   qint64 latency)
+{
+	{
+		QMutexLocker locker(&lock_);
+
+		stats_.frames++;
+		stats_.total_latency += latency;
+		stats_.maximum_latency = std::max(stats_.maximum_latency, latency);
+
+		if (!success && write_error_.isEmpty()) {
+			write_error_ = error;
+		}
+	}
+
+	pending_.release();
+}
+
+bool OIIOEncoder::TakeWriteError()
+{
+	QMutexLocker locker(&lock_);
+
+	if (write_error_.isEmpty()) {
+		return false;
+	}
+
+	// SetError() isn't thread-safe, so errors from the workers are only passed on from here
+	SetError(write_error_);
+	return true;
 }
 
 }
@@ -22,16 +22,55 @@
 #ifndef OIIOENCODER_H
 #define OIIOENCODER_H
 
+#include <QMutex>
+#include <QSemaphore>
+#include <QThreadPool>
+
 #include "codec/encoder.h"
 
 namespace olive
 {
 
+/**
+ * @brief Encoder for still images and image sequences
+ *
+ * Every frame is an independent file, so frames are compressed and written on a pool of worker threads
+ * (EncodingParams::video_threads(), or one per core) in whatever order they arrive. At most
+ * kMaximumPendingPerThread frames per thread are held in memory; WriteFrame() blocks once that's reached.
+ *
+ * The "compression" video option is passed on to OIIO as is, e.g. "dwaa:45" or "zip:6" for OpenEXR, "zip:9"
+ * for PNG or "lzw" for TIFF.
+ */
 class OIIOEncoder : public Encoder {
 	Q_OBJECT
 public:
 	OIIOEncoder(const EncodingParams &params);
 
+	virtual ~OIIOEncoder() override;
+
+	struct WriteStats {
+		int frames = 0;
+
+		/// Total and longest time taken to compress and write one frame, in milliseconds
+		qint64 total_latency = 0;
+		qint64 maximum_latency = 0;
+	};
+
+	static const int kMaximumPendingPerThread = 2;
+
+	virtual bool WritesFramesInAnyOrder() const override
+	{
+		return true;
+	}
+
+	WriteStats GetWriteStats() const;
+
+	/**
+   * @brief Write `frame` to `filename` synchronously
+   */
+	static bool WriteImage(const Frame *frame, const std::string &filename,
+						   const QString &compression, QString *error);
+
 public slots:
 	virtual bool Open() override;
 
@@ -41,6 +80,21 @@ public slots:
 	virtual bool WriteSubtitle(const SubtitleBlock *sub_block) override;
 
 	virtual void Close() override;
+
+private:
+	void FrameWritten(bool success, const QString &error, qint64 latency);
+
+	bool TakeWriteError();
+
+	QThreadPool pool_;
+
+	QSemaphore pending_;
+
+	mutable QMutex lock_;
+
+	WriteStats stats_;
+
+	QString write_error_;
 };
 
 }
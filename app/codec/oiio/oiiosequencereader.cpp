@@ -0,0 +1,362 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "oiiosequencereader.h"
+
+#include <QDateTime>
+
+#include "codec/decoder.h"
+#include "codec/oiio/oiiodecoder.h"
+
+namespace olive
+{
+
+QMutex OIIOSequenceReader::registry_lock_;
+QHash<QString, OIIOSequenceReaderPtr> OIIOSequenceReader::registry_;
+std::atomic<quint64> OIIOSequenceReader::stat_prefetch_used_{ 0 };
+std::atomic<quint64> OIIOSequenceReader::stat_prefetch_wasted_{ 0 };
+std::atomic<quint64> OIIOSequenceReader::stat_synchronous_{ 0 };
+std::atomic<int> OIIOSequenceReader::playback_speed_{ 0 };
+
+OIIOSequenceReader::OIIOSequenceReader(const QString &filename, int subimage)
+	: filename_(filename)
+	, subimage_(subimage)
+	, divider_(0)
+	, head_(0)
+	, has_head_(false)
+	, step_(1)
+	, recent_step_count_(0)
+	, recent_step_index_(0)
+	, last_accessed_(QDateTime::currentMSecsSinceEpoch())
+{
+}
+
+OIIOSequenceReader::~OIIOSequenceReader()
+{
+	for (const Slot &s : qAsConst(slots_)) {
+		if (s.frame) {
+			stat_prefetch_wasted_++;
+		}
+	}
+}
+
+OIIOSequenceReaderPtr OIIOSequenceReader::Get(const QString &filename,
+											  int subimage)
+{
+	QString key =
+		QStringLiteral("%1:%2").arg(filename, QString::number(subimage));
+
+	QMutexLocker locker(&registry_lock_);
+
+	OIIOSequenceReaderPtr reader = registry_.value(key);
+
+	if (!reader) {
+		reader = std::make_shared<OIIOSequenceReader>(filename, subimage);
+		registry_.insert(key, reader);
+	}
+
+	return reader;
+}
+
+void OIIOSequenceReader::ClearInactive(qint64 time)
+{
+	QMutexLocker locker(&registry_lock_);
+
+	for (auto it = registry_.begin(); it != registry_.end();) {
+		OIIOSequenceReaderPtr reader = it.value();
+
+		QMutexLocker reader_locker(&reader->mutex_);
+		if (reader->last_accessed_ < time) {
+			it = registry_.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
+OIIOSequenceReader::Stats OIIOSequenceReader::GetStats()
+{
+	Stats s;
+	s.prefetch_used = stat_prefetch_used_;
+	s.prefetch_wasted = stat_prefetch_wasted_;
+	s.synchronous = stat_synchronous_;
+	return s;
+}
+
+void OIIOSequenceReader::SetPlaybackSpeed(int speed)
+{
+	playback_speed_ = speed;
+}
+
+FramePtr OIIOSequenceReader::ReadFrame(int64_t frame_number, int divider)
+{
+	QMutexLocker locker(&mutex_);
+
+	last_accessed_ = QDateTime::currentMSecsSinceEpoch();
+
+	if (divider != divider_) {
+		// Everything prefetched so far is the wrong size
+		for (auto it = slots_.begin(); it != slots_.end();) {
+			it = DiscardSlot(it);
+		}
+		divider_ = divider;
+	}
+
+	// Move the window along with playback
+	UpdateStep(frame_number);
+
+	// Take the frame if it's been prefetched, or wait for it if it's already being read
+	FramePtr frame;
+	auto slot = slots_.find(frame_number);
+	while (slot != slots_.end() && !slot->ready) {
+		slot_ready_.wait(&mutex_);
+		slot = slots_.find(frame_number);
+	}
+
+	if (slot != slots_.end()) {
+		frame = slot->frame;
+		slots_.erase(slot);
+
+		if (frame) {
+			stat_prefetch_used_++;
+		}
+	}
+
+	// Drop anything that's no longer ahead of us. Reads still in flight are dropped when they finish.
+	for (auto it = slots_.begin(); it != slots_.end();) {
+		if (it->ready && !IsInWindow(it.key())) {
+			it = DiscardSlot(it);
+		} else {
+			it++;
+		}
+	}
+
+	OIIOSequenceReaderPtr self = shared_from_this();
+	for (int i = 1; i <= kPrefetchCount; i++) {
+		int64_t next = head_ + int64_t(step_) * i;
+		if (next < 0) {
+			break;
+		}
+
+		if (!slots_.contains(next)) {
+			slots_.insert(next, Slot());
+			io_pool()->start([self, next, divider] {
+				self->PrefetchFinished(next, divider, self->Read(next, divider));
+			});
+		}
+	}
+
+	locker.unlock();
+
+	if (!frame) {
+		frame = Read(frame_number, divider);
+		stat_synchronous_++;
+	}
+
+	return frame;
+}
+
+FramePtr OIIOSequenceReader::Read(int64_t frame_number, int divider)
+{
+	std::string fn =
+		Decoder::TransformImageSequenceFileName(filename_, frame_number)
+			.toStdString();
+
+	// Re-opening an existing input skips looking up and creating the format plugin again
+	std::unique_ptr<OIIO::ImageInput> input = TakeInput();
+	OIIO::ImageSpec spec;
+	if (!input || !input->open(fn, spec)) {
+		std::unique_ptr<OIIO::ImageInput> fresh = OIIO::ImageInput::open(fn);
+		if (!fresh) {
+			if (input) {
+				ReturnInput(std::move(input));
+			}
+			return nullptr;
+		}
+		input = std::move(fresh);
+	}
+
+	FramePtr frame;
+	if (input->seek_subimage(subimage_, 0)) {
+		frame = Frame::Create();
+		if (!OIIODecoder::ReadImage(input.get(), divider, frame.get())) {
+			frame = nullptr;
+		}
+	}
+
+	input->close();
+	ReturnInput(std::move(input));
+
+	return frame;
+}
+
+void OIIOSequenceReader::PrefetchFinished(int64_t frame_number, int divider,
+										  FramePtr frame)
+{
+	QMutexLocker locker(&mutex_);
+
+	auto slot = slots_.find(frame_number);
+
+	if (slot == slots_.end() || slot->ready || divider != divider_) {
+		// No longer wanted
+		if (frame) {
+			stat_prefetch_wasted_++;
+		}
+	} else if (!IsInWindow(frame_number)) {
+		slots_.erase(slot);
+		if (frame) {
+			stat_prefetch_wasted_++;
+		}
+	} else {
+		slot->frame = frame;
+		slot->ready = true;
+	}
+
+	slot_ready_.wakeAll();
+}
+
+void OIIOSequenceReader::UpdateStep(int64_t frame_number)
+{
+	const int speed = playback_speed_;
+	const int direction = (speed > 0) - (speed < 0);
+
+	if (direction != 0 && (step_ > 0) != (direction > 0)) {
+		// The viewer knows which way it's playing, whatever we guessed before
+		step_ = direction;
+		recent_step_count_ = 0;
+		recent_step_index_ = 0;
+	}
+
+	if (!has_head_) {
+		head_ = frame_number;
+		has_head_ = true;
+		return;
+	}
+
+	int64_t delta = frame_number - head_;
+	if (delta == 0) {
+		return;
+	}
+
+	int64_t ahead = (step_ > 0) ? delta : -delta;
+	int64_t window = int64_t(qAbs(step_)) * kPrefetchCount;
+	if (ahead > window || ahead < -window) {
+		// A seek, start again from here. Without a direction from the viewer we assume normal forward playback
+		// will resume.
+		head_ = frame_number;
+		step_ = (direction < 0) ? -1 : 1;
+		recent_step_count_ = 0;
+		recent_step_index_ = 0;
+		return;
+	}
+
+	// While playing, requests against the direction of playback are just other render threads finishing late
+	if (qAbs(delta) <= kMaximumStep &&
+		(direction == 0 || (delta > 0) == (direction > 0))) {
+		recent_steps_[recent_step_index_] = int(delta);
+		recent_step_index_ = (recent_step_index_ + 1) % kStepHistory;
+		recent_step_count_ = qMin(recent_step_count_ + 1, kStepHistory);
+
+		auto count = [this](int step) {
+			int c = 0;
+			for (int i = 0; i < recent_step_count_; i++) {
+				if (recent_steps_[i] == step) {
+					c++;
+				}
+			}
+			return c;
+		};
+
+		// Only switch to a step that's been seen more often than the current one, so a few requests arriving
+		// out of order don't change it
+		int best_count = count(step_);
+		for (int i = 0; i < recent_step_count_; i++) {
+			int c = count(recent_steps_[i]);
+			if (c > best_count) {
+				step_ = recent_steps_[i];
+				best_count = c;
+			}
+		}
+	}
+
+	// The head only moves forward in the direction of the step
+	if ((delta > 0) == (step_ > 0)) {
+		head_ = frame_number;
+	}
+}
+
+bool OIIOSequenceReader::IsInWindow(int64_t frame_number) const
+{
+	// Keep a few frames behind the head, render threads running behind may still ask for them
+	int64_t ahead = (step_ > 0) ? (frame_number - head_) :
+								  (head_ - frame_number);
+	return ahead >= -kMaximumStep &&
+		   ahead <= int64_t(qAbs(step_)) * kPrefetchCount;
+}
+
+QMap<int64_t, OIIOSequenceReader::Slot>::iterator
+OIIOSequenceReader::DiscardSlot(QMap<int64_t, Slot>::iterator it)
+{
+	if (it->frame) {
+		stat_prefetch_wasted_++;
+	}
+
+	return slots_.erase(it);
+}
+
+std::unique_ptr<OIIO::ImageInput> OIIOSequenceReader::TakeInput()
+{
+	QMutexLocker locker(&input_lock_);
+
+	if (inputs_.empty()) {
+		return nullptr;
+	}
+
+	std::unique_ptr<OIIO::ImageInput> input = std::move(inputs_.back());
+	inputs_.pop_back();
+	return input;
+}
+
+void OIIOSequenceReader::ReturnInput(std::unique_ptr<OIIO::ImageInput> input)
+{
+	QMutexLocker locker(&input_lock_);
+
+	// One per IO thread plus the render thread is all we'll ever use at once
+	if (inputs_.size() <= size_t(kIOThreadCount)) {
+		inputs_.push_back(std::move(input));
+	}
+}
+
+QThreadPool *OIIOSequenceReader::io_pool()
+{
+	static QThreadPool pool;
+
+	// Reads are IO bound, so this doesn't need to scale with cores
+	static const bool initialized = [] {
+		pool.setMaxThreadCount(kIOThreadCount);
+		return true;
+	}();
+	Q_UNUSED(initialized)
+
+	return &pool;
+}
+
+}
@@ -0,0 +1,179 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef OIIOSEQUENCEREADER_H
+#define OIIOSEQUENCEREADER_H
+
+#include <OpenImageIO/imageio.h>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "codec/frame.h"
+
+namespace olive
+{
+
+class OIIOSequenceReader;
+using OIIOSequenceReaderPtr = std::shared_ptr<OIIOSequenceReader>;
+
+/**
+ * @brief Reads frames of an image sequence with read-ahead
+ *
+ * Image sequences used to be read by opening a new decoder for every frame, synchronously, on the render
+ * thread. On slow or network storage this is far below real time even when the CPU is idle.
+ *
+ * A reader keeps a window of kPrefetchCount frames ahead of the furthest frame it's been asked for (the head) and
+ * reads them on a shared IO thread pool. Playback direction comes from the viewer (see SetPlaybackSpeed()), and the
+ * step is whichever step was seen most often in the last kStepHistory requests, so requests arriving out of order
+ * from several render threads don't move the window backwards or throw away prefetched frames. OIIO::ImageInput objects are kept and re-opened for each file
+ * rather than being re-created, and frame memory comes from FrameManager's pool.
+ *
+ * Readers are shared per (sequence, subimage) and are thread-safe.
+ */
+class OIIOSequenceReader :
+	public std::enable_shared_from_this<OIIOSequenceReader> {
+public:
+	struct Stats {
+		/// Frames that were served from the prefetch buffer
+		quint64 prefetch_used = 0;
+
+		/// Frames that were prefetched but thrown away without being used
+		quint64 prefetch_wasted = 0;
+
+		/// Frames that had to be read on the requesting thread
+		quint64 synchronous = 0;
+	};
+
+	static const int kPrefetchCount = 8;
+
+	static const int kMaximumStep = 8;
+
+	static const int kIOThreadCount = 4;
+
+	static const int kStepHistory = 8;
+
+	OIIOSequenceReader(const QString &filename, int subimage);
+
+	~OIIOSequenceReader();
+
+	/**
+   * @brief Get the shared reader for an image sequence
+   *
+   * `filename` is any filename from the sequence (see Decoder::TransformImageSequenceFileName()).
+   */
+	static OIIOSequenceReaderPtr Get(const QString &filename, int subimage);
+
+	/**
+   * @brief Release readers (and their prefetched frames) that haven't been used since `time`
+   */
+	static void ClearInactive(qint64 time);
+
+	/**
+   * @brief Totals across all readers since startup
+   */
+	static Stats GetStats();
+
+	/**
+   * @brief Set the speed the viewer is playing at, or 0 if it isn't playing
+   *
+   * While playing, only requests in the direction of playback can move a reader's window.
+   */
+	static void SetPlaybackSpeed(int speed);
+
+	/**
+   * @brief Read a frame of the sequence and schedule prefetching of the frames expected next
+   *
+   * Returns nullptr if the frame couldn't be read.
+   */
+	FramePtr ReadFrame(int64_t frame_number, int divider);
+
+private:
+	struct Slot {
+		FramePtr frame;
+		bool ready = false;
+	};
+
+	FramePtr Read(int64_t frame_number, int divider);
+
+	void PrefetchFinished(int64_t frame_number, int divider, FramePtr frame);
+
+	void UpdateStep(int64_t frame_number);
+
+	bool IsInWindow(int64_t frame_number) const;
+
+	QMap<int64_t, Slot>::iterator DiscardSlot(QMap<int64_t, Slot>::iterator it);
+
+	std::unique_ptr<OIIO::ImageInput> TakeInput();
+
+	void ReturnInput(std::unique_ptr<OIIO::ImageInput> input);
+
+	static QThreadPool *io_pool();
+
+	QString filename_;
+
+	int subimage_;
+
+	QMutex mutex_;
+
+	QWaitCondition slot_ready_;
+
+	QMap<int64_t, Slot> slots_;
+
+	int divider_;
+
+	int64_t head_;
+
+	bool has_head_;
+
+	int step_;
+
+	int recent_steps_[kStepHistory];
+
+	int recent_step_count_;
+
+	int recent_step_index_;
+
+	qint64 last_accessed_;
+
+	QMutex input_lock_;
+
+	std::vector<std::unique_ptr<OIIO::ImageInput>> inputs_;
+
+	static QMutex registry_lock_;
+
+	static QHash<QString, OIIOSequenceReaderPtr> registry_;
+
+	static std::atomic<quint64> stat_prefetch_used_;
+	static std::atomic<quint64> stat_prefetch_wasted_;
+	static std::atomic<quint64> stat_synchronous_;
+
+	static std::atomic<int> playback_speed_;
+};
+
+}
+
+#endif // OIIOSEQUENCEREADER_H
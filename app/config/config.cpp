@@ -33,6 +33,7 @@
 #include "common/filefunctions.h"
 #include "common/xmlutils.h"
 #include "core.h"
+#include "render/decoderpool.h"
 #include "timeline/timelinecommon.h"
 #include "ui/colorcoding.h"
 #include "ui/style/style.h"
@@ -144,6 +145,8 @@ void Config::SetDefaults()
 	SetEntryInternal(QStringLiteral("PreviewNonFloatDontAskAgain"),
 					 NodeValue::kBoolean, false);
 	SetEntryInternal(QStringLiteral("UseGLFinish"), NodeValue::kBoolean, false);
+	SetEntryInternal(QStringLiteral("ZstdProjectCompression"),
+					 NodeValue::kBoolean, false);
 
 	SetEntryInternal(QStringLiteral("TimelineThumbnailMode"), NodeValue::kInt,
 					 Timeline::kThumbnailInOut);
@@ -170,6 +173,12 @@ void Config::SetDefaults()
 
 	SetEntryInternal(QStringLiteral("AutoCacheDelay"), NodeValue::kInt, 1000);
 
+	SetEntryInternal(QStringLiteral("DecoderMaximumInstances"), NodeValue::kInt,
+					 DecoderPool::kDefaultMaximumInstances);
+
+	// Number of worker processes to split exports between, off unless above 1
+	SetEntryInternal(QStringLiteral("ExportWorkers"), NodeValue::kInt, 0);
+
 	SetEntryInternal(QStringLiteral("CatColor0"), NodeValue::kInt,
 					 ColorCoding::kRed);
 	SetEntryInternal(QStringLiteral("CatColor1"), NodeValue::kInt,
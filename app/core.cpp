@@ -31,6 +31,8 @@
 #include <QMessageBox>
 #include <QStatusBar>
 #include <QStyleFactory>
+#include <QTextStream>
+#include <iostream>
 #include "window/mainwindow/mainwindowundo.h"
 #ifdef Q_OS_WINDOWS
 #include <QtPlatformHeaders/QWindowsWindowFunctions>
@@ -71,6 +73,8 @@
 #include "task/project/import/importerrordialog.h"
 #include "task/project/load/load.h"
 #include "task/project/save/save.h"
+#include "task/export/export.h"
+#include "task/export/segmentedexport.h"
 #include "task/taskmanager.h"
 #include "ui/style/style.h"
 #include "undo/undostack.h"
@@ -262,7 +266,10 @@ void Core::Start()
 								  Qt::QueuedConnection);
 		break;
 	case CoreParams::kHeadlessExport:
-		qInfo() << "Headless export is not fully implemented yet";
+		// Run once the event loop has started so exit() isn't ignored
+		QTimer::singleShot(0, this, [this] {
+			QCoreApplication::exit(StartHeadlessExport() ? 0 : 1);
+		});
 		break;
 	case CoreParams::kHeadlessPreCache:
 		qInfo() << "Headless pre-cache is not fully implemented yet";
@@ -283,6 +290,9 @@ void Core::Start()
 
 void Core::Stop()
 {
+	// Projects may have been closed before their last save finished writing
+	ProjectSaveTask::WaitForBackgroundSaves();
+
 	// Assume all projects have closed gracefully and no auto-recovery is necessary
 	autorecovered_projects_.clear();
 	SaveUnrecoveredList();
@@ -621,6 +631,17 @@ bool Core::AddOpenProjectFromTask(Task *task, bool add_to_recents)
 			AddOpenProject(project, add_to_recents);
 			main_window_->LoadLayout(load_task->GetLoadedLayout());
 
+			if (!load_task->GetLoadTimings().isEmpty()) {
+				QStringList phases;
+				for (const QPair<QString, qint64> &t :
+					 load_task->GetLoadTimings()) {
+					phases.append(tr("%1 %2 ms").arg(t.first).arg(t.second));
+				}
+				ShowStatusBarMessage(tr("Loaded \"%1\" (%2)")
+										 .arg(load_task->GetFilename(),
+											  phases.join(QStringLiteral(", "))));
+			}
+
 			return true;
 		} else {
 			delete project;
@@ -751,76 +772,120 @@ bool Core::StartHeadlessExport()
 		return false;
 	}
 
+	if (core_params_.export_params().isEmpty()) {
+		qCritical().noquote()
+			<< tr("You must specify export parameters with --export-params");
+		return false;
+	}
+
+	EncodingParams params;
+	{
+		QFile params_file(core_params_.export_params());
+		if (!params_file.open(QFile::ReadOnly) || !params.Load(&params_file)) {
+			qCritical().noquote() << tr("Failed to read export parameters");
+			return false;
+		}
+	}
+
+	const bool report = core_params_.export_report();
+
 	// Start a load task and try running it
 	ProjectLoadTask plm(startup_project);
-	CLITaskDialog task_dialog(&plm);
-
-	/*
-  if (task_dialog.Run()) {
-    std::unique_ptr<Project> p = std::unique_ptr<Project>(plm.GetLoadedProject());
-    QVector<Item*> items = p->get_items_of_type(Item::kSequence);
-
-    // Check if this project contains sequences
-    if (items.isEmpty()) {
-      qCritical().noquote() << tr("Project contains no sequences, nothing to export");
-      return false;
-    }
-
-    Sequence* sequence = nullptr;
-
-    // Check if this project contains multiple sequences
-    if (items.size() > 1) {
-      qInfo().noquote() << tr("This project has multiple sequences. Which do you wish to export?");
-      for (int i=0;i<items.size();i++) {
-        std::cout << "[" << i << "] " << items.at(i)->GetLabel().toStdString();
-      }
-
-      QTextStream stream(stdin);
-      QString sequence_read;
-      int sequence_index = -1;
-      QString quit_code = QStringLiteral("q");
-      std::string prompt = tr("Enter number (or %1 to cancel): ").arg(quit_code).toStdString();
-      forever {
-        std::cout << prompt;
-
-        stream.readLineInto(&sequence_read);
-
-        if (!QString::compare(sequence_read, quit_code, Qt::CaseInsensitive)) {
-          return false;
-        }
-
-        bool ok;
-        sequence_index = sequence_read.toInt(&ok);
-
-        if (ok && sequence_index >= 0 && sequence_index < items.size()) {
-          break;
-        } else {
-          qCritical().noquote() << tr("Invalid sequence number");
-        }
-      }
-
-      sequence = static_cast<Sequence*>(items.at(sequence_index));
-    } else {
-      sequence = static_cast<Sequence*>(items.first());
-    }
-
-    ExportParams params;
-    ExportTask export_task(sequence->viewer_output(), p->color_manager(), params);
-    CLITaskDialog export_dialog(&export_task);
-    if (export_dialog.Run()) {
-      qInfo().noquote() << tr("Export succeeded");
-      return true;
-    } else {
-      qInfo().noquote() << tr("Export failed: %1").arg(export_task.GetError());
-      return false;
-    }
-  } else {
-    qCritical().noquote() << tr("Project failed to load: %1").arg(plm.GetError());
-    return false;
-  }
-  */
+	bool loaded;
+	if (report) {
+		loaded = plm.Start();
+	} else {
+		CLITaskDialog task_dialog(&plm);
+		loaded = task_dialog.Run();
+	}
 
-	return false;
+	if (!loaded) {
+		qCritical().noquote()
+			<< tr("Project failed to load: %1").arg(plm.GetError());
+		return false;
+	}
+
+	std::unique_ptr<Project> p(plm.GetLoadedProject());
+	QVector<Sequence *> sequences = p->root()->ListChildrenOfType<Sequence>();
+
+	// Check if this project contains sequences
+	if (sequences.isEmpty()) {
+		qCritical().noquote()
+			<< tr("Project contains no sequences, nothing to export");
+		return false;
+	}
+
+	int sequence_index = core_params_.export_sequence();
+
+	if (sequence_index == -1) {
+		if (sequences.size() == 1) {
+			sequence_index = 0;
+		} else {
+			qInfo().noquote() << tr(
+				"This project has multiple sequences. Which do you wish to export?");
+			for (int i = 0; i < sequences.size(); i++) {
+				std::cout << "[" << i << "] "
+						  << sequences.at(i)->GetLabel().toStdString()
+						  << std::endl;
+			}
+
+			QTextStream stream(stdin);
+			QString sequence_read;
+			QString quit_code = QStringLiteral("q");
+			std::string prompt = tr("Enter number (or %1 to cancel): ")
+									 .arg(quit_code)
+									 .toStdString();
+			forever {
+				std::cout << prompt << std::flush;
+
+				stream.readLineInto(&sequence_read);
+
+				if (!QString::compare(sequence_read, quit_code,
+									  Qt::CaseInsensitive)) {
+					return false;
+				}
+
+				bool ok;
+				sequence_index = sequence_read.toInt(&ok);
+
+				if (ok && sequence_index >= 0 &&
+					sequence_index < sequences.size()) {
+					break;
+				} else {
+					qCritical().noquote() << tr("Invalid sequence number");
+				}
+			}
+		}
+	}
+
+	if (sequence_index < 0 || sequence_index >= sequences.size()) {
+		qCritical().noquote() << tr("Invalid sequence number");
+		return false;
+	}
+
+	Sequence *sequence = sequences.at(sequence_index);
+
+	ExportTask export_task(sequence, p->color_manager(), params);
+
+	bool exported;
+	if (report) {
+		connect(&export_task, &Task::ProgressChanged, this,
+				&SegmentedExportTask::WriteWorkerProgress,
+				Qt::DirectConnection);
+		exported = export_task.Start();
+	} else {
+		CLITaskDialog export_dialog(&export_task);
+		exported = export_dialog.Run();
+	}
+
+	if (exported) {
+		qInfo().noquote() << tr("Export succeeded");
+		return true;
+	} else {
+		qCritical().noquote()
+			<< tr("Export failed: %1").arg(export_task.GetError());
+		return false;
+	}
 }
 
 void Core::OpenStartupProject()
@@ -954,17 +1019,54 @@ void Core::SaveProjectInternal(const QString &override_filename)
 		return;
 #endif
 	} else {
-		bool use_compression = !open_project_->filename().endsWith(
-			QStringLiteral(".ovexml"), Qt::CaseInsensitive);
-		psm = new ProjectSaveTask(open_project_, use_compression);
-		static_cast<ProjectSaveTask *>(psm)->SetLayout(
-			main_window_->SaveLayout());
+		ProjectSerializer::Compression compression =
+			ProjectSerializer::kUncompressed;
+		if (!open_project_->filename().endsWith(QStringLiteral(".ovexml"),
+												Qt::CaseInsensitive)) {
+			// Builds without Zstandard can't open OVEZ files, so it's only written when asked for
+			bool zstd = OLIVE_CONFIG("ZstdProjectCompression").toBool() &&
+						ProjectSerializer::IsCompressionSupported(
+							ProjectSerializer::kCompressedZstd);
+			compression = zstd ? ProjectSerializer::kCompressedZstd :
+								 ProjectSerializer::kCompressedZlib;
+		}
+		ProjectSaveTask *save = new ProjectSaveTask(open_project_, compression);
+		save->SetLayout(main_window_->SaveLayout());
 
 		if (!override_filename.isEmpty()) {
 			// Set override filename if provided
-			static_cast<ProjectSaveTask *>(psm)->SetOverrideFilename(
-				override_filename);
+			save->SetOverrideFilename(override_filename);
+		}
+
+		// Serializing has to happen here since the project can't change while it's read, but only
+		// nodes changed since the last save are serialized again. Compressing and writing the file
+		// happens in the background so a large project doesn't hold up the GUI. Whatever is saved is the project as it is now, so
+		// it's no longer modified as far as the user is concerned.
+		if (!save->TakeSnapshot()) {
+			ShowStatusBarMessage(save->GetError());
+			save->deleteLater();
+			return;
 		}
+
+		bool is_autorecovery = !override_filename.isEmpty();
+		if (!is_autorecovery) {
+			open_project_->set_modified(false);
+		}
+
+		connect(save, &Task::Finished, this,
+				[this, is_autorecovery](Task *task, bool succeeded) {
+					if (succeeded) {
+						if (!is_autorecovery) {
+							ProjectSaveSucceeded(task);
+						}
+					} else {
+						ProjectSaveFailed(task, is_autorecovery);
+					}
+					task->deleteLater();
+				});
+
+		save->StartInBackground();
+		return;
 	}
 
 	// We don't use a TaskDialog here because a model save dialog is annoying, particularly when
@@ -972,10 +1074,6 @@ void Core::SaveProjectInternal(const QString &override_filename)
 	// cause a brief (but often unnoticeable) pause in the GUI, which, while not ideal, is not that
 	// different from what already happened (modal dialog preventing use of the GUI) and in many ways
 	// less annoying (doesn't disrupt any current actions or pull focus from elsewhere).
-	//
-	// Ideally we could do this in a background thread and show progress in the status bar like
-	// Microsoft Word, but that would be far more complex. If it becomes necessary in the future,
-	// we will look into an approach like that.
 	if (psm->Start()) {
 		if (override_filename.isEmpty()) {
 			ProjectSaveSucceeded(psm);
@@ -1190,6 +1288,10 @@ void Core::SaveAutorecovery()
 void Core::ProjectSaveSucceeded(Task *task)
 {
 	Project *p = static_cast<ProjectSaveTask *>(task)->GetProject();
+	if (!p) {
+		// Project was closed while it was being written
+		return;
+	}
 
 	PushRecentlyOpenedProject(p->filename());
 
@@ -1201,6 +1303,18 @@ void Core::ProjectSaveSucceeded(Task *task)
 	ShowStatusBarMessage(tr("Saved to \"%1\" successfully").arg(p->filename()));
 }
 
+void Core::ProjectSaveFailed(Task *task, bool autorecovery)
+{
+	if (!autorecovery) {
+		// The snapshot was assumed to be saved, but nothing made it to disk
+		if (Project *p = static_cast<ProjectSaveTask *>(task)->GetProject()) {
+			p->set_modified(true);
+		}
+	}
+
+	ShowStatusBarMessage(task->GetError());
+}
+
 Project *Core::GetActiveProject() const
 {
 	return open_project_;
@@ -1834,6 +1948,8 @@ Core::CoreParams::CoreParams()
 	: mode_(kRunNormal)
 	, run_fullscreen_(false)
 	, crash_(false)
+	, export_sequence_(-1)
+	, export_report_(false)
 {
 }
 
@@ -109,6 +109,42 @@ public:
 			crash_ = true;
 		}
 
+		const QString &export_params() const
+		{
+			return export_params_;
+		}
+
+		void set_export_params(const QString &s)
+		{
+			export_params_ = s;
+		}
+
+		/**
+   * @brief Index of the sequence to export, -1 to ask
+   */
+		int export_sequence() const
+		{
+			return export_sequence_;
+		}
+
+		void set_export_sequence(int i)
+		{
+			export_sequence_ = i;
+		}
+
+		/**
+   * @brief Report progress in a form SegmentedExportTask can read rather than drawing a progress bar
+   */
+		bool export_report() const
+		{
+			return export_report_;
+		}
+
+		void set_export_report(bool e)
+		{
+			export_report_ = e;
+		}
+
 	private:
 		RunMode mode_;
 
@@ -119,6 +155,12 @@ public:
 		bool run_fullscreen_;
 
 		bool crash_;
+
+		QString export_params_;
+
+		int export_sequence_;
+
+		bool export_report_;
 	};
 
 	/**
@@ -596,6 +638,8 @@ private slots:
 
 	void ProjectSaveSucceeded(Task *task);
 
+	void ProjectSaveFailed(Task *task, bool autorecovery);
+
 	bool AddOpenProjectFromTaskAndAddToRecents(Task *task)
 	{
 		return AddOpenProjectFromTask(task, true);
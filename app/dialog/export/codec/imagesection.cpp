@@ -53,6 +53,107 @@ ImageSection::ImageSection(QWidget *parent)
 	connect(frame_slider_, &RationalSlider::ValueChanged, this,
 			&ImageSection::TimeChanged);
 	layout->addWidget(frame_slider_, row, 1);
+
+	row++;
+
+	layout->addWidget(new QLabel(tr("Compression:")), row, 0);
+
+	compression_combobox_ = new QComboBox();
+	connect(compression_combobox_,
+			static_cast<void (QComboBox::*)(int)>(
+				&QComboBox::currentIndexChanged),
+			this, &ImageSection::CompressionChanged);
+	layout->addWidget(compression_combobox_, row, 1);
+
+	row++;
+
+	layout->addWidget(new QLabel(tr("Compression Level:")), row, 0);
+
+	compression_level_ = new QSpinBox();
+	layout->addWidget(compression_level_, row, 1);
+
+	SetCodec(ExportCodec::kCodecPNG);
+}
+
+void ImageSection::SetCodec(ExportCodec::Codec codec)
+{
+	// Item data is the method as OIIO's "compression" attribute names it
+	compression_combobox_->clear();
+
+	switch (codec) {
+	case ExportCodec::kCodecOpenEXR:
+		compression_combobox_->addItem(tr("ZIP"), QStringLiteral("zip"));
+		compression_combobox_->addItem(tr("ZIP (Single Scanline)"),
+									   QStringLiteral("zips"));
+		compression_combobox_->addItem(tr("PIZ"), QStringLiteral("piz"));
+		compression_combobox_->addItem(tr("DWAA"), QStringLiteral("dwaa"));
+		compression_combobox_->addItem(tr("DWAB"), QStringLiteral("dwab"));
+		compression_combobox_->addItem(tr("None"), QStringLiteral("none"));
+		break;
+	case ExportCodec::kCodecPNG:
+		compression_combobox_->addItem(tr("ZIP"), QStringLiteral("zip"));
+		break;
+	case ExportCodec::kCodecTIFF:
+		compression_combobox_->addItem(tr("LZW"), QStringLiteral("lzw"));
+		compression_combobox_->addItem(tr("ZIP"), QStringLiteral("zip"));
+		compression_combobox_->addItem(tr("None"), QStringLiteral("none"));
+		break;
+	default:
+		break;
+	}
+
+	compression_combobox_->setEnabled(compression_combobox_->count() > 1);
+	CompressionChanged();
+}
+
+void ImageSection::AddOpts(EncodingParams *params)
+{
+	QString method = compression_combobox_->currentData().toString();
+	if (method.isEmpty()) {
+		return;
+	}
+
+	if (compression_level_->isEnabled()) {
+		method = QStringLiteral("%1:%2").arg(
+			method, QString::number(compression_level_->value()));
+	}
+
+	params->set_video_option(QStringLiteral("compression"), method);
+}
+
+void ImageSection::SetOpts(const EncodingParams *p)
+{
+	QStringList compression =
+		p->video_option(QStringLiteral("compression")).split(':');
+
+	int index = compression_combobox_->findData(compression.first());
+	if (index == -1) {
+		return;
+	}
+
+	compression_combobox_->setCurrentIndex(index);
+	if (compression.size() > 1) {
+		compression_level_->setValue(compression.at(1).toInt());
+	}
+}
+
+void ImageSection::CompressionChanged()
+{
+	QString method = compression_combobox_->currentData().toString();
+
+	if (method == QStringLiteral("zip") || method == QStringLiteral("zips")) {
+		compression_level_->setEnabled(true);
+		compression_level_->setRange(1, 9);
+		compression_level_->setValue(6);
+	} else if (method == QStringLiteral("dwaa") ||
+			   method == QStringLiteral("dwab")) {
+		// OpenEXR's default DWA level, higher is smaller and lossier
+		compression_level_->setEnabled(true);
+		compression_level_->setRange(0, 1000);
+		compression_level_->setValue(45);
+	} else {
+		compression_level_->setEnabled(false);
+	}
 }
 
 void ImageSection::ImageSequenceCheckBoxToggled(bool e)
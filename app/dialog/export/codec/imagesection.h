@@ -23,6 +23,8 @@
 #define IMAGESECTION_H
 
 #include <QCheckBox>
+#include <QComboBox>
+#include <QSpinBox>
 
 #include "codecsection.h"
 #include "widget/slider/rationalslider.h"
@@ -35,6 +37,15 @@ class ImageSection : public CodecSection {
 public:
 	ImageSection(QWidget *parent = nullptr);
 
+	/**
+   * @brief Update the compression methods offered for `codec`
+   */
+	void SetCodec(ExportCodec::Codec codec);
+
+	virtual void AddOpts(EncodingParams *params) override;
+
+	virtual void SetOpts(const EncodingParams *p) override;
+
 	bool IsImageSequenceChecked() const
 	{
 		return image_sequence_checkbox_->isChecked();
@@ -68,8 +79,14 @@ private:
 
 	RationalSlider *frame_slider_;
 
+	QComboBox *compression_combobox_;
+
+	QSpinBox *compression_level_;
+
 private slots:
 	void ImageSequenceCheckBoxToggled(bool e);
+
+	void CompressionChanged();
 };
 
 }
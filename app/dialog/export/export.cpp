@@ -33,10 +33,12 @@
 
 #include "common/digit.h"
 #include "common/qtutils.h"
+#include "config/config.h"
 #include "dialog/task/task.h"
 #include "exportsavepresetdialog.h"
 #include "node/project.h"
 #include "node/project/sequence/sequence.h"
+#include "task/export/segmentedexport.h"
 #include "task/taskmanager.h"
 #include "ui/icons/icons.h"
 #include "widget/timeruler/timeruler.h"
@@ -397,8 +399,16 @@ void ExportDialog::StartExport()
 		return;
 	}
 
-	ExportTask *task =
-		new ExportTask(viewer_node_, color_manager_, GenerateParams());
+	EncodingParams params = GenerateParams();
+
+	// Split long exports between worker processes if the user asked for it
+	Task *task;
+	int workers = OLIVE_CONFIG("ExportWorkers").toInt();
+	if (workers > 1 && SegmentedExportTask::CanSegment(viewer_node_, params)) {
+		task = new SegmentedExportTask(viewer_node_, params, workers);
+	} else {
+		task = new ExportTask(viewer_node_, color_manager_, params);
+	}
 
 	if (export_bkg_box_->isChecked()) {
 		// Send to TaskManager to export in background
@@ -273,8 +273,12 @@ void ExportVideoTab::VideoCodecChanged()
 		SetCodecSection(cineform_section_);
 		break;
 	default:
-		SetCodecSection(
-			ExportCodec::IsCodecAStillImage(codec) ? image_section_ : nullptr);
+		if (ExportCodec::IsCodecAStillImage(codec)) {
+			image_section_->SetCodec(codec);
+			SetCodecSection(image_section_);
+		} else {
+			SetCodecSection(nullptr);
+		}
 	}
 
 	// Set default pixel format
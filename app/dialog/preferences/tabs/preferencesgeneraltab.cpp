@@ -28,6 +28,7 @@
 
 #include "common/autoscroll.h"
 #include "core.h"
+#include "node/project/serializer/serializer.h"
 
 namespace olive
 {
@@ -167,6 +168,27 @@ PreferencesGeneralTab::PreferencesGeneralTab()
 		autorecovery_layout->addWidget(browse_autorecoveries, row, 1);
 	}
 
+	{
+		QGroupBox *project_groupbox = new QGroupBox(tr("Project Files"));
+		QGridLayout *project_layout = new QGridLayout(project_groupbox);
+		layout->addWidget(project_groupbox);
+
+		project_layout->addWidget(new QLabel(tr("Compress With Zstandard:")),
+								  0, 0);
+
+		zstd_project_compression_ = new QCheckBox();
+		zstd_project_compression_->setToolTip(
+			tr("Saves faster and smaller, but the project can't be opened by "
+			   "builds of Olive without Zstandard support."));
+		zstd_project_compression_->setChecked(
+			OLIVE_CONFIG("ZstdProjectCompression").toBool());
+		project_layout->addWidget(zstd_project_compression_, 0, 1);
+
+		// Only offer it when this build can read the files back
+		project_groupbox->setVisible(ProjectSerializer::IsCompressionSupported(
+			ProjectSerializer::kCompressedZstd));
+	}
+
 	layout->addStretch();
 }
 
@@ -201,6 +223,9 @@ void PreferencesGeneralTab::Accept(MultiUndoCommand *command)
 		QVariant::fromValue(autorecovery_maximum_->GetValue());
 	Core::instance()->SetAutorecoveryInterval(
 		autorecovery_interval_->GetValue());
+
+	OLIVE_CONFIG("ZstdProjectCompression") =
+		zstd_project_compression_->isChecked();
 }
 
 void PreferencesGeneralTab::AddLanguage(const QString &locale_name)
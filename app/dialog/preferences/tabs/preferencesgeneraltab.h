@@ -57,6 +57,8 @@ private:
 	IntegerSlider *autorecovery_interval_;
 
 	IntegerSlider *autorecovery_maximum_;
+
+	QCheckBox *zstd_project_compression_;
 };
 
 }
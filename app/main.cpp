@@ -82,7 +82,9 @@ int decompress_project(const QString &project)
 			   .toUtf8()
 			   .constData());
 
-	if (!olive::ProjectSerializer::CheckCompressedID(&project_file)) {
+	olive::ProjectSerializer::Compression compression =
+		olive::ProjectSerializer::GetCompression(&project_file);
+	if (compression == olive::ProjectSerializer::kUncompressed) {
 		printf("%s\n",
 			   QCoreApplication::translate(
 				   "main", "Failed to decompress, project may be corrupt")
@@ -91,13 +93,13 @@ int decompress_project(const QString &project)
 		return 1;
 	}
 
-	QByteArray b = project_file.readAll();
+	QByteArray decompressed;
+	bool decompressed_ok = olive::ProjectSerializer::Decompress(
+		&project_file, compression, &decompressed);
 
 	project_file.close();
 
-	QByteArray decompressed = qUncompress(b);
-
-	if (decompressed.isEmpty()) {
+	if (!decompressed_ok || decompressed.isEmpty()) {
 		printf("%s\n",
 			   QCoreApplication::translate(
 				   "main", "Failed to decompress, project may be corrupt")
@@ -199,6 +201,21 @@ int main(int argc, char *argv[])
 		{ QStringLiteral("x"), QStringLiteral("-export") },
 		QCoreApplication::translate("main", "Export only (No GUI)"));
 
+	auto export_params_option = parser.AddOption(
+		{ QStringLiteral("-export-params") },
+		QCoreApplication::translate("main", "Export parameters to use with --export"),
+		true, QCoreApplication::translate("main", "xml-file"));
+
+	auto export_sequence_option = parser.AddOption(
+		{ QStringLiteral("-export-sequence") },
+		QCoreApplication::translate("main", "Index of the sequence to export"),
+		true, QCoreApplication::translate("main", "index"));
+
+	// Used by SegmentedExportTask to run exports as worker processes
+	auto export_report_option = parser.AddOption(
+		{ QStringLiteral("-export-report") }, QString(), false, QString(),
+		true);
+
 	auto ts_option = parser.AddOption(
 		{ QStringLiteral("-ts") },
 		QCoreApplication::translate("main", "Override language with file"),
@@ -280,6 +297,12 @@ int main(int argc, char *argv[])
 
 	if (export_option->IsSet()) {
 		startup_params.set_run_mode(olive::Core::CoreParams::kHeadlessExport);
+		startup_params.set_export_params(export_params_option->GetSetting());
+		startup_params.set_export_sequence(
+			export_sequence_option->IsSet() ?
+				export_sequence_option->GetSetting().toInt() :
+				-1);
+		startup_params.set_export_report(export_report_option->IsSet());
 	}
 
 	if (ts_option->IsSet()) {
@@ -334,6 +357,10 @@ int main(int argc, char *argv[])
 #endif // _WIN32
 
 		a.reset(new QApplication(argc, argv));
+	} else if (startup_params.run_mode() ==
+			   olive::Core::CoreParams::kHeadlessExport) {
+		// Rendering still needs an OpenGL context
+		a.reset(new QGuiApplication(argc, argv));
 	} else {
 		a.reset(new QCoreApplication(argc, argv));
 	}
@@ -241,8 +241,19 @@ rational ClipBlock::MediaToSequenceTime(const rational &media_time) const
 	return sequence_time;
 }
 
+bool ClipBlock::IsSequenceShown() const
+{
+	// Clips that aren't in a sequence yet are still requested as before
+	Sequence *s = track() ? track()->sequence() : nullptr;
+	return !s || s->AreCachesRetained();
+}
+
 void ClipBlock::RequestRangeFromConnected(const TimeRange &range)
 {
+	if (!IsSequenceShown()) {
+		return;
+	}
+
 	Track::Type type = GetTrackType();
 
 	if (type == Track::kVideo || type == Track::kAudio) {
@@ -281,6 +292,10 @@ void ClipBlock::RequestRangeFromConnected(const TimeRange &range)
 void ClipBlock::RequestInvalidatedFromConnected(bool force_all,
 												const TimeRange &intersect)
 {
+	if (!IsSequenceShown()) {
+		return;
+	}
+
 	Track::Type type = GetTrackType();
 
 	if (type == Track::kVideo || type == Track::kAudio) {
@@ -464,22 +479,8 @@ void ClipBlock::InputConnectedEvent(const QString &input, int element,
 	super::InputConnectedEvent(input, element, output);
 
 	if (input == kBufferIn) {
-		connect(output->thumbnail_cache(), &FrameHashCache::Invalidated, this,
-				&Block::PreviewChanged);
-		connect(output->waveform_cache(), &AudioPlaybackCache::Invalidated,
-				this, &Block::PreviewChanged);
-		connect(output->video_frame_cache(), &FrameHashCache::Invalidated, this,
-				&Block::PreviewChanged);
-		connect(output->audio_playback_cache(),
-				&AudioPlaybackCache::Invalidated, this, &Block::PreviewChanged);
-		connect(output->thumbnail_cache(), &FrameHashCache::Validated, this,
-				&Block::PreviewChanged);
-		connect(output->waveform_cache(), &AudioPlaybackCache::Validated, this,
-				&Block::PreviewChanged);
-		connect(output->video_frame_cache(), &FrameHashCache::Validated, this,
-				&Block::PreviewChanged);
-		connect(output->audio_playback_cache(), &AudioPlaybackCache::Validated,
-				this, &Block::PreviewChanged);
+		// Through the node rather than its caches, so they aren't created until something's drawn
+		connect(output, &Node::CachesChanged, this, &Block::PreviewChanged);
 	}
 }
 
@@ -489,24 +490,7 @@ void ClipBlock::InputDisconnectedEvent(const QString &input, int element,
 	super::InputDisconnectedEvent(input, element, output);
 
 	if (input == kBufferIn) {
-		disconnect(output->thumbnail_cache(), &FrameHashCache::Invalidated,
-				   this, &Block::PreviewChanged);
-		disconnect(output->waveform_cache(), &AudioPlaybackCache::Invalidated,
-				   this, &Block::PreviewChanged);
-		disconnect(output->video_frame_cache(), &FrameHashCache::Invalidated,
-				   this, &Block::PreviewChanged);
-		disconnect(output->audio_playback_cache(),
-				   &AudioPlaybackCache::Invalidated, this,
-				   &Block::PreviewChanged);
-		disconnect(output->thumbnail_cache(), &FrameHashCache::Validated, this,
-				   &Block::PreviewChanged);
-		disconnect(output->waveform_cache(), &AudioPlaybackCache::Validated,
-				   this, &Block::PreviewChanged);
-		disconnect(output->video_frame_cache(), &FrameHashCache::Validated,
-				   this, &Block::PreviewChanged);
-		disconnect(output->audio_playback_cache(),
-				   &AudioPlaybackCache::Validated, this,
-				   &Block::PreviewChanged);
+		disconnect(output, &Node::CachesChanged, this, &Block::PreviewChanged);
 	}
 }
 
@@ -247,6 +247,11 @@ private:
 
 	rational MediaToSequenceTime(const rational &media_time) const;
 
+	/**
+   * @brief Returns whether a panel is showing the sequence this clip is in
+   */
+	bool IsSequenceShown() const;
+
 	void RequestRangeFromConnected(const TimeRange &range);
 
 	void RequestRangeForCache(PlaybackCache *cache, const TimeRange &max_range,
@@ -47,15 +47,18 @@ ShaderCode MaskDistortNode::GetShaderCode(const ShaderRequest &request) const
 	if (request.id == QStringLiteral("mrg")) {
 		return ShaderCode(FileFunctions::ReadFileAsString(
 			QStringLiteral(":/shaders/multiply.frag")));
-	} else if (request.id == QStringLiteral("feather")) {
-		return ShaderCode(FileFunctions::ReadFileAsString(
-			QStringLiteral(":/shaders/blur.frag")));
 	} else if (request.id == QStringLiteral("invert")) {
 		return ShaderCode(FileFunctions::ReadFileAsString(
 			QStringLiteral(":/shaders/invertrgba.frag")));
-	} else {
-		return super::GetShaderCode(request);
 	}
+
+	// Feather
+	ShaderCode blur = BlurFilterNode::GetSeparableBlurShaderCode(request.id);
+	if (!blur.frag_code().isEmpty()) {
+		return blur;
+	}
+
+	return super::GetShaderCode(request);
 }
 
 void MaskDistortNode::Retranslate()
@@ -94,32 +97,11 @@ void MaskDistortNode::Value(const NodeValueRow &value,
 
 		if (value[kFeatherInput].toDouble() > 0.0) {
 			// Nest a blur shader in there too
-			ShaderJob feather;
-
-			feather.SetShaderID(QStringLiteral("feather"));
-			feather.Insert(BlurFilterNode::kTextureInput, job);
-			feather.Insert(BlurFilterNode::kMethodInput,
-						   NodeValue(NodeValue::kInt,
-									 int(BlurFilterNode::kGaussian), this));
-			feather.Insert(BlurFilterNode::kHorizInput,
-						   NodeValue(NodeValue::kBoolean, true, this));
-			feather.Insert(BlurFilterNode::kVertInput,
-						   NodeValue(NodeValue::kBoolean, true, this));
-			feather.Insert(BlurFilterNode::kRepeatEdgePixelsInput,
-						   NodeValue(NodeValue::kBoolean, true, this));
-			feather.Insert(BlurFilterNode::kRadiusInput,
-						   NodeValue(NodeValue::kFloat,
-									 value[kFeatherInput].toDouble(), this));
-			feather.SetIterations(2, BlurFilterNode::kTextureInput);
-			feather.Insert(QStringLiteral("resolution_in"),
-						   NodeValue(NodeValue::kVec2,
-									 texture ? texture->virtual_resolution() :
-											   globals.square_resolution(),
-									 this));
-
 			merge.Insert(QStringLiteral("tex_b"),
-						 NodeValue(NodeValue::kTexture,
-								   Texture::Job(job_params, feather), this));
+						 BlurFilterNode::CreateSeparableBlurJob(
+							 job, BlurFilterNode::kGaussian,
+							 value[kFeatherInput].toDouble(), true, true, true,
+							 this));
 		} else {
 			merge.Insert(QStringLiteral("tex_b"), job);
 		}
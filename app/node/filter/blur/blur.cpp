@@ -21,9 +21,30 @@
 
 #include "blur.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace olive
 {
 
+namespace
+{
+
+const QString kDownsampleShader = QStringLiteral("blur_down");
+const QString kKernelShader = QStringLiteral("blur_kernel");
+const QString kUpsampleShader = QStringLiteral("blur_up");
+
+// Halving stops before a level gets smaller than this along a blurred axis
+const int kMinimumLevelSize = 8;
+const int kMaximumLevels = 8;
+
+// Variance (in pixels of level 0) the down and upsample passes add for every level of the pyramid, divided by
+// 4^level. The downsample's tent covers 4 pixels (0.75), the upsample's taps and bilinear filtering on twice the
+// pixel size add about 2.
+const double kPyramidVariancePerLevel = 2.75;
+
+}
+
 const QString BlurFilterNode::kTextureInput = QStringLiteral("tex_in");
 const QString BlurFilterNode::kMethodInput = QStringLiteral("method_in");
 const QString BlurFilterNode::kRadiusInput = QStringLiteral("radius_in");
@@ -123,7 +144,11 @@ void BlurFilterNode::Retranslate()
 
 ShaderCode BlurFilterNode::GetShaderCode(const ShaderRequest &request) const
 {
-	Q_UNUSED(request)
+	ShaderCode separable = GetSeparableBlurShaderCode(request.id);
+	if (!separable.frag_code().isEmpty()) {
+		return separable;
+	}
+
 	return ShaderCode(FileFunctions::ReadFileAsString(":/shaders/blur.frag"));
 }
 
@@ -134,48 +159,224 @@ void BlurFilterNode::Value(const NodeValueRow &value,
 	// If there's no texture, no need to run an operation
 	if (TexturePtr tex = value[kTextureInput].toTexture()) {
 		Method method = static_cast<Method>(value[kMethodInput].toInt());
+		double radius = value[kRadiusInput].toDouble();
+		bool separable = (method == kBox || method == kGaussian);
+		bool horiz = value[kHorizInput].toBool();
+		bool vert = value[kVertInput].toBool();
 
-		bool can_push_job = true;
-		int iterations = 1;
-
-		// Check if radius is > 0
-		if (value[kRadiusInput].toDouble() > 0.0) {
-			// Method-specific considerations
-			switch (method) {
-			case kBox:
-			case kGaussian: {
-				bool horiz = value[kHorizInput].toBool();
-				bool vert = value[kVertInput].toBool();
-
-				if (!horiz && !vert) {
-					// Disable job if horiz and vert are unchecked
-					can_push_job = false;
-				} else if (horiz && vert) {
-					// Set iteration count to 2 if we're blurring both horizontally and vertically
-					iterations = 2;
-				}
-				break;
-			}
-			case kDirectional:
-			case kRadial:
-				break;
-			}
+		if (radius <= 0.0 || (separable && !horiz && !vert)) {
+			// If we're not performing the blur job, just push the texture
+			table->Push(value[kTextureInput]);
+		} else if (separable) {
+			table->Push(CreateSeparableBlurJob(
+				value[kTextureInput], method, radius, horiz, vert,
+				value[kRepeatEdgePixelsInput].toBool(), this));
 		} else {
-			can_push_job = false;
-		}
-
-		if (can_push_job) {
 			ShaderJob job(value);
 			job.Insert(QStringLiteral("resolution_in"),
 					   NodeValue(NodeValue::kVec2, tex->virtual_resolution(),
 								 this));
-			job.SetIterations(iterations, kTextureInput);
 			table->Push(NodeValue::kTexture, tex->toJob(job), this);
+		}
+	}
+}
+
+BlurFilterNode::SeparableKernel
+BlurFilterNode::CalculateSeparableKernel(Method method, double radius,
+										 int max_levels)
+{
+	SeparableKernel kernel;
+
+	// Taps either side of the center read two pixels each
+	const double max_extent = 2 * (kMaximumTaps - 1);
+
+	// Box "radius" is half its width, gaussian radius is sigma and the kernel extends to 3 sigma
+	double variance = (method == kBox) ? radius * radius / 3.0 : radius * radius;
+	double level_variance, extent;
+
+	for (kernel.levels = 0;; kernel.levels++) {
+		double scale = std::pow(4.0, kernel.levels);
+		double pyramid_variance =
+			kPyramidVariancePerLevel * (scale - 1.0) / 3.0;
+
+		level_variance = std::max(variance - pyramid_variance, 0.0) / scale;
+		extent = (method == kBox) ? std::sqrt(3.0 * level_variance) :
+									3.0 * std::sqrt(level_variance);
+
+		if (extent <= max_extent || kernel.levels >= max_levels) {
+			break;
+		}
+	}
+
+	if (extent > max_extent) {
+		// Out of levels, blur as much as we can without more taps
+		level_variance *= (max_extent * max_extent) / (extent * extent);
+		extent = max_extent;
+	}
+
+	int r = std::ceil(extent);
+	QVector<double> w(r + 1);
+	double sigma = std::sqrt(level_variance);
+
+	for (int i = 0; i <= r; i++) {
+		if (method == kBox) {
+			// Partially weight the outermost pixel so the blur animates smoothly
+			w[i] = std::clamp(extent + 0.5 - i, 0.0, 1.0);
 		} else {
-			// If we're not performing the blur job, just push the texture
-			table->Push(value[kTextureInput]);
+			w[i] = (sigma > 0.0) ? std::exp(-0.5 * i * i / (sigma * sigma)) :
+								   (i == 0);
+		}
+	}
+
+	double total = w[0];
+	for (int i = 1; i <= r; i++) {
+		total += 2.0 * w[i];
+	}
+
+	kernel.offsets.append(0.0f);
+	kernel.weights.append(w[0] / total);
+
+	// Merge pairs of pixels into one read between them, weighted so bilinear filtering returns their weighted sum
+	for (int i = 1; i <= r; i += 2) {
+		double a = w[i];
+		double b = (i + 1 <= r) ? w[i + 1] : 0.0;
+		if (a + b <= 0.0) {
+			break;
 		}
+
+		kernel.offsets.append((i * a + (i + 1) * b) / (a + b));
+		kernel.weights.append((a + b) / total);
 	}
+
+	return kernel;
+}
+
+NodeValue BlurFilterNode::CreateSeparableBlurJob(const NodeValue &input,
+												 Method method, double radius,
+												 bool horiz, bool vert,
+												 bool repeat_edge_pixels,
+												 const Node *from)
+{
+	TexturePtr tex = input.toTexture();
+	const VideoParams &full = tex->params();
+
+	int max_levels = 0;
+	while (max_levels < kMaximumLevels) {
+		int size = 2 << max_levels;
+		if ((horiz && full.effective_width() / size < kMinimumLevelSize) ||
+			(vert && full.effective_height() / size < kMinimumLevelSize)) {
+			break;
+		}
+		max_levels++;
+	}
+
+	// Radius is in sequence pixels, the kernel works on the pixels actually in the texture
+	SeparableKernel kernel = CalculateSeparableKernel(
+		method, radius * full.effective_height() / full.height(), max_levels);
+
+	const NodeValue direction(
+		NodeValue::kVec2, QVector2D(horiz ? 1.0f : 0.0f, vert ? 1.0f : 0.0f),
+		from);
+	const NodeValue repeat(NodeValue::kBoolean, repeat_edge_pixels, from);
+
+	auto texel_size = [from](const VideoParams &p) {
+		return NodeValue(NodeValue::kVec2,
+						 QVector2D(1.0f / p.effective_width(),
+								   1.0f / p.effective_height()),
+						 from);
+	};
+
+	QVector<VideoParams> levels = { full };
+	NodeValue current = input;
+
+	for (int i = 0; i < kernel.levels; i++) {
+		VideoParams p = levels.last();
+		if (horiz) {
+			p.set_width((p.width() + 1) / 2);
+		}
+		if (vert) {
+			p.set_height((p.height() + 1) / 2);
+		}
+
+		ShaderJob down;
+		down.SetShaderID(kDownsampleShader);
+		down.Insert(kTextureInput, current);
+		down.Insert(QStringLiteral("texel_in"), texel_size(levels.last()));
+		down.Insert(QStringLiteral("direction_in"), direction);
+		down.Insert(kRepeatEdgePixelsInput, repeat);
+
+		current = NodeValue(NodeValue::kTexture, Texture::Job(p, down), from);
+		levels.append(p);
+	}
+
+	const VideoParams &smallest = levels.last();
+
+	NodeValueArray offsets, weights;
+	for (int i = 0; i < kernel.offsets.size(); i++) {
+		offsets[i] = NodeValue(NodeValue::kFloat, kernel.offsets.at(i), from);
+		weights[i] = NodeValue(NodeValue::kFloat, kernel.weights.at(i), from);
+	}
+
+	ShaderJob blur;
+	blur.SetShaderID(kKernelShader);
+	blur.Insert(kTextureInput, current);
+	blur.Insert(kHorizInput, NodeValue(NodeValue::kBoolean, horiz, from));
+	blur.Insert(kVertInput, NodeValue(NodeValue::kBoolean, vert, from));
+	blur.Insert(kRepeatEdgePixelsInput, repeat);
+	blur.Insert(QStringLiteral("tap_count_in"),
+				NodeValue(NodeValue::kInt, kernel.offsets.size(), from));
+	blur.Insert(QStringLiteral("offsets_in"),
+				NodeValue(NodeValue::kFloat, QVariant::fromValue(offsets), from,
+						  true));
+	blur.Insert(QStringLiteral("weights_in"),
+				NodeValue(NodeValue::kFloat, QVariant::fromValue(weights), from,
+						  true));
+
+	// Texture pixels, stretched by the pixel aspect ratio like virtual_resolution()
+	blur.Insert(QStringLiteral("resolution_in"),
+				NodeValue(NodeValue::kVec2,
+						  QVector2D(double(smallest.effective_width()) *
+										full.square_pixel_width() /
+										full.width(),
+									smallest.effective_height()),
+						  from));
+
+	if (horiz && vert) {
+		blur.SetIterations(2, kTextureInput);
+	}
+
+	current =
+		NodeValue(NodeValue::kTexture, Texture::Job(smallest, blur), from);
+
+	for (int i = levels.size() - 1; i > 0; i--) {
+		ShaderJob up;
+		up.SetShaderID(kUpsampleShader);
+		up.Insert(kTextureInput, current);
+		up.Insert(QStringLiteral("texel_in"), texel_size(levels.at(i)));
+		up.Insert(QStringLiteral("direction_in"), direction);
+		up.Insert(kRepeatEdgePixelsInput, repeat);
+
+		current = NodeValue(NodeValue::kTexture,
+							Texture::Job(levels.at(i - 1), up), from);
+	}
+
+	return current;
+}
+
+ShaderCode BlurFilterNode::GetSeparableBlurShaderCode(const QString &shader_id)
+{
+	if (shader_id == kDownsampleShader) {
+		return ShaderCode(
+			FileFunctions::ReadFileAsString(":/shaders/blurdown.frag"));
+	} else if (shader_id == kKernelShader) {
+		return ShaderCode(
+			FileFunctions::ReadFileAsString(":/shaders/blurkernel.frag"));
+	} else if (shader_id == kUpsampleShader) {
+		return ShaderCode(
+			FileFunctions::ReadFileAsString(":/shaders/blurup.frag"));
+	}
+
+	return ShaderCode();
 }
 
 void BlurFilterNode::UpdateGizmoPositions(const NodeValueRow &row,
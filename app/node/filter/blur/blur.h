@@ -57,6 +57,40 @@ public:
 	virtual void UpdateGizmoPositions(const NodeValueRow &row,
 									  const NodeGlobals &globals) override;
 
+	/**
+   * @brief Weights of a box or gaussian blur, merged so each tap reads two pixels at once
+   *
+   * The image is halved `levels` times before the kernel runs and scaled back up after, so large radii cost
+   * about as much as small ones. Offsets are in pixels of the smallest level.
+   */
+	struct SeparableKernel {
+		int levels = 0;
+		QVector<float> offsets;
+		QVector<float> weights;
+	};
+
+	static SeparableKernel CalculateSeparableKernel(Method method,
+													double radius,
+													int max_levels);
+
+	/**
+   * @brief Create the jobs that blur `input` with a box or gaussian kernel
+   *
+   * `from` must return GetSeparableBlurShaderCode() for the shader IDs these jobs use.
+   */
+	static NodeValue CreateSeparableBlurJob(const NodeValue &input,
+											Method method, double radius,
+											bool horiz, bool vert,
+											bool repeat_edge_pixels,
+											const Node *from);
+
+	/**
+   * @brief Shader code for the jobs CreateSeparableBlurJob() creates, empty for any other ID
+   */
+	static ShaderCode GetSeparableBlurShaderCode(const QString &shader_id);
+
+	static const int kMaximumTaps = 8;
+
 	static const QString kTextureInput;
 	static const QString kMethodInput;
 	static const QString kRadiusInput;
@@ -22,8 +22,11 @@
 #include "textv3.h"
 
 #include <QAbstractTextDocumentLayout>
+#include <QCryptographicHash>
 #include <QDateTime>
 #include <QTextDocument>
+#include <algorithm>
+#include <cmath>
 
 #include "common/html.h"
 #include "core.h"
@@ -47,6 +50,11 @@ const QString TextGeneratorV3::kVerticalAlignmentInput =
 const QString TextGeneratorV3::kUseArgsInput = QStringLiteral("use_args_in");
 const QString TextGeneratorV3::kArgsInput = QStringLiteral("args_in");
 
+// Position of the text box within the rasterized texture
+static const QString kRasterOffset = QStringLiteral("raster_offset_in");
+
+static const QString kPlaceShader = QStringLiteral("place");
+
 TextGeneratorV3::TextGeneratorV3()
 	: ShapeNodeBase(false)
 	, dont_emit_valign_(false)
@@ -106,6 +114,16 @@ void TextGeneratorV3::Retranslate()
 	SetInputName(kArgsInput, tr("Arguments"));
 }
 
+ShaderCode TextGeneratorV3::GetShaderCode(const ShaderRequest &request) const
+{
+	if (request.id == kPlaceShader) {
+		return ShaderCode(
+			FileFunctions::ReadFileAsString(QStringLiteral(":/shaders/place.frag")));
+	}
+
+	return super::GetShaderCode(request);
+}
+
 void TextGeneratorV3::Value(const NodeValueRow &value,
 							const NodeGlobals &globals,
 							NodeValueTable *table) const
@@ -128,16 +146,92 @@ void TextGeneratorV3::Value(const NodeValueRow &value,
 	if (!text.isEmpty()) {
 		TexturePtr base = value[kTextInput].toTexture();
 
-		VideoParams text_params = base ? base->params() : globals.vparams();
-		text_params.set_format(PixelFormat::U8);
-		text_params.set_colorspace(
-			project()->color_manager()->GetDefaultInputColorSpace());
-
-		GenerateJob job(value);
-		job.Insert(kTextInput, NodeValue(NodeValue::kText, text));
+		VideoParams frame_params = base ? base->params() : globals.vparams();
+
+		// Only the text box is rasterized, and only again if the text or its layout changes. Moving it just changes
+		// where the raster is placed in the frame.
+		const int divider = frame_params.divider();
+		const QVector2D size = value[kSizeInput].toVec2();
+		const QVector2D pos = value[kPositionInput].toVec2();
+
+		// Corner of the box in texture pixels, rounded to an eighth of a pixel so text moving by fractions of a
+		// pixel can still reuse rasters
+		QVector2D box_origin =
+			((QVector2D(frame_params.width(), frame_params.height()) - size) *
+				 0.5f +
+			 pos) /
+			divider;
+		box_origin = QVector2D(std::round(box_origin.x() * 8.0f) / 8.0f,
+							   std::round(box_origin.y() * 8.0f) / 8.0f);
+		QVector2D box_end = box_origin + size / divider;
+
+		// Parts of the box that are out of frame aren't rasterized
+		int raster_left = std::max(0, int(std::floor(box_origin.x())));
+		int raster_top = std::max(0, int(std::floor(box_origin.y())));
+		int raster_right = std::min(frame_params.effective_width(),
+									int(std::ceil(box_end.x())));
+		int raster_bottom = std::min(frame_params.effective_height(),
+									 int(std::ceil(box_end.y())));
+
+		if (raster_right > raster_left && raster_bottom > raster_top) {
+			VideoParams text_params = frame_params;
+			text_params.set_width((raster_right - raster_left) * divider);
+			text_params.set_height((raster_bottom - raster_top) * divider);
+			text_params.set_format(PixelFormat::U8);
+			text_params.set_colorspace(
+				project()->color_manager()->GetDefaultInputColorSpace());
+
+			const QVector2D raster_offset =
+				box_origin - QVector2D(raster_left, raster_top);
+
+			GenerateJob job;
+			job.Insert(kTextInput, NodeValue(NodeValue::kText, text));
+			job.Insert(kSizeInput, value[kSizeInput]);
+			job.Insert(kVerticalAlignmentInput, value[kVerticalAlignmentInput]);
+			job.Insert(kRasterOffset,
+					   NodeValue(NodeValue::kVec2, raster_offset, this));
+
+			// The raster only depends on these and the texture parameters
+			QCryptographicHash hash(QCryptographicHash::Sha1);
+			hash.addData(text.toUtf8());
+			hash.addData(QStringLiteral("%1:%2:%3:%4:%5")
+							 .arg(QString::number(size.x()),
+								  QString::number(size.y()),
+								  QString::number(
+									  value[kVerticalAlignmentInput].toInt()),
+								  QString::number(raster_offset.x()),
+								  QString::number(raster_offset.y()))
+							 .toUtf8());
+			job.SetCacheKey(QString::fromLatin1(hash.result().toHex()));
+
+			ShaderJob place;
+			place.SetShaderID(kPlaceShader);
+			place.Insert(QStringLiteral("tex_in"),
+						 NodeValue(NodeValue::kTexture,
+								   Texture::Job(text_params, job), this));
+			place.Insert(QStringLiteral("offset_in"),
+						 NodeValue(NodeValue::kVec2,
+								   QVector2D(raster_left, raster_top), this));
+			place.Insert(QStringLiteral("size_in"),
+						 NodeValue(NodeValue::kVec2,
+								   QVector2D(text_params.effective_width(),
+											 text_params.effective_height()),
+								   this));
+			place.Insert(QStringLiteral("resolution_in"),
+						 NodeValue(NodeValue::kVec2,
+								   QVector2D(frame_params.effective_width(),
+											 frame_params.effective_height()),
+								   this));
+
+			// Raster pixels line up with the frame's, so don't filter them
+			place.SetInterpolation(QStringLiteral("tex_in"), Texture::kNearest);
+
+			PushMergableJob(value, Texture::Job(frame_params, place), table);
+			return;
+		}
+	}
 
-		PushMergableJob(value, Texture::Job(text_params, job), table);
-	} else if (value[kBaseInput].toTexture()) {
+	if (value[kBaseInput].toTexture()) {
 		table->Push(value[kBaseInput]);
 	}
 }
@@ -164,15 +258,13 @@ void TextGeneratorV3::GenerateFrame(FramePtr frame,
 	QVector2D size = job.Get(kSizeInput).toVec2();
 	text_doc.setTextWidth(size.x());
 
-	// Draw rich text onto image
+	// Draw rich text onto image, the frame only covers the text box (or the part of it that's in frame)
 	QPainter p(&img);
+
+	QVector2D offset = job.Get(kRasterOffset).toVec2();
+	p.translate(offset.x(), offset.y());
 	p.scale(1.0 / frame->video_params().divider(),
 			1.0 / frame->video_params().divider());
-
-	QVector2D pos = job.Get(kPositionInput).toVec2();
-	p.translate(pos.x() - size.x() / 2, pos.y() - size.y() / 2);
-	p.translate(frame->video_params().width() / 2,
-				frame->video_params().height() / 2);
 	p.setClipRect(0, 0, size.x(), size.y());
 
 	switch (static_cast<VerticalAlignment>(
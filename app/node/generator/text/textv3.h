@@ -42,6 +42,8 @@ public:
 
 	virtual void Retranslate() override;
 
+	virtual ShaderCode
+	GetShaderCode(const ShaderRequest &request) const override;
 	virtual void Value(const NodeValueRow &value, const NodeGlobals &globals,
 					   NodeValueTable *table) const override;
 
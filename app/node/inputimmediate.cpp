@@ -31,6 +31,7 @@ NodeInputImmediate::NodeInputImmediate(NodeValue::Type type,
 									   const SplitValue &default_val)
 	: default_value_(default_val)
 	, keyframing_(false)
+	, data_type_(type)
 {
 	set_data_type(type);
 }
@@ -192,10 +193,39 @@ void NodeInputImmediate::set_data_type(NodeValue::Type type)
 {
 	int track_size = NodeValue::get_number_of_keyframe_tracks(type);
 
+	data_type_ = type;
 	keyframe_tracks_.resize(track_size);
 	standard_value_.resize(track_size);
 
 	set_split_standard_value(default_value_);
+
+	QMutexLocker locker(&compiled_curves_lock_);
+	compiled_curves_.clear();
+	compiled_curves_.resize(track_size);
+}
+
+std::shared_ptr<const KeyframeCurve>
+NodeInputImmediate::get_compiled_curve(int track) const
+{
+	QMutexLocker locker(&compiled_curves_lock_);
+
+	std::shared_ptr<const KeyframeCurve> &curve = compiled_curves_[track];
+
+	if (!curve) {
+		curve = std::make_shared<KeyframeCurve>(keyframe_tracks_.at(track),
+												data_type_);
+	}
+
+	return curve;
+}
+
+void NodeInputImmediate::invalidate_compiled_curves()
+{
+	QMutexLocker locker(&compiled_curves_lock_);
+
+	for (std::shared_ptr<const KeyframeCurve> &c : compiled_curves_) {
+		c.reset();
+	}
 }
 
 NodeKeyframe *NodeInputImmediate::get_earliest_keyframe() const
@@ -251,6 +281,7 @@ void NodeInputImmediate::insert_keyframe(NodeKeyframe *key)
 	}
 
 	key_track.insert(insert_index, key);
+	invalidate_compiled_curves();
 
 	NodeKeyframe *previous = insert_index > 0 ? key_track.at(insert_index - 1) :
 												nullptr;
@@ -284,6 +315,7 @@ void NodeInputImmediate::remove_keyframe(NodeKeyframe *key)
 	key->set_next(nullptr);
 
 	keyframe_tracks_[key->track()].removeOne(key);
+	invalidate_compiled_curves();
 }
 
 void NodeInputImmediate::delete_all_keyframes(QObject *parent)
@@ -22,8 +22,12 @@
 #ifndef NODEINPUTIMMEDIATE_H
 #define NODEINPUTIMMEDIATE_H
 
+#include <memory>
+#include <QMutex>
+
 #include "common/xmlutils.h"
 #include "node/keyframe.h"
+#include "node/keyframecurve.h"
 #include "node/value.h"
 #include "splitvalue.h"
 
@@ -156,6 +160,18 @@ public:
 
 	void set_data_type(NodeValue::Type type);
 
+	/**
+   * @brief Get a compiled copy of a keyframe track for fast evaluation
+   *
+   * The curve is compiled on first use and cached until the track is edited. Safe to call from any thread.
+   */
+	std::shared_ptr<const KeyframeCurve> get_compiled_curve(int track) const;
+
+	/**
+   * @brief Discard all compiled curves, must be called whenever a keyframe is changed
+   */
+	void invalidate_compiled_curves();
+
 private:
 	/**
    * @brief Non-keyframed value
@@ -178,6 +194,15 @@ private:
    * @brief Internal keyframing enabled setting
    */
 	bool keyframing_;
+
+	NodeValue::Type data_type_;
+
+	/**
+   * @brief Lazily compiled keyframe tracks, null entries have not been compiled yet
+   */
+	mutable QVector<std::shared_ptr<const KeyframeCurve> > compiled_curves_;
+
+	mutable QMutex compiled_curves_lock_;
 };
 
 }
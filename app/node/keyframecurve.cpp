@@ -0,0 +1,284 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "keyframecurve.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define OLIVE_KEYFRAMECURVE_SSE
+#endif
+
+#include "common/lerp.h"
+
+namespace olive
+{
+
+KeyframeCurve::KeyframeCurve(const NodeKeyframeTrack &track,
+							 NodeValue::Type type)
+{
+	const int count = track.size();
+	const bool can_interpolate = NodeValue::type_can_be_interpolated(type);
+
+	times_.resize(count);
+	values_.resize(count);
+	segments_.resize(count);
+
+	for (int i = 0; i < count; i++) {
+		const NodeKeyframe *key = track.at(i);
+
+		times_[i] = key->time().toDouble();
+
+		if (type == NodeValue::kRational) {
+			values_[i] = key->value().value<rational>().toDouble();
+		} else {
+			values_[i] = key->value().toDouble();
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		Segment &s = segments_[i];
+		s.type = kHold;
+		s.c1x = s.c1y = s.c2x = s.c2y = 0.0;
+
+		if (i == count - 1 || !can_interpolate) {
+			continue;
+		}
+
+		const NodeKeyframe *before = track.at(i);
+		const NodeKeyframe *after = track.at(i + 1);
+
+		if (before->type() == NodeKeyframe::kHold) {
+			continue;
+		}
+
+		if (before->type() == NodeKeyframe::kBezier &&
+			after->type() == NodeKeyframe::kBezier) {
+			s.type = kCubic;
+			s.c1x = times_[i] + before->valid_bezier_control_out().x();
+			s.c1y = values_[i] + before->valid_bezier_control_out().y();
+			s.c2x = times_[i + 1] + after->valid_bezier_control_in().x();
+			s.c2y = values_[i + 1] + after->valid_bezier_control_in().y();
+		} else if (before->type() == NodeKeyframe::kBezier) {
+			s.type = kQuadratic;
+			s.c1x = before->valid_bezier_control_out().x() + times_[i];
+			s.c1y = before->valid_bezier_control_out().y() + values_[i];
+		} else if (after->type() == NodeKeyframe::kBezier) {
+			s.type = kQuadratic;
+			s.c1x = after->valid_bezier_control_in().x() + times_[i + 1];
+			s.c1y = after->valid_bezier_control_in().y() + values_[i + 1];
+		} else {
+			s.type = kLinear;
+		}
+	}
+}
+
+int KeyframeCurve::FindKey(double time, int hint) const
+{
+	const int count = key_count();
+
+	if (count == 0 || time < times_.front()) {
+		return -1;
+	}
+
+	// Fast path for monotonic queries, check the hinted segment and the one after it
+	if (hint >= 0 && hint < count && times_[hint] <= time) {
+		if (hint == count - 1 || time < times_[hint + 1]) {
+			return hint;
+		}
+
+		if (hint + 1 == count - 1 || time < times_[hint + 2]) {
+			return hint + 1;
+		}
+	}
+
+	auto it = std::upper_bound(times_.cbegin(), times_.cend(), time);
+	return int(it - times_.cbegin()) - 1;
+}
+
+double KeyframeCurve::Interpolate(int key, double time) const
+{
+	const Segment &s = segments_[key];
+	const double before_time = times_[key];
+	const double before_val = values_[key];
+	const double after_time = times_[key + 1];
+	const double after_val = values_[key + 1];
+
+	switch (s.type) {
+	case kHold:
+		return before_val;
+	case kLinear:
+		return lerp(before_val, after_val,
+					(time - before_time) / (after_time - before_time));
+	case kQuadratic:
+		return Bezier::QuadraticXtoY(time,
+									 Imath::V2d(before_time, before_val),
+									 Imath::V2d(s.c1x, s.c1y),
+									 Imath::V2d(after_time, after_val));
+	case kCubic:
+		return Bezier::CubicXtoY(time, Imath::V2d(before_time, before_val),
+								 Imath::V2d(s.c1x, s.c1y),
+								 Imath::V2d(s.c2x, s.c2y),
+								 Imath::V2d(after_time, after_val));
+	}
+
+	return before_val;
+}
+
+double KeyframeCurve::ValueAt(double time) const
+{
+	if (isEmpty()) {
+		return 0.0;
+	}
+
+	if (time <= times_.front()) {
+		return values_.front();
+	}
+
+	if (time >= times_.back()) {
+		return values_.back();
+	}
+
+	int key = FindKey(time);
+
+	if (times_[key] == time) {
+		return values_[key];
+	}
+
+	return Interpolate(key, time);
+}
+
+void KeyframeCurve::Evaluate(double start, double step, float *out,
+							 size_t count) const
+{
+	if (count == 0) {
+		return;
+	}
+
+	if (isEmpty() || step <= 0.0) {
+		std::fill(out, out + count, float(ValueAt(start)));
+		return;
+	}
+
+	const int last = key_count() - 1;
+	int key = 0;
+	size_t i = 0;
+
+	while (i < count) {
+		double t = start + step * double(i);
+
+		if (t <= times_.front()) {
+			out[i] = float(values_.front());
+			i++;
+			continue;
+		}
+
+		key = FindKey(t, key);
+
+		if (key >= last) {
+			// Everything from here on is past the last key
+			std::fill(out + i, out + count, float(values_.back()));
+			return;
+		}
+
+		// Find how many samples fall within this segment
+		const double segment_end = times_[key + 1];
+		size_t end = i;
+		while (end < count && start + step * double(end) < segment_end) {
+			end++;
+		}
+
+		if (t == times_[key]) {
+			out[i] = float(values_[key]);
+			i++;
+		}
+
+		switch (segments_[key].type) {
+		case kHold:
+			std::fill(out + i, out + end, float(values_[key]));
+			break;
+		case kLinear:
+		{
+			const double slope = (values_[key + 1] - values_[key]) /
+								 (times_[key + 1] - times_[key]);
+			const double first =
+				values_[key] + slope * (start + step * double(i) - times_[key]);
+			FillLinear(out + i, end - i, first, slope * step);
+			break;
+		}
+		case kQuadratic:
+		case kCubic:
+			for (size_t j = i; j < end; j++) {
+				out[j] = float(Interpolate(key, start + step * double(j)));
+			}
+			break;
+		}
+
+		i = end;
+	}
+}
+
+void KeyframeCurve::Evaluate(const TimeRange &range, const rational &step,
+							 float *out) const
+{
+	Evaluate(range.in().toDouble(), step.toDouble(), out,
+			 GetSampleCount(range, step));
+}
+
+size_t KeyframeCurve::GetSampleCount(const TimeRange &range,
+									 const rational &step)
+{
+	if (step <= rational(0) || range.length() <= rational(0)) {
+		return 0;
+	}
+
+	rational steps = range.length() / step;
+
+	// Round up, a partial step at the end still gets a sample
+	int64_t num = steps.numerator();
+	int64_t den = steps.denominator();
+	return size_t((num + den - 1) / den);
+}
+
+void KeyframeCurve::FillLinear(float *out, size_t count, double start,
+							   double increment)
+{
+	size_t i = 0;
+
+#ifdef OLIVE_KEYFRAMECURVE_SSE
+	const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+	const __m128 inc = _mm_set1_ps(float(increment));
+	const __m128 lane_offsets = _mm_mul_ps(lanes, inc);
+
+	for (; i + 4 <= count; i += 4) {
+		// Re-anchor every block in double precision so error doesn't accumulate over long buffers
+		__m128 base = _mm_set1_ps(float(start + increment * double(i)));
+		_mm_storeu_ps(out + i, _mm_add_ps(base, lane_offsets));
+	}
+#endif
+
+	for (; i < count; i++) {
+		out[i] = float(start + increment * double(i));
+	}
+}
+
+}
@@ -0,0 +1,154 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef NODEKEYFRAMECURVE_H
+#define NODEKEYFRAMECURVE_H
+
+#include <olive/core/core.h>
+#include <vector>
+
+#include "node/keyframe.h"
+#include "node/value.h"
+
+namespace olive
+{
+
+using namespace core;
+
+/**
+ * @brief A flattened, read-only copy of a keyframe track optimized for evaluation
+ *
+ * NodeKeyframe objects are heap-allocated QObjects with rational times and QVariant values, which makes
+ * evaluating a track at many times (audio automation, the curve editor) far more expensive than it needs to be.
+ * A KeyframeCurve stores the same data as contiguous arrays of doubles with the bezier control points already
+ * resolved, so evaluation only has to locate the segment and interpolate.
+ *
+ * Curves are compiled lazily by NodeInputImmediate and thrown away whenever the track is edited. Evaluation is
+ * numerically identical to Node::GetSplitValueAtTimeOnTrack().
+ */
+class KeyframeCurve {
+public:
+	/**
+   * @brief How the segment between key `i` and key `i + 1` is interpolated
+   */
+	enum SegmentType : uint8_t { kHold, kLinear, kQuadratic, kCubic };
+
+	KeyframeCurve() = default;
+
+	/**
+   * @brief Compile a curve from a sorted keyframe track
+   *
+   * If `type` cannot be interpolated (see NodeValue::type_can_be_interpolated()), every segment is compiled as a
+   * hold.
+   */
+	KeyframeCurve(const NodeKeyframeTrack &track, NodeValue::Type type);
+
+	bool isEmpty() const
+	{
+		return times_.empty();
+	}
+
+	int key_count() const
+	{
+		return int(times_.size());
+	}
+
+	double key_time(int index) const
+	{
+		return times_[index];
+	}
+
+	double key_value(int index) const
+	{
+		return values_[index];
+	}
+
+	SegmentType segment_type(int index) const
+	{
+		return segments_[index].type;
+	}
+
+	/**
+   * @brief Find the index of the last key whose time is <= `time`
+   *
+   * Returns -1 if `time` precedes every key. `hint` is the index returned by a previous call and makes lookups
+   * O(1) when times are queried in increasing order.
+   */
+	int FindKey(double time, int hint = 0) const;
+
+	/**
+   * @brief Interpolate within the segment starting at `key` (must be a valid index that isn't the last key)
+   */
+	double Interpolate(int key, double time) const;
+
+	/**
+   * @brief Evaluate the curve at a single time
+   */
+	double ValueAt(double time) const;
+
+	/**
+   * @brief Evaluate `count` samples starting at `start` and spaced `step` apart into `out`
+   *
+   * Uses a monotonic cursor so the whole buffer is produced in a single pass over the segments. Linear segments
+   * are filled with a vectorized lerp.
+   */
+	void Evaluate(double start, double step, float *out, size_t count) const;
+
+	/**
+   * @brief Evaluate every `step` in `range` into `out`
+   *
+   * `out` must have room for GetSampleCount(range, step) floats.
+   */
+	void Evaluate(const TimeRange &range, const rational &step, float *out) const;
+
+	/**
+   * @brief Number of samples Evaluate() will write for this range and step
+   */
+	static size_t GetSampleCount(const TimeRange &range, const rational &step);
+
+	/**
+   * @brief Fill `out` with `count` samples of a linear ramp starting at `start` and increasing by `increment`
+   */
+	static void FillLinear(float *out, size_t count, double start,
+						   double increment);
+
+private:
+	struct Segment {
+		SegmentType type;
+
+		// Absolute bezier control points (time, value). For quadratic segments only the first is used.
+		double c1x;
+		double c1y;
+		double c2x;
+		double c2y;
+	};
+
+	std::vector<double> times_;
+
+	std::vector<double> values_;
+
+	// One entry per key, the last is unused and always kHold
+	std::vector<Segment> segments_;
+};
+
+}
+
+#endif // NODEKEYFRAMECURVE_H
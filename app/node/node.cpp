@@ -25,6 +25,7 @@
 #include <QGuiApplication>
 #include <QDebug>
 #include <QFile>
+#include <atomic>
 
 #include "common/lerp.h"
 #include "core.h"
@@ -44,20 +45,36 @@ namespace olive
 
 const QString Node::kEnabledInput = QStringLiteral("enabled_in");
 
+namespace
+{
+
+// Epochs are unique across the process, so a node reached by propagations on several threads never mistakes
+// one for another
+std::atomic<uint64_t> next_invalidation_epoch(0);
+
+// Epoch of the propagation running on this thread, and how deep into it we are
+thread_local uint64_t invalidation_epoch = 0;
+thread_local int invalidation_depth = 0;
+
+}
+
 Node::Node()
 	: override_color_(-1)
 	, folder_(nullptr)
 	, flags_(kNone)
+	, video_cache_(nullptr)
+	, thumbnail_cache_(nullptr)
+	, audio_cache_(nullptr)
+	, waveform_cache_(nullptr)
+	, cache_users_(0)
 	, caches_enabled_(true)
+	, invalidation_epoch_(0)
 {
 	AddInput(kEnabledInput, NodeValue::kBoolean, true);
 
-	video_cache_ = new FrameHashCache(this);
-	thumbnail_cache_ = new ThumbnailCache(this);
-	audio_cache_ = new AudioPlaybackCache(this);
-	waveform_cache_ = new AudioWaveformCache(this);
-
-	waveform_cache_->SetSavingEnabled(false);
+	for (QUuid &u : cache_uuids_) {
+		u = QUuid::createUuid();
+	}
 }
 
 Node::~Node()
@@ -250,10 +267,104 @@ void Node::DisconnectEdge(Node *output, const NodeInput &input)
 
 void Node::CopyCacheUuidsFrom(Node *n)
 {
-	video_cache_->SetUuid(n->video_cache_->GetUuid());
-	audio_cache_->SetUuid(n->audio_cache_->GetUuid());
-	thumbnail_cache_->SetUuid(n->thumbnail_cache_->GetUuid());
-	waveform_cache_->SetUuid(n->waveform_cache_->GetUuid());
+	for (int i = 0; i < kCacheTypeCount; i++) {
+		SetCacheUuid(CacheType(i), n->GetCacheUuid(CacheType(i)));
+	}
+}
+
+QUuid Node::GetCacheUuid(CacheType type) const
+{
+	if (HasCaches()) {
+		return GetCache(type)->GetUuid();
+	} else {
+		return cache_uuids_[type];
+	}
+}
+
+void Node::SetCacheUuid(CacheType type, const QUuid &uuid)
+{
+	if (HasCaches()) {
+		GetCache(type)->SetUuid(uuid);
+	} else {
+		cache_uuids_[type] = uuid;
+	}
+	InvalidateSerialized();
+}
+
+void Node::InvalidateSerialized()
+{
+	if (Project *p = parent()) {
+		p->InvalidateSerializedNode(this);
+	}
+}
+
+void Node::RetainCaches()
+{
+	cache_users_++;
+
+	if (cache_users_ == 1) {
+		CachesRetainedEvent();
+	}
+}
+
+void Node::ReleaseCaches()
+{
+	if (cache_users_ > 0) {
+		cache_users_--;
+	}
+
+	if (cache_users_ == 0 && HasCaches()) {
+		for (int i = 0; i < kCacheTypeCount; i++) {
+			GetCache(CacheType(i))->Unload();
+		}
+	}
+}
+
+void Node::CreateCaches() const
+{
+	if (HasCaches()) {
+		return;
+	}
+
+	Node *self = const_cast<Node *>(this);
+
+	video_cache_ = new FrameHashCache(self);
+	thumbnail_cache_ = new ThumbnailCache(self);
+	audio_cache_ = new AudioPlaybackCache(self);
+	waveform_cache_ = new AudioWaveformCache(self);
+
+	for (int i = 0; i < kCacheTypeCount; i++) {
+		PlaybackCache *c = GetCache(CacheType(i));
+
+		// Reads whatever state was left in the cache directory
+		c->SetUuid(cache_uuids_[i]);
+
+		connect(c, &PlaybackCache::Validated, self, &Node::CachesChanged);
+		connect(c, &PlaybackCache::Invalidated, self, &Node::CachesChanged);
+	}
+
+	connect(waveform_cache_, &PlaybackCache::Validated, self,
+			&Node::WaveformCacheValidated);
+
+	emit self->CachesCreated();
+}
+
+PlaybackCache *Node::GetCache(CacheType type) const
+{
+	switch (type) {
+	case kVideoCache:
+		return video_cache_;
+	case kThumbnailCache:
+		return thumbnail_cache_;
+	case kAudioCache:
+		return audio_cache_;
+	case kWaveformCache:
+		return waveform_cache_;
+	case kCacheTypeCount:
+		break;
+	}
+
+	return nullptr;
 }
 
 QString Node::GetInputName(const QString &id) const
@@ -460,118 +571,56 @@ QVariant Node::GetSplitValueAtTimeOnTrack(const QString &input,
 		NodeValue::Type type = GetInputDataType(input);
 
 		// If we're here, the time must be somewhere in between the keyframes
-		NodeKeyframe *before = nullptr, *after = nullptr;
-
-		int low = 0;
-		int high = key_track.size() - 1;
-		while (low <= high) {
-			int mid = low + (high - low) / 2;
-			NodeKeyframe *mid_key = key_track.at(mid);
-			NodeKeyframe *next_key = key_track.at(mid + 1);
-
-			if (mid_key->time() <= time && next_key->time() > time) {
-				before = mid_key;
-				after = next_key;
-				break;
-			} else if (mid_key->time() < time) {
-				low = mid + 1;
-			} else {
-				high = mid - 1;
+		std::shared_ptr<const KeyframeCurve> curve =
+			GetImmediate(input, element)->get_compiled_curve(track);
+		Q_ASSERT(curve->key_count() == key_track.size());
+
+		double t = time.toDouble();
+		int before = curve->FindKey(t);
+
+		if (before >= 0 && before < key_track.size() - 1) {
+			if (curve->key_time(before) == t ||
+				curve->segment_type(before) == KeyframeCurve::kHold) {
+				// Time == keyframe time or we're holding, so value is precise
+				return key_track.at(before)->value();
 			}
-		}
-
-		if (before) {
-			if (before->time() == time ||
-				((!NodeValue::type_can_be_interpolated(type) ||
-				  before->type() == NodeKeyframe::kHold) &&
-				 after->time() > time)) {
-				// Time == keyframe time, so value is precise
-				return before->value();
-
-			} else if (after->time() == time) {
-				// Time == keyframe time, so value is precise
-				return after->value();
-
-			} else if (before->time() < time && after->time() > time) {
-				// We must interpolate between these keyframes
-
-				double before_val, after_val, interpolated;
-				if (type == NodeValue::kRational) {
-					before_val = before->value().value<rational>().toDouble();
-					after_val = after->value().value<rational>().toDouble();
-				} else {
-					before_val = before->value().toDouble();
-					after_val = after->value().toDouble();
-				}
-
-				if (before->type() == NodeKeyframe::kBezier &&
-					after->type() == NodeKeyframe::kBezier) {
-					// Perform a cubic bezier with two control points
-					interpolated = Bezier::CubicXtoY(
-						time.toDouble(),
-						Imath::V2d(before->time().toDouble(), before_val),
-						Imath::V2d(before->time().toDouble() +
-									   before->valid_bezier_control_out().x(),
-								   before_val +
-									   before->valid_bezier_control_out().y()),
-						Imath::V2d(after->time().toDouble() +
-									   after->valid_bezier_control_in().x(),
-								   after_val +
-									   after->valid_bezier_control_in().y()),
-						Imath::V2d(after->time().toDouble(), after_val));
-
-				} else if (before->type() == NodeKeyframe::kBezier ||
-						   after->type() == NodeKeyframe::kBezier) {
-					// Perform a quadratic bezier with only one control point
-
-					Imath::V2d control_point;
-
-					if (before->type() == NodeKeyframe::kBezier) {
-						control_point.x =
-							(before->valid_bezier_control_out().x() +
-							 before->time().toDouble());
-						control_point.y =
-							(before->valid_bezier_control_out().y() +
-							 before_val);
-					} else {
-						control_point.x =
-							(after->valid_bezier_control_in().x() +
-							 after->time().toDouble());
-						control_point.y =
-							(after->valid_bezier_control_in().y() + after_val);
-					}
-
-					// Interpolate value using quadratic beziers
-					interpolated = Bezier::QuadraticXtoY(
-						time.toDouble(),
-						Imath::V2d(before->time().toDouble(), before_val),
-						control_point,
-						Imath::V2d(after->time().toDouble(), after_val));
-
-				} else {
-					// To have arrived here, the keyframes must both be linear
-					qreal period_progress =
-						(time.toDouble() - before->time().toDouble()) /
-						(after->time().toDouble() - before->time().toDouble());
 
-					interpolated = lerp(before_val, after_val, period_progress);
-				}
+			// We must interpolate between these keyframes
+			double interpolated = curve->Interpolate(before, t);
 
-				if (type == NodeValue::kRational) {
-					return QVariant::fromValue(
-						rational::fromDouble(interpolated));
-				} else {
-					return interpolated;
-				}
+			if (type == NodeValue::kRational) {
+				return QVariant::fromValue(rational::fromDouble(interpolated));
+			} else {
+				return interpolated;
 			}
 		} else {
-			qWarning() << "Binary search for keyframes failed";
+			qWarning() << "Keyframe search failed";
 		}
 	}
 
 	return GetSplitStandardValueOnTrack(input, track, element);
 }
 
+void Node::GetSplitValuesOverRangeOnTrack(const QString &input,
+										   const TimeRange &range,
+										   const rational &step, float *out,
+										   int track, int element) const
+{
+	size_t count = KeyframeCurve::GetSampleCount(range, step);
+
+	if (IsUsingStandardValue(input, track, element)) {
+		QVariant v = GetSplitStandardValueOnTrack(input, track, element);
+		float f = (GetInputDataType(input) == NodeValue::kRational) ?
+					  v.value<rational>().toDouble() :
+					  v.toDouble();
+		std::fill(out, out + count, f);
+	} else {
+		GetImmediate(input, element)
+			->get_compiled_curve(track)
+			->Evaluate(range, step, out);
+	}
+}
+
 QVariant Node::GetDefaultValue(const QString &input) const
 {
 	NodeValue::Type type = GetInputDataType(input);
@@ -1010,6 +1059,14 @@ void Node::InvalidateCache(const TimeRange &range, const QString &from,
 	Q_UNUSED(from)
 	Q_UNUSED(element)
 
+	// In graphs with shared sub-trees (e.g. one footage feeding several merges), the same node can be reached
+	// many times during one propagation. Subclasses have already mapped `range` to this node's time, so if
+	// this node has handled it this epoch, invalidating and propagating it again would be redundant.
+	if (invalidation_depth > 0 && options.isEmpty() &&
+		!MarkInvalidatedThisEpoch(range)) {
+		return;
+	}
+
 	if (AreCachesEnabled()) {
 		if (range.in() != range.out()) {
 			TimeRange vr = range.Intersected(GetVideoCacheRange());
@@ -1230,12 +1287,36 @@ Node *Node::CopyNodeInGraph(Node *node, MultiUndoCommand *command)
 void Node::SendInvalidateCache(const TimeRange &range,
 							   const InvalidateCacheOptions &options)
 {
+	// Every top-level invalidation starts a new propagation epoch, see Node::InvalidateCache()
+	if (invalidation_depth == 0) {
+		invalidation_epoch = ++next_invalidation_epoch;
+	}
+
+	invalidation_depth++;
+
 	for (const OutputConnection &conn : output_connections_) {
 		// Send clear cache signal to the Node
 		const NodeInput &in = conn.second;
 
 		in.node()->InvalidateCache(range, in.input(), in.element(), options);
 	}
+
+	invalidation_depth--;
+}
+
+bool Node::MarkInvalidatedThisEpoch(const TimeRange &range)
+{
+	if (invalidation_epoch_ != invalidation_epoch) {
+		invalidation_epoch_ = invalidation_epoch;
+		invalidated_this_epoch_.clear();
+	}
+
+	if (invalidated_this_epoch_.contains(range)) {
+		return false;
+	}
+
+	invalidated_this_epoch_.insert(range);
+	return true;
 }
 
 void Node::InvalidateAll(const QString &input, int element)
@@ -1409,17 +1490,17 @@ bool Node::Load(QXmlStreamReader *reader, SerializedData *data)
 		} else if (reader->name() == QStringLiteral("caches")) {
 			while (XMLReadNextStartElement(reader)) {
 				if (reader->name() == QStringLiteral("audio")) {
-					this->audio_playback_cache()->SetUuid(
-						QUuid::fromString(reader->readElementText()));
+					SetCacheUuid(kAudioCache,
+								 QUuid::fromString(reader->readElementText()));
 				} else if (reader->name() == QStringLiteral("video")) {
-					this->video_frame_cache()->SetUuid(
-						QUuid::fromString(reader->readElementText()));
+					SetCacheUuid(kVideoCache,
+								 QUuid::fromString(reader->readElementText()));
 				} else if (reader->name() == QStringLiteral("thumb")) {
-					this->thumbnail_cache()->SetUuid(
-						QUuid::fromString(reader->readElementText()));
+					SetCacheUuid(kThumbnailCache,
+								 QUuid::fromString(reader->readElementText()));
 				} else if (reader->name() == QStringLiteral("waveform")) {
-					this->waveform_cache()->SetUuid(
-						QUuid::fromString(reader->readElementText()));
+					SetCacheUuid(kWaveformCache,
+								 QUuid::fromString(reader->readElementText()));
 				} else {
 					reader->skipCurrentElement();
 				}
@@ -1523,15 +1604,14 @@ void Node::Save(QXmlStreamWriter *writer) const
 
 	writer->writeStartElement(QStringLiteral("caches"));
 
-	writer->writeTextElement(
-		QStringLiteral("audio"),
-		this->audio_playback_cache()->GetUuid().toString());
+	writer->writeTextElement(QStringLiteral("audio"),
+							 GetCacheUuid(kAudioCache).toString());
 	writer->writeTextElement(QStringLiteral("video"),
-							 this->video_frame_cache()->GetUuid().toString());
+							 GetCacheUuid(kVideoCache).toString());
 	writer->writeTextElement(QStringLiteral("thumb"),
-							 this->thumbnail_cache()->GetUuid().toString());
+							 GetCacheUuid(kThumbnailCache).toString());
 	writer->writeTextElement(QStringLiteral("waveform"),
-							 this->waveform_cache()->GetUuid().toString());
+							 GetCacheUuid(kWaveformCache).toString());
 
 	writer->writeEndElement(); // caches
 
@@ -2340,6 +2420,11 @@ TimeRange Node::TransformTimeTo(TimeRange time, Node *target,
 void Node::ParameterValueChanged(const QString &input, int element,
 								 const TimeRange &range)
 {
+	if (NodeInputImmediate *imm = GetImmediate(input, element)) {
+		// Keyframes may have changed, any compiled curves are now stale
+		imm->invalidate_compiled_curves();
+	}
+
 	InputValueChangedEvent(input, element);
 
 	emit ValueChanged(NodeInput(this, input, element), range);
@@ -278,26 +278,73 @@ public:
 		return HasInputWithID(id);
 	}
 
+	/**
+   * @brief This node's caches
+   *
+   * Caches are created, and their state read from the cache directory, the first time any of them
+   * is asked for. Most nodes never are, so a project with many sequences only pays for the ones
+   * that are used. Must be called from the thread the node lives in.
+   */
 	FrameHashCache *video_frame_cache() const
 	{
+		CreateCaches();
 		return video_cache_;
 	}
 
 	ThumbnailCache *thumbnail_cache() const
 	{
+		CreateCaches();
 		return thumbnail_cache_;
 	}
 
 	AudioPlaybackCache *audio_playback_cache() const
 	{
+		CreateCaches();
 		return audio_cache_;
 	}
 
 	AudioWaveformCache *waveform_cache() const
 	{
+		CreateCaches();
 		return waveform_cache_;
 	}
 
+	/**
+   * @brief Returns whether this node's caches have been created yet
+   */
+	bool HasCaches() const
+	{
+		return video_cache_ != nullptr;
+	}
+
+	enum CacheType {
+		kVideoCache,
+		kThumbnailCache,
+		kAudioCache,
+		kWaveformCache,
+		kCacheTypeCount
+	};
+
+	/**
+   * @brief Get or set the ID of one of this node's caches without creating it
+   */
+	QUuid GetCacheUuid(CacheType type) const;
+	void SetCacheUuid(CacheType type, const QUuid &uuid);
+
+	/**
+   * @brief Mark this node's caches as used by a panel
+   *
+   * Once every panel that retained them calls ReleaseCaches(), anything the caches hold in memory
+   * that can be read back from the cache directory is freed.
+   */
+	void RetainCaches();
+	void ReleaseCaches();
+
+	bool AreCachesRetained() const
+	{
+		return cache_users_ > 0;
+	}
+
 	virtual TimeRange GetVideoCacheRange() const
 	{
 		return TimeRange();
@@ -543,6 +590,18 @@ public:
 		return GetSplitValueAtTimeOnTrack(input.input(), time, input.track());
 	}
 
+	/**
+   * @brief Evaluate a track at every `step` in `range` into a float buffer
+   *
+   * Much faster than calling GetSplitValueAtTimeOnTrack() per time since the keyframes are compiled into a
+   * KeyframeCurve and walked with a monotonic cursor. `out` must have room for
+   * KeyframeCurve::GetSampleCount(range, step) floats. Only meaningful for numeric types.
+   */
+	void GetSplitValuesOverRangeOnTrack(const QString &input,
+										const TimeRange &range,
+										const rational &step, float *out,
+										int track = 0, int element = -1) const;
+
 	QVariant GetDefaultValue(const QString &input) const;
 	SplitValue GetSplitDefaultValue(const QString &input) const;
 	QVariant GetSplitDefaultValueOnTrack(const QString &input, int track) const;
@@ -1115,6 +1174,13 @@ public:
 	{
 	}
 
+	/**
+   * @brief Called when the first panel retains this node's caches, see RetainCaches()
+   */
+	virtual void CachesRetainedEvent()
+	{
+	}
+
 	static void SetValueAtTime(const NodeInput &input, const rational &time,
 							   const QVariant &value, int track,
 							   MultiUndoCommand *command,
@@ -1159,6 +1225,14 @@ protected:
 		plugin_instance_ = instance;
 	}
 
+	/**
+   * @brief Discard the XML the project saved for this node last time
+   *
+   * Project only watches the signals of state that Save() writes. Call this when saved state (including
+   * anything SaveCustom() writes) changes without one of them being emitted.
+   */
+	void InvalidateSerialized();
+
 	void InsertInput(const QString &id, NodeValue::Type type,
 					 const QVariant &default_value, InputFlags flags,
 					 int index);
@@ -1346,6 +1420,21 @@ signals:
 
 	void InputFlagsChanged(const QString &input, const InputFlags &flags);
 
+	/**
+   * @brief Emitted once this node's caches have been created
+   */
+	void CachesCreated();
+
+	/**
+   * @brief Emitted when a range of any of this node's caches is validated or invalidated
+   */
+	void CachesChanged();
+
+	/**
+   * @brief Emitted when a range of this node's waveform cache is validated
+   */
+	void WaveformCacheValidated();
+
 private:
 	struct Input {
 		NodeValue::Type type;
@@ -1470,14 +1559,33 @@ private:
 
 	QString effect_input_;
 
-	FrameHashCache *video_cache_;
-	ThumbnailCache *thumbnail_cache_;
+	void CreateCaches() const;
+
+	PlaybackCache *GetCache(CacheType type) const;
+
+	mutable FrameHashCache *video_cache_;
+	mutable ThumbnailCache *thumbnail_cache_;
+
+	mutable AudioPlaybackCache *audio_cache_;
+	mutable AudioWaveformCache *waveform_cache_;
 
-	AudioPlaybackCache *audio_cache_;
-	AudioWaveformCache *waveform_cache_;
+	// IDs of the caches until they're created, the caches own them afterwards
+	QUuid cache_uuids_[kCacheTypeCount];
+
+	int cache_users_;
 
 	bool caches_enabled_;
 
+	/**
+   * @brief Ranges this node already invalidated during the current propagation, whichever input they came from
+   *
+   * See InvalidateCache(). Only valid while `invalidation_epoch_` matches the current epoch.
+   */
+	uint64_t invalidation_epoch_;
+	TimeRangeList invalidated_this_epoch_;
+
+	bool MarkInvalidatedThisEpoch(const TimeRange &range);
+
 private slots:
 	/**
    * @brief Slot when a keyframe's time changes to keep the keyframes correctly sorted by time
@@ -360,7 +360,7 @@ void ViewerOutput::InputConnectedEvent(const QString &input, int element,
 	if (input == kTextureInput) {
 		emit TextureInputChanged();
 	} else if (input == kSamplesInput) {
-		connect(output->waveform_cache(), &AudioWaveformCache::Validated, this,
+		connect(output, &Node::WaveformCacheValidated, this,
 				&ViewerOutput::ConnectedWaveformChanged);
 	}
 
@@ -373,8 +373,8 @@ void ViewerOutput::InputDisconnectedEvent(const QString &input, int element,
 	if (input == kTextureInput) {
 		emit TextureInputChanged();
 	} else if (input == kSamplesInput) {
-		disconnect(output->waveform_cache(), &AudioWaveformCache::Validated,
-				   this, &ViewerOutput::ConnectedWaveformChanged);
+		disconnect(output, &Node::WaveformCacheValidated, this,
+				   &ViewerOutput::ConnectedWaveformChanged);
 	}
 
 	super::InputDisconnectedEvent(input, element, output);
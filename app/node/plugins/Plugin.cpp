@@ -155,6 +155,7 @@ static QString ClipLabelForName(const std::string &name,
 
 olive::plugin::PluginNode::PluginNode(
 	OFX::Host::ImageEffect::Instance *plugin)
+	: render_instances_(std::make_unique<InstancePool>(plugin))
 {
 	plugin_instance_=plugin;
 	bool has_texture_input = false;
@@ -22,6 +22,9 @@
 #include "ofxhPluginCache.h"
 #include "ofxImageEffect.h"
 #include "node/node.h"
+#include "pluginSupport/instancepool.h"
+
+#include <memory>
 
 namespace olive
 {
@@ -76,9 +79,22 @@ public:
    */
 	virtual void GenerateFrame(FramePtr frame, const GenerateJob &job) const;
 
+	/**
+   * @brief Instances render threads lease to render this node
+   *
+   * Separate from the node's own instance, which stays bound to the node's inputs for the UI.
+   */
+	InstancePool *render_instances() const
+	{
+		return render_instances_.get();
+	}
+
 public slots:
 	void pushButtonClicked(QString name);
 
+private:
+	std::unique_ptr<InstancePool> render_instances_;
+
 };
 
 }
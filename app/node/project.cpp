@@ -31,6 +31,8 @@
 #include "dialog/progress/progress.h"
 #include "node/color/ociobase/ociobase.h"
 #include "node/factory.h"
+#include "node/output/track/track.h"
+#include "node/project/serializer/parallelnodeloader.h"
 #include "node/serializeddata.h"
 #include "pluginSupport/OliveHost.h"
 #include "ofxhPluginCache.h"
@@ -149,6 +151,8 @@ SerializedData Project::Load(QXmlStreamReader *reader)
 			}
 
 		} else if (reader->name() == QStringLiteral("nodes")) {
+			ParallelNodeLoader loader(this, &data);
+
 			while (XMLReadNextStartElement(reader)) {
 				if (reader->name() == QStringLiteral("node")) {
 					QString id;
@@ -175,9 +179,7 @@ SerializedData Project::Load(QXmlStreamReader *reader)
 							// Disable cache while node is being loaded (we'll re-enable it later)
 							node->SetCachesEnabled(false);
 
-							node->Load(reader, &data);
-
-							node->setParent(this);
+							loader.Add(node, reader);
 						}
 					}
 				} else {
@@ -185,6 +187,8 @@ SerializedData Project::Load(QXmlStreamReader *reader)
 				}
 			}
 
+			loader.Finish();
+
 		} else if (reader->name() == QStringLiteral("settings")) {
 			while (XMLReadNextStartElement(reader)) {
 				QString key = reader->name().toString();
@@ -282,11 +286,7 @@ void Project::Save(QXmlStreamWriter *writer) const
 		writer->writeStartElement(QStringLiteral("nodes"));
 
 		foreach (Node *node, this->nodes()) {
-			writer->writeStartElement(QStringLiteral("node"));
-
-			node->Save(writer);
-
-			writer->writeEndElement(); // node
+			SaveNode(writer, node);
 		}
 
 		writer->writeEndElement(); // nodes
@@ -304,6 +304,42 @@ void Project::Save(QXmlStreamWriter *writer) const
 	}
 }
 
+void Project::InvalidateSerializedNode(Node *node)
+{
+	serialized_nodes_.remove(node);
+}
+
+void Project::SaveNode(QXmlStreamWriter *writer, Node *node) const
+{
+	QByteArray &element = serialized_nodes_[node];
+
+	if (element.isEmpty()) {
+		// Kept unformatted, whitespace is added when it's written back through `writer`
+		QXmlStreamWriter node_writer(&element);
+
+		node_writer.writeStartElement(QStringLiteral("node"));
+		node->Save(&node_writer);
+		node_writer.writeEndElement(); // node
+	}
+
+	// Parsing the element back is much cheaper than Node::Save(), and going through the writer keeps its
+	// state (open start tags, formatting) correct
+	QXmlStreamReader reader(element);
+	while (!reader.atEnd()) {
+		reader.readNext();
+		if (!reader.isStartDocument() && !reader.isEndDocument() &&
+			!reader.hasError()) {
+			writer->writeCurrentToken(reader);
+		}
+	}
+}
+
+void Project::SerializedNodeChanged()
+{
+	// Only used as a key, the node may be in the middle of being destroyed
+	serialized_nodes_.remove(static_cast<Node *>(sender()));
+}
+
 int Project::GetNumberOfContextsNodeIsIn(Node *node, bool except_itself) const
 {
 	int count = 0;
@@ -337,6 +373,75 @@ void Project::childEvent(QChildEvent *event)
 			connect(node, &Node::InputValueHintChanged, this,
 					&Project::InputValueHintChanged, Qt::DirectConnection);
 
+			// Only the signals of state that Node::Save() writes, anything else calls
+			// Node::InvalidateSerialized()
+			connect(node, &Node::LabelChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::ColorChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::ValueChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputConnected, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputDisconnected, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputValueHintChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputPropertyChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::LinksChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputArraySizeChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::KeyframeAdded, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::KeyframeRemoved, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::KeyframeTimeChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::KeyframeTypeChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::KeyframeValueChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::KeyframeEnableChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputAdded, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputRemoved, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputNameChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputDataTypeChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::InputFlagsChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::NodeAddedToContext, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::NodePositionInContextChanged, this,
+					&Project::SerializedNodeChanged);
+			connect(node, &Node::NodeRemovedFromContext, this,
+					&Project::SerializedNodeChanged);
+
+			if (Track *track = dynamic_cast<Track *>(node)) {
+				connect(track, &Track::TrackHeightChanged, this,
+						&Project::SerializedNodeChanged);
+			}
+
+			if (ViewerOutput *viewer = dynamic_cast<ViewerOutput *>(node)) {
+				// Markers and the workarea are saved with the viewer but signal on their own
+				auto changed = [this, node] { InvalidateSerializedNode(node); };
+				connect(viewer->GetMarkers(), &TimelineMarkerList::MarkerAdded,
+						this, changed);
+				connect(viewer->GetMarkers(),
+						&TimelineMarkerList::MarkerRemoved, this, changed);
+				connect(viewer->GetMarkers(),
+						&TimelineMarkerList::MarkerModified, this, changed);
+				connect(viewer->GetWorkArea(),
+						&TimelineWorkArea::EnabledChanged, this, changed);
+				connect(viewer->GetWorkArea(), &TimelineWorkArea::RangeChanged,
+						this, changed);
+			}
+
 			if (NodeGroup *group = dynamic_cast<NodeGroup *>(node)) {
 				connect(group, &NodeGroup::InputPassthroughAdded, this,
 						&Project::GroupAddedInputPassthrough,
@@ -347,6 +452,14 @@ void Project::childEvent(QChildEvent *event)
 				connect(group, &NodeGroup::OutputPassthroughChanged, this,
 						&Project::GroupChangedOutputPassthrough,
 						Qt::DirectConnection);
+
+				// Passthroughs are saved with the group
+				connect(group, &NodeGroup::InputPassthroughAdded, this,
+						&Project::SerializedNodeChanged);
+				connect(group, &NodeGroup::InputPassthroughRemoved, this,
+						&Project::SerializedNodeChanged);
+				connect(group, &NodeGroup::OutputPassthroughChanged, this,
+						&Project::SerializedNodeChanged);
 			}
 
 			emit NodeAdded(node);
@@ -381,6 +494,14 @@ void Project::childEvent(QChildEvent *event)
 			disconnect(node, &Node::InputValueHintChanged, this,
 					   &Project::InputValueHintChanged);
 
+			// Drops the SerializedNodeChanged() connections along with anything else still connected
+			disconnect(node, nullptr, this, nullptr);
+			if (ViewerOutput *viewer = dynamic_cast<ViewerOutput *>(node)) {
+				disconnect(viewer->GetMarkers(), nullptr, this, nullptr);
+				disconnect(viewer->GetWorkArea(), nullptr, this, nullptr);
+			}
+			serialized_nodes_.remove(node);
+
 			if (NodeGroup *group = dynamic_cast<NodeGroup *>(node)) {
 				disconnect(group, &NodeGroup::InputPassthroughAdded, this,
 						   &Project::GroupAddedInputPassthrough);
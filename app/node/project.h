@@ -74,8 +74,21 @@ public:
 	void Initialize();
 
 	SerializedData Load(QXmlStreamReader *reader);
+
+	/**
+   * @brief Write the project as XML
+   *
+   * Every node's element is kept after it's written and reused until the node changes, so saving a
+   * project that's mostly unchanged since the last save only serializes what was edited. Kept elements
+   * are written back through `writer`, so they're formatted like the rest of the document.
+   */
 	void Save(QXmlStreamWriter *writer) const;
 
+	/**
+   * @brief Discard the saved XML of `node`, see Node::InvalidateSerialized()
+   */
+	void InvalidateSerializedNode(Node *node);
+
 	int GetNumberOfContextsNodeIsIn(Node *node,
 									bool except_itself = false) const;
 
@@ -244,6 +257,8 @@ protected:
 	virtual void childEvent(QChildEvent *event) override;
 
 private:
+	void SaveNode(QXmlStreamWriter *writer, Node *node) const;
+
 	QUuid uuid_;
 
 	Folder *root_;
@@ -261,6 +276,12 @@ private:
 	QVector<Node *> node_children_;
 
 	QMap<QString, QString> settings_;
+
+	/// Every node's `<node>` element from the last save, see Save()
+	mutable QHash<Node *, QByteArray> serialized_nodes_;
+
+private slots:
+	void SerializedNodeChanged();
 };
 
 }
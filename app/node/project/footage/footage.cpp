@@ -65,7 +65,7 @@ Footage::Footage(const QString &filename)
 	connect(check_timer, &QTimer::timeout, this, &Footage::CheckFootage);
 	check_timer->start();
 
-	connect(this->waveform_cache(), &AudioWaveformCache::Validated, this,
+	connect(this, &Node::WaveformCacheValidated, this,
 			&ViewerOutput::ConnectedWaveformChanged);
 }
 
@@ -164,6 +164,7 @@ const qint64 &Footage::timestamp() const
 void Footage::set_timestamp(const qint64 &t)
 {
 	timestamp_ = t;
+	InvalidateSerialized();
 }
 
 int Footage::GetStreamIndex(Track::Type type, int index) const
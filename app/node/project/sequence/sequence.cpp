@@ -23,6 +23,7 @@
 
 #include <QThread>
 
+#include "node/block/clip/clip.h"
 #include "panel/timeline/timeline.h"
 #include "ui/icons/icons.h"
 #include "timeline/timelineundogeneral.h"
@@ -187,6 +188,20 @@ void Sequence::InputDisconnectedEvent(const QString &input, int element,
 	super::InputDisconnectedEvent(input, element, output);
 }
 
+void Sequence::CachesRetainedEvent()
+{
+	super::CachesRetainedEvent();
+
+	// Clips don't ask for thumbnails and waveforms while nothing is showing this sequence
+	for (Track *track : GetTracks()) {
+		for (Block *b : track->Blocks()) {
+			if (ClipBlock *clip = dynamic_cast<ClipBlock *>(b)) {
+				clip->RequestInvalidatedFromConnected();
+			}
+		}
+	}
+}
+
 void Sequence::UpdateTrackCache()
 {
 	track_cache_.clear();
@@ -100,6 +100,8 @@ protected:
 
 	virtual rational VerifyLengthInternal(Track::Type type) const override;
 
+	virtual void CachesRetainedEvent() override;
+
 signals:
 	void TrackAdded(Track *track);
 	void TrackRemoved(Track *track);
@@ -0,0 +1,149 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "parallelnodeloader.h"
+
+#include <QThread>
+#include <QXmlStreamWriter>
+#include <QtConcurrent>
+
+#include "node/plugins/Plugin.h"
+
+namespace olive
+{
+
+ParallelNodeLoader::ParallelNodeLoader(QObject *parent, SerializedData *data)
+	: parent_(parent)
+	, data_(data)
+	, pending_bytes_(0)
+{
+}
+
+ParallelNodeLoader::~ParallelNodeLoader()
+{
+	Finish();
+}
+
+void ParallelNodeLoader::Add(Node *node, QXmlStreamReader *reader)
+{
+	Job job;
+	job.node = node;
+	job.loaded = false;
+
+	if (dynamic_cast<plugin::PluginNode *>(node)) {
+		node->Load(reader, &job.data);
+		job.loaded = true;
+	} else {
+		// Copy the element so it can be parsed again on another thread
+		QXmlStreamWriter writer(&job.xml);
+		int depth = 0;
+		do {
+			writer.writeCurrentToken(*reader);
+
+			if (reader->isStartElement()) {
+				depth++;
+			} else if (reader->isEndElement()) {
+				depth--;
+			}
+		} while (depth > 0 && !reader->atEnd() && reader->readNext());
+
+		// Detach the node from this thread so whichever thread loads it can take it, along with any
+		// children (e.g. keyframes) it creates while loading
+		node->moveToThread(nullptr);
+
+		pending_bytes_ += job.xml.size();
+	}
+
+	jobs_.push_back(std::move(job));
+
+	if (pending_bytes_ >= kBatchSize) {
+		Flush();
+	}
+}
+
+void ParallelNodeLoader::Finish()
+{
+	if (!jobs_.empty()) {
+		Flush();
+	}
+}
+
+void ParallelNodeLoader::Flush()
+{
+	QtConcurrent::blockingMap(jobs_, &ParallelNodeLoader::LoadJob);
+
+	for (Job &job : jobs_) {
+		if (!job.loaded) {
+			job.node->moveToThread(QThread::currentThread());
+		}
+
+		job.node->setParent(parent_);
+
+		Merge(data_, job.data);
+	}
+
+	jobs_.clear();
+	pending_bytes_ = 0;
+}
+
+void ParallelNodeLoader::LoadJob(Job &job)
+{
+	if (job.loaded) {
+		return;
+	}
+
+	// Objects without a thread can be pulled into the current one
+	job.node->moveToThread(QThread::currentThread());
+
+	QXmlStreamReader reader(job.xml);
+
+	// Node::Load() expects to be on the node's start element
+	if (reader.readNextStartElement()) {
+		job.node->Load(&reader, &job.data);
+	}
+
+	job.node->moveToThread(nullptr);
+
+	// No need to hold onto this until the whole batch is done
+	job.xml.clear();
+}
+
+void ParallelNodeLoader::Merge(SerializedData *to, const SerializedData &from)
+{
+	for (auto it = from.positions.cbegin(); it != from.positions.cend(); it++) {
+		to->positions.insert(it.key(), it.value());
+	}
+
+	for (auto it = from.node_ptrs.cbegin(); it != from.node_ptrs.cend(); it++) {
+		to->node_ptrs.insert(it.key(), it.value());
+	}
+
+	to->desired_connections.append(from.desired_connections);
+	to->block_links.append(from.block_links);
+	to->group_input_links.append(from.group_input_links);
+
+	for (auto it = from.group_output_links.cbegin();
+		 it != from.group_output_links.cend(); it++) {
+		to->group_output_links.insert(it.key(), it.value());
+	}
+}
+
+}
@@ -0,0 +1,97 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef PARALLELNODELOADER_H
+#define PARALLELNODELOADER_H
+
+#include <QByteArray>
+#include <QXmlStreamReader>
+#include <vector>
+
+#include "node/serializeddata.h"
+
+namespace olive
+{
+
+/**
+ * @brief Loads the nodes of a project on several threads
+ *
+ * Add() is called for each node element while the project is read. It only copies the element,
+ * the node is loaded (inputs, keyframes, caches, probing footage) later in batches on the global
+ * thread pool. Nodes are then added to `parent` and their SerializedData merged into `data` in
+ * the order they were added, so the result is the same as loading them one at a time.
+ *
+ * Plugin nodes are loaded straight away on the calling thread, since OFX plugins may not expect
+ * to be called from several threads at once.
+ */
+class ParallelNodeLoader {
+public:
+	ParallelNodeLoader(QObject *parent, SerializedData *data);
+
+	~ParallelNodeLoader();
+
+	ParallelNodeLoader(const ParallelNodeLoader &) = delete;
+	ParallelNodeLoader &operator=(const ParallelNodeLoader &) = delete;
+
+	/**
+   * @brief Queue `node` to be loaded from the node element `reader` is currently on
+   *
+   * Leaves `reader` on the element's end, like Node::Load() does. The loader takes ownership of
+   * `node` until it's added to the parent.
+   */
+	void Add(Node *node, QXmlStreamReader *reader);
+
+	/**
+   * @brief Load anything that's still queued
+   */
+	void Finish();
+
+	/**
+   * @brief Amount of copied XML to queue before loading it, bounds memory use on large projects
+   */
+	static const int kBatchSize = 4 * 1024 * 1024;
+
+private:
+	struct Job {
+		Node *node;
+		QByteArray xml;
+		SerializedData data;
+		bool loaded;
+	};
+
+	void Flush();
+
+	static void LoadJob(Job &job);
+
+	static void Merge(SerializedData *to, const SerializedData &from);
+
+	QObject *parent_;
+
+	SerializedData *data_;
+
+	std::vector<Job> jobs_;
+
+	int pending_bytes_;
+};
+
+}
+
+#endif // PARALLELNODELOADER_H
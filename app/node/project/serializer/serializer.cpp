@@ -22,8 +22,16 @@
 #include "serializer.h"
 
 #include <QApplication>
+#include <QBuffer>
+#include <QDebug>
 #include <QFile>
+#include <QThread>
 #include <QXmlStreamReader>
+#include <vector>
+
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
 
 #include "common/xmlutils.h"
 #include "core.h"
@@ -60,43 +68,229 @@ void ProjectSerializer::Destroy()
 	instances_.clear();
 }
 
-ProjectSerializer::Result ProjectSerializer::Load(Project *project,
-												  const QString &filename,
-												  LoadType load_type)
+namespace
 {
-	QFile project_file(filename);
 
-	if (project_file.open(QFile::ReadOnly)) {
-		// Some project files are compressed, marked with "OVEC" at the beginning of the file. Check for
-		// that signature now.
-		std::unique_ptr<QXmlStreamReader> reader;
-		if (CheckCompressedID(&project_file)) {
-			// File is compressed, decompress into memory
-			QByteArray b;
-			b = qUncompress(project_file.readAll());
-			reader.reset(new QXmlStreamReader(b));
-		} else {
-			project_file.seek(0);
-			reader.reset(new QXmlStreamReader(&project_file));
+/**
+ * @brief Read-only sequential device that decompresses a project file as it's read
+ *
+ * Reports how far through `source` it is to a progress callback.
+ */
+class ProjectReadDevice : public QIODevice {
+public:
+	ProjectReadDevice(QIODevice *source,
+					  ProjectSerializer::Compression compression,
+					  const ProjectSerializer::ProgressCallback &progress =
+						  ProjectSerializer::ProgressCallback())
+		: source_(source)
+		, compression_(compression)
+		, progress_(progress)
+		, last_progress_(0)
+		, finished_(false)
+		, error_(false)
+	{
+#ifdef USE_ZSTD
+		ctx_ = nullptr;
+		if (compression_ == ProjectSerializer::kCompressedZstd) {
+			ctx_ = ZSTD_createDCtx();
+			error_ = !ctx_;
+			in_buf_.resize(ZSTD_DStreamInSize());
+			in_ = { in_buf_.data(), 0, 0 };
+			last_ret_ = 1;
+			output_full_ = false;
 		}
+#endif
+	}
 
-		Result inner_result = Load(project, reader.get(), load_type);
+	virtual ~ProjectReadDevice() override
+	{
+#ifdef USE_ZSTD
+		ZSTD_freeDCtx(ctx_);
+#endif
+	}
 
-		project_file.close();
+	/**
+   * @brief Returns whether files with this compression can be read by this device
+   */
+	static bool CanStream(ProjectSerializer::Compression compression)
+	{
+#ifdef USE_ZSTD
+		if (compression == ProjectSerializer::kCompressedZstd) {
+			return true;
+		}
+#endif
+		return compression == ProjectSerializer::kUncompressed;
+	}
+
+	bool HasError() const
+	{
+		return error_;
+	}
 
-		if (inner_result.code() != kSuccess) {
-			return inner_result;
+	virtual bool isSequential() const override
+	{
+		return true;
+	}
+
+	virtual bool atEnd() const override
+	{
+		return finished_ && QIODevice::atEnd();
+	}
+
+protected:
+	virtual qint64 readData(char *data, qint64 maxlen) override
+	{
+		if (finished_ || error_) {
+			return error_ ? -1 : 0;
 		}
 
-		if (reader->hasError()) {
-			Result r(kXmlError);
-			r.SetDetails(reader->errorString());
+		qint64 read;
+
+#ifdef USE_ZSTD
+		if (compression_ == ProjectSerializer::kCompressedZstd) {
+			read = ReadZstd(data, maxlen);
+		} else
+#endif
+		{
+			read = source_->read(data, maxlen);
+			if (read <= 0) {
+				finished_ = true;
+				error_ = (read < 0);
+			}
+		}
+
+		ReportProgress();
+
+		return read;
+	}
+
+	virtual qint64 writeData(const char *, qint64) override
+	{
+		return -1;
+	}
+
+private:
+	void ReportProgress()
+	{
+		if (!progress_ || source_->size() <= 0) {
+			return;
+		}
+
+		// Only report whole percentages so the progress bar isn't flooded
+		double p = double(source_->pos()) / double(source_->size());
+		if (finished_ || p - last_progress_ >= 0.01) {
+			last_progress_ = p;
+			progress_(p);
+		}
+	}
+
+#ifdef USE_ZSTD
+	qint64 ReadZstd(char *data, qint64 maxlen)
+	{
+		// Block until there's some output, the XML reader takes 0 to mean the end of the file
+		while (true) {
+			if (in_.pos == in_.size && !output_full_) {
+				qint64 r = source_->read(in_buf_.data(), in_buf_.size());
+				if (r <= 0) {
+					// Anything other than a complete frame means the file was cut short
+					finished_ = true;
+					error_ = (r < 0 || last_ret_ != 0);
+					return error_ ? -1 : 0;
+				}
+				in_ = { in_buf_.data(), size_t(r), 0 };
+			}
+
+			ZSTD_outBuffer o = { data, size_t(maxlen), 0 };
+			last_ret_ = ZSTD_decompressStream(ctx_, &o, &in_);
+			if (ZSTD_isError(last_ret_)) {
+				finished_ = true;
+				error_ = true;
+				return -1;
+			}
+
+			// The decoder may still be holding output it didn't have room for
+			output_full_ = (o.pos == o.size);
+
+			if (o.pos > 0) {
+				return qint64(o.pos);
+			}
+		}
+	}
+
+	ZSTD_DCtx *ctx_;
+	std::vector<char> in_buf_;
+	ZSTD_inBuffer in_;
+	size_t last_ret_;
+	bool output_full_;
+#endif
+
+	QIODevice *source_;
+	ProjectSerializer::Compression compression_;
+	ProjectSerializer::ProgressCallback progress_;
+	double last_progress_;
+	bool finished_;
+	bool error_;
+};
+
+}
+
+ProjectSerializer::Result
+ProjectSerializer::Load(Project *project, const QString &filename,
+						LoadType load_type, const ProgressCallback &progress)
+{
+	QFile project_file(filename);
+
+	if (!project_file.open(QFile::ReadOnly)) {
+		return kFileError;
+	}
+
+	// Some project files are compressed, marked with "OVEC" or "OVEZ" at the beginning of the file.
+	// Check for that signature now.
+	Compression compression = GetCompression(&project_file);
+	if (compression == kUncompressed) {
+		project_file.seek(0);
+	}
+
+	QByteArray b;
+	QBuffer buffer(&b);
+	QIODevice *source = &project_file;
+
+	if (!ProjectReadDevice::CanStream(compression)) {
+		// zlib data can't be decompressed in pieces, so this has to happen up front
+		if (!Decompress(&project_file, compression, &b)) {
+			Result r(kFileError);
+			r.SetDetails(filename);
 			return r;
-		} else {
-			return inner_result;
 		}
+		buffer.open(QBuffer::ReadOnly);
+		source = &buffer;
+		compression = kUncompressed;
+	}
+
+	// Parse as the file is read, only a chunk of it is in memory at any time
+	ProjectReadDevice device(source, compression, progress);
+	device.open(QIODevice::ReadOnly);
+
+	QXmlStreamReader reader(&device);
+
+	Result inner_result = Load(project, &reader, load_type);
+
+	if (device.HasError()) {
+		Result r(kFileError);
+		r.SetDetails(filename);
+		return r;
+	}
+
+	if (inner_result.code() != kSuccess) {
+		return inner_result;
+	}
+
+	if (reader.hasError()) {
+		Result r(kXmlError);
+		r.SetDetails(reader.errorString());
+		return r;
 	} else {
-		return kFileError;
+		return inner_result;
 	}
 }
 
@@ -164,38 +358,111 @@ ProjectSerializer::Result ProjectSerializer::Paste(LoadType load_type,
 ProjectSerializer::Result ProjectSerializer::Save(const SaveData &data,
 												  bool compress)
 {
-	QString temp_save =
-		FileFunctions::GetSafeTemporaryFilename(data.GetFilename());
+	QByteArray b;
+	QXmlStreamWriter writer(&b);
 
-	QFile project_file(temp_save);
+	Result inner_result = Save(&writer, data);
 
-	if (project_file.open(QFile::WriteOnly)) {
-		QByteArray b;
-		QXmlStreamWriter writer(&b);
+	if (writer.hasError()) {
+		Result r(kXmlError);
+		return r;
+	}
 
-		Result inner_result = Save(&writer, data);
+	if (inner_result != kSuccess) {
+		return inner_result;
+	}
 
-		if (writer.hasError()) {
-			Result r(kXmlError);
-			return r;
+	return Write(data.GetFilename(), b,
+				 compress ? kCompressedZlib : kUncompressed);
+}
+
+#ifdef USE_ZSTD
+// Zstandard's default, about as fast as qCompress() on one thread while compressing better
+static const int kZstdCompressionLevel = 3;
+
+static bool WriteZstd(QFile *file, const QByteArray &b)
+{
+	ZSTD_CCtx *ctx = ZSTD_createCCtx();
+	if (!ctx) {
+		return false;
+	}
+
+	ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel,
+						   kZstdCompressionLevel);
+
+	// Fails harmlessly if libzstd was built without threading, it'll compress on this thread instead
+	ZSTD_CCtx_setParameter(ctx, ZSTD_c_nbWorkers, QThread::idealThreadCount());
+
+	ZSTD_CCtx_setPledgedSrcSize(ctx, b.size());
+
+	// Write each compressed block as soon as it's ready rather than building the whole file in memory
+	std::vector<char> out(ZSTD_CStreamOutSize());
+	ZSTD_inBuffer in = { b.constData(), size_t(b.size()), 0 };
+	bool ok = true;
+	size_t remaining;
+
+	do {
+		ZSTD_outBuffer o = { out.data(), out.size(), 0 };
+		remaining = ZSTD_compressStream2(ctx, &o, &in, ZSTD_e_end);
+		if (ZSTD_isError(remaining) ||
+			file->write(out.data(), o.pos) != qint64(o.pos)) {
+			ok = false;
+			break;
 		}
+	} while (remaining);
 
-		if (compress) {
-			project_file.write("OVEC");
-			project_file.write(qCompress(b));
-		} else {
-			project_file.write(b);
+	ZSTD_freeCCtx(ctx);
+
+	return ok;
+}
+#endif
+
+ProjectSerializer::Result ProjectSerializer::Write(const QString &filename,
+												   const QByteArray &xml,
+												   Compression compression)
+{
+	if (!IsCompressionSupported(compression)) {
+		qWarning() << "Compression" << compression
+				   << "isn't supported by this build, falling back to zlib";
+		compression = kCompressedZlib;
+	}
+
+	QString temp_save = FileFunctions::GetSafeTemporaryFilename(filename);
+
+	QFile project_file(temp_save);
+
+	if (project_file.open(QFile::WriteOnly)) {
+		bool written = false;
+
+		switch (compression) {
+		case kUncompressed:
+			written = project_file.write(xml) == xml.size();
+			break;
+		case kCompressedZlib: {
+			QByteArray compressed = qCompress(xml);
+			written = project_file.write("OVEC") == 4 &&
+					  project_file.write(compressed) == compressed.size();
+			break;
+		}
+		case kCompressedZstd:
+#ifdef USE_ZSTD
+			written = project_file.write("OVEZ") == 4 &&
+					  WriteZstd(&project_file, xml);
+#endif
+			break;
 		}
 
 		project_file.close();
 
-		if (inner_result != kSuccess) {
-			return inner_result;
+		if (!written) {
+			QFile::remove(temp_save);
+			Result r(kFileError);
+			r.SetDetails(temp_save);
+			return r;
 		}
 
 		// Save was successful, we can now rewrite the original file
-		if (FileFunctions::RenameFileAllowOverwrite(temp_save,
-													data.GetFilename())) {
+		if (FileFunctions::RenameFileAllowOverwrite(temp_save, filename)) {
 			return kSuccess;
 		} else {
 			Result r(kOverwriteError);
@@ -258,10 +525,54 @@ ProjectSerializer::Result ProjectSerializer::Copy(const SaveData &data)
 	return res;
 }
 
-bool ProjectSerializer::CheckCompressedID(QFile *file)
+bool ProjectSerializer::IsCompressionSupported(Compression compression)
+{
+#ifdef USE_ZSTD
+	Q_UNUSED(compression)
+	return true;
+#else
+	return compression != kCompressedZstd;
+#endif
+}
+
+ProjectSerializer::Compression ProjectSerializer::GetCompression(QFile *file)
 {
 	QByteArray b = file->read(4);
-	return !memcmp(b.data(), "OVEC", 4);
+
+	if (b == QByteArrayLiteral("OVEC")) {
+		return kCompressedZlib;
+	} else if (b == QByteArrayLiteral("OVEZ")) {
+		return kCompressedZstd;
+	}
+
+	return kUncompressed;
+}
+
+bool ProjectSerializer::Decompress(QFile *file, Compression compression,
+								   QByteArray *out)
+{
+	switch (compression) {
+	case kUncompressed:
+		*out = file->readAll();
+		return true;
+	case kCompressedZlib:
+		*out = qUncompress(file->readAll());
+		return !out->isEmpty();
+	case kCompressedZstd: {
+#ifdef USE_ZSTD
+		ProjectReadDevice device(file, compression);
+		device.open(QIODevice::ReadOnly);
+		*out = device.readAll();
+		return !device.HasError();
+#else
+		qWarning() << "Project is compressed with Zstandard, which this build "
+					  "doesn't support";
+		return false;
+#endif
+	}
+	}
+
+	return false;
 }
 
 bool ProjectSerializer::IsCancelled() const
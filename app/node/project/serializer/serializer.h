@@ -22,6 +22,7 @@
 #ifndef PROJECTSERIALIZER_H
 #define PROJECTSERIALIZER_H
 
+#include <functional>
 #include <vector>
 
 #include "common/define.h"
@@ -84,6 +85,9 @@ public:
 		QVector<Node *> nodes;
 
 		Node::OutputConnections promised_connections;
+
+		/// How long each phase of loading took in milliseconds, in the order they ran
+		QVector<QPair<QString, qint64>> timings;
 	};
 
 	class Result {
@@ -236,8 +240,20 @@ public:
 
 	static void Destroy();
 
+	/**
+   * @brief Called with how much of a project file has been read, from 0.0 to 1.0
+   */
+	using ProgressCallback = std::function<void(double)>;
+
+	/**
+   * @brief Load a project file
+   *
+   * Zstandard compressed and uncompressed files are parsed as they're read rather than read into
+   * memory first.
+   */
 	static Result Load(Project *project, const QString &filename,
-					   LoadType load_type);
+					   LoadType load_type,
+					   const ProgressCallback &progress = ProgressCallback());
 	static Result Load(Project *project, QXmlStreamReader *read_device,
 					   LoadType load_type);
 	static Result Paste(LoadType load_type, Project *project = nullptr);
@@ -246,7 +262,49 @@ public:
 	static Result Save(QXmlStreamWriter *write_device, const SaveData &data);
 	static Result Copy(const SaveData &data);
 
-	static bool CheckCompressedID(QFile *file);
+	enum Compression {
+		/// Plain XML
+		kUncompressed,
+
+		/// "OVEC" followed by qCompress() data
+		kCompressedZlib,
+
+		/// "OVEZ" followed by a Zstandard frame, only readable by builds with Zstandard
+		kCompressedZstd
+	};
+
+	/**
+   * @brief Write already serialized project XML to `filename` with `compression`
+   *
+   * Doesn't touch any project, so it's safe to call from any thread. The file is written to a
+   * temporary file first and only replaces `filename` once it's complete. If this build can't
+   * write `compression`, the file is written with kCompressedZlib instead.
+   */
+	static Result Write(const QString &filename, const QByteArray &xml,
+						Compression compression);
+
+	/**
+   * @brief Whether this build can read and write files with `compression`
+   */
+	static bool IsCompressionSupported(Compression compression);
+
+	/**
+   * @brief Determine how a project file is compressed from its signature
+   *
+   * If the file is compressed, it's left positioned just after the signature.
+   */
+	static Compression GetCompression(QFile *file);
+
+	static bool CheckCompressedID(QFile *file)
+	{
+		return GetCompression(file) != kUncompressed;
+	}
+
+	/**
+   * @brief Decompress the rest of `file`, which GetCompression() has been called on
+   */
+	static bool Decompress(QFile *file, Compression compression,
+						   QByteArray *out);
 
 protected:
 	virtual LoadData Load(Project *project, QXmlStreamReader *reader,
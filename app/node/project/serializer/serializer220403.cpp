@@ -507,16 +507,20 @@ void ProjectSerializer220403::LoadNode(Node *node, XMLNodeData &xml_node_data,
 		} else if (reader->name() == QStringLiteral("caches")) {
 			while (XMLReadNextStartElement(reader)) {
 				if (reader->name() == QStringLiteral("audio")) {
-					node->audio_playback_cache()->SetUuid(
+					node->SetCacheUuid(
+						Node::kAudioCache,
 						QUuid::fromString(reader->readElementText()));
 				} else if (reader->name() == QStringLiteral("video")) {
-					node->video_frame_cache()->SetUuid(
+					node->SetCacheUuid(
+						Node::kVideoCache,
 						QUuid::fromString(reader->readElementText()));
 				} else if (reader->name() == QStringLiteral("thumb")) {
-					node->thumbnail_cache()->SetUuid(
+					node->SetCacheUuid(
+						Node::kThumbnailCache,
 						QUuid::fromString(reader->readElementText()));
 				} else if (reader->name() == QStringLiteral("waveform")) {
-					node->waveform_cache()->SetUuid(
+					node->SetCacheUuid(
+						Node::kWaveformCache,
 						QUuid::fromString(reader->readElementText()));
 				} else {
 					reader->skipCurrentElement();
@@ -44,9 +44,14 @@ ProjectSerializer230220::Load(Project *project, QXmlStreamReader *reader,
 	switch (load_type) {
 	case kProject: {
 		if (reader->name() == QStringLiteral("project")) {
+			QElapsedTimer timer;
+
 			while (XMLReadNextStartElement(reader)) {
 				if (reader->name() == QStringLiteral("project")) {
+					timer.start();
 					project_data = project->Load(reader);
+					load_data.timings.append(
+						{ QStringLiteral("nodes"), timer.elapsed() });
 				} else if (reader->name() == QStringLiteral("layout")) {
 					load_data.layout = MainWindowLayoutInfo::fromXml(
 						reader, project_data.node_ptrs);
@@ -55,7 +60,10 @@ ProjectSerializer230220::Load(Project *project, QXmlStreamReader *reader,
 				}
 			}
 
+			timer.start();
 			PostConnect(project->nodes(), &project_data);
+			load_data.timings.append(
+				{ QStringLiteral("connections"), timer.elapsed() });
 		} else {
 			reader->skipCurrentElement();
 		}
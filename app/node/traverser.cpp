@@ -21,6 +21,8 @@
 
 #include "traverser.h"
 
+#include <algorithm>
+
 #include "node.h"
 #include "node/block/clip/clip.h"
 #include "render/job/footagejob.h"
@@ -140,7 +142,9 @@ NodeValue NodeTraverser::GenerateRowValueElement(const Node *node,
 
 	NodeValue value = table->TakeAt(value_index);
 
-	if (value.type() == NodeValue::kTexture && UseCache()) {
+	// Caches can't be created on render threads, see ProjectCopier::DoNodeAdd()
+	if (value.type() == NodeValue::kTexture && UseCache() &&
+		node->HasCaches()) {
 		if (TexturePtr tex = value.toTexture()) {
 			QMutexLocker locker(node->video_frame_cache()->mutex());
 
@@ -405,6 +409,11 @@ void NodeTraverser::ResolveJobs(NodeValue &val)
 			if (AcceleratedJob *base_job = job_tex->job()) {
 				if (resolved_texture_cache_.contains(job_tex.get())) {
 					val.set_value(resolved_texture_cache_.value(job_tex.get()));
+				} else if (UseShaderFusion() &&
+						   dynamic_cast<ShaderJob *>(base_job) &&
+						   ResolveFusedShader(val)) {
+					resolved_texture_cache_.insert(job_tex.get(),
+												   val.toTexture());
 				} else {
 					// Resolve any sub-jobs
 					for (auto it = base_job->GetValues().begin();
@@ -532,6 +541,93 @@ void NodeTraverser::ResolveJobs(NodeValue &val)
 	}
 }
 
+bool NodeTraverser::ResolveFusedShader(NodeValue &val)
+{
+	TexturePtr job_tex = val.toTexture();
+	ShaderJob *last_job = static_cast<ShaderJob *>(job_tex->job());
+
+	if (!ShaderFusion::CanFuse(val.source(), last_job)) {
+		return false;
+	}
+
+	// Walk upstream for as long as each shader reads the one before it at the same resolution. Stages are
+	// collected last to first.
+	QVector<ShaderFusion::Stage> stages;
+	stages.append({ val.source(), last_job, QString() });
+
+	TexturePtr stage_tex = job_tex;
+
+	while (stages.size() < ShaderFusion::kMaximumStages) {
+		ShaderFusion::Stage &stage = stages.last();
+		ShaderFusion::Analysis analysis =
+			ShaderFusion::Analyze(stage.node, stage.job);
+
+		ShaderFusion::Stage upstream;
+		TexturePtr upstream_tex;
+
+		for (const QString &input : analysis.chainable_inputs) {
+			NodeValue in_val = stage.job->Get(input);
+			if (in_val.type() != NodeValue::kTexture) {
+				continue;
+			}
+
+			TexturePtr in_tex = in_val.toTexture();
+			ShaderJob *in_job =
+				in_tex ? dynamic_cast<ShaderJob *>(in_tex->job()) : nullptr;
+
+			if (in_job && !resolved_texture_cache_.contains(in_tex.get()) &&
+				in_tex->params().effective_width() ==
+					stage_tex->params().effective_width() &&
+				in_tex->params().effective_height() ==
+					stage_tex->params().effective_height() &&
+				in_tex->params().channel_count() ==
+					stage_tex->params().channel_count() &&
+				ShaderFusion::CanFuse(in_val.source(), in_job)) {
+				upstream = { in_val.source(), in_job, QString() };
+				upstream_tex = in_tex;
+				stage.input = input;
+				break;
+			}
+		}
+
+		if (!upstream_tex) {
+			break;
+		}
+
+		stages.append(upstream);
+		stage_tex = upstream_tex;
+	}
+
+	if (stages.size() < 2) {
+		return false;
+	}
+
+	std::reverse(stages.begin(), stages.end());
+
+	// Resolve everything the stages read except the textures computed in the fused shader
+	for (const ShaderFusion::Stage &stage : stages) {
+		for (auto it = stage.job->GetValues().begin();
+			 it != stage.job->GetValues().end(); it++) {
+			if (it.key() != stage.input) {
+				ResolveJobs(it.value());
+			}
+		}
+	}
+
+	ShaderJob fused = ShaderFusion::CreateJob(stages);
+
+	TexturePtr tex = CreateTexture(job_tex->params());
+
+	if (!ProcessFusedShader(tex, stages, &fused)) {
+		// Stages get rendered one by one, their chained inputs are still unresolved
+		return false;
+	}
+
+	val.set_value(tex);
+
+	return true;
+}
+
 TexturePtr NodeTraverser::CreateDummyTexture(const VideoParams &p)
 {
 	return std::make_shared<Texture>(p);
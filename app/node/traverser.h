@@ -34,6 +34,7 @@
 #include "render/job/footagejob.h"
 #include "value.h"
 #include "render/job/pluginjob.h"
+#include "render/shaderfusion.h"
 
 namespace olive
 {
@@ -111,6 +112,18 @@ protected:
 	{
 	}
 
+	/**
+   * @brief Render `stages` in one pass using `job` from ShaderFusion::CreateJob()
+   *
+   * Returns false if the fused shader couldn't be used, in which case the stages are rendered separately.
+   */
+	virtual bool ProcessFusedShader(TexturePtr destination,
+									const QVector<ShaderFusion::Stage> &stages,
+									const ShaderJob *job)
+	{
+		return false;
+	}
+
 	virtual void ProcessColorTransform(TexturePtr destination, const Node *node,
 									   const ColorTransformJob *job)
 	{
@@ -197,9 +210,19 @@ protected:
 		return false;
 	}
 
+	/**
+   * @brief Whether chains of simple shaders should be rendered in one pass with ProcessFusedShader()
+   */
+	virtual bool UseShaderFusion() const
+	{
+		return false;
+	}
+
 private:
 	TexturePtr CreateDummyTexture(const VideoParams &p);
 
+	bool ResolveFusedShader(NodeValue &val);
+
 	VideoParams video_params_;
 
 	AudioParams audio_params_;
@@ -32,6 +32,8 @@
 #include <cmath>
 #include <cstring>
 #include <memory>
+#include <QDebug>
+#include <QThread>
 #ifdef OFX_SUPPORTS_OPENGLRENDER
 #include <QOpenGLFunctions>
 #endif
@@ -117,8 +119,61 @@ static bool PackedDstInfo(AVPixelFormat fmt, int *channels,
 	}
 }
 
+static bool RectIsEmpty(const OfxRectI &r)
+{
+	return r.x2 <= r.x1 || r.y2 <= r.y1;
+}
+
+static OfxRectI RectIntersect(const OfxRectI &a, const OfxRectI &b)
+{
+	return { std::max(a.x1, b.x1), std::max(a.y1, b.y1), std::min(a.x2, b.x2),
+			 std::min(a.y2, b.y2) };
+}
+
+static OfxRectI RectUnion(const OfxRectI &a, const OfxRectI &b)
+{
+	if (RectIsEmpty(a)) {
+		return b;
+	}
+	if (RectIsEmpty(b)) {
+		return a;
+	}
+	return { std::min(a.x1, b.x1), std::min(a.y1, b.y1), std::max(a.x2, b.x2),
+			 std::max(a.y2, b.y2) };
+}
+
+static bool RectContains(const OfxRectI &outer, const OfxRectI &inner)
+{
+	return inner.x1 >= outer.x1 && inner.y1 >= outer.y1 &&
+		   inner.x2 <= outer.x2 && inner.y2 <= outer.y2;
+}
+
+// Reuse `slot` if it already has the right size and format, otherwise allocate a new frame into it
+static olive::AVFramePtr PooledFrame(olive::AVFramePtr &slot, AVPixelFormat fmt,
+									 int width, int height)
+{
+	if (slot && slot->format == fmt && slot->width == width &&
+		slot->height == height && slot->data[0] && slot.use_count() == 1) {
+		return slot;
+	}
+
+	olive::AVFramePtr frame = olive::CreateAVFramePtr();
+	frame->format = fmt;
+	frame->width = width;
+	frame->height = height;
+	if (av_frame_get_buffer(frame.get(), 0) < 0) {
+		return nullptr;
+	}
+
+	slot = frame;
+	return frame;
+}
+
 static olive::AVFramePtr ReadbackTextureToFrame(olive::TexturePtr texture,
-												const olive::VideoParams &params)
+												const olive::VideoParams &params,
+												olive::AVFramePtr &readback_pool,
+												olive::AVFramePtr &rgba_pool,
+												SwsContext **sws_ctx)
 {
 	if (!texture || texture->IsDummy() || !texture->renderer()) {
 		return nullptr;
@@ -137,11 +192,9 @@ static olive::AVFramePtr ReadbackTextureToFrame(olive::TexturePtr texture,
 	}
 
 	if (!(desc->flags & AV_PIX_FMT_FLAG_PLANAR)) {
-		olive::AVFramePtr frame = olive::CreateAVFramePtr();
-		frame->format = pix_fmt;
-		frame->width = params.width();
-		frame->height = params.height();
-		if (av_frame_get_buffer(frame.get(), 0) < 0) {
+		olive::AVFramePtr frame = PooledFrame(readback_pool, pix_fmt,
+											  params.width(), params.height());
+		if (!frame) {
 			return nullptr;
 		}
 		const int linesize_pixels = BytesToPixels(frame->linesize[0], params);
@@ -155,11 +208,9 @@ static olive::AVFramePtr ReadbackTextureToFrame(olive::TexturePtr texture,
 		params.width(), params.height(), olive::core::PixelFormat::U8, 4,
 		params.pixel_aspect_ratio(), params.interlacing(), params.divider());
 
-	olive::AVFramePtr rgba_frame = olive::CreateAVFramePtr();
-	rgba_frame->format = AV_PIX_FMT_RGBA;
-	rgba_frame->width = params.width();
-	rgba_frame->height = params.height();
-	if (av_frame_get_buffer(rgba_frame.get(), 0) < 0) {
+	olive::AVFramePtr rgba_frame = PooledFrame(rgba_pool, AV_PIX_FMT_RGBA,
+											   params.width(), params.height());
+	if (!rgba_frame) {
 		return nullptr;
 	}
 
@@ -169,31 +220,29 @@ static olive::AVFramePtr ReadbackTextureToFrame(olive::TexturePtr texture,
 											 rgba_frame->data[0],
 											 linesize_pixels);
 
-	olive::AVFramePtr dst = olive::CreateAVFramePtr();
-	dst->format = pix_fmt;
-	dst->width = params.width();
-	dst->height = params.height();
-	if (av_frame_get_buffer(dst.get(), 0) < 0) {
+	olive::AVFramePtr dst = PooledFrame(readback_pool, pix_fmt, params.width(),
+										params.height());
+	if (!dst) {
 		return rgba_frame;
 	}
 
-	SwsContext *sws_ctx = sws_getContext(
-		rgba_frame->width, rgba_frame->height,
+	*sws_ctx = sws_getCachedContext(
+		*sws_ctx, rgba_frame->width, rgba_frame->height,
 		static_cast<AVPixelFormat>(rgba_frame->format),
 		dst->width, dst->height, pix_fmt, SWS_POINT,
 		nullptr, nullptr, nullptr);
-	if (!sws_ctx) {
+	if (!*sws_ctx) {
 		return rgba_frame;
 	}
 
-	sws_scale(sws_ctx, rgba_frame->data, rgba_frame->linesize, 0,
+	sws_scale(*sws_ctx, rgba_frame->data, rgba_frame->linesize, 0,
 			  rgba_frame->height, dst->data, dst->linesize);
-	sws_freeContext(sws_ctx);
 	return dst;
 }
 
 static olive::AVFramePtr ConvertPackedFloatFrame(olive::AVFramePtr src,
-												 AVPixelFormat dst_fmt)
+												 AVPixelFormat dst_fmt,
+												 olive::AVFramePtr &pool)
 {
 	if (!src || !src->data[0]) {
 		return nullptr;
@@ -210,11 +259,8 @@ static olive::AVFramePtr ConvertPackedFloatFrame(olive::AVFramePtr src,
 		return nullptr;
 	}
 
-	olive::AVFramePtr dst = olive::CreateAVFramePtr();
-	dst->format = dst_fmt;
-	dst->width = src->width;
-	dst->height = src->height;
-	if (av_frame_get_buffer(dst.get(), 0) < 0) {
+	olive::AVFramePtr dst = PooledFrame(pool, dst_fmt, src->width, src->height);
+	if (!dst) {
 		return nullptr;
 	}
 
@@ -369,11 +415,9 @@ bool olive::plugin::OliveClipInstance::getConnected() const
 			return false;
 		return true;
 	}
-#ifdef OFX_SUPPORTS_OPENGLRENDER
-	if (!input_textures_.isEmpty()) {
+	if (!inputs_.isEmpty()) {
 		return true;
 	}
-#endif
 	if(images_.empty())
 		return false;
 	return true;
@@ -395,20 +439,17 @@ OFX::Host::ImageEffect::Image *
 olive::plugin::OliveClipInstance::getImage(OfxTime time,
 										   const OfxRectD *optionalBounds)
 {
-	OfxRectD rod_d = getRegionOfDefinition(time);
-	OfxRectI rod = { static_cast<int>(std::floor(rod_d.x1)),
-					 static_cast<int>(std::floor(rod_d.y1)),
-					 static_cast<int>(std::ceil(rod_d.x2)),
-					 static_cast<int>(std::ceil(rod_d.y2)) };
-	(void)optionalBounds;
-	// Always return full-frame images to keep input data consistent.
-	OfxRectI bounds = rod;
+	OfxRectI rod = getPixelRegionOfDefinition(time);
 
 	if (name_ == "Output") {
+		// Always return full-frame output images, the render window covers the whole frame
+		OfxRectI bounds = rod;
+
 		if (!images_.contains(time)) {
 			// make a new ref counted image
 			images_.insert(time, new Image(*const_cast<OliveClipInstance *>(this),
 											 params_, bounds, rod, true));
+			TrimCache(time);
 		}
 
 		// add another reference to the member image for this fetch
@@ -418,15 +459,17 @@ olive::plugin::OliveClipInstance::getImage(OfxTime time,
 		images_[time]->addReference();
 
 		images_[time]->EnsureAllocatedFromParams(params_, bounds, rod, true);
+		SetImageRenderScale(images_[time]);
 
 		// return it
 		return images_[time];
 	} else {
-		if (images_.contains(time)) {
-			Image* image = images_.value(time);
-			image->EnsureAllocatedFromParams(params_, bounds, rod, false);
-			image->addReference();
-			return image;
+		if (inputs_.contains(time)) {
+			// First fetch of this frame is when it's actually downloaded
+			if (Image *image = MaterializeInputImage(time, optionalBounds)) {
+				image->addReference();
+				return image;
+			}
 		}
 
 		// Fetch on demand for the input clip.
@@ -435,7 +478,8 @@ olive::plugin::OliveClipInstance::getImage(OfxTime time,
 		//
 		// You should do somewhat more sophisticated image management
 		// than this.
-		Image *image = new Image(*this, params_, bounds, rod, true);
+		Image *image = new Image(*this, params_, rod, rod, true);
+		SetImageRenderScale(image);
 		return image;
 	}
 }
@@ -447,15 +491,13 @@ olive::plugin::OliveClipInstance::getOutputImage(OfxTime time)
 		return images_.value(time);
 	}
 
-	OfxRectD rod_d = getRegionOfDefinition(time);
-	OfxRectI rod = { static_cast<int>(std::floor(rod_d.x1)),
-					 static_cast<int>(std::floor(rod_d.y1)),
-					 static_cast<int>(std::ceil(rod_d.x2)),
-					 static_cast<int>(std::ceil(rod_d.y2)) };
+	OfxRectI rod = getPixelRegionOfDefinition(time);
 	OfxRectI bounds = rod;
 
 	auto image = new Image(*this, params_, bounds, rod, true);
+	SetImageRenderScale(image);
 	images_.insert(time, image);
+	TrimCache(time);
 	return image;
 }
 OfxRectD
@@ -466,10 +508,59 @@ olive::plugin::OliveClipInstance::getRegionOfDefinition(OfxTime time) const
 	}
 	OfxRectD regionOfDefinition;
 	regionOfDefinition.x1 = regionOfDefinition.y1 = 0;
-	regionOfDefinition.x2 = params_.width();
+	regionOfDefinition.x2 = params_.width() * getAspectRatio();
 	regionOfDefinition.y2 = params_.height();
 	return regionOfDefinition;
 }
+
+OfxRectI
+olive::plugin::OliveClipInstance::getPixelRegionOfDefinition(OfxTime time) const
+{
+	return CanonicalToPixel(getRegionOfDefinition(time));
+}
+
+OfxRectI
+olive::plugin::OliveClipInstance::CanonicalToPixel(const OfxRectD &rect) const
+{
+	double par = getAspectRatio();
+	if (par <= 0.0) {
+		par = 1.0;
+	}
+
+	// Tolerance so e.g. 1920 * PAR / PAR doesn't round out to 1921
+	const double e = 1e-6;
+	const double sx = render_scale_.x / par;
+	const double sy = render_scale_.y;
+	return { static_cast<int>(std::floor(rect.x1 * sx + e)),
+			 static_cast<int>(std::floor(rect.y1 * sy + e)),
+			 static_cast<int>(std::ceil(rect.x2 * sx - e)),
+			 static_cast<int>(std::ceil(rect.y2 * sy - e)) };
+}
+
+void olive::plugin::OliveClipInstance::SetImageRenderScale(Image *image) const
+{
+	image->setDoubleProperty(kOfxImageEffectPropRenderScale, render_scale_.x, 0);
+	image->setDoubleProperty(kOfxImageEffectPropRenderScale, render_scale_.y, 1);
+}
+
+void olive::plugin::OliveClipInstance::setRegionOfInterest(
+	OfxRectD regionOfInterest, OfxTime time)
+{
+	regionsOfInterest_[time] = regionOfInterest;
+	TrimCache(time);
+}
+
+void olive::plugin::OliveClipInstance::setRenderScale(OfxPointD scale)
+{
+	if (scale.x == render_scale_.x && scale.y == render_scale_.y) {
+		return;
+	}
+
+	render_scale_ = scale;
+
+	// Cached images are the wrong size now
+	ready_images_.clear();
+}
 void olive::plugin::OliveClipInstance::setRegionOfDefinition(
 	OfxRectD regionOfDefinition, OfxTime time)
 {
@@ -481,109 +572,238 @@ void olive::plugin::OliveClipInstance::setDefaultRegionOfDefinition(
 {
 	defaultRegionOfDefinitions_ = regionOfDefinition;
 }
-void olive::plugin::OliveClipInstance::setInputTexture(TexturePtr texture, OfxTime time){
+olive::plugin::OliveClipInstance::~OliveClipInstance()
+{
+	for (Image *image : images_) {
+		image->releaseReference();
+	}
+
+	sws_freeContext(readback_sws_ctx_);
+	sws_freeContext(convert_sws_ctx_);
+}
+
+void olive::plugin::OliveClipInstance::setInputTexture(TexturePtr texture,
+													   OfxTime time)
+{
 	if (!texture) {
 		return;
 	}
-	VideoParams incoming = texture->params();
-	
-	this->params_ = incoming;
-#ifdef OFX_SUPPORTS_OPENGLRENDER
-	input_textures_.insert(time, texture);
-#endif
 
-	AVFramePtr frame = texture->frame();
-	if (!frame || !frame->data[0]) {
-		frame = ReadbackTextureToFrame(texture, params_);
+	setInputTexture(texture, time, texture->params());
+}
+
+void olive::plugin::OliveClipInstance::setInputTexture(
+	TexturePtr texture, OfxTime time, const VideoParams &image_params)
+{
+	if (!texture) {
+		return;
 	}
-	AVPixelFormat expected_fmt =
-		FFmpegUtils::GetFFmpegPixelFormat(params_.format(),
-										  params_.channel_count());
-	if (expected_fmt == AV_PIX_FMT_NONE) {
+
+	this->params_ = texture->params();
+	render_thread_ = QThread::currentThread();
+
+	inputs_.insert(time, { texture, image_params, nullptr });
+	ready_images_.remove(time);
+	TrimCache(time);
+}
+
+void olive::plugin::OliveClipInstance::ReadbackInputTexture(OfxTime time)
+{
+	auto it = inputs_.find(time);
+	if (it == inputs_.end() || !it->texture) {
 		return;
 	}
-	OfxRectI bounds = { 0, 0, params_.width(), params_.height() };
-	OfxRectD rod_d = getRegionOfDefinition(time);
-	OfxRectI regionOfDefinition = { static_cast<int>(std::floor(rod_d.x1)),
-									static_cast<int>(std::floor(rod_d.y1)),
-									static_cast<int>(std::ceil(rod_d.x2)),
-									static_cast<int>(std::ceil(rod_d.y2)) };
 
-	Image* image;
-	if (images_.contains(time)) {
-		image = images_.value(time);
-		image->EnsureAllocatedFromParams(params_, bounds, regionOfDefinition,
-										 false);
+	AVFramePtr frame = it->texture->frame();
+	if (frame && frame->data[0]) {
+		return;
+	}
+
+	// A fresh frame each time, so an image that was read back for another time isn't overwritten
+	AVFramePtr readback_pool;
+	AVFramePtr rgba_pool;
+	it->frame = ReadbackTextureToFrame(it->texture, it->texture->params(),
+									   readback_pool, rgba_pool,
+									   &readback_sws_ctx_);
+}
+
+olive::plugin::Image *
+olive::plugin::OliveClipInstance::MaterializeInputImage(
+	OfxTime time, const OfxRectD *optionalBounds)
+{
+	const Input input = inputs_.value(time);
+	const VideoParams &image_params = input.image_params;
+
+	AVPixelFormat expected_fmt = FFmpegUtils::GetFFmpegPixelFormat(
+		image_params.format(), image_params.channel_count());
+	if (expected_fmt == AV_PIX_FMT_NONE) {
+		return nullptr;
+	}
+
+	// The whole frame at the render scale, which is what the texture gets converted to
+	const OfxRectI regionOfDefinition = getPixelRegionOfDefinition(time);
+	const int frame_width = regionOfDefinition.x2 - regionOfDefinition.x1;
+	const int frame_height = regionOfDefinition.y2 - regionOfDefinition.y1;
+	if (frame_width <= 0 || frame_height <= 0) {
+		return nullptr;
+	}
+
+	// Only the region the plugin asked for in getRegionsOfInterest (or when fetching) goes into the image
+	OfxRectI bounds = regionOfDefinition;
+	if (regionsOfInterest_.contains(time)) {
+		bounds = RectIntersect(CanonicalToPixel(regionsOfInterest_.value(time)),
+							   regionOfDefinition);
+	}
+	if (optionalBounds) {
+		bounds = RectUnion(bounds,
+						   RectIntersect(CanonicalToPixel(*optionalBounds),
+										 regionOfDefinition));
+	}
+	if (RectIsEmpty(bounds)) {
+		bounds = regionOfDefinition;
+	}
+
+	Image *image = images_.value(time);
+	if (image && ready_images_.contains(time)) {
+		OfxRectI image_bounds;
+		image->getIntPropertyN(kOfxImagePropBounds, &image_bounds.x1, 4);
+		if (RectContains(image_bounds, bounds)) {
+			return image;
+		}
+
+		// The plugin may still be using the smaller image, so make a new one rather than reallocating it
+		bounds = RectUnion(bounds, image_bounds);
+		images_.remove(time);
+		ready_images_.remove(time);
+		image->releaseReference();
+		image = nullptr;
+	}
+
+	if (image) {
+		image->EnsureAllocatedFromParams(image_params, bounds,
+										 regionOfDefinition, false);
 	} else {
-		image = new Image(*this, params_, bounds,
-										regionOfDefinition, false);
+		image = new Image(*this, image_params, bounds, regionOfDefinition,
+						  false);
 		images_.insert(time, image);
 	}
+	SetImageRenderScale(image);
 
 	uint8_t *dst = (uint8_t*)image->data();
 	if (!dst) {
-		return;
+		return image;
+	}
+
+	// Textures that came from the CPU still have their frame, only read back the ones that didn't. That needs
+	// the render thread's GL context, plugin threads can only use what ReadbackInputTexture() downloaded.
+	const VideoParams &texture_params = input.texture->params();
+	AVFramePtr frame = input.frame;
+	if (!frame || !frame->data[0]) {
+		frame = input.texture->frame();
+	}
+	if (!frame || !frame->data[0]) {
+		if (QThread::currentThread() == render_thread_) {
+			frame = ReadbackTextureToFrame(input.texture, texture_params,
+										   readback_frame_, rgba_frame_,
+										   &readback_sws_ctx_);
+		} else {
+			qWarning() << "OFX input image fetched outside the render thread before it was read back";
+		}
 	}
 
 	if (!frame || !frame->data[0]) {
 		std::memset(dst, 0, image->row_bytes() * image->height());
-		return;
+		ready_images_.insert(time);
+		return image;
 	}
 
 	AVFramePtr src_frame = frame;
-	if (frame->format != expected_fmt ||
-		frame->width != params_.width() ||
-		frame->height != params_.height()) {
-		if (PackedFloatChannels(static_cast<AVPixelFormat>(frame->format)) > 0) {
-			AVFramePtr converted =
-				ConvertPackedFloatFrame(frame, expected_fmt);
-			if (converted) {
-				src_frame = converted;
-				goto copy_pixels;
-			}
-		}
-		AVFramePtr converted = CreateAVFramePtr();
-		converted->format = expected_fmt;
-		converted->width = params_.width();
-		converted->height = params_.height();
-		if (av_frame_get_buffer(converted.get(), 0) < 0) {
-			return;
+	if (frame->format != expected_fmt || frame->width != frame_width ||
+		frame->height != frame_height) {
+		AVFramePtr converted;
+
+		if (PackedFloatChannels(static_cast<AVPixelFormat>(frame->format)) > 0 &&
+			frame->width == frame_width && frame->height == frame_height) {
+			converted = ConvertPackedFloatFrame(frame, expected_fmt,
+												convert_frame_);
 		}
 
-		SwsContext *sws_ctx = sws_getContext(
-			frame->width, frame->height,
-			static_cast<AVPixelFormat>(frame->format),
-			converted->width, converted->height,
-			static_cast<AVPixelFormat>(converted->format),
-			SWS_POINT, nullptr, nullptr, nullptr);
-		if (!sws_ctx) {
-			return;
-		}
+		if (!converted) {
+			converted = PooledFrame(convert_frame_, expected_fmt, frame_width,
+									frame_height);
+			if (!converted) {
+				return image;
+			}
+
+			convert_sws_ctx_ = sws_getCachedContext(
+				convert_sws_ctx_, frame->width, frame->height,
+				static_cast<AVPixelFormat>(frame->format), converted->width,
+				converted->height, expected_fmt, SWS_POINT, nullptr, nullptr,
+				nullptr);
+			if (!convert_sws_ctx_) {
+				return image;
+			}
 
-		sws_scale(sws_ctx, frame->data, frame->linesize, 0, frame->height,
-				  converted->data, converted->linesize);
-		sws_freeContext(sws_ctx);
+			sws_scale(convert_sws_ctx_, frame->data, frame->linesize, 0, frame->height,
+					  converted->data, converted->linesize);
+		}
 
 		src_frame = converted;
 	}
 
-copy_pixels:
-	int bytes_per_component = params_.format().byte_count();
-	int bytes_per_row = params_.width() * params_.channel_count() *
-						bytes_per_component;
-	int src_row_bytes = src_frame->linesize[0];
-	int dst_row_bytes = image->row_bytes();
-	int copy_bytes = std::min(bytes_per_row,
-							  std::min(src_row_bytes, dst_row_bytes));
-	int copy_height = std::min(image->height(), src_frame->height);
-
-	const uint8_t *src = src_frame->data[0];
-	for (int y = 0; y < copy_height; ++y) {
-		std::memcpy(dst + y * dst_row_bytes, src + y * src_row_bytes,
-					copy_bytes);
+	const int bytes_per_pixel =
+		image_params.channel_count() * image_params.format().byte_count();
+	const int src_row_bytes = src_frame->linesize[0];
+	const int dst_row_bytes = image->row_bytes();
+	const int src_x_offset = (bounds.x1 - regionOfDefinition.x1) * bytes_per_pixel;
+	const int copy_bytes =
+		std::min((bounds.x2 - bounds.x1) * bytes_per_pixel,
+				 std::min(src_row_bytes - src_x_offset, dst_row_bytes));
+	const int src_y_offset = bounds.y1 - regionOfDefinition.y1;
+	const int copy_height =
+		std::min(bounds.y2 - bounds.y1, src_frame->height - src_y_offset);
+
+	const uint8_t *src =
+		src_frame->data[0] + src_y_offset * src_row_bytes + src_x_offset;
+	if (copy_bytes == src_row_bytes && copy_bytes == dst_row_bytes) {
+		std::memcpy(dst, src, size_t(copy_bytes) * copy_height);
+	} else {
+		for (int y = 0; y < copy_height; ++y) {
+			std::memcpy(dst + y * dst_row_bytes, src + y * src_row_bytes,
+						copy_bytes);
+		}
 	}
 
-	
+	ready_images_.insert(time);
+	return image;
+}
+
+void olive::plugin::OliveClipInstance::TrimCache(OfxTime time)
+{
+	// Plugins mostly look at times around the one being rendered, so drop whichever end is further away
+	auto trim = [time](auto &map, auto on_remove) {
+		while (map.size() > kMaximumCachedFrames) {
+			auto victim = (time - map.firstKey() >= map.lastKey() - time) ?
+							  map.begin() :
+							  std::prev(map.end());
+			on_remove(victim.key(), victim.value());
+			map.erase(victim);
+		}
+	};
+
+	trim(images_, [this](OfxTime t, Image *image) {
+		ready_images_.remove(t);
+
+		// The plugin may still hold references, in which case it's deleted when it releases them
+		image->releaseReference();
+	});
+
+	trim(inputs_, [](OfxTime, const Input &) {});
+	trim(regionsOfInterest_, [](OfxTime, const OfxRectD &) {});
+
+#ifdef OFX_SUPPORTS_OPENGLRENDER
+	trim(output_textures_, [](OfxTime, const TexturePtr &) {});
+#endif
 }
 
 void olive::plugin::OliveClipInstance::setOutputTexture(TexturePtr texture,
@@ -594,6 +814,7 @@ void olive::plugin::OliveClipInstance::setOutputTexture(TexturePtr texture,
 		return;
 	}
 	output_textures_.insert(time, texture);
+	TrimCache(time);
 #else
 	(void)texture;
 	(void)time;
@@ -611,25 +832,17 @@ olive::plugin::OliveClipInstance::loadTexture(OfxTime time, const char *format,
 	if (isOutput()) {
 		gl_texture = output_textures_.value(time, nullptr);
 	} else {
-		TexturePtr input = input_textures_.value(time);
-		gl_texture = input ? input : nullptr;
+		gl_texture = inputs_.value(time).texture;
 	}
 
 	if (!gl_texture || gl_texture->IsDummy() || !gl_texture->id().isValid()) {
 		return nullptr;
 	}
 
-	OfxRectD rod_d = getRegionOfDefinition(time);
-	OfxRectI rod = { static_cast<int>(std::floor(rod_d.x1)),
-					 static_cast<int>(std::floor(rod_d.y1)),
-					 static_cast<int>(std::ceil(rod_d.x2)),
-					 static_cast<int>(std::ceil(rod_d.y2)) };
+	OfxRectI rod = getPixelRegionOfDefinition(time);
 	OfxRectI bounds = rod;
 	if (optionalBounds) {
-		bounds.x1 = static_cast<int>(std::floor(optionalBounds->x1));
-		bounds.y1 = static_cast<int>(std::floor(optionalBounds->y1));
-		bounds.x2 = static_cast<int>(std::ceil(optionalBounds->x2));
-		bounds.y2 = static_cast<int>(std::ceil(optionalBounds->y2));
+		bounds = CanonicalToPixel(*optionalBounds);
 	}
 	bounds.x1 = std::max(bounds.x1, rod.x1);
 	bounds.y1 = std::max(bounds.y1, rod.y1);
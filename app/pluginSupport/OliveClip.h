@@ -26,11 +26,17 @@
 #include "image.h"
 #include "ofxCore.h"
 #include "ofxhClip.h"
+#include "common/ffmpegutils.h"
 #include "render/texture.h"
 #include "render/videoparams.h"
 
 #include <QMap>
+#include <QSet>
 #include <memory>
+
+class QThread;
+
+struct SwsContext;
 namespace olive
 {
 namespace plugin
@@ -44,6 +50,12 @@ public:
 	{
 		params_ = params;
 	}
+
+	~OliveClipInstance() override;
+
+	/// Number of frames of images (and input textures) kept around for plugins that sample other times
+	static const int kMaximumCachedFrames = 4;
+
     OFX::Host::ImageEffect::Image* getOutputImage(OfxTime time);
 
 	const std::string &getUnmappedBitDepth() const override;
@@ -62,6 +74,26 @@ public:
 
 	void setRegionOfDefinition(OfxRectD regionOfDefinition, OfxTime time);
 	void setDefaultRegionOfDefinition(OfxRectD regionOfDefinition);
+
+	/**
+   * @brief Set the region the plugin asked for from this input at `time`, in canonical coordinates
+   *
+   * Images fetched from the clip only cover this region (plus any bounds the plugin asks for when fetching),
+   * rather than the whole frame.
+   */
+	void setRegionOfInterest(OfxRectD regionOfInterest, OfxTime time);
+
+	/**
+   * @brief Set the render scale images are fetched and rendered at
+   *
+   * Image bounds are in pixels at this scale, e.g. at 0.25 a 1920x1080 frame is 480x270 pixels.
+   */
+	void setRenderScale(OfxPointD scale);
+
+	/**
+   * @brief Region of definition at `time` in pixel coordinates at the current render scale
+   */
+	OfxRectI getPixelRegionOfDefinition(OfxTime time) const;
 	void setParams(const VideoParams &params)
 	{
 		params_ = params;
@@ -72,22 +104,75 @@ public:
 												 const OfxRectD *optionalBounds) override;
 #   endif
 
+	/**
+   * @brief Set the texture this input clip provides at `time`
+   *
+   * Nothing is downloaded here. GL plugins get the texture itself from loadTexture(), and the CPU image is only
+   * read back and converted to `image_params` (format and channel count) the first time the plugin fetches it
+   * with getImage(). Without `image_params`, the image has the texture's format.
+   */
 	void setInputTexture(TexturePtr texture, OfxTime time);
+	void setInputTexture(TexturePtr texture, OfxTime time,
+						 const VideoParams &image_params);
 	void setOutputTexture(TexturePtr texture, OfxTime time);
 
+	/**
+   * @brief Download the input texture at `time` while the render thread's GL context is current
+   *
+   * Plugins may fetch images from their own threads, which have no GL context to read the texture back with, so
+   * CPU renders call this on the render thread before the render action. getImage() then only converts the frame.
+   */
+	void ReadbackInputTexture(OfxTime time);
+
 private:
+	struct Input {
+		TexturePtr texture;
+		VideoParams image_params;
+
+		/// The texture's pixels when it was read back ahead of the fetch
+		AVFramePtr frame;
+	};
+
+	Image *MaterializeInputImage(OfxTime time, const OfxRectD *optionalBounds);
+
+	OfxRectI CanonicalToPixel(const OfxRectD &rect) const;
+
+	void SetImageRenderScale(Image *image) const;
+
+	/// Drop the cached frames furthest from `time` until at most kMaximumCachedFrames are left
+	void TrimCache(OfxTime time);
+
 	VideoParams params_;
 
 	QMap<OfxTime, OfxRectD> regionOfDefinitions_;
 
+	QMap<OfxTime, OfxRectD> regionsOfInterest_;
+
+	OfxPointD render_scale_ = { 1.0, 1.0 };
+
 	OfxRectD defaultRegionOfDefinitions_;
 
 	std::string name_;
 	QMap<OfxTime, Image*> images_;
+
+	/// Input images in images_ that are up to date with the texture in inputs_
+	QSet<OfxTime> ready_images_;
+
+	QMap<OfxTime, Input> inputs_;
+
+	/// Thread the input textures were set on, the only one with a GL context to download them with
+	QThread *render_thread_ = nullptr;
 #ifdef OFX_SUPPORTS_OPENGLRENDER
-	QMap<OfxTime, TexturePtr> input_textures_;
 	QMap<OfxTime, TexturePtr> output_textures_;
 #endif
+
+	// Reused between fetches so a download doesn't allocate every frame. Readback and conversion have their own
+	// scalers, otherwise each would invalidate the other's cached context on every fetch.
+	SwsContext *readback_sws_ctx_ = nullptr;
+	SwsContext *convert_sws_ctx_ = nullptr;
+	AVFramePtr readback_frame_;
+	AVFramePtr rgba_frame_;
+	AVFramePtr convert_frame_;
 };
 }
 }
@@ -173,6 +173,15 @@ void OlivePluginInstance::setNode(std::shared_ptr<PluginNode> node)
 	}
 }
 
+void OlivePluginInstance::setSourceNode(PluginNode *node)
+{
+	for (const auto &entry : getParams()) {
+		if (auto *bound = dynamic_cast<NodeBoundParam *>(entry.second)) {
+			bound->SetSourceNode(node);
+		}
+	}
+}
+
 OfxStatus OlivePluginInstance::vmessage(const char *type, const char *id,
 								  const char *format, va_list args)
 {
@@ -553,12 +562,58 @@ OFX::Host::ImageEffect::ClipInstance *OlivePluginInstance::newClipInstance(
 	return clipInstance;
 }
 
+OfxStatus OlivePluginInstance::ensureSequenceRender(OfxTime start, OfxTime end,
+												   OfxTime step,
+												   bool interactive,
+												   OfxPointD render_scale)
+{
+	if (sequence_open_ && sequence_start_ == start && sequence_end_ == end &&
+		sequence_step_ == step && sequence_interactive_ == interactive &&
+		sequence_scale_.x == render_scale.x &&
+		sequence_scale_.y == render_scale.y) {
+		return kOfxStatOK;
+	}
+
+	endSequenceRender();
+
+	OfxStatus stat = beginRenderAction(start, end, step, interactive,
+									   render_scale, true, interactive);
+	if (stat != kOfxStatOK && stat != kOfxStatReplyDefault) {
+		return stat;
+	}
+
+	sequence_open_ = true;
+	sequence_start_ = start;
+	sequence_end_ = end;
+	sequence_step_ = step;
+	sequence_interactive_ = interactive;
+	sequence_scale_ = render_scale;
+	return stat;
+}
+
+void OlivePluginInstance::endSequenceRender()
+{
+	if (!sequence_open_) {
+		return;
+	}
+
+	sequence_open_ = false;
+	endRenderAction(sequence_start_, sequence_end_, sequence_step_,
+					sequence_interactive_, sequence_scale_, true,
+					sequence_interactive_);
+}
+
 OlivePluginInstance::~OlivePluginInstance()
 {
 	if (!QCoreApplication::instance() ||
 		qEnvironmentVariableIsSet("OAK_OFX_ITEST")) {
 		_created = false;
 	}
+
+	// Sequences stay open between frames, close the last one before the plugin destroys the instance
+	if (_created) {
+		endSequenceRender();
+	}
 }
 
 }
@@ -75,6 +75,10 @@ public:
 		this->params_=params;
 	}
 	void setNode(std::shared_ptr<PluginNode> node);
+	// 作用：让未绑定节点的参数从该节点读取未拷入的时间点。
+	// Purpose: Let params of an instance that isn't bound to a node read the
+	// times the renderer didn't copy in from `node`.
+	void setSourceNode(PluginNode *node);
 	std::shared_ptr<PluginNode> node() const
 	{
 		return node_;
@@ -87,6 +91,20 @@ public:
 	{
 		return _created;
 	}
+
+	// 作用：保持覆盖给定范围的序列渲染处于打开状态，范围或参数不同则先结束旧的。
+	// Purpose: Keep a sequence render (begin/end sequence render actions) open
+	// over start..end. One begun with a different range, step, scale or
+	// interactivity is ended first.
+	OfxStatus ensureSequenceRender(OfxTime start, OfxTime end, OfxTime step,
+								   bool interactive, OfxPointD render_scale);
+	// 作用：结束当前打开的序列渲染（如果有）。
+	// Purpose: End the open sequence render, if any.
+	void endSequenceRender();
+	bool isInSequenceRender() const
+	{
+		return sequence_open_;
+	}
 	OFX::Host::ImageEffect::ClipInstance *newClipInstance(
 		OFX::Host::ImageEffect::Instance *plugin,
 		OFX::Host::ImageEffect::ClipDescriptor *descriptor,
@@ -212,6 +230,12 @@ private:
 	bool progress_cancelled_ = false;
 	bool progress_active_ = false;
 	bool open_gl_enabled_ = false;
+	bool sequence_open_ = false;
+	OfxTime sequence_start_ = 0.0;
+	OfxTime sequence_end_ = 0.0;
+	OfxTime sequence_step_ = 1.0;
+	bool sequence_interactive_ = false;
+	OfxPointD sequence_scale_ = { 1.0, 1.0 };
 };
 }
 }
@@ -0,0 +1,172 @@
+/*
+ * Oak Video Editor - Non-Linear Video Editor
+ * Copyright (C) 2025 Olive CE Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "instancepool.h"
+
+#include "OlivePluginInstance.h"
+#include "ofxImageEffect.h"
+#include "ofxhImageEffectAPI.h"
+
+#include <QHash>
+
+namespace olive
+{
+namespace plugin
+{
+
+InstancePool::InstancePool(OFX::Host::ImageEffect::Instance *prototype)
+{
+	OFX::Host::ImageEffect::ImageEffectPlugin *plugin = prototype->getPlugin();
+	const std::string context = prototype->getContext();
+
+	plugin_id_ = QString::fromStdString(plugin->getIdentifier());
+	safety_ = ThreadSafetyFromString(
+		prototype->getDescriptor().getProps().getStringProperty(
+			kOfxImageEffectPluginRenderThreadSafety));
+	factory_ = [plugin, context, prototype] {
+		OFX::Host::ImageEffect::Instance *instance =
+			plugin->createInstance(context, nullptr);
+
+		// Plugins may read other frames than the one the renderer copies in, those come from the node
+		auto *source = dynamic_cast<OlivePluginInstance *>(prototype);
+		auto *olive_instance = dynamic_cast<OlivePluginInstance *>(instance);
+		if (source && olive_instance) {
+			olive_instance->setSourceNode(source->node().get());
+		}
+		return instance;
+	};
+}
+
+InstancePool::InstancePool(const QString &plugin_id, ThreadSafety safety,
+						   Factory factory)
+	: plugin_id_(plugin_id)
+	, safety_(safety)
+	, factory_(std::move(factory))
+{
+}
+
+InstancePool::~InstancePool()
+{
+	qDeleteAll(instances_);
+}
+
+InstancePool::Lease InstancePool::Acquire()
+{
+	QMutex *plugin_lock = nullptr;
+	if (safety_ == kUnsafe) {
+		plugin_lock = GetPluginLock(plugin_id_);
+		plugin_lock->lock();
+	}
+
+	OFX::Host::ImageEffect::Instance *instance = nullptr;
+	{
+		QMutexLocker locker(&lock_);
+		if (!idle_.isEmpty()) {
+			instance = idle_.takeLast();
+		}
+	}
+
+	if (!instance) {
+		// Creating an instance calls into the plugin, don't hold up other threads returning theirs
+		instance = factory_ ? factory_() : nullptr;
+		if (!instance) {
+			if (plugin_lock) {
+				plugin_lock->unlock();
+			}
+			return Lease();
+		}
+
+		QMutexLocker locker(&lock_);
+		instances_.append(instance);
+	}
+
+	return Lease(this, instance, plugin_lock);
+}
+
+int InstancePool::count() const
+{
+	QMutexLocker locker(&lock_);
+	return instances_.size();
+}
+
+InstancePool::ThreadSafety
+InstancePool::ThreadSafetyFromString(const std::string &safety)
+{
+	if (safety == kOfxImageEffectRenderUnsafe) {
+		return kUnsafe;
+	}
+	if (safety == kOfxImageEffectRenderFullySafe) {
+		return kFullySafe;
+	}
+
+	// "instancesafe" is the default in the OFX spec
+	return kInstanceSafe;
+}
+
+QMutex *InstancePool::GetPluginLock(const QString &plugin_id)
+{
+	static QMutex locks_lock;
+	static QHash<QString, QMutex *> locks;
+
+	QMutexLocker locker(&locks_lock);
+	QMutex *&lock = locks[plugin_id];
+	if (!lock) {
+		// Lives as long as the process, plugins stay loaded that long too
+		lock = new QMutex();
+	}
+	return lock;
+}
+
+void InstancePool::Release(OFX::Host::ImageEffect::Instance *instance)
+{
+	QMutexLocker locker(&lock_);
+	idle_.append(instance);
+}
+
+InstancePool::Lease::Lease(InstancePool *pool,
+						   OFX::Host::ImageEffect::Instance *instance,
+						   QMutex *plugin_lock)
+	: pool_(pool)
+	, instance_(instance)
+	, plugin_lock_(plugin_lock)
+{
+}
+
+InstancePool::Lease::Lease(Lease &&other) noexcept
+	: pool_(other.pool_)
+	, instance_(other.instance_)
+	, plugin_lock_(other.plugin_lock_)
+{
+	other.pool_ = nullptr;
+	other.instance_ = nullptr;
+	other.plugin_lock_ = nullptr;
+}
+
+InstancePool::Lease::~Lease()
+{
+	if (pool_ && instance_) {
+		pool_->Release(instance_);
+	}
+	if (plugin_lock_) {
+		plugin_lock_->unlock();
+	}
+}
+
+}
+}
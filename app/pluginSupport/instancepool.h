@@ -0,0 +1,128 @@
+/*
+ * Oak Video Editor - Non-Linear Video Editor
+ * Copyright (C) 2025 Olive CE Team
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef INSTANCEPOOL_H
+#define INSTANCEPOOL_H
+#include "ofxhImageEffect.h"
+
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <string>
+
+namespace olive
+{
+namespace plugin
+{
+// 作用：按插件声明的线程安全级别，为每个节点维护一组可并发渲染的 OFX 实例。
+// Purpose: Per-node set of OFX instances that render threads lease, honoring the
+// plugin's kOfxImageEffectPluginRenderThreadSafety.
+//
+// Rendering writes per-frame state into an instance (parameter values, clip
+// textures, clip preferences), so a lease is exclusive even for "fully safe"
+// plugins. Instances are created on demand, so a node ends up with as many as
+// there were render threads rendering it at once. "Unsafe" plugins are
+// additionally serialized across every node that uses the same plugin.
+//
+// Pooled instances are not bound to the node: their parameters hold whatever
+// the renderer copies into them for the frames being rendered, and read the
+// node for any other time.
+class InstancePool {
+public:
+	enum ThreadSafety { kUnsafe, kInstanceSafe, kFullySafe };
+
+	using Factory = std::function<OFX::Host::ImageEffect::Instance *()>;
+
+	// 作用：从原型实例读取插件、上下文和线程安全级别。
+	// Purpose: Create instances of the same plugin and context as `prototype`.
+	explicit InstancePool(OFX::Host::ImageEffect::Instance *prototype);
+
+	InstancePool(const QString &plugin_id, ThreadSafety safety,
+				 Factory factory);
+
+	~InstancePool();
+
+	InstancePool(const InstancePool &) = delete;
+	InstancePool &operator=(const InstancePool &) = delete;
+
+	class Lease {
+	public:
+		Lease() = default;
+		Lease(Lease &&other) noexcept;
+		~Lease();
+
+		Lease(const Lease &) = delete;
+		Lease &operator=(const Lease &) = delete;
+		Lease &operator=(Lease &&) = delete;
+
+		OFX::Host::ImageEffect::Instance *get() const
+		{
+			return instance_;
+		}
+
+		explicit operator bool() const
+		{
+			return instance_;
+		}
+
+	private:
+		friend class InstancePool;
+
+		Lease(InstancePool *pool, OFX::Host::ImageEffect::Instance *instance,
+			  QMutex *plugin_lock);
+
+		InstancePool *pool_ = nullptr;
+		OFX::Host::ImageEffect::Instance *instance_ = nullptr;
+		QMutex *plugin_lock_ = nullptr;
+	};
+
+	// 作用：取得一个空闲实例（必要时新建），对不安全插件会阻塞直到轮到本线程。
+	// Purpose: Lease an idle instance, creating one if all are busy. Blocks for
+	// "unsafe" plugins while any other instance of the plugin is rendering.
+	Lease Acquire();
+
+	ThreadSafety safety() const
+	{
+		return safety_;
+	}
+
+	int count() const;
+
+	static ThreadSafety ThreadSafetyFromString(const std::string &safety);
+
+	// 作用：返回同一插件所有节点共享的渲染锁。
+	// Purpose: Lock shared by every node of the plugin `plugin_id`.
+	static QMutex *GetPluginLock(const QString &plugin_id);
+
+private:
+	void Release(OFX::Host::ImageEffect::Instance *instance);
+
+	QString plugin_id_;
+	ThreadSafety safety_;
+	Factory factory_;
+
+	mutable QMutex lock_;
+	QVector<OFX::Host::ImageEffect::Instance *> instances_;
+	QVector<OFX::Host::ImageEffect::Instance *> idle_;
+};
+}
+}
+
+#endif //INSTANCEPOOL_H
@@ -32,7 +32,11 @@
 #include "node/plugins/Plugin.h"
 #include "core.h"
 #include "undo/undocommand.h"
+#include <array>
+#include <cmath>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <qlogging.h>
 namespace olive
 {
@@ -46,10 +50,120 @@ inline QString ParamChangeLabel(const OFX::Host::Param::Descriptor &descriptor)
 void SubmitUndoCommand(const std::shared_ptr<PluginNode> &node,
 					   UndoCommand *command, const QString &label);
 
+/**
+ * @brief Values copied into a param that isn't bound to a node
+ *
+ * The renderer copies in the values of the frame it renders, so values set for
+ * a time are kept for that time instead of replacing what other frames read.
+ */
+template <typename T>
+class UnboundValue {
+public:
+	bool Get(T &value) const
+	{
+		if (!has_value_) {
+			return false;
+		}
+		value = value_;
+		return true;
+	}
+	bool Get(OfxTime time, T &value) const
+	{
+		auto it = values_.find(time);
+		if (it == values_.end()) {
+			return false;
+		}
+		value = it->second;
+		return true;
+	}
+	void Set(const T &value)
+	{
+		value_ = value;
+		has_value_ = true;
+		// A value that doesn't vary with time replaces every per-time value
+		values_.clear();
+	}
+	void Set(OfxTime time, const T &value)
+	{
+		value_ = value;
+		has_value_ = true;
+		if (values_.size() >= kMaximumTimes && !values_.count(time)) {
+			// Renders are usually near each other, forget the time furthest from this one
+			auto first = values_.begin();
+			auto last = std::prev(values_.end());
+			values_.erase(std::abs(first->first - time) >
+								  std::abs(last->first - time) ?
+							  first :
+							  last);
+		}
+		values_[time] = value;
+	}
+
+private:
+	static constexpr size_t kMaximumTimes = 64;
+
+	bool has_value_ = false;
+	T value_{};
+	std::map<OfxTime, T> values_;
+};
+
+inline int ParamDefaultInt(const OFX::Host::Param::Descriptor &descriptor,
+						   int index = 0)
+{
+	return descriptor.getProperties().getIntProperty(kOfxParamPropDefault,
+													 index);
+}
+inline double ParamDefaultDouble(const OFX::Host::Param::Descriptor &descriptor,
+								 int index = 0)
+{
+	return descriptor.getProperties().getDoubleProperty(kOfxParamPropDefault,
+														index);
+}
+
 class NodeBoundParam {
 public:
 	virtual ~NodeBoundParam() = default;
 	virtual void SetNode(const std::shared_ptr<PluginNode> &node) = 0;
+
+	/**
+	 * @brief Node an unbound param reads the times it has no value for from
+	 *
+	 * Pooled render instances aren't bound to their node, but plugins that read
+	 * other frames than the one being rendered still need that node's values.
+	 */
+	void SetSourceNode(PluginNode *node)
+	{
+		source_node_ = node;
+	}
+
+protected:
+	/**
+	 * @brief Node to read `time` from, or nullptr if `value` already holds it
+	 *
+	 * An unbound param answers with the value set for `time`, then its source
+	 * node, then the last value set, then `default_value`.
+	 */
+	template <typename T>
+	PluginNode *NodeForTime(PluginNode *bound, const UnboundValue<T> &values,
+							OfxTime time, T &value,
+							const T &default_value) const
+	{
+		if (bound) {
+			return bound;
+		}
+		if (values.Get(time, value)) {
+			return nullptr;
+		}
+		if (source_node_) {
+			return source_node_;
+		}
+		if (!values.Get(value)) {
+			value = default_value;
+		}
+		return nullptr;
+	}
+
+	PluginNode *source_node_ = nullptr;
 };
 
 class PushbuttonInstance : public OFX::Host::Param::PushbuttonInstance,
@@ -77,8 +191,11 @@ protected:
 	std::shared_ptr<PluginNode>   _node;
 	OFX::Host::Param::Descriptor& _descriptor;
 	QString id;
-	bool has_value_ = false;
-	int value_ = 0;
+	UnboundValue<int> value_;
+	int DefaultValue() const
+	{
+		return ParamDefaultInt(_descriptor);
+	}
 public:
 	IntegerInstance(std::shared_ptr<PluginNode>node, OFX::Host::Param::Descriptor &descriptor)
 		: OFX::Host::Param::IntegerInstance(descriptor)
@@ -92,7 +209,9 @@ public:
 	OfxStatus get(int &a)
 	{
 		if (!_node) {
-			a = has_value_ ? value_ : 0;
+			if (!value_.Get(a)) {
+				a = DefaultValue();
+			}
 			return kOfxStatOK;
 		}
 		if (id.isEmpty()) {
@@ -104,31 +223,32 @@ public:
 			a=variant.toInt();
 			return kOfxStatOK;
 		}
-		a=0;
+		a=DefaultValue();
 		return kOfxStatErrValue;
 	}
 	OfxStatus get(OfxTime time, int &data)
 	{
-		if (!_node) {
-			data = has_value_ ? value_ : 0;
+		PluginNode *read_node =
+			NodeForTime(_node.get(), value_, time, data, DefaultValue());
+		if (!read_node) {
 			return kOfxStatOK;
 		}
-		if (id.isEmpty()) {
+		if (_node && id.isEmpty()) {
 			return kOfxStatErrBadHandle;
 		}
-		QVariant variant=_node->GetValueAtTime(id, rational::fromDouble(time));
+		QVariant variant = read_node->GetValueAtTime(
+			_descriptor.getName().c_str(), rational::fromDouble(time));
 		if (variant.typeId()==QVariant::Int) {
 			data=variant.toInt();
 			return kOfxStatOK;
 		}
-		data=0;
+		data=DefaultValue();
 		return kOfxStatErrValue;
 	}
 	OfxStatus set(int data)
 	{
 		if (!_node) {
-			value_ = data;
-			has_value_ = true;
+			value_.Set(data);
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -143,8 +263,7 @@ public:
 	OfxStatus set(OfxTime time, int data)
 	{
 		if (!_node) {
-			value_ = data;
-			has_value_ = true;
+			value_.Set(time, data);
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -162,8 +281,11 @@ class DoubleInstance : public OFX::Host::Param::DoubleInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	double value_ = 0.0;
+	UnboundValue<double> value_;
+	double DefaultValue() const
+	{
+		return ParamDefaultDouble(_descriptor);
+	}
 public:
 	DoubleInstance(std::shared_ptr<PluginNode> effect, const std::string& name, OFX::Host::Param::Descriptor& descriptor)
 		: OFX::Host::Param::DoubleInstance(descriptor)
@@ -179,7 +301,9 @@ public:
 	OfxStatus get(double& data)
 	{
 		if (!node) {
-			data = has_value_ ? value_ : 0.0;
+			if (!value_.Get(data)) {
+				data = DefaultValue();
+			}
 			return kOfxStatOK;
 		}
 		QVariant variant = node->GetStandardValue(_descriptor.getName().c_str());
@@ -187,30 +311,30 @@ public:
 			data = variant.toDouble();
 			return kOfxStatOK;
 		}
-		data = 0.0;
+		data = DefaultValue();
 		return kOfxStatErrValue;
 	}
 	OfxStatus get(OfxTime time, double& data)
 	{
-		if (!node) {
-			data = has_value_ ? value_ : 0.0;
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, data, DefaultValue());
+		if (!read_node) {
 			return kOfxStatOK;
 		}
 		QVariant variant =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time));
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time));
 		if (variant.canConvert<double>()) {
 			data = variant.toDouble();
 			return kOfxStatOK;
 		}
-		data = 0.0;
+		data = DefaultValue();
 		return kOfxStatErrValue;
 	}
 	OfxStatus set(double data)
 	{
 		if (!node) {
-			value_ = data;
-			has_value_ = true;
+			value_.Set(data);
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -223,8 +347,7 @@ public:
 	OfxStatus set(OfxTime time, double data)
 	{
 		if (!node) {
-			value_ = data;
-			has_value_ = true;
+			value_.Set(time, data);
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -249,8 +372,7 @@ class BooleanInstance : public OFX::Host::Param::BooleanInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	bool value_ = false;
+	UnboundValue<bool> value_;
 	bool DefaultValue() const
 	{
 		return _descriptor.getProperties()
@@ -271,7 +393,9 @@ public:
 	OfxStatus get(bool& data)
 	{
 		if (!node) {
-			data = has_value_ ? value_ : false;
+			if (!value_.Get(data)) {
+				data = DefaultValue();
+			}
 			return kOfxStatOK;
 		}
 		QVariant variant = node->GetStandardValue(_descriptor.getName().c_str());
@@ -284,13 +408,14 @@ public:
 	}
 	OfxStatus get(OfxTime time, bool& data)
 	{
-		if (!node) {
-			data = has_value_ ? value_ : false;
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, data, DefaultValue());
+		if (!read_node) {
 			return kOfxStatOK;
 		}
 		QVariant variant =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time));
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time));
 		if (variant.isNull()){
 			qWarning().noquote()<<"Boolean get failed: Varient is null" << time << rational::fromDouble(time).toDouble();
 		}
@@ -309,8 +434,7 @@ public:
 	OfxStatus set(bool data)
 	{
 		if (!node) {
-			value_ = data;
-			has_value_ = true;
+			value_.Set(data);
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -323,8 +447,7 @@ public:
 	OfxStatus set(OfxTime time, bool data)
 	{
 		if (!node) {
-			value_ = data;
-			has_value_ = true;
+			value_.Set(time, data);
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -341,8 +464,11 @@ class ChoiceInstance : public OFX::Host::Param::ChoiceInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	int value_ = 0;
+	UnboundValue<int> value_;
+	int DefaultValue() const
+	{
+		return ParamDefaultInt(_descriptor);
+	}
 public:
 	ChoiceInstance(std::shared_ptr<PluginNode> effect,  const std::string& name, OFX::Host::Param::Descriptor& descriptor)
 		: OFX::Host::Param::ChoiceInstance(descriptor)
@@ -358,7 +484,9 @@ public:
 	OfxStatus get(int& data)
 	{
 		if (!node) {
-			data = has_value_ ? value_ : 0;
+			if (!value_.Get(data)) {
+				data = DefaultValue();
+			}
 			return kOfxStatOK;
 		}
 		QVariant variant = node->GetStandardValue(_descriptor.getName().c_str());
@@ -366,30 +494,30 @@ public:
 			data = variant.toInt();
 			return kOfxStatOK;
 		}
-		data = 0;
+		data = DefaultValue();
 		return kOfxStatErrValue;
 	}
 	OfxStatus get(OfxTime time, int& data)
 	{
-		if (!node) {
-			data = has_value_ ? value_ : 0;
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, data, DefaultValue());
+		if (!read_node) {
 			return kOfxStatOK;
 		}
 		QVariant variant =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time));
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time));
 		if (variant.canConvert<int>()) {
 			data = variant.toInt();
 			return kOfxStatOK;
 		}
-		data = 0;
+		data = DefaultValue();
 		return kOfxStatErrValue;
 	}
 	OfxStatus set(int data)
 	{
 		if (!node) {
-			value_ = data;
-			has_value_ = true;
+			value_.Set(data);
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -402,8 +530,7 @@ public:
 	OfxStatus set(OfxTime time, int data)
 	{
 		if (!node) {
-			value_ = data;
-			has_value_ = true;
+			value_.Set(time, data);
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -420,8 +547,15 @@ class RGBAInstance : public OFX::Host::Param::RGBAInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	double value_[4] = {0.0, 0.0, 0.0, 0.0};
+	UnboundValue<std::array<double, 4>> value_;
+	std::array<double, 4> DefaultValue() const
+	{
+		std::array<double, 4> value;
+		for (int i = 0; i < 4; i++) {
+			value[i] = ParamDefaultDouble(_descriptor, i);
+		}
+		return value;
+	}
 public:
 	RGBAInstance(std::shared_ptr<PluginNode> effect, const std::string& name, OFX::Host::Param::Descriptor& descriptor)
 		: OFX::Host::Param::RGBAInstance(descriptor)
@@ -437,14 +571,14 @@ public:
 	OfxStatus get(double& r,double& g,double& b,double& a)
 	{
 		if (!node) {
-			if (has_value_) {
-				r = value_[0];
-				g = value_[1];
-				b = value_[2];
-				a = value_[3];
-			} else {
-				r = g = b = a = 0.0;
+			std::array<double, 4> value;
+			if (!value_.Get(value)) {
+				value = DefaultValue();
 			}
+			r = value[0];
+			g = value[1];
+			b = value[2];
+			a = value[3];
 			return kOfxStatOK;
 		}
 		olive::core::Color c =
@@ -459,20 +593,19 @@ public:
 	}
 	OfxStatus get(OfxTime time, double& r,double& g,double& b,double& a)
 	{
-		if (!node) {
-			if (has_value_) {
-				r = value_[0];
-				g = value_[1];
-				b = value_[2];
-				a = value_[3];
-			} else {
-				r = g = b = a = 0.0;
-			}
+		std::array<double, 4> value;
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, value, DefaultValue());
+		if (!read_node) {
+			r = value[0];
+			g = value[1];
+			b = value[2];
+			a = value[3];
 			return kOfxStatOK;
 		}
 		olive::core::Color c =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time))
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time))
 				.value<olive::core::Color>();
 
 		r = static_cast<double>(c.red());
@@ -484,11 +617,7 @@ public:
 	OfxStatus set(double r,double g,double b,double a)
 	{
 		if (!node) {
-			value_[0] = r;
-			value_[1] = g;
-			value_[2] = b;
-			value_[3] = a;
-			has_value_ = true;
+			value_.Set({ r, g, b, a });
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -502,11 +631,7 @@ public:
 	OfxStatus set(OfxTime time, double r,double g,double b,double a)
 	{
 		if (!node) {
-			value_[0] = r;
-			value_[1] = g;
-			value_[2] = b;
-			value_[3] = a;
-			has_value_ = true;
+			value_.Set(time, { r, g, b, a });
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -530,8 +655,15 @@ class RGBInstance : public OFX::Host::Param::RGBInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	double value_[3] = {0.0, 0.0, 0.0};
+	UnboundValue<std::array<double, 3>> value_;
+	std::array<double, 3> DefaultValue() const
+	{
+		std::array<double, 3> value;
+		for (int i = 0; i < 3; i++) {
+			value[i] = ParamDefaultDouble(_descriptor, i);
+		}
+		return value;
+	}
 public:
 	RGBInstance(std::shared_ptr<PluginNode> effect,  const std::string& name, OFX::Host::Param::Descriptor& descriptor)
 		: OFX::Host::Param::RGBInstance(descriptor)
@@ -547,13 +679,13 @@ public:
 	OfxStatus get(double& r,double& g,double& b)
 	{
 		if (!node) {
-			if (has_value_) {
-				r = value_[0];
-				g = value_[1];
-				b = value_[2];
-			} else {
-				r = g = b = 0.0;
+			std::array<double, 3> value;
+			if (!value_.Get(value)) {
+				value = DefaultValue();
 			}
+			r = value[0];
+			g = value[1];
+			b = value[2];
 			return kOfxStatOK;
 		}
 		olive::core::Color c =
@@ -567,19 +699,18 @@ public:
 	}
 	OfxStatus get(OfxTime time, double& r,double& g,double& b)
 	{
-		if (!node) {
-			if (has_value_) {
-				r = value_[0];
-				g = value_[1];
-				b = value_[2];
-			} else {
-				r = g = b = 0.0;
-			}
+		std::array<double, 3> value;
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, value, DefaultValue());
+		if (!read_node) {
+			r = value[0];
+			g = value[1];
+			b = value[2];
 			return kOfxStatOK;
 		}
 		olive::core::Color c =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time))
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time))
 				.value<olive::core::Color>();
 
 		r = static_cast<double>(c.red());
@@ -590,10 +721,7 @@ public:
 	OfxStatus set(double r,double g,double b)
 	{
 		if (!node) {
-			value_[0] = r;
-			value_[1] = g;
-			value_[2] = b;
-			has_value_ = true;
+			value_.Set({ r, g, b });
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -607,10 +735,7 @@ public:
 	OfxStatus set(OfxTime time, double r,double g,double b)
 	{
 		if (!node) {
-			value_[0] = r;
-			value_[1] = g;
-			value_[2] = b;
-			has_value_ = true;
+			value_.Set(time, { r, g, b });
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -631,8 +756,15 @@ class Double2DInstance : public OFX::Host::Param::Double2DInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	double value_[2] = {0.0, 0.0};
+	UnboundValue<std::array<double, 2>> value_;
+	std::array<double, 2> DefaultValue() const
+	{
+		std::array<double, 2> value;
+		for (int i = 0; i < 2; i++) {
+			value[i] = ParamDefaultDouble(_descriptor, i);
+		}
+		return value;
+	}
 public:
 	Double2DInstance(std::shared_ptr<PluginNode> effect, const std::string& name, OFX::Host::Param::Descriptor& descriptor)
 		: OFX::Host::Param::Double2DInstance(descriptor)
@@ -648,12 +780,12 @@ public:
 	OfxStatus get(double& x,double& y)
 	{
 		if (!node) {
-			if (has_value_) {
-				x = value_[0];
-				y = value_[1];
-			} else {
-				x = y = 0.0;
+			std::array<double, 2> value;
+			if (!value_.Get(value)) {
+				value = DefaultValue();
 			}
+			x = value[0];
+			y = value[1];
 			return kOfxStatOK;
 		}
 		QVector2D vec =
@@ -665,18 +797,17 @@ public:
 	}
 	OfxStatus get(OfxTime time,double& x,double& y)
 	{
-		if (!node) {
-			if (has_value_) {
-				x = value_[0];
-				y = value_[1];
-			} else {
-				x = y = 0.0;
-			}
+		std::array<double, 2> value;
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, value, DefaultValue());
+		if (!read_node) {
+			x = value[0];
+			y = value[1];
 			return kOfxStatOK;
 		}
 		QVector2D vec =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time))
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time))
 				.value<QVector2D>();
 		x = static_cast<double>(vec.x());
 		y = static_cast<double>(vec.y());
@@ -685,9 +816,7 @@ public:
 	OfxStatus set(double x,double y)
 	{
 		if (!node) {
-			value_[0] = x;
-			value_[1] = y;
-			has_value_ = true;
+			value_.Set({ x, y });
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -700,9 +829,7 @@ public:
 	OfxStatus set(OfxTime time,double x,double y)
 	{
 		if (!node) {
-			value_[0] = x;
-			value_[1] = y;
-			has_value_ = true;
+			value_.Set(time, { x, y });
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -721,8 +848,15 @@ class Integer2DInstance : public OFX::Host::Param::Integer2DInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	int value_[2] = {0, 0};
+	UnboundValue<std::array<int, 2>> value_;
+	std::array<int, 2> DefaultValue() const
+	{
+		std::array<int, 2> value;
+		for (int i = 0; i < 2; i++) {
+			value[i] = ParamDefaultInt(_descriptor, i);
+		}
+		return value;
+	}
 public:
 	Integer2DInstance(std::shared_ptr<PluginNode> effect,  const std::string& name, OFX::Host::Param::Descriptor& descriptor)
 		: OFX::Host::Param::Integer2DInstance(descriptor)
@@ -738,12 +872,12 @@ public:
 	OfxStatus get(int& x,int& y)
 	{
 		if (!node) {
-			if (has_value_) {
-				x = value_[0];
-				y = value_[1];
-			} else {
-				x = y = 0;
+			std::array<int, 2> value;
+			if (!value_.Get(value)) {
+				value = DefaultValue();
 			}
+			x = value[0];
+			y = value[1];
 			return kOfxStatOK;
 		}
 		QVector2D vec =
@@ -755,18 +889,17 @@ public:
 	}
 	OfxStatus get(OfxTime time,int& x,int& y)
 	{
-		if (!node) {
-			if (has_value_) {
-				x = value_[0];
-				y = value_[1];
-			} else {
-				x = y = 0;
-			}
+		std::array<int, 2> value;
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, value, DefaultValue());
+		if (!read_node) {
+			x = value[0];
+			y = value[1];
 			return kOfxStatOK;
 		}
 		QVector2D vec =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time))
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time))
 				.value<QVector2D>();
 		x = static_cast<int>(vec.x());
 		y = static_cast<int>(vec.y());
@@ -775,9 +908,7 @@ public:
 	OfxStatus set(int x,int y)
 	{
 		if (!node) {
-			value_[0] = x;
-			value_[1] = y;
-			has_value_ = true;
+			value_.Set({ x, y });
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -790,9 +921,7 @@ public:
 	OfxStatus set(OfxTime time,int x,int y)
 	{
 		if (!node) {
-			value_[0] = x;
-			value_[1] = y;
-			has_value_ = true;
+			value_.Set(time, { x, y });
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -811,8 +940,15 @@ class Double3DInstance : public OFX::Host::Param::Double3DInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	double value_[3] = {0.0, 0.0, 0.0};
+	UnboundValue<std::array<double, 3>> value_;
+	std::array<double, 3> DefaultValue() const
+	{
+		std::array<double, 3> value;
+		for (int i = 0; i < 3; i++) {
+			value[i] = ParamDefaultDouble(_descriptor, i);
+		}
+		return value;
+	}
 public:
 	Double3DInstance(std::shared_ptr<PluginNode> effect, const std::string& name,
 					 OFX::Host::Param::Descriptor& descriptor)
@@ -829,13 +965,13 @@ public:
 	OfxStatus get(double& x,double& y,double& z)
 	{
 		if (!node) {
-			if (has_value_) {
-				x = value_[0];
-				y = value_[1];
-				z = value_[2];
-			} else {
-				x = y = z = 0.0;
+			std::array<double, 3> value;
+			if (!value_.Get(value)) {
+				value = DefaultValue();
 			}
+			x = value[0];
+			y = value[1];
+			z = value[2];
 			return kOfxStatOK;
 		}
 		QVector3D vec =
@@ -848,19 +984,18 @@ public:
 	}
 	OfxStatus get(OfxTime time,double& x,double& y,double& z)
 	{
-		if (!node) {
-			if (has_value_) {
-				x = value_[0];
-				y = value_[1];
-				z = value_[2];
-			} else {
-				x = y = z = 0.0;
-			}
+		std::array<double, 3> value;
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, value, DefaultValue());
+		if (!read_node) {
+			x = value[0];
+			y = value[1];
+			z = value[2];
 			return kOfxStatOK;
 		}
 		QVector3D vec =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time))
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time))
 				.value<QVector3D>();
 		x = static_cast<double>(vec.x());
 		y = static_cast<double>(vec.y());
@@ -870,10 +1005,7 @@ public:
 	OfxStatus set(double x,double y,double z)
 	{
 		if (!node) {
-			value_[0] = x;
-			value_[1] = y;
-			value_[2] = z;
-			has_value_ = true;
+			value_.Set({ x, y, z });
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -886,10 +1018,7 @@ public:
 	OfxStatus set(OfxTime time,double x,double y,double z)
 	{
 		if (!node) {
-			value_[0] = x;
-			value_[1] = y;
-			value_[2] = z;
-			has_value_ = true;
+			value_.Set(time, { x, y, z });
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -910,8 +1039,15 @@ class Integer3DInstance : public OFX::Host::Param::Integer3DInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	int value_[3] = {0, 0, 0};
+	UnboundValue<std::array<int, 3>> value_;
+	std::array<int, 3> DefaultValue() const
+	{
+		std::array<int, 3> value;
+		for (int i = 0; i < 3; i++) {
+			value[i] = ParamDefaultInt(_descriptor, i);
+		}
+		return value;
+	}
 public:
 	Integer3DInstance(std::shared_ptr<PluginNode> effect, const std::string& name,
 					  OFX::Host::Param::Descriptor& descriptor)
@@ -928,13 +1064,13 @@ public:
 	OfxStatus get(int& x,int& y,int& z)
 	{
 		if (!node) {
-			if (has_value_) {
-				x = value_[0];
-				y = value_[1];
-				z = value_[2];
-			} else {
-				x = y = z = 0;
+			std::array<int, 3> value;
+			if (!value_.Get(value)) {
+				value = DefaultValue();
 			}
+			x = value[0];
+			y = value[1];
+			z = value[2];
 			return kOfxStatOK;
 		}
 		QVector3D vec =
@@ -947,19 +1083,18 @@ public:
 	}
 	OfxStatus get(OfxTime time,int& x,int& y,int& z)
 	{
-		if (!node) {
-			if (has_value_) {
-				x = value_[0];
-				y = value_[1];
-				z = value_[2];
-			} else {
-				x = y = z = 0;
-			}
+		std::array<int, 3> value;
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, value, DefaultValue());
+		if (!read_node) {
+			x = value[0];
+			y = value[1];
+			z = value[2];
 			return kOfxStatOK;
 		}
 		QVector3D vec =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time))
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time))
 				.value<QVector3D>();
 		x = static_cast<int>(vec.x());
 		y = static_cast<int>(vec.y());
@@ -969,10 +1104,7 @@ public:
 	OfxStatus set(int x,int y,int z)
 	{
 		if (!node) {
-			value_[0] = x;
-			value_[1] = y;
-			value_[2] = z;
-			has_value_ = true;
+			value_.Set({ x, y, z });
 			return kOfxStatOK;
 		}
 		SplitValue split = NodeValue::split_normal_value_into_track_values(
@@ -985,10 +1117,7 @@ public:
 	OfxStatus set(OfxTime time,int x,int y,int z)
 	{
 		if (!node) {
-			value_[0] = x;
-			value_[1] = y;
-			value_[2] = z;
-			has_value_ = true;
+			value_.Set(time, { x, y, z });
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -1009,8 +1138,12 @@ class StringInstance : public OFX::Host::Param::StringInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	std::string value_;
+	UnboundValue<std::string> value_;
+	std::string DefaultValue() const
+	{
+		return _descriptor.getProperties().getStringProperty(
+			kOfxParamPropDefault);
+	}
 public:
 	StringInstance(std::shared_ptr<PluginNode> effect, const std::string& name,
 				   OFX::Host::Param::Descriptor& descriptor)
@@ -1027,7 +1160,9 @@ public:
 	OfxStatus get(std::string &data)
 	{
 		if (!node) {
-			data = has_value_ ? value_ : std::string();
+			if (!value_.Get(data)) {
+				data = DefaultValue();
+			}
 			return kOfxStatOK;
 		}
 		QVariant variant = node->GetStandardValue(_descriptor.getName().c_str());
@@ -1040,13 +1175,14 @@ public:
 	}
 	OfxStatus get(OfxTime time, std::string &data)
 	{
-		if (!node) {
-			data = has_value_ ? value_ : std::string();
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, data, DefaultValue());
+		if (!read_node) {
 			return kOfxStatOK;
 		}
 		QVariant variant =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time));
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time));
 		if (variant.canConvert<QString>()) {
 			data = variant.toString().toStdString();
 			return kOfxStatOK;
@@ -1057,8 +1193,7 @@ public:
 	OfxStatus set(const char *data)
 	{
 		if (!node) {
-			value_ = data ? data : "";
-			has_value_ = true;
+			value_.Set(data ? data : "");
 			return kOfxStatOK;
 		}
 		QString v = QString::fromUtf8(data);
@@ -1072,8 +1207,7 @@ public:
 	OfxStatus set(OfxTime time, const char *data)
 	{
 		if (!node) {
-			value_ = data ? data : "";
-			has_value_ = true;
+			value_.Set(time, data ? data : "");
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
@@ -1090,8 +1224,12 @@ class CustomInstance : public OFX::Host::Param::CustomInstance,
 protected:
 	std::shared_ptr<PluginNode>   node;
 	OFX::Host::Param::Descriptor& _descriptor;
-	bool has_value_ = false;
-	std::string value_;
+	UnboundValue<std::string> value_;
+	std::string DefaultValue() const
+	{
+		return _descriptor.getProperties().getStringProperty(
+			kOfxParamPropDefault);
+	}
 public:
 	CustomInstance(std::shared_ptr<PluginNode> effect, const std::string& name,
 				   OFX::Host::Param::Descriptor& descriptor)
@@ -1108,7 +1246,9 @@ public:
 	OfxStatus get(std::string &data)
 	{
 		if (!node) {
-			data = has_value_ ? value_ : std::string();
+			if (!value_.Get(data)) {
+				data = DefaultValue();
+			}
 			return kOfxStatOK;
 		}
 		QVariant variant = node->GetStandardValue(_descriptor.getName().c_str());
@@ -1125,13 +1265,14 @@ public:
 	}
 	OfxStatus get(OfxTime time, std::string &data)
 	{
-		if (!node) {
-			data = has_value_ ? value_ : std::string();
+		PluginNode *read_node =
+			NodeForTime(node.get(), value_, time, data, DefaultValue());
+		if (!read_node) {
 			return kOfxStatOK;
 		}
 		QVariant variant =
-			node->GetValueAtTime(_descriptor.getName().c_str(),
-								 rational::fromDouble(time));
+			read_node->GetValueAtTime(_descriptor.getName().c_str(),
+									  rational::fromDouble(time));
 		if (variant.canConvert<QByteArray>()) {
 			data = variant.toByteArray().toStdString();
 			return kOfxStatOK;
@@ -1146,8 +1287,7 @@ public:
 	OfxStatus set(const char *data)
 	{
 		if (!node) {
-			value_ = data ? data : "";
-			has_value_ = true;
+			value_.Set(data ? data : "");
 			return kOfxStatOK;
 		}
 		QByteArray v = QByteArray(data);
@@ -1161,8 +1301,7 @@ public:
 	OfxStatus set(OfxTime time, const char *data)
 	{
 		if (!node) {
-			value_ = data ? data : "";
-			has_value_ = true;
+			value_.Set(time, data ? data : "");
 			return kOfxStatOK;
 		}
 		auto command = new MultiUndoCommand();
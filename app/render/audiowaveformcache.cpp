@@ -21,21 +21,80 @@
 
 #include "audiowaveformcache.h"
 
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include "common/filefunctions.h"
+#include "render/diskmanager.h"
+
 namespace olive
 {
 
 #define super PlaybackCache
 
+// Bump whenever the layout written by WriteWaveformFile() changes
+static const quint32 kWaveformCacheVersion = 1;
+
+// Runs on a worker thread, so it only touches the copies it's given
+static void WriteWaveformFile(const QString &filename,
+							  const TimeRangeList &ranges,
+							  std::shared_ptr<AudioVisualWaveform> waveform)
+{
+	if (ranges.isEmpty()) {
+		QFile::remove(filename);
+		return;
+	}
+
+	QSaveFile f(filename);
+	if (!f.open(QFile::WriteOnly)) {
+		return;
+	}
+
+	QDataStream s(&f);
+
+	s << kWaveformCacheVersion;
+
+	// Using "int" to match the state file
+	s << int(ranges.size());
+	for (const TimeRange &r : ranges) {
+		s << qint64(r.in().numerator()) << qint64(r.in().denominator())
+		  << qint64(r.out().numerator()) << qint64(r.out().denominator());
+	}
+
+	// QSaveFile discards the file unless it's committed
+	if (!waveform->Save(s) || !f.commit()) {
+		qWarning() << "Failed to save waveform" << filename;
+	}
+}
+
 AudioWaveformCache::AudioWaveformCache(QObject *parent)
 	: super{ parent }
+	, save_pending_(false)
+	, unloaded_(false)
 {
 	waveforms_ = std::make_shared<AudioVisualWaveform>();
+
+	// Sums arrive a chunk at a time while caching, only write them once they stop for a moment
+	save_timer_ = new QTimer(this);
+	save_timer_->setSingleShot(true);
+	save_timer_->setInterval(kSaveDelay);
+	connect(save_timer_, &QTimer::timeout, this,
+			&AudioWaveformCache::SaveWaveform);
+}
+
+AudioWaveformCache::~AudioWaveformCache()
+{
+	save_future_.waitForFinished();
 }
 
 void AudioWaveformCache::WriteWaveform(const TimeRange &range,
 									   const TimeRangeList &valid_ranges,
 									   const AudioVisualWaveform *waveform)
 {
+	EnsureLoaded();
+
 	// Write each valid range to the segments
 	foreach (const TimeRange &r, valid_ranges) {
 		if (waveform) {
@@ -45,6 +104,8 @@ void AudioWaveformCache::WriteWaveform(const TimeRange &range,
 
 		Validate(r);
 	}
+
+	QueueSave();
 }
 
 void DrawSubRect(QPainter *painter, const QRect &rect, const double &scale,
@@ -69,6 +130,8 @@ void AudioWaveformCache::Draw(QPainter *painter, const QRect &rect,
 							  const double &scale,
 							  const rational &start_time) const
 {
+	EnsureLoaded();
+
 	if (!passthroughs_.empty()) {
 		TimeRange wave_range(start_time,
 							 start_time +
@@ -96,11 +159,15 @@ AudioVisualWaveform::Sample
 AudioWaveformCache::GetSummaryFromTime(const rational &start,
 									   const rational &length) const
 {
+	EnsureLoaded();
+
 	return waveforms_->GetSummaryFromTime(start, length);
 }
 
 rational AudioWaveformCache::length() const
 {
+	EnsureLoaded();
+
 	return waveforms_->length();
 }
 
@@ -108,6 +175,8 @@ void AudioWaveformCache::SetPassthrough(PlaybackCache *cache)
 {
 	AudioWaveformCache *c = static_cast<AudioWaveformCache *>(cache);
 
+	c->EnsureLoaded();
+
 	for (const TimeRange &r : c->GetValidatedRanges()) {
 		WaveformPassthrough t = r;
 		t.waveform = c->waveforms_;
@@ -124,7 +193,145 @@ void AudioWaveformCache::InvalidateEvent(const TimeRange &range)
 {
 	TimeRangeList::util_remove(&passthroughs_, range);
 
+	// Don't leave stale sums in the file for ranges that get validated again later
+	QueueSave();
+
 	super::InvalidateEvent(range);
 }
 
+void AudioWaveformCache::Unload()
+{
+	PlaybackCache::Unload();
+
+	// Nothing could be read back without a copy in the cache directory
+	if (!IsSavingEnabled() || !DiskManager::instance() || unloaded_) {
+		return;
+	}
+
+	if (save_pending_) {
+		// The waveform is about to be replaced, so the save can have it rather than a copy
+		save_timer_->stop();
+		save_future_.waitForFinished();
+		save_pending_ = false;
+		StartSave(waveforms_);
+	}
+
+	waveforms_ = std::make_shared<AudioVisualWaveform>();
+	waveforms_->set_channel_count(params_.channel_count());
+
+	unloaded_ = true;
+}
+
+void AudioWaveformCache::StateLoadedEvent()
+{
+	LoadWaveform();
+}
+
+void AudioWaveformCache::LoadWaveform()
+{
+	unloaded_ = false;
+
+	// Don't read the file while it's still being written
+	save_future_.waitForFinished();
+
+	TimeRangeList restored;
+
+	QFile f(GetWaveformFilename());
+	if (f.open(QFile::ReadOnly)) {
+		QDataStream s(&f);
+
+		quint32 version;
+		s >> version;
+
+		if (version == kWaveformCacheVersion) {
+			TimeRangeList ranges;
+			int range_count;
+
+			s >> range_count;
+			for (int i = 0; i < range_count && s.status() == QDataStream::Ok;
+				 i++) {
+				qint64 in_num, in_den, out_num, out_den;
+
+				s >> in_num >> in_den >> out_num >> out_den;
+
+				if (in_den && out_den) {
+					ranges.insert(TimeRange(rational(in_num, in_den),
+											rational(out_num, out_den)));
+				}
+			}
+
+			AudioVisualWaveform loaded;
+			if (s.status() == QDataStream::Ok && loaded.Load(s)) {
+				*waveforms_ = std::move(loaded);
+				restored = ranges;
+			}
+		}
+	}
+
+	// The state is saved as soon as something is validated while the waveform is saved a little
+	// later, so anything the state has that the waveform file doesn't needs to be summed again
+	TimeRangeList missing = GetValidatedRanges();
+	for (const TimeRange &r : restored) {
+		missing.remove(r);
+	}
+
+	for (const TimeRange &r : missing) {
+		Invalidate(r);
+	}
+}
+
+void AudioWaveformCache::SaveWaveform()
+{
+	// Nothing's been summed since the waveform was unloaded, so the file is already up to date
+	if (unloaded_) {
+		save_pending_ = false;
+		return;
+	}
+
+	if (save_future_.isRunning()) {
+		// Try again once the previous write has had time to finish
+		save_timer_->start();
+		return;
+	}
+
+	save_pending_ = false;
+
+	// Sums keep being written into the waveform on this thread, so the worker gets a copy
+	StartSave(std::make_shared<AudioVisualWaveform>(*waveforms_));
+}
+
+void AudioWaveformCache::StartSave(WaveformPtr waveform)
+{
+	if (!DiskManager::instance()) {
+		return;
+	}
+
+	TimeRangeList ranges;
+	if (HasValidatedRanges()) {
+		if (!FileFunctions::DirectoryIsValid(GetThisCacheDirectory())) {
+			return;
+		}
+		ranges = GetValidatedRanges();
+	}
+
+	save_future_ = QtConcurrent::run(WriteWaveformFile, GetWaveformFilename(),
+									 ranges, waveform);
+}
+
+QString AudioWaveformCache::GetWaveformFilename() const
+{
+	return GetThisCacheDirectory().filePath(QStringLiteral("waveform"));
+}
+
+void AudioWaveformCache::QueueSave()
+{
+	if (IsSavingEnabled()) {
+		save_pending_ = true;
+
+		// Restarts the timer if it's already running. Queued since states can be loaded on the project
+		// loading thread before the cache is moved to the main thread.
+		QMetaObject::invokeMethod(save_timer_, "start", Qt::QueuedConnection);
+	}
+}
+
 }
@@ -22,6 +22,9 @@
 #ifndef AUDIOWAVEFORMCACHE_H
 #define AUDIOWAVEFORMCACHE_H
 
+#include <QFuture>
+#include <QTimer>
+
 #include "audio/audiovisualwaveform.h"
 #include "playbackcache.h"
 
@@ -57,12 +60,57 @@ public:
 
 	virtual void SetPassthrough(PlaybackCache *cache) override;
 
+	virtual ~AudioWaveformCache() override;
+
+	/**
+   * @brief Frees the waveform, it's read back from the cache directory when it's next used
+   */
+	virtual void Unload() override;
+
+	/**
+   * @brief How long after the last change the waveform is written to the cache directory
+   */
+	static const int kSaveDelay = 1000;
+
 protected:
 	virtual void InvalidateEvent(const TimeRange &range) override;
 
+	virtual void StateLoadedEvent() override;
+
+private slots:
+	void SaveWaveform();
+
 private:
 	using WaveformPtr = std::shared_ptr<AudioVisualWaveform>;
 
+	QString GetWaveformFilename() const;
+
+	void QueueSave();
+
+	void LoadWaveform();
+
+	/**
+   * @brief Write `waveform` and the ranges it covers on a worker thread
+   *
+   * Only one write runs at a time, so an older copy never replaces a newer one.
+   */
+	void StartSave(WaveformPtr waveform);
+
+	void EnsureLoaded() const
+	{
+		if (unloaded_) {
+			const_cast<AudioWaveformCache *>(this)->LoadWaveform();
+		}
+	}
+
+	QTimer *save_timer_;
+
+	QFuture<void> save_future_;
+
+	bool save_pending_;
+
+	bool unloaded_;
+
 	WaveformPtr waveforms_;
 
 	AudioParams params_;
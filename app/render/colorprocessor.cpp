@@ -28,6 +28,10 @@
 namespace olive
 {
 
+QMutex ColorProcessor::registry_lock_;
+QHash<QString, ColorProcessor::RegistryEntry> ColorProcessor::registry_;
+std::list<QString> ColorProcessor::registry_lru_;
+
 ColorProcessor::ColorProcessor(ColorManager *config, const QString &input,
 							   const ColorTransform &transform,
 							   Direction direction)
@@ -129,8 +133,69 @@ ColorProcessorPtr ColorProcessor::Create(ColorManager *config,
 										 const ColorTransform &transform,
 										 Direction direction)
 {
-	return std::make_shared<ColorProcessor>(config, input, transform,
-											direction);
+	// Resolve defaults now so the key doesn't depend on whether they were given explicitly
+	const QString output = (transform.output().isEmpty()) ?
+							   config->GetDefaultDisplay() :
+							   transform.output();
+	const QString view =
+		(transform.is_display() && transform.view().isEmpty()) ?
+			config->GetDefaultView(output) :
+			transform.view();
+
+	const QString key =
+		QStringLiteral("%1\n%2\n%3\n%4\n%5\n%6\n%7")
+			.arg(QString::fromUtf8(config->GetConfig()->getCacheID()), input,
+				 output, transform.is_display() ? view : QString(),
+				 transform.look(),
+				 QString::number(transform.is_display()),
+				 QString::number(direction));
+
+	{
+		QMutexLocker locker(&registry_lock_);
+		if (ColorProcessorPtr processor = FindRegistered(key)) {
+			return processor;
+		}
+	}
+
+	// Building the processor is far more expensive than the lookup, so do it without holding up
+	// threads that only need a processor that's already registered
+	ColorProcessorPtr processor =
+		std::make_shared<ColorProcessor>(config, input, transform, direction);
+
+	QMutexLocker locker(&registry_lock_);
+
+	// Another thread may have built the same processor meanwhile, keep handing out the one it registered
+	if (ColorProcessorPtr existing = FindRegistered(key)) {
+		return existing;
+	}
+
+	while (registry_.size() >= kMaximumRegisteredProcessors) {
+		registry_.remove(registry_lru_.front());
+		registry_lru_.pop_front();
+	}
+
+	registry_lru_.push_back(key);
+	registry_.insert(key, { processor, std::prev(registry_lru_.end()) });
+
+	return processor;
+}
+
+ColorProcessorPtr ColorProcessor::FindRegistered(const QString &key)
+{
+	auto it = registry_.find(key);
+	if (it == registry_.end()) {
+		return nullptr;
+	}
+
+	registry_lru_.splice(registry_lru_.end(), registry_lru_, it->lru);
+	return it->processor;
+}
+
+void ColorProcessor::ClearRegistry()
+{
+	QMutexLocker locker(&registry_lock_);
+	registry_.clear();
+	registry_lru_.clear();
 }
 
 ColorProcessorPtr ColorProcessor::Create(OCIO::ConstProcessorRcPtr processor)
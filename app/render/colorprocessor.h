@@ -22,6 +22,10 @@
 #ifndef COLORPROCESSOR_H
 #define COLORPROCESSOR_H
 
+#include <QHash>
+#include <QMutex>
+#include <list>
+
 #include "codec/frame.h"
 #include "common/ocioutils.h"
 #include "render/colortransform.h"
@@ -45,11 +49,20 @@ public:
 
 	DISABLE_COPY_MOVE(ColorProcessor)
 
+	/**
+   * @brief Get a processor for converting `input` with `dest_space`
+   *
+   * Processors are immutable once created, so they're shared process-wide and keyed by the
+   * config's cache ID and every parameter of the transform. Repeated calls with the same
+   * arguments (e.g. once per frame from the renderer) return the same processor.
+   */
 	static ColorProcessorPtr Create(ColorManager *config, const QString &input,
 									const ColorTransform &dest_space,
 									Direction direction = kNormal);
 	static ColorProcessorPtr Create(OCIO::ConstProcessorRcPtr processor);
 
+	static void ClearRegistry();
+
 	OCIO::ConstProcessorRcPtr GetProcessor();
 
 	void ConvertFrame(FramePtr f);
@@ -63,6 +76,25 @@ public:
 	}
 
 private:
+	struct RegistryEntry {
+		ColorProcessorPtr processor;
+		std::list<QString>::iterator lru;
+	};
+
+	/**
+   * @brief Find a registered processor and mark it most recently used, call with registry_lock_ held
+   */
+	static ColorProcessorPtr FindRegistered(const QString &key);
+
+	static const int kMaximumRegisteredProcessors = 256;
+
+	static QMutex registry_lock_;
+
+	static QHash<QString, RegistryEntry> registry_;
+
+	// Keys of registry_, least recently used at the front
+	static std::list<QString> registry_lru_;
+
 	OCIO::ConstProcessorRcPtr processor_;
 
 	OCIO::ConstCPUProcessorRcPtr cpu_processor_;
@@ -0,0 +1,333 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "colorshadercache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "render/videoparams.h"
+
+namespace olive
+{
+
+QMutex ColorShaderCache::lock_;
+QHash<QString, ColorShaderCache::Entry> ColorShaderCache::shaders_;
+std::list<QString> ColorShaderCache::shaders_lru_;
+
+ColorShaderCache::ShaderPtr
+ColorShaderCache::Get(ColorProcessorPtr processor,
+					  const QString &function_name)
+{
+	const QString key = QStringLiteral("%1:%2").arg(
+		QString::fromUtf8(processor->id()), function_name);
+
+	{
+		QMutexLocker locker(&lock_);
+		if (ShaderPtr shader = Find(key)) {
+			return shader;
+		}
+	}
+
+	// Loading or extracting the shader is far more expensive than the lookup, so do it without holding up
+	// threads that only need a shader that's already in memory
+	ShaderPtr shader;
+	const QString filename = GetCacheFilename(key);
+
+	auto loaded = std::make_shared<Shader>();
+	if (Load(filename, key, loaded.get())) {
+		shader = loaded;
+
+		// The modification time marks when a file was last used, see TrimDirectory()
+		QFile file(filename);
+		if (file.open(QFile::ReadWrite)) {
+			file.setFileTime(QDateTime::currentDateTime(),
+							 QFileDevice::FileModificationTime);
+		}
+	} else {
+		shader = Extract(processor, function_name);
+
+		if (shader) {
+			if (Save(filename, key, *shader)) {
+				TrimDirectory(QFileInfo(filename).path(), kMaximumDiskUsage);
+			} else {
+				qWarning() << "Failed to write color shader cache" << filename;
+			}
+		}
+	}
+
+	if (!shader) {
+		return nullptr;
+	}
+
+	QMutexLocker locker(&lock_);
+
+	// Another thread may have made the same shader meanwhile, keep handing out the one it inserted
+	if (ShaderPtr existing = Find(key)) {
+		return existing;
+	}
+
+	while (shaders_.size() >= kMaximumShaders) {
+		shaders_.remove(shaders_lru_.front());
+		shaders_lru_.pop_front();
+	}
+
+	shaders_lru_.push_back(key);
+	shaders_.insert(key, { shader, std::prev(shaders_lru_.end()) });
+
+	return shader;
+}
+
+ColorShaderCache::ShaderPtr ColorShaderCache::Find(const QString &key)
+{
+	auto it = shaders_.find(key);
+	if (it == shaders_.end()) {
+		return nullptr;
+	}
+
+	shaders_lru_.splice(shaders_lru_.end(), shaders_lru_, it->lru);
+	return it->shader;
+}
+
+ColorShaderCache::ShaderPtr
+ColorShaderCache::Extract(ColorProcessorPtr processor,
+						  const QString &function_name)
+{
+	auto shader_desc = OCIO::GpuShaderDesc::CreateShaderDesc();
+	shader_desc->setLanguage(OCIO::GPU_LANGUAGE_GLSL_ES_3_0);
+	shader_desc->setFunctionName(function_name.toUtf8());
+	shader_desc->setResourcePrefix("ocio_");
+
+	processor->GetProcessor()->getDefaultGPUProcessor()->extractGpuShaderInfo(
+		shader_desc);
+
+	auto shader = std::make_shared<Shader>();
+
+	shader->text = QString::fromUtf8(shader_desc->getShaderText());
+
+	shader->lut3d.resize(shader_desc->getNum3DTextures());
+	for (unsigned int i = 0; i < shader_desc->getNum3DTextures(); i++) {
+		const char *tex_name = nullptr;
+		const char *sampler_name = nullptr;
+		unsigned int edge_len = 0;
+		OCIO::Interpolation interpolation = OCIO::INTERP_LINEAR;
+
+		shader_desc->get3DTexture(i, tex_name, sampler_name, edge_len,
+								  interpolation);
+
+		if (!tex_name || !*tex_name || !sampler_name || !*sampler_name ||
+			!edge_len) {
+			qCritical() << "3D LUT texture data is corrupted";
+			return nullptr;
+		}
+
+		const float *values = nullptr;
+		shader_desc->get3DTextureValues(i, values);
+		if (!values) {
+			qCritical() << "3D LUT texture values are missing";
+			return nullptr;
+		}
+
+		LUT &lut = shader->lut3d[i];
+		lut.sampler_name = QString::fromUtf8(sampler_name);
+		lut.width = lut.height = lut.depth = edge_len;
+		lut.channel_count = VideoParams::kRGBChannelCount;
+		lut.nearest = (interpolation == OCIO::INTERP_NEAREST);
+		lut.values = QVector<float>(values, values + edge_len * edge_len *
+														 edge_len *
+														 lut.channel_count);
+	}
+
+	shader->lut1d.resize(shader_desc->getNumTextures());
+	for (unsigned int i = 0; i < shader_desc->getNumTextures(); i++) {
+		const char *tex_name = nullptr;
+		const char *sampler_name = nullptr;
+		unsigned int width = 0, height = 0;
+		OCIO::GpuShaderDesc::TextureType channel =
+			OCIO::GpuShaderDesc::TEXTURE_RGB_CHANNEL;
+		OCIO::Interpolation interpolation = OCIO::INTERP_LINEAR;
+		OCIO::GpuShaderDesc::TextureDimensions dimensions =
+			OCIO::GpuShaderDesc::TEXTURE_2D;
+		shader_desc->getTexture(i, tex_name, sampler_name, width, height,
+								channel, dimensions, interpolation);
+
+		if (!tex_name || !*tex_name || !sampler_name || !*sampler_name ||
+			!width) {
+			qCritical() << "1D LUT texture data is corrupted";
+			return nullptr;
+		}
+
+		const float *values = nullptr;
+		shader_desc->getTextureValues(i, values);
+		if (!values) {
+			qCritical() << "1D LUT texture values are missing";
+			return nullptr;
+		}
+
+		LUT &lut = shader->lut1d[i];
+		lut.sampler_name = QString::fromUtf8(sampler_name);
+		lut.width = width;
+		lut.height = height;
+		lut.depth = 1;
+		lut.channel_count =
+			(channel == OCIO::GpuShaderDesc::TEXTURE_RED_CHANNEL) ?
+				1 :
+				VideoParams::kRGBChannelCount;
+		lut.nearest = (interpolation == OCIO::INTERP_NEAREST);
+		lut.values = QVector<float>(values, values + width * height *
+														 lut.channel_count);
+	}
+
+	return shader;
+}
+
+QString ColorShaderCache::GetCacheFilename(const QString &key)
+{
+	QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+
+	return dir.filePath(
+		QStringLiteral("ocioshaders/%1").arg(QString::fromLatin1(
+			QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1)
+				.toHex())));
+}
+
+// OCIO only ever generates a handful of LUTs per shader, anything more means the file is corrupt
+static const quint32 kMaximumLUTCount = 64;
+
+static void WriteLUTs(QDataStream &stream,
+					  const QVector<ColorShaderCache::LUT> &luts)
+{
+	stream << quint32(luts.size());
+	for (const ColorShaderCache::LUT &lut : luts) {
+		stream << lut.sampler_name << qint32(lut.width) << qint32(lut.height)
+			   << qint32(lut.depth) << qint32(lut.channel_count) << lut.nearest
+			   << lut.values;
+	}
+}
+
+static bool ReadLUTs(QDataStream &stream, QVector<ColorShaderCache::LUT> *luts)
+{
+	quint32 count;
+	stream >> count;
+	if (stream.status() != QDataStream::Ok || count > kMaximumLUTCount) {
+		return false;
+	}
+
+	luts->resize(count);
+	for (ColorShaderCache::LUT &lut : *luts) {
+		qint32 width, height, depth, channel_count;
+		stream >> lut.sampler_name >> width >> height >> depth >>
+			channel_count >> lut.nearest >> lut.values;
+
+		lut.width = width;
+		lut.height = height;
+		lut.depth = depth;
+		lut.channel_count = channel_count;
+
+		if (stream.status() != QDataStream::Ok ||
+			lut.values.size() != qint64(width) * height * depth * channel_count) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ColorShaderCache::Save(const QString &filename, const QString &key,
+							const Shader &shader)
+{
+	QDir().mkpath(QFileInfo(filename).path());
+
+	QSaveFile file(filename);
+	if (!file.open(QFile::WriteOnly)) {
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	stream << kCacheVersion << key << shader.text;
+	WriteLUTs(stream, shader.lut3d);
+	WriteLUTs(stream, shader.lut1d);
+
+	return stream.status() == QDataStream::Ok && file.commit();
+}
+
+void ColorShaderCache::TrimDirectory(const QString &path, qint64 max_bytes)
+{
+	// Oldest first
+	const QFileInfoList files = QDir(path).entryInfoList(
+		QDir::Files, QDir::Time | QDir::Reversed);
+
+	qint64 total = 0;
+	for (const QFileInfo &info : files) {
+		total += info.size();
+	}
+
+	for (const QFileInfo &info : files) {
+		if (total <= max_bytes) {
+			break;
+		}
+
+		if (QFile::remove(info.filePath())) {
+			total -= info.size();
+		}
+	}
+}
+
+bool ColorShaderCache::Load(const QString &filename, const QString &key,
+							Shader *shader)
+{
+	QFile file(filename);
+	if (!file.open(QFile::ReadOnly)) {
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+	quint32 version;
+	QString stored_key;
+	stream >> version;
+	if (version != kCacheVersion) {
+		return false;
+	}
+
+	// Guard against hash collisions
+	stream >> stored_key;
+	if (stored_key != key) {
+		return false;
+	}
+
+	stream >> shader->text;
+
+	return ReadLUTs(stream, &shader->lut3d) &&
+		   ReadLUTs(stream, &shader->lut1d);
+}
+
+}
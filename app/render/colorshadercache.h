@@ -0,0 +1,119 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef COLORSHADERCACHE_H
+#define COLORSHADERCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <list>
+#include <memory>
+
+#include "render/colorprocessor.h"
+
+namespace olive
+{
+
+/**
+ * @brief Process-wide cache of the GPU shader code and baked LUTs OCIO generates for a processor
+ *
+ * Extracting GPU shader info from OCIO bakes any LUTs the processor needs, which can take a noticeable amount
+ * of time for complex configs. Every renderer used to repeat this for itself, and again in every session.
+ * Results are now kept in memory for the lifetime of the process and written to the user's cache directory so
+ * later sessions can skip OCIO entirely. The files on disk are kept under kMaximumDiskUsage and the shaders in
+ * memory under kMaximumShaders, in both cases by dropping the least recently used ones.
+ *
+ * Renderers still compile the shader and upload the LUTs themselves since those are tied to a graphics context.
+ */
+class ColorShaderCache {
+public:
+	struct LUT {
+		QString sampler_name;
+		int width = 0;
+		int height = 0;
+		int depth = 0;
+		int channel_count = 0;
+		bool nearest = false;
+		QVector<float> values;
+	};
+
+	struct Shader {
+		QString text;
+		QVector<LUT> lut3d;
+		QVector<LUT> lut1d;
+	};
+
+	using ShaderPtr = std::shared_ptr<const Shader>;
+
+	/**
+   * @brief Get the shader for `processor` using `function_name` as the OCIO function name
+   *
+   * Returns nullptr if OCIO produced invalid data. This function is thread-safe.
+   */
+	static ShaderPtr Get(ColorProcessorPtr processor,
+						 const QString &function_name);
+
+	static bool Save(const QString &filename, const QString &key,
+					 const Shader &shader);
+
+	static bool Load(const QString &filename, const QString &key,
+					 Shader *shader);
+
+	/**
+   * @brief Delete the least recently used files in `path` until the rest take up at most `max_bytes`
+   */
+	static void TrimDirectory(const QString &path, qint64 max_bytes);
+
+	static const qint64 kMaximumDiskUsage = 128LL * 1024LL * 1024LL;
+
+	static const int kMaximumShaders = 256;
+
+private:
+	struct Entry {
+		ShaderPtr shader;
+		std::list<QString>::iterator lru;
+	};
+
+	/**
+   * @brief Find a shader in memory and mark it most recently used, call with lock_ held
+   */
+	static ShaderPtr Find(const QString &key);
+
+	static ShaderPtr Extract(ColorProcessorPtr processor,
+							 const QString &function_name);
+
+	static QString GetCacheFilename(const QString &key);
+
+	static const quint32 kCacheVersion = 1;
+
+	static QMutex lock_;
+
+	static QHash<QString, Entry> shaders_;
+
+	// Keys of shaders_, least recently used at the front
+	static std::list<QString> shaders_lru_;
+};
+
+}
+
+#endif // COLORSHADERCACHE_H
@@ -0,0 +1,413 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "decoderpool.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+
+namespace olive
+{
+
+DecoderPool::DecoderPool(int maximum_instances, Factory factory)
+	: factory_(std::move(factory))
+	, maximum_instances_(qMax(1, maximum_instances))
+{
+}
+
+DecoderPool::~DecoderPool()
+{
+	Clear();
+}
+
+DecoderPtr DecoderPool::Lease(const QString &decoder_id,
+							  const Decoder::CodecStream &stream,
+							  const rational &time, bool *created)
+{
+	if (created) {
+		*created = false;
+	}
+
+	if (!stream.IsValid()) {
+		return nullptr;
+	}
+
+	// Decoders are shared between blocks, so the pool is keyed on the file and stream only
+	Decoder::CodecStream key(stream.filename(), stream.stream(), nullptr);
+
+	qint64 last_modified = GetLastModified(stream.filename());
+
+	std::vector<DecoderPtr> stale;
+	DecoderPtr lease;
+	bool is_new = false;
+
+	{
+		QMutexLocker locker(&mutex_);
+
+		InstanceList &list = pools_[key];
+
+		// Drop idle instances of an older version of the file, leased ones are dropped when they're released
+		for (auto it = list.begin(); it != list.end();) {
+			if (it->last_modified != last_modified && !it->leases) {
+				stale.push_back(it->decoder);
+				it = list.erase(it);
+			} else {
+				it++;
+			}
+		}
+
+		auto nearest = FindNearest(list, time, last_modified, true);
+
+		if (nearest != list.end() &&
+			qAbs((nearest->position - time).toDouble()) <=
+				kMaximumReuseDistance) {
+			// An idle instance is already close by
+			lease = CreateLease(key, *nearest, time);
+		} else if (int(list.size()) < maximum_instances_) {
+			Instance instance;
+			instance.decoder = factory_(decoder_id);
+			instance.last_modified = last_modified;
+			if (instance.decoder) {
+				list.push_back(instance);
+				lease = CreateLease(key, list.back(), time);
+				is_new = true;
+			}
+		} else {
+			if (nearest == list.end()) {
+				// Every instance is busy, share the nearest one
+				nearest = FindNearest(list, time, last_modified, false);
+			}
+
+			if (nearest != list.end()) {
+				lease = CreateLease(key, *nearest, time);
+			}
+		}
+	}
+
+	for (const DecoderPtr &d : stale) {
+		d->Close();
+	}
+
+	if (!lease || !OpenLease(key, stream, lease)) {
+		return nullptr;
+	}
+
+	if (created) {
+		*created = is_new;
+	}
+
+	return lease;
+}
+
+DecoderPtr DecoderPool::LeaseForWarmUp(const QString &decoder_id,
+									   const Decoder::CodecStream &stream,
+									   const rational &time,
+									   qint64 idle_since)
+{
+	if (!stream.IsValid()) {
+		return nullptr;
+	}
+
+	Decoder::CodecStream key(stream.filename(), stream.stream(), nullptr);
+
+	qint64 last_modified = GetLastModified(stream.filename());
+
+	DecoderPtr lease;
+
+	{
+		QMutexLocker locker(&mutex_);
+
+		InstanceList &list = pools_[key];
+
+		auto nearest = FindNearest(list, time, last_modified, true);
+		if (nearest != list.end() &&
+			qAbs((nearest->position - time).toDouble()) <=
+				kMaximumReuseDistance) {
+			// An idle instance is already close by, Lease() will hand out that one
+			return nullptr;
+		}
+
+		if (int(list.size()) < maximum_instances_) {
+			Instance instance;
+			instance.decoder = factory_(decoder_id);
+			instance.last_modified = last_modified;
+			if (instance.decoder) {
+				list.push_back(instance);
+				lease = CreateLease(key, list.back(), time);
+			}
+		} else {
+			// Take over the idle instance that's gone unused the longest. One a render released recently is
+			// probably about to be leased again where it is, so moving it would cost more than it saves.
+			auto oldest = list.end();
+			for (auto it = list.begin(); it != list.end(); it++) {
+				if (it->leases || it->last_modified != last_modified ||
+					it->decoder->GetLastAccessedTime() >= idle_since) {
+					continue;
+				}
+
+				if (oldest == list.end() ||
+					it->decoder->GetLastAccessedTime() <
+						oldest->decoder->GetLastAccessedTime()) {
+					oldest = it;
+				}
+			}
+
+			if (oldest != list.end()) {
+				lease = CreateLease(key, *oldest, time);
+			}
+		}
+	}
+
+	if (!lease || !OpenLease(key, stream, lease)) {
+		return nullptr;
+	}
+
+	return lease;
+}
+
+qint64 DecoderPool::GetLastModified(const QString &filename)
+{
+	qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+	{
+		QMutexLocker locker(&mutex_);
+
+		auto it = modified_.constFind(filename);
+		if (it != modified_.constEnd() &&
+			now - it->checked < kModifiedCheckInterval) {
+			return it->last_modified;
+		}
+	}
+
+	// Stat outside the lock, this can be slow on network storage
+	qint64 last_modified =
+		QFileInfo(filename).lastModified().toMSecsSinceEpoch();
+
+	QMutexLocker locker(&mutex_);
+	modified_.insert(filename, { last_modified, now });
+
+	return last_modified;
+}
+
+void DecoderPool::ClearUnusedSince(qint64 time)
+{
+	std::vector<DecoderPtr> closing;
+
+	{
+		QMutexLocker locker(&mutex_);
+
+		for (auto pool = pools_.begin(); pool != pools_.end();) {
+			InstanceList &list = pool.value();
+
+			for (auto it = list.begin(); it != list.end();) {
+				if (!it->leases && it->decoder->GetLastAccessedTime() < time) {
+					closing.push_back(it->decoder);
+					it = list.erase(it);
+				} else {
+					it++;
+				}
+			}
+
+			if (list.empty()) {
+				pool = pools_.erase(pool);
+			} else {
+				pool++;
+			}
+		}
+
+		// Forget files that are no longer in use so they're checked again next time
+		for (auto it = modified_.begin(); it != modified_.end();) {
+			if (it->checked < time) {
+				it = modified_.erase(it);
+			} else {
+				it++;
+			}
+		}
+	}
+
+	for (const DecoderPtr &d : closing) {
+		d->Close();
+	}
+}
+
+void DecoderPool::Clear()
+{
+	QHash<Decoder::CodecStream, InstanceList> pools;
+
+	{
+		QMutexLocker locker(&mutex_);
+		pools.swap(pools_);
+		modified_.clear();
+	}
+
+	for (const InstanceList &list : qAsConst(pools)) {
+		for (const Instance &instance : list) {
+			instance.decoder->Close();
+		}
+	}
+}
+
+int DecoderPool::GetMaximumInstances() const
+{
+	QMutexLocker locker(&mutex_);
+
+	return maximum_instances_;
+}
+
+void DecoderPool::SetMaximumInstances(int n)
+{
+	QMutexLocker locker(&mutex_);
+
+	// Pools over the new limit shrink as their instances become idle and time out
+	maximum_instances_ = qMax(1, n);
+}
+
+DecoderPool::Stats DecoderPool::GetStats() const
+{
+	Stats s;
+	std::vector<DecoderPtr> decoders;
+
+	{
+		QMutexLocker locker(&mutex_);
+
+		for (const InstanceList &list : pools_) {
+			for (const Instance &instance : list) {
+				decoders.push_back(instance.decoder);
+				if (instance.leases) {
+					s.leased++;
+				}
+			}
+		}
+	}
+
+	// Querying memory locks each decoder, which may be busy decoding, so don't hold the pool while doing it
+	s.instances = int(decoders.size());
+	for (const DecoderPtr &d : decoders) {
+		s.memory_usage += d->GetMemoryUsage();
+	}
+
+	return s;
+}
+
+bool DecoderPool::OpenLease(const Decoder::CodecStream &key,
+							const Decoder::CodecStream &stream,
+							const DecoderPtr &lease)
+{
+	// Open() returns immediately if the instance is already open, and blocks if another thread is opening it
+	if (lease->Open(stream)) {
+		return true;
+	}
+
+	qWarning() << "Failed to open decoder for" << stream.filename()
+			   << "::" << stream.stream();
+
+	QMutexLocker locker(&mutex_);
+	InstanceList &list = pools_[key];
+	for (auto it = list.begin(); it != list.end(); it++) {
+		if (it->decoder.get() == lease.get()) {
+			list.erase(it);
+			break;
+		}
+	}
+
+	return false;
+}
+
+DecoderPtr DecoderPool::CreateLease(const Decoder::CodecStream &stream,
+									Instance &instance, const rational &time)
+{
+	instance.leases++;
+	instance.position = time;
+
+	DecoderPtr decoder = instance.decoder;
+
+	// Alias the pooled decoder so the lease is returned when the caller's last copy goes away
+	return DecoderPtr(decoder.get(), [this, stream, decoder](Decoder *d) {
+		Release(stream, d);
+	});
+}
+
+void DecoderPool::Release(const Decoder::CodecStream &stream,
+						  Decoder *decoder)
+{
+	DecoderPtr stale;
+
+	{
+		QMutexLocker locker(&mutex_);
+
+		auto pool = pools_.find(stream);
+		if (pool == pools_.end()) {
+			return;
+		}
+
+		InstanceList &list = pool.value();
+		for (auto it = list.begin(); it != list.end(); it++) {
+			if (it->decoder.get() == decoder) {
+				it->leases--;
+
+				auto modified = modified_.constFind(stream.filename());
+				if (!it->leases && modified != modified_.constEnd() &&
+					modified->last_modified != it->last_modified) {
+					// File changed while this instance was in use
+					stale = it->decoder;
+					list.erase(it);
+				}
+				break;
+			}
+		}
+	}
+
+	if (stale) {
+		stale->Close();
+	}
+}
+
+DecoderPool::InstanceList::iterator
+DecoderPool::FindNearest(InstanceList &list, const rational &time,
+						 qint64 last_modified, bool idle_only)
+{
+	auto nearest = list.end();
+	double nearest_distance = 0;
+
+	for (auto it = list.begin(); it != list.end(); it++) {
+		if (it->last_modified != last_modified || (idle_only && it->leases)) {
+			continue;
+		}
+
+		double distance = qAbs((it->position - time).toDouble());
+
+		// Decoding forward from a nearby position is much cheaper than seeking back, so prefer instances
+		// that are behind the requested time
+		if (it->position > time) {
+			distance *= 2;
+		}
+
+		if (nearest == list.end() || distance < nearest_distance) {
+			nearest = it;
+			nearest_distance = distance;
+		}
+	}
+
+	return nearest;
+}
+
+}
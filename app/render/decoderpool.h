@@ -0,0 +1,160 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef DECODERPOOL_H
+#define DECODERPOOL_H
+
+#include <functional>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <vector>
+
+#include "codec/decoder.h"
+
+namespace olive
+{
+
+/**
+ * @brief Shared pool of open decoders per (file, stream)
+ *
+ * Decoders used to be cached per block, so every clip cut from the same source opened its own demuxer, codec
+ * context, threads and frame cache. A heavily cut timeline could end up with dozens of decoders per file.
+ *
+ * The pool keeps up to GetMaximumInstances() decoders per (file, stream). Lease() hands out the idle instance
+ * whose last requested time is nearest to the new one, so playback over a cut keeps using the instance that's
+ * already positioned there and only distant jumps open another. Once the maximum is reached, instances are
+ * shared (decoders are thread-safe).
+ *
+ * The file's modification time is only checked once per kModifiedCheckInterval rather than on every frame.
+ * All functions are thread-safe.
+ */
+class DecoderPool {
+public:
+	using Factory = std::function<DecoderPtr(const QString &decoder_id)>;
+
+	struct Stats {
+		/// Open decoder instances across all files
+		int instances = 0;
+
+		/// Instances currently leased by a render
+		int leased = 0;
+
+		/// Bytes held by open decoders (see Decoder::GetMemoryUsage())
+		qint64 memory_usage = 0;
+	};
+
+	static const int kDefaultMaximumInstances = 4;
+
+	static const qint64 kModifiedCheckInterval = 1000;
+
+	/// How far (in seconds) an idle instance can be from the requested time before opening another is preferred
+	static const int kMaximumReuseDistance = 2;
+
+	explicit DecoderPool(int maximum_instances = kDefaultMaximumInstances,
+						 Factory factory = Decoder::CreateFromID);
+
+	~DecoderPool();
+
+	/**
+   * @brief Get an open decoder for `stream` that's well placed to decode `time`
+   *
+   * The decoder is returned to the pool when the last copy of the returned pointer is released. Returns nullptr
+   * if a decoder couldn't be opened. If `created` is set, it's set to whether a new instance was opened.
+   */
+	DecoderPtr Lease(const QString &decoder_id,
+					 const Decoder::CodecStream &stream, const rational &time,
+					 bool *created = nullptr);
+
+	/**
+   * @brief Get a decoder that can be positioned at `time` ahead of a render without disturbing other renders
+   *
+   * Never returns an instance that's leased, or one last accessed at or after `idle_since` (a render may
+   * have just released it and want it back where it is). A new instance is opened if the maximum allows.
+   * Returns nullptr if an idle instance is already close to `time` or no instance is free to move.
+   */
+	DecoderPtr LeaseForWarmUp(const QString &decoder_id,
+							  const Decoder::CodecStream &stream,
+							  const rational &time, qint64 idle_since);
+
+	/**
+   * @brief Get the modification time of `filename`, checking the file at most once per kModifiedCheckInterval
+   */
+	qint64 GetLastModified(const QString &filename);
+
+	/**
+   * @brief Close idle instances that haven't been used since `time`
+   */
+	void ClearUnusedSince(qint64 time);
+
+	void Clear();
+
+	int GetMaximumInstances() const;
+
+	void SetMaximumInstances(int n);
+
+	Stats GetStats() const;
+
+private:
+	struct Instance {
+		DecoderPtr decoder;
+		rational position;
+		qint64 last_modified = 0;
+		int leases = 0;
+	};
+
+	struct Modified {
+		qint64 last_modified = 0;
+		qint64 checked = 0;
+	};
+
+	using InstanceList = std::vector<Instance>;
+
+	DecoderPtr CreateLease(const Decoder::CodecStream &stream,
+						   Instance &instance, const rational &time);
+
+	/**
+   * @brief Open a lease's decoder, dropping its instance from the pool if that fails
+   */
+	bool OpenLease(const Decoder::CodecStream &key,
+				   const Decoder::CodecStream &stream, const DecoderPtr &lease);
+
+	void Release(const Decoder::CodecStream &stream, Decoder *decoder);
+
+	static InstanceList::iterator FindNearest(InstanceList &list,
+											  const rational &time,
+											  qint64 last_modified,
+											  bool idle_only);
+
+	Factory factory_;
+
+	int maximum_instances_;
+
+	mutable QMutex mutex_;
+
+	QHash<Decoder::CodecStream, InstanceList> pools_;
+
+	QHash<QString, Modified> modified_;
+};
+
+}
+
+#endif // DECODERPOOL_H
@@ -0,0 +1,182 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "decoderwarmer.h"
+
+#include <QDateTime>
+
+#include "node/block/clip/clip.h"
+#include "node/project/footage/footage.h"
+#include "node/project/sequence/sequence.h"
+
+namespace olive
+{
+
+DecoderWarmer::DecoderWarmer(DecoderPool *pool)
+	: pool_(pool)
+{
+	threads_.setMaxThreadCount(kThreadCount);
+}
+
+DecoderWarmer::~DecoderWarmer()
+{
+	threads_.clear();
+	threads_.waitForDone();
+}
+
+void DecoderWarmer::Update(ViewerOutput *viewer, const rational &playhead,
+						   int speed, int divider)
+{
+	Sequence *sequence = dynamic_cast<Sequence *>(viewer);
+	if (!sequence || speed <= 0) {
+		return;
+	}
+
+	// Window is in sequence time, so it covers more of the sequence at faster playback speeds
+	rational limit = playhead + rational(kWindow * speed);
+	VideoParams sequence_params = sequence->GetVideoParams();
+
+	QSet<Block *> in_window;
+
+	for (Track *track : sequence->GetTracks()) {
+		if (track->IsMuted()) {
+			continue;
+		}
+
+		for (Block *b = track->NearestBlockAfter(playhead);
+			 b && b->in() <= limit; b = b->next()) {
+			ClipBlock *clip = dynamic_cast<ClipBlock *>(b);
+			if (!clip || !clip->is_enabled()) {
+				continue;
+			}
+
+			in_window.insert(b);
+
+			if (warmed_.contains(b)) {
+				continue;
+			}
+
+			Footage *footage = dynamic_cast<Footage *>(clip->connected_viewer());
+			if (!footage || !footage->IsValid()) {
+				continue;
+			}
+
+			Request r;
+			r.decoder_id = footage->decoder();
+			r.filename = footage->filename();
+
+			// Keep the decoder from being closed as inactive before the playhead gets to it
+			r.keep_alive =
+				(b->in() - playhead).toDouble() * 1000 / speed;
+
+			if (track->type() == Track::kVideo) {
+				VideoParams vp = footage->GetFirstEnabledVideoStream();
+
+				// Stills are cheap to open and sequences are prefetched by OIIOSequenceReader
+				if (!vp.is_valid() ||
+					vp.video_type() != VideoParams::kVideoTypeVideo) {
+					continue;
+				}
+
+				r.stream = vp.stream_index();
+				r.video = true;
+				r.time = GetFirstFrameTime(clip->media_range(), clip->reverse(),
+										   vp.frame_rate_as_time_base());
+
+				// A different divider than playback asks for would make the decoder reopen at the new one
+				r.divider =
+					GetFootageDivider(vp, sequence_params, divider);
+			} else if (track->type() == Track::kAudio) {
+				AudioParams ap = footage->GetFirstEnabledAudioStream();
+				if (!ap.is_valid()) {
+					continue;
+				}
+
+				r.stream = ap.stream_index();
+				r.video = false;
+				r.time = GetFirstFrameTime(clip->media_range(), clip->reverse(),
+										   rational(1, ap.sample_rate()));
+				r.divider = 1;
+			} else {
+				continue;
+			}
+
+			warmed_.insert(b);
+			threads_.start([this, r] { Warm(r); });
+		}
+	}
+
+	// Anything that's no longer ahead of the playhead can be warmed again if we come back to it
+	warmed_ = in_window;
+}
+
+void DecoderWarmer::Reset()
+{
+	threads_.clear();
+	warmed_.clear();
+}
+
+rational DecoderWarmer::GetFirstFrameTime(const TimeRange &media_range,
+										 bool reverse,
+										 const rational &timebase)
+{
+	if (!reverse) {
+		return media_range.in();
+	}
+
+	return qMax(media_range.in(), media_range.out() - timebase);
+}
+
+int DecoderWarmer::GetFootageDivider(const VideoParams &footage,
+									 VideoParams sequence, int divider)
+{
+	if (divider > sequence.divider()) {
+		sequence.set_divider(divider);
+	}
+
+	if (sequence.divider() <= 1) {
+		return 1;
+	}
+
+	return std::min(VideoParams::GetDividerForTargetResolution(
+						footage.width(), footage.height(),
+						sequence.effective_width(), sequence.effective_height()),
+					sequence.divider());
+}
+
+void DecoderWarmer::Warm(const Request &r)
+{
+	DecoderPtr decoder = pool_->LeaseForWarmUp(
+		r.decoder_id, Decoder::CodecStream(r.filename, r.stream, nullptr),
+		r.time, QDateTime::currentMSecsSinceEpoch() - kIdleTime);
+
+	if (!decoder) {
+		return;
+	}
+
+	if (r.video) {
+		decoder->PrepareVideo(r.time, r.divider);
+	}
+
+	decoder->IncrementAccessTime(r.keep_alive);
+}
+
+}
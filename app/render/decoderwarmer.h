@@ -0,0 +1,117 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef DECODERWARMER_H
+#define DECODERWARMER_H
+
+#include <QSet>
+#include <QThreadPool>
+
+#include "node/output/viewer/viewer.h"
+#include "render/decoderpool.h"
+
+namespace olive
+{
+
+class Block;
+
+/**
+ * @brief Opens and seeks decoders for clips just ahead of the playhead
+ *
+ * Decoders are opened lazily on the render thread the first time a clip is rendered, so every cut during
+ * playback paid for opening the file, probing its streams, opening the codec and decoding from the nearest
+ * keyframe, which showed up as a hitch.
+ *
+ * While a viewer is playing forward, Update() looks for clips starting within kWindow of the playhead and
+ * prepares a decoder for each at the clip's first frame on a background thread. Only new instances or ones no
+ * render has used for kIdleTime are prepared (see DecoderPool::LeaseForWarmUp()), so a decoder that's busy with
+ * playback is never seeked away. When playback reaches the clip, the pool hands the render thread that same,
+ * already positioned, instance.
+ *
+ * Update() must be called from the main thread.
+ */
+class DecoderWarmer {
+public:
+	/// How far ahead of the playhead (in seconds of sequence time) clips are warmed up
+	static const int kWindow = 3;
+
+	static const int kThreadCount = 2;
+
+	/// How long (in milliseconds) a decoder must have gone unused before it may be moved to warm up another clip
+	static const qint64 kIdleTime = 2000;
+
+	explicit DecoderWarmer(DecoderPool *pool);
+
+	~DecoderWarmer();
+
+	/**
+   * @brief Warm up decoders for clips coming up after `playhead`
+   *
+   * `speed` is the playback speed, nothing is done unless it's positive. `divider` is the divider playback
+   * frames are being rendered at, if it's higher than the sequence's own (see ViewerPlaybackScheduler).
+   */
+	void Update(ViewerOutput *viewer, const rational &playhead, int speed,
+				int divider = 0);
+
+	/**
+   * @brief Time of the first frame a clip shows, `timebase` being the length of one frame (or sample)
+   *
+   * That's the start of the media range, or for reversed clips the last frame before its exclusive end.
+   */
+	static rational GetFirstFrameTime(const TimeRange &media_range,
+									  bool reverse, const rational &timebase);
+
+	/**
+   * @brief Divider footage with `footage` parameters is decoded at in a sequence with `sequence` parameters
+   *
+   * Matches what Footage asks the decoder for, including a playback `divider` above the sequence's.
+   */
+	static int GetFootageDivider(const VideoParams &footage,
+								 VideoParams sequence, int divider);
+
+	/**
+   * @brief Forget which clips were warmed up (e.g. when playback stops)
+   */
+	void Reset();
+
+private:
+	struct Request {
+		QString decoder_id;
+		QString filename;
+		int stream;
+		bool video;
+		int divider;
+		rational time;
+		qint64 keep_alive;
+	};
+
+	void Warm(const Request &r);
+
+	DecoderPool *pool_;
+
+	QThreadPool threads_;
+
+	QSet<Block *> warmed_;
+};
+
+}
+
+#endif // DECODERWARMER_H
@@ -36,6 +36,24 @@ public:
 	{
 		Insert(row);
 	}
+
+	/**
+   * @brief Key for everything the generated frame depends on besides its parameters
+   *
+   * If set, renderers may reuse a frame previously generated with the same key rather than generating it again.
+   */
+	const QString &GetCacheKey() const
+	{
+		return cache_key_;
+	}
+
+	void SetCacheKey(const QString &key)
+	{
+		cache_key_ = key;
+	}
+
+private:
+	QString cache_key_;
 };
 
 }
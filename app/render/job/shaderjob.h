@@ -101,7 +101,7 @@ public:
 		vertex_overrides_ = vertex_coords;
 	}
 
-	const QVector<float> &GetVertexCoordinates()
+	const QVector<float> &GetVertexCoordinates() const
 	{
 		return vertex_overrides_;
 	}
@@ -396,6 +396,13 @@ void OpenGLRenderer::Flush()
 	}
 }
 
+void OpenGLRenderer::Finish()
+{
+	GL_PREAMBLE;
+
+	functions_->glFinish();
+}
+
 Color OpenGLRenderer::GetPixelFromTexture(Texture *texture, const QPointF &pt)
 {
 	AttachTextureAsDestination(texture->id());
@@ -461,8 +468,18 @@ void OpenGLRenderer::Blit(QVariant s, AcceleratedJob& a_job, Texture *destinatio
 			// This variable is used in the shader, let's set it
 			const NodeValue &value = it.value();
 
-			// Arrays are not currently supported in this system
+			// Only float arrays (e.g. precomputed kernel weights) are currently supported in this system
 			if (value.array()) {
+				if (value.type() == NodeValue::kFloat) {
+					NodeValueArray arr = value.toArray();
+					QVector<GLfloat> floats;
+					floats.reserve(arr.size());
+					for (auto a = arr.cbegin(); a != arr.cend(); a++) {
+						floats.append(a->second.toDouble());
+					}
+					functions_->glUniform1fv(variable_location, floats.size(),
+											 floats.constData());
+				}
 				continue;
 			}
 
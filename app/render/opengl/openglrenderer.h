@@ -68,6 +68,8 @@ public:
 
 	virtual void Flush() override;
 
+	virtual void Finish() override;
+
 	virtual Color GetPixelFromTexture(olive::Texture *texture,
 									  const QPointF &pt) override;
 
@@ -44,13 +44,54 @@ void PlaybackCache::Invalidate(const TimeRange &r)
 
 	InvalidateEvent(r);
 
-	emit Invalidated(r);
+	QMutexLocker locker(mutex());
 
-	if (saving_enabled_) {
+	pending_invalidated_.insert(r);
+
+	if (!flush_queued_) {
+		flush_queued_ = true;
+		QMetaObject::invokeMethod(this, &PlaybackCache::FlushInvalidations,
+								  Qt::QueuedConnection);
+	}
+}
+
+void PlaybackCache::FlushInvalidations()
+{
+	TimeRangeList ranges;
+
+	{
+		QMutexLocker locker(mutex());
+
+		flush_queued_ = false;
+
+		ranges = pending_invalidated_;
+		pending_invalidated_.clear();
+	}
+
+	for (const TimeRange &r : ranges) {
+		emit Invalidated(r);
+	}
+
+	if (saving_enabled_ && !ranges.isEmpty()) {
 		SaveState();
 	}
 }
 
+void PlaybackCache::Unload()
+{
+	bool flush;
+	{
+		QMutexLocker locker(mutex());
+		flush = !pending_invalidated_.isEmpty();
+	}
+
+	if (flush) {
+		FlushInvalidations();
+	}
+
+	requested_ = TimeRangeList();
+}
+
 Node *PlaybackCache::parent() const
 {
 	return dynamic_cast<Node *>(QObject::parent());
@@ -130,6 +171,8 @@ void PlaybackCache::LoadState()
 		f.close();
 
 		last_loaded_state_ = file_time;
+
+		StateLoadedEvent();
 	}
 }
 
@@ -266,6 +309,7 @@ PlaybackCache::PlaybackCache(QObject *parent)
 	: QObject(parent)
 	, saving_enabled_(true)
 	, last_loaded_state_(0)
+	, flush_queued_(false)
 {
 	uuid_ = QUuid::createUuid();
 }
@@ -104,6 +104,14 @@ public:
 
 	virtual void SetPassthrough(PlaybackCache *cache);
 
+	/**
+   * @brief Free anything held in memory that can be read back from the cache directory
+   *
+   * Batched invalidations are written out and outstanding requests are dropped, since no panel is
+   * waiting for them anymore. Subclasses holding more than validated ranges free it too.
+   */
+	virtual void Unload();
+
 	QMutex *mutex()
 	{
 		return &mutex_;
@@ -150,6 +158,9 @@ signals:
 
 	void CancelAll();
 
+private slots:
+	void FlushInvalidations();
+
 protected:
 	void Validate(const TimeRange &r, bool signal = true);
 
@@ -163,6 +174,16 @@ protected:
 	{
 	}
 
+	/**
+   * @brief Called once LoadState() has read the validated ranges
+   *
+   * Caches that keep data outside the state file can use this to invalidate anything they
+   * couldn't restore.
+   */
+	virtual void StateLoadedEvent()
+	{
+	}
+
 	Project *GetProject() const;
 
 private:
@@ -180,6 +201,12 @@ private:
 	std::vector<Passthrough> passthroughs_;
 
 	qint64 last_loaded_state_;
+
+	// Ranges invalidated since the last FlushInvalidations(). Signalling and saving state are batched
+	// so a burst of edits (e.g. dragging a parameter) only emits one Invalidated per range per
+	// event loop iteration instead of one per edit. Both are guarded by mutex().
+	TimeRangeList pending_invalidated_;
+	bool flush_queued_;
 };
 
 }
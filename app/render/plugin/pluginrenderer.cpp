@@ -42,6 +42,7 @@
 #define GL_PREAMBLE //QMutexLocker __l(&global_opengl_mutex);
 #include "pluginrenderer.h"
 #include "pluginSupport/OliveClip.h"
+#include "pluginSupport/instancepool.h"
 #include "pluginSupport/OlivePluginInstance.h"
 #include "common/ffmpegutils.h"
 #include "ofxhParam.h"
@@ -906,16 +907,17 @@ static olive::AVFramePtr ConvertFrameIfNeeded(olive::AVFramePtr src,
 		return src;
 	}
 
+	// Textures are allocated at the effective (divided) size, so that's what the frame has to be uploaded at
 	if (src->format == dst_fmt &&
-		src->width == dst_params.width() &&
-		src->height == dst_params.height()) {
+		src->width == dst_params.effective_width() &&
+		src->height == dst_params.effective_height()) {
 		return src;
 	}
 
 	olive::AVFramePtr dst = olive::CreateAVFramePtr();
 	dst->format = dst_fmt;
-	dst->width = dst_params.width();
-	dst->height = dst_params.height();
+	dst->width = dst_params.effective_width();
+	dst->height = dst_params.effective_height();
 	if (av_frame_get_buffer(dst.get(), 0) < 0) {
 		return src;
 	}
@@ -1036,11 +1038,17 @@ static olive::AVFramePtr ConvertFrameIfNeeded(olive::AVFramePtr src,
 		return true;
 	};
 
+	// The hand-written conversions below only convert formats, anything that needs scaling (e.g. a full
+	// resolution image from a plugin rendering a preview) goes through swscale
+	const bool same_size =
+		src->width == dst->width && src->height == dst->height;
+
 	const int dst_float_channels = float_channels(dst_fmt);
 	if (dst_float_channels > 0) {
 		int src_channels = 0;
 		int bytes_per_component = 0;
-		if (dst_packed_info(static_cast<AVPixelFormat>(src->format),
+		if (same_size &&
+			dst_packed_info(static_cast<AVPixelFormat>(src->format),
 							&src_channels, &bytes_per_component)) {
 			if (float_dst_from_packed(src, dst_fmt, dst)) {
 				return dst;
@@ -1079,7 +1087,7 @@ static olive::AVFramePtr ConvertFrameIfNeeded(olive::AVFramePtr src,
 
 	const int src_float_channels = float_channels(
 		static_cast<AVPixelFormat>(src->format));
-	if (src_float_channels > 0) {
+	if (src_float_channels > 0 && same_size) {
 		int dst_channels = 0;
 		int bytes_per_component = 0;
 		if (dst_packed_info(dst_fmt, &dst_channels, &bytes_per_component) &&
@@ -1340,10 +1348,23 @@ static olive::AVFramePtr DownloadTextureToFrame(const olive::TexturePtr &tex)
 void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::PluginJob& job,
 					  olive::TexturePtr destination,
 					  olive::VideoParams destination_params,
-					  bool clear_destination, bool interactive)
+					  bool clear_destination, bool interactive,
+					  const SequenceRange &sequence)
 {
-	auto instance=job.pluginInstance();
+	// Render threads each lease their own instance of the node so they don't trample on each other's
+	// parameters and clips; jobs without a node render the job's instance directly
+	InstancePool::Lease lease;
+	OFX::Host::ImageEffect::Instance *instance = nullptr;
+	if (PluginNode *node = job.node()) {
+		if (InstancePool *pool = node->render_instances()) {
+			lease = pool->Acquire();
+			instance = lease.get();
+		}
+	} else {
+		instance = job.pluginInstance();
+	}
 	if (!instance) {
+		MarkRenderFailure(destination);
 		return;
 	}
 	bool supports_opengl = false;
@@ -1362,18 +1383,21 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 		olive_instance->setVideoParam(destination_params);
 	}
 
-	// current render scale of 1
+	// Previews at a fraction of the resolution are rendered at that fraction by plugins that can take images
+	// of differing sizes, instead of processing full resolution buffers
 	OfxPointD renderScale;
 	renderScale.x = renderScale.y = 1.0;
-
-
-	int numFramesToRender=1;
+	if (destination_params.divider() > 1 &&
+		instance->getDescriptor().supportsMultiResolution()) {
+		renderScale.x = renderScale.y = 1.0 / destination_params.divider();
+	}
 
 	// Output Clip
 	OliveClipInstance *output_clip=dynamic_cast<plugin::OliveClipInstance *>(instance->getClip("Output"));
 	if (!output_clip) {
 		return;
 	}
+	output_clip->setRenderScale(renderScale);
 
 	// ensure the instance was created
 	OfxStatus stat = kOfxStatOK;
@@ -1389,6 +1413,11 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 
 	OfxTime frame = job.time_seconds();
 
+	// Pooled instances aren't bound to the node, copy this frame's parameter values into them
+	if (lease) {
+		ApplyParamOverrides(*instance, job.GetValues(), frame);
+	}
+
 	const auto &clips = olive_instance->getDescriptor().getClips();
 	QString effect_input_id;
 	if (const auto *node = job.node()) {
@@ -1417,6 +1446,7 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 		if (!input_clip) {
 			continue;
 		}
+		input_clip->setRenderScale(renderScale);
 		const QString clip_key = QString::fromStdString(entry.first);
 		TexturePtr input_tex = nullptr;
 		if (!effect_input_id.isEmpty() && clip_key == effect_input_id &&
@@ -1476,8 +1506,8 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 	// on a real host, these will be the regions of each input clip that the
 	// effect needs to render a given frame (clipped to the RoD).
 	//
-	// In our example we are doing full frame fetches regardless.
-	
+	// Input images only cover these regions, see OliveClipInstance::setRegionOfInterest().
+
 
 	// set correct format for input
 	for (const auto &entry : input_clips) {
@@ -1490,13 +1520,7 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 		}
 		const QString clip_key = QString::fromStdString(entry.first);
 		TexturePtr input_tex = input_textures[entry.first];
-		if (!use_opengl) {
-			AVFramePtr ptr =
-				ReadbackTextureToFrame(input_tex, input_tex->params());
-			input_tex->handleFrame(ptr);
-		}
 		if (is_usable_input(input_tex)) {
-			input_textures[entry.first] = input_tex;
 			std::string bitdepth = input_clip->getProps()
 				.getStringProperty(kOfxImageEffectPropPixelDepth);
 			std::string component = input_clip->getProps()
@@ -1504,14 +1528,15 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 			VideoParams params = input_tex->params();
 			params.set_format(PixelFormat::from_ofx(bitdepth));
 			params.set_channel_count(component);
-			ConvertTextureForParams(input_tex, params);
 			OfxRectD rod;
 			rod.x1 = 0;
 			rod.y1 = 0;
 			rod.x2 = params.width() * params.pixel_aspect_ratio().toDouble();
 			rod.y2 = params.height();
 			input_clip->setRegionOfDefinition(rod, frame);
-			input_clip->setInputTexture(input_tex,frame);
+
+			// The clip only downloads and converts to the plugin's format if the plugin fetches the image
+			input_clip->setInputTexture(input_tex, frame, params);
 			input_clips[entry.first] = input_clip;
 		}
 	}
@@ -1523,6 +1548,11 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 		MarkRenderFailure(destination);
 		return;
 	}
+	for (const auto &entry : rois) {
+		if (auto *input_clip = dynamic_cast<OliveClipInstance *>(entry.first)) {
+			input_clip->setRegionOfInterest(entry.second, frame);
+		}
+	}
 	// set correct format for output
 	VideoParams output_params = destination_params; // params for plugin
 	std::string bitdepth =
@@ -1535,20 +1565,43 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 
 	// The render window is in pixel coordinates
 	// ie: render scale and a PAR of not 1
-	OfxRectI renderWindow;
-	renderWindow.x1 = renderWindow.y1 = 0;
-	renderWindow.x2 = destination_params.width();
-	renderWindow.y2 = destination_params.height();
+	OfxRectI renderWindow = output_clip->getPixelRegionOfDefinition(frame);
 
-	
-	stat = instance->beginRenderAction(frame, numFramesToRender,
-		1.0, false, renderScale, true,
-		interactive);
+	// Frames of an export or playback run share one sequence render, which stays open on the instance until
+	// it's asked to render something else. Anything else is a sequence of its own.
+	const bool in_sequence = olive_instance && sequence.IsValid() &&
+							 frame >= sequence.start && frame <= sequence.end;
+
+	// Steps are in seconds like the times, a lone frame steps by its own duration just like a sequence does
+	OfxTime frame_step = sequence.IsValid() ?
+							 sequence.step :
+							 destination_params.frame_rate_as_time_base().toDouble();
+	if (!(frame_step > 0.0)) {
+		frame_step = 1.0;
+	}
+
+	if (in_sequence) {
+		stat = olive_instance->ensureSequenceRender(sequence.start, sequence.end,
+													sequence.step, interactive,
+													renderScale);
+	} else {
+		if (olive_instance) {
+			olive_instance->endSequenceRender();
+		}
+		stat = instance->beginRenderAction(frame, frame, frame_step, interactive,
+										   renderScale, true, interactive);
+	}
 	if (stat != kOfxStatOK && stat != kOfxStatReplyDefault) {
 		LogOfxFailure("beginRender", stat, instance);
 		MarkRenderFailure(destination);
 		return;
 	}
+	auto end_render = [&]() {
+		if (!in_sequence) {
+			instance->endRenderAction(frame, frame, frame_step, interactive,
+									  renderScale, true, interactive);
+		}
+	};
 
 #ifdef OFX_SUPPORTS_OPENGLRENDER
 	if (use_opengl) {
@@ -1563,11 +1616,18 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 			<< "OFX render skipped due to invalid output params for plugin="
 			<< PluginIdForInstance(instance);
 		MarkRenderFailure(destination);
-		instance->endRenderAction(frame, numFramesToRender, 1.0, interactive,
-								  renderScale, true, interactive);
+		end_render();
 		return;
 	}
 
+	// CPU plugins may fetch their inputs from threads of their own, download the textures while the GL context
+	// is still current here
+	if (!use_opengl) {
+		for (const auto &entry : input_clips) {
+			entry.second->ReadbackInputTexture(frame);
+		}
+	}
+
 	// render a frame
 	const char *render_field = GetRenderFieldForParams(output_params);
 	stat = instance->renderAction(frame, render_field, renderWindow, renderScale,
@@ -1592,8 +1652,7 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 			output_clip->getOutputImage(frame);
 		LogImageProps("output", output_image);
 		MarkRenderFailure(destination);
-		instance->endRenderAction(frame, numFramesToRender, 1.0, interactive,
-								  renderScale, true, interactive);
+		end_render();
 		return;
 	}
 
@@ -1606,8 +1665,7 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 				<< "OFX getOutputImage returned null for plugin="
 				<< PluginIdForInstance(instance);
 			MarkRenderFailure(destination);
-			instance->endRenderAction(frame, numFramesToRender, 1.0, interactive,
-									  renderScale, true, interactive);
+			end_render();
 			return;
 		}
 		} else {
@@ -1616,8 +1674,7 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 			DetachOutputTexture();
 			instance->contextDetachedAction();
 #endif
-			instance->endRenderAction(frame, numFramesToRender, 1.0, interactive,
-									  renderScale, true, interactive);
+			end_render();
 			return;
 		}
 	}
@@ -1630,8 +1687,7 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 			qWarning().noquote()
 				<< "OFX output image conversion failed for plugin="
 				<< PluginIdForInstance(instance);
-			instance->endRenderAction(frame, numFramesToRender, 1.0, interactive,
-							  renderScale, true, interactive);
+			end_render();
 			return;
 		}
 		AVFramePtr converted = ConvertFrameIfNeeded(frame_ptr, destination_params);
@@ -1683,8 +1739,7 @@ void olive::plugin::PluginRenderer::RenderPlugin(TexturePtr src, olive::plugin::
 		}
 	}
 
-	instance->endRenderAction(frame, numFramesToRender, 1.0, interactive, renderScale, true,interactive
-							  );
+	end_render();
 
 }
 
@@ -42,6 +42,21 @@ namespace detail {
 // Purpose: Convert byte stride to pixel stride for texture I/O.
 int BytesToPixels(int byte_linesize, const olive::VideoParams &params);
 }
+// 作用：一次连续渲染（导出、播放）的帧范围，用于 OFX 序列渲染动作。
+// Purpose: Frame range of a run of renders (export, playback) for the OFX
+// begin/end sequence render actions. Times are in seconds like the job's time,
+// `end` is the last frame rendered and `step` one frame's duration. A range
+// without a step is no range at all.
+struct SequenceRange {
+	OfxTime start = 0.0;
+	OfxTime end = 0.0;
+	OfxTime step = 0.0;
+
+	bool IsValid() const
+	{
+		return end >= start && step > 0.0;
+	}
+};
 // 作用：OFX 插件渲染器，负责 CPU/GL 路径下的插件调用和纹理桥接。
 // Purpose: OFX plugin renderer that drives CPU/GL render paths and texture bridging.
 class PluginRenderer : public olive::OpenGLRenderer{
@@ -57,10 +72,13 @@ public:
 	void DetachOutputTexture();
 	// 作用：执行插件渲染流程（参数配置、输入/输出、调用渲染动作）。
 	// Purpose: Execute plugin render flow (params, inputs/outputs, render actions).
+	// Frames inside a valid `sequence` leave the instance's sequence render open
+	// for the next frame, others are bracketed on their own.
 	void RenderPlugin(TexturePtr src, olive::plugin::PluginJob& job,
 					  olive::TexturePtr destination,
 					  olive::VideoParams destination_params,
-					  bool clear_destination, bool interactive);
+					  bool clear_destination, bool interactive,
+					  const SequenceRange &sequence = SequenceRange());
 
 };
 }
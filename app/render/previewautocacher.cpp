@@ -25,6 +25,7 @@
 #include <QtConcurrent/QtConcurrent>
 
 #include "codec/conformmanager.h"
+#include "codec/oiio/oiiosequencereader.h"
 #include "node/input/multicam/multicamnode.h"
 #include "node/inputdragger.h"
 #include "node/project.h"
@@ -44,6 +45,10 @@ PreviewAutoCacher::PreviewAutoCacher(QObject *parent)
 	, display_color_processor_(nullptr)
 	, multicam_(nullptr)
 	, ignore_cache_requests_(false)
+	, decoder_warmer_(nullptr)
+	, playback_viewer_(nullptr)
+	, playback_speed_(0)
+	, playback_divider_(0)
 {
 	copier_ = new ProjectCopier(this);
 	connect(copier_, &ProjectCopier::AddedNode, this,
@@ -72,17 +77,27 @@ PreviewAutoCacher::~PreviewAutoCacher()
 }
 
 RenderTicketPtr PreviewAutoCacher::GetSingleFrame(ViewerOutput *viewer,
-												  const rational &t, bool dry)
+												  const rational &t, bool dry,
+												  int divider,
+												  const TimeRange &sequence_range)
 {
-	return GetSingleFrame(viewer->GetConnectedTextureOutput(), viewer, t, dry);
+	return GetSingleFrame(viewer->GetConnectedTextureOutput(), viewer, t, dry,
+						  divider, sequence_range);
 }
 
 RenderTicketPtr PreviewAutoCacher::GetSingleFrame(Node *n, ViewerOutput *viewer,
-												  const rational &t, bool dry)
+												  const rational &t, bool dry,
+												  int divider,
+												  const TimeRange &sequence_range)
 {
 	// If we have a single frame render queued (but not yet sent to the RenderManager), cancel it now
 	CancelQueuedSingleFrameRender();
 
+	if (viewer == playback_viewer_) {
+		// Playback may render below the sequence's resolution, decoders are warmed up at the same divider
+		playback_divider_ = divider;
+	}
+
 	// Create a new single frame render ticket
 	auto sfr = std::make_shared<RenderTicket>();
 	sfr->Start();
@@ -90,6 +105,8 @@ RenderTicketPtr PreviewAutoCacher::GetSingleFrame(Node *n, ViewerOutput *viewer,
 	sfr->setProperty("dry", dry);
 	sfr->setProperty("node", QtUtils::PtrToValue(n));
 	sfr->setProperty("viewer", QtUtils::PtrToValue(viewer));
+	sfr->setProperty("divider", divider);
+	sfr->setProperty("sequencerange", QVariant::fromValue(sequence_range));
 
 	// Queue it and try to render
 	single_frame_render_ = sfr;
@@ -303,6 +320,13 @@ void PreviewAutoCacher::ConnectToNodeCache(Node *node)
 		return;
 	}
 
+	if (!node->HasCaches()) {
+		// Nothing can be requested from caches that don't exist yet, connect once they're created
+		connect(node, &Node::CachesCreated, this,
+				&PreviewAutoCacher::NodeCachesCreated, Qt::UniqueConnection);
+		return;
+	}
+
 	connect(node->video_frame_cache(), &PlaybackCache::Requested, this,
 			&PreviewAutoCacher::VideoInvalidatedFromCache);
 
@@ -327,8 +351,25 @@ void PreviewAutoCacher::ConnectToNodeCache(Node *node)
 	node->waveform_cache()->ResignalRequests();
 }
 
+void PreviewAutoCacher::NodeCachesCreated()
+{
+	Node *node = static_cast<Node *>(sender());
+
+	disconnect(node, &Node::CachesCreated, this,
+			   &PreviewAutoCacher::NodeCachesCreated);
+
+	ConnectToNodeCache(node);
+}
+
 void PreviewAutoCacher::DisconnectFromNodeCache(Node *node)
 {
+	disconnect(node, &Node::CachesCreated, this,
+			   &PreviewAutoCacher::NodeCachesCreated);
+
+	if (!node->HasCaches()) {
+		return;
+	}
+
 	disconnect(node->video_frame_cache(), &PlaybackCache::Requested, this,
 			   &PreviewAutoCacher::VideoInvalidatedFromCache);
 
@@ -448,9 +489,28 @@ void PreviewAutoCacher::SetPlayhead(const rational &playhead)
 		TimeRange(playhead - OLIVE_CONFIG("DiskCacheBehind").value<rational>(),
 				  playhead + OLIVE_CONFIG("DiskCacheAhead").value<rational>());
 
+	if (decoder_warmer_ && playback_viewer_) {
+		decoder_warmer_->Update(playback_viewer_, playhead, playback_speed_,
+								playback_divider_);
+	}
+
 	TryRender();
 }
 
+void PreviewAutoCacher::SetPlaybackState(ViewerOutput *viewer, int speed)
+{
+	playback_viewer_ = viewer;
+	playback_speed_ = speed;
+	playback_divider_ = 0;
+
+	// Image sequences read ahead in the direction we're playing
+	OIIOSequenceReader::SetPlaybackSpeed(viewer ? speed : 0);
+
+	if (decoder_warmer_ && !viewer) {
+		decoder_warmer_->Reset();
+	}
+}
+
 template <typename T> void CancelTasks(const T &task_list, bool and_wait)
 {
 	for (auto it = task_list.cbegin(); it != task_list.cend(); it++) {
@@ -530,7 +590,8 @@ void PreviewAutoCacher::TryRender()
 			RenderTicketWatcher *watcher = RenderFrame(
 				copy, QtUtils::ValueToPtr<ViewerOutput>(t->property("viewer")),
 				t->property("time").value<rational>(), nullptr,
-				t->property("dry").toBool());
+				t->property("dry").toBool(), t->property("divider").toInt(),
+				t->property("sequencerange").value<TimeRange>(), true);
 			video_immediate_passthroughs_[watcher].append(t);
 		} else {
 			qWarning() << "Failed to find copied node for SFR ticket, requeueing";
@@ -555,7 +616,8 @@ void PreviewAutoCacher::TryRender()
 					rational t;
 					while (running_video_tasks_.size() < max_tasks &&
 						   d.iterator.GetNext(&t)) {
-						RenderFrame(copy, d.context, t, d.cache, false);
+						RenderFrame(copy, d.context, t, d.cache, false, 0,
+									d.range);
 
 						emit SignalCacheProxyTaskProgress(
 							double(d.iterator.frame_index()) /
@@ -627,7 +689,9 @@ RenderTicketWatcher *PreviewAutoCacher::RenderFrame(Node *node,
 													ViewerOutput *context,
 													const rational &time,
 													PlaybackCache *cache,
-													bool dry)
+													bool dry, int divider,
+													const TimeRange &sequence_range,
+													bool interactive)
 {
 	RenderTicketWatcher *watcher = new RenderTicketWatcher();
 	watcher->setProperty("job",
@@ -644,6 +708,10 @@ RenderTicketWatcher *PreviewAutoCacher::RenderFrame(Node *node,
 										 copied_color_manager_,
 										 RenderMode::kOffline);
 
+	if (divider > rvp.video_params.divider()) {
+		rvp.video_params.set_divider(divider);
+	}
+
 	if (FrameHashCache *frame_cache = dynamic_cast<FrameHashCache *>(cache)) {
 		if (ThumbnailCache *wave_cache =
 				dynamic_cast<ThumbnailCache *>(cache)) {
@@ -664,6 +732,9 @@ RenderTicketWatcher *PreviewAutoCacher::RenderFrame(Node *node,
 
 	rvp.return_type = dry ? RenderManager::kNull : RenderManager::kTexture;
 
+	rvp.sequence_range = sequence_range;
+	rvp.interactive = interactive;
+
 	// Allow using cached images for this render job
 	rvp.use_cache = true;
 
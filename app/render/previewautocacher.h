@@ -30,6 +30,7 @@
 #include "node/node.h"
 #include "node/output/viewer/viewer.h"
 #include "node/project.h"
+#include "render/decoderwarmer.h"
 #include "render/projectcopier.h"
 #include "render/renderjobtracker.h"
 #include "render/renderticket.h"
@@ -49,10 +50,22 @@ public:
 
 	virtual ~PreviewAutoCacher() override;
 
+	/**
+   * @brief Render a single frame outside of the cache
+   *
+   * If `divider` is larger than the viewer's own divider, the frame is rendered at that lower resolution instead
+   * (used by playback to trade resolution for speed).
+   *
+   * `sequence_range` is the run of frames this one is part of (e.g. the range being played back), passed on to
+   * OFX plugins. The frame is rendered as interactive, someone is waiting to see it.
+   */
 	RenderTicketPtr GetSingleFrame(ViewerOutput *viewer, const rational &t,
-								   bool dry = false);
+								   bool dry = false, int divider = 0,
+								   const TimeRange &sequence_range = TimeRange());
 	RenderTicketPtr GetSingleFrame(Node *n, ViewerOutput *viewer,
-								   const rational &t, bool dry = false);
+								   const rational &t, bool dry = false,
+								   int divider = 0,
+								   const TimeRange &sequence_range = TimeRange());
 
 	RenderTicketPtr GetRangeOfAudio(ViewerOutput *viewer, TimeRange range);
 
@@ -104,6 +117,18 @@ public:
 		ignore_cache_requests_ = e;
 	}
 
+	void SetDecoderWarmer(DecoderWarmer *warmer)
+	{
+		decoder_warmer_ = warmer;
+	}
+
+	/**
+   * @brief Set the viewer that's currently playing and its speed, or nullptr and 0 when playback stops
+   *
+   * While playing, SetPlayhead() also warms up decoders for clips coming up in `viewer`.
+   */
+	void SetPlaybackState(ViewerOutput *viewer, int speed);
+
 public slots:
 	void SetDisplayColorProcessor(ColorProcessorPtr processor)
 	{
@@ -120,7 +145,9 @@ private:
 
 	RenderTicketWatcher *RenderFrame(Node *node, ViewerOutput *context,
 									 const rational &time, PlaybackCache *cache,
-									 bool dry);
+									 bool dry, int divider = 0,
+									 const TimeRange &sequence_range = TimeRange(),
+									 bool interactive = false);
 
 	RenderTicketPtr RenderAudio(Node *node, ViewerOutput *context,
 								const TimeRange &range, PlaybackCache *cache);
@@ -204,7 +231,21 @@ private:
 
 	bool ignore_cache_requests_;
 
+	DecoderWarmer *decoder_warmer_;
+
+	ViewerOutput *playback_viewer_;
+
+	int playback_speed_;
+
+	// Divider playback frames were last requested at, 0 for the sequence's own
+	int playback_divider_;
+
 private slots:
+	/**
+   * @brief Connects to a node's caches once they're created, see ConnectToNodeCache()
+   */
+	void NodeCachesCreated();
+
 	/**
    * @brief Handler for when the NodeGraph reports a video change over a certain time range
    */
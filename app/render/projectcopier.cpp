@@ -38,10 +38,17 @@ void ProjectCopier::SetProject(Project *project)
 {
 	if (original_) {
 		// Clear current project
+		for (auto it = copy_map_.cbegin(); it != copy_map_.cend(); it++) {
+			disconnect(it.key(), &Node::CachesCreated, this,
+					   &ProjectCopier::QueueCachesCreated);
+		}
+
 		qDeleteAll(created_nodes_);
 		created_nodes_.clear();
 		copy_map_.clear();
 		graph_update_queue_.clear();
+		pending_value_changes_.clear();
+		pending_value_hint_changes_.clear();
 
 		disconnect(original_, &Project::NodeAdded, this,
 				   &ProjectCopier::QueueNodeAdd);
@@ -127,14 +134,19 @@ void ProjectCopier::ProcessUpdateQueue()
 			DoEdgeRemove(job.output, job.input);
 			break;
 		case QueuedJob::kValueChanged:
+			pending_value_changes_.remove(job.input);
 			DoValueChange(job.input);
 			break;
 		case QueuedJob::kValueHintChanged:
+			pending_value_hint_changes_.remove(job.input);
 			DoValueHintChange(job.input);
 			break;
 		case QueuedJob::kProjectSettingChanged:
 			DoProjectSettingChange(job.key, job.value);
 			break;
+		case QueuedJob::kCachesCreated:
+			DoCachesCreated(job.node);
+			break;
 		}
 	}
 
@@ -162,6 +174,16 @@ void ProjectCopier::DoNodeAdd(Node *node)
 	// Copy cache UUIDs
 	copy->CopyCacheUuidsFrom(node);
 
+	// Render threads look for frames already in the copy's cache and can't create it themselves. A
+	// node with nothing cached has nothing to find, so the copy only gets caches once the original
+	// does (e.g. when a viewer first queues a render of it).
+	if (node->HasCaches()) {
+		copy->video_frame_cache();
+	} else {
+		connect(node, &Node::CachesCreated, this,
+				&ProjectCopier::QueueCachesCreated, Qt::UniqueConnection);
+	}
+
 	// Insert into map
 	InsertIntoCopyMap(node, copy);
 
@@ -171,6 +193,9 @@ void ProjectCopier::DoNodeAdd(Node *node)
 
 void ProjectCopier::DoNodeRemove(Node *node)
 {
+	disconnect(node, &Node::CachesCreated, this,
+			   &ProjectCopier::QueueCachesCreated);
+
 	// Find our copy and remove it
 	Node *copy = copy_map_.take(node);
 
@@ -237,6 +262,14 @@ void ProjectCopier::DoProjectSettingChange(const QString &key,
 	copy_->SetSetting(key, value);
 }
 
+void ProjectCopier::DoCachesCreated(Node *node)
+{
+	// Creating them here rather than straight away keeps render threads from seeing half-created caches
+	if (Node *copy = copy_map_.value(node)) {
+		copy->video_frame_cache();
+	}
+}
+
 void ProjectCopier::InsertIntoCopyMap(Node *node, Node *copy)
 {
 	// Insert into map
@@ -258,6 +291,9 @@ void ProjectCopier::QueueNodeAdd(Node *node)
 
 void ProjectCopier::QueueNodeRemove(Node *node)
 {
+	// Any changes made after this point must be queued after the removal, not merged into jobs before it
+	ClearPendingChangesForNode(node);
+
 	graph_update_queue_.push_back({ QueuedJob::kNodeRemoved, node, NodeInput(),
 									nullptr, QString(), QString() });
 	UpdateGraphChangeValue();
@@ -279,14 +315,12 @@ void ProjectCopier::QueueEdgeRemove(Node *output, const NodeInput &input)
 
 void ProjectCopier::QueueValueChange(const NodeInput &input)
 {
-	/*for (auto it = graph_update_queue_.begin(); it != graph_update_queue_.end(); ) {
-    if (it->type == QueuedJob::kValueChanged && it->input == input) {
-      it = graph_update_queue_.erase(it);
-    } else {
-      it++;
-    }
-  }*/
+	if (pending_value_changes_.contains(input)) {
+		// A job for this input is already queued and will pick up this change too
+		return;
+	}
 
+	pending_value_changes_.insert(input);
 	graph_update_queue_.push_back({ QueuedJob::kValueChanged, nullptr, input,
 									nullptr, QString(), QString() });
 	UpdateGraphChangeValue();
@@ -294,6 +328,11 @@ void ProjectCopier::QueueValueChange(const NodeInput &input)
 
 void ProjectCopier::QueueValueHintChange(const NodeInput &input)
 {
+	if (pending_value_hint_changes_.contains(input)) {
+		return;
+	}
+
+	pending_value_hint_changes_.insert(input);
 	graph_update_queue_.push_back({ QueuedJob::kValueHintChanged, nullptr,
 									input, nullptr, QString(), QString() });
 	UpdateGraphChangeValue();
@@ -307,6 +346,19 @@ void ProjectCopier::QueueProjectSettingChange(const QString &key,
 	UpdateGraphChangeValue();
 }
 
+void ProjectCopier::QueueCachesCreated()
+{
+	Node *node = static_cast<Node *>(sender());
+
+	disconnect(node, &Node::CachesCreated, this,
+			   &ProjectCopier::QueueCachesCreated);
+
+	// Caches don't change what the graph renders, so this doesn't count as a graph change
+	graph_update_queue_.push_back({ QueuedJob::kCachesCreated, node,
+									NodeInput(), nullptr, QString(),
+									QString() });
+}
+
 void ProjectCopier::UpdateGraphChangeValue()
 {
 	graph_changed_time_.Acquire();
@@ -317,4 +369,25 @@ void ProjectCopier::UpdateLastSyncedValue()
 	last_update_time_.Acquire();
 }
 
+void ProjectCopier::ClearPendingChangesForNode(Node *node)
+{
+	for (auto it = pending_value_changes_.begin();
+		 it != pending_value_changes_.end();) {
+		if (it->node() == node) {
+			it = pending_value_changes_.erase(it);
+		} else {
+			it++;
+		}
+	}
+
+	for (auto it = pending_value_hint_changes_.begin();
+		 it != pending_value_hint_changes_.end();) {
+		if (it->node() == node) {
+			it = pending_value_hint_changes_.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
 }
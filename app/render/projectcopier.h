@@ -22,11 +22,25 @@
 #ifndef PROJECTCOPIER_H
 #define PROJECTCOPIER_H
 
+#include <QSet>
+
 #include "node/project.h"
 
 namespace olive
 {
 
+/**
+ * @brief Keeps a copy of a project's node graph for render threads to read
+ *
+ * Changes to the original are queued and replayed onto the copy in ProcessUpdateQueue(). The owner
+ * must only call that while no render job is reading the copy, PreviewAutoCacher does so once its
+ * running tasks have finished. Value and hint changes are coalesced per input while queued.
+ *
+ * This is a mutable mirror, not a versioned snapshot: there is one copy at a time, nothing is shared
+ * between copies, and GetLastUpdateTime() is the version render jobs are stamped with and checked against
+ * GetGraphChangeTime() to tell whether their result is still current. Each owner (PreviewAutoCacher,
+ * ExportTask) keeps a full copy of its own.
+ */
 class ProjectCopier : public QObject {
 	Q_OBJECT
 public:
@@ -88,12 +102,15 @@ private:
 	void DoValueChange(const NodeInput &input);
 	void DoValueHintChange(const NodeInput &input);
 	void DoProjectSettingChange(const QString &key, const QString &value);
+	void DoCachesCreated(Node *node);
 
 	void InsertIntoCopyMap(Node *node, Node *copy);
 
 	void UpdateGraphChangeValue();
 	void UpdateLastSyncedValue();
 
+	void ClearPendingChangesForNode(Node *node);
+
 	Project *original_;
 	Project *copy_;
 
@@ -106,7 +123,8 @@ private:
 			kEdgeRemoved,
 			kValueChanged,
 			kValueHintChanged,
-			kProjectSettingChanged
+			kProjectSettingChanged,
+			kCachesCreated
 		};
 
 		Type type;
@@ -119,6 +137,13 @@ private:
 	};
 
 	std::list<QueuedJob> graph_update_queue_;
+
+	// Inputs that already have a value or hint job waiting in the queue. Those jobs copy whatever the
+	// original holds at the time they're processed, so any further changes to the same input before
+	// then can be dropped instead of queueing more work (e.g. every mouse move while dragging).
+	QSet<NodeInput> pending_value_changes_;
+	QSet<NodeInput> pending_value_hint_changes_;
+
 	QHash<Node *, Node *> copy_map_;
 	QHash<Project *, Project *> graph_map_;
 	QVector<Node *> created_nodes_;
@@ -140,6 +165,8 @@ private slots:
 	void QueueValueHintChange(const NodeInput &input);
 
 	void QueueProjectSettingChange(const QString &key, const QString &value);
+
+	void QueueCachesCreated();
 };
 
 }
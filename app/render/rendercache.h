@@ -38,12 +38,6 @@ private:
 	QMutex mutex_;
 };
 
-struct DecoderPair {
-	DecoderPtr decoder = nullptr;
-	qint64 last_modified = 0;
-};
-
-using DecoderCache = RenderCache<Decoder::CodecStream, DecoderPair>;
 using ShaderCache = RenderCache<QString, QVariant>;
 
 }
@@ -26,12 +26,15 @@
 #include <QTimer>
 #include <QVector2D>
 
+#include "render/colorshadercache.h"
+
 namespace olive
 {
 
 Renderer::Renderer(QObject *parent)
 	: QObject(parent)
 	, lifetime_(std::make_shared<RendererLifetime>())
+	, texture_pool_(TexturePool::GetSharedBudget())
 {
 }
 
@@ -49,19 +52,14 @@ TexturePtr Renderer::CreateTexture(const VideoParams &params, const void *data,
 	QVariant v;
 
 	if (USE_TEXTURE_CACHE) {
-		QMutexLocker locker(&texture_cache_lock_);
-		for (auto it = texture_cache_.begin(); it != texture_cache_.end();
-			 it++) {
-			if (it->width == params.effective_width() &&
-				it->height == params.effective_height() &&
-				it->depth == params.effective_depth() &&
-				it->format == params.format() &&
-				it->channel_count == params.channel_count()) {
-				v = it->handle;
-				texture_cache_.erase(it);
-				break;
-			}
+		if (QThread::currentThread() == this->thread()) {
+			DestroyPendingTextures();
 		}
+
+		v = texture_pool_.Acquire(TexturePool::MakeKey(
+			params.effective_width(), params.effective_height(),
+			params.effective_depth(), params.format(),
+			params.channel_count()));
 	}
 
 	if (v.isNull()) {
@@ -99,14 +97,18 @@ void Renderer::DestroyTexture(Texture *texture)
 		//
 		//       Presumably Vulkan would not have this issue because it allows for application-wide
 		//       instances and multithreading.
-		texture_cache_lock_.lock();
-		texture_cache_.push_back(
-			{ texture->params().effective_width(),
-			  texture->params().effective_height(),
-			  texture->params().effective_depth(), texture->params().format(),
-			  texture->params().channel_count(), texture->id(),
-			  QDateTime::currentMSecsSinceEpoch() });
-		texture_cache_lock_.unlock();
+		//
+		//       Textures that the pool evicts are only queued here and destroyed once we're back on
+		//       the renderer's own thread.
+		const VideoParams &p = texture->params();
+		texture_pool_.Release(
+			TexturePool::MakeKey(p.effective_width(), p.effective_height(),
+								 p.effective_depth(), p.format(),
+								 p.channel_count()),
+			texture->id(),
+			qint64(p.effective_width()) * p.effective_height() *
+				p.effective_depth() * p.GetBytesPerPixel(),
+			QDateTime::currentMSecsSinceEpoch());
 
 		if (QThread::currentThread() == this->thread()) {
 			ClearOldTextures();
@@ -173,10 +175,8 @@ void Renderer::Destroy()
 		interlace_texture_.clear();
 	}
 
-	for (auto it = texture_cache_.begin(); it != texture_cache_.end(); it++) {
-		DestroyNativeTexture(it->handle);
-	}
-	texture_cache_.clear();
+	texture_pool_.Clear();
+	DestroyPendingTextures();
 
 	DestroyInternal();
 }
@@ -204,35 +204,31 @@ bool Renderer::GetColorContext(const ColorTransformJob &color_job,
 		color_ctx = color_cache_.value(proc_id);
 		return true;
 	} else {
-		// Create shader description
+		// Generate shader description
 		QString ocio_func_name;
 		if (color_job.GetFunctionName().isEmpty()) {
 			ocio_func_name = "OCIODisplay";
 		} else {
 			ocio_func_name = color_job.GetFunctionName();
 		}
-		auto shader_desc = OCIO::GpuShaderDesc::CreateShaderDesc();
-		shader_desc->setLanguage(OCIO::GPU_LANGUAGE_GLSL_ES_3_0);
-		shader_desc->setFunctionName(ocio_func_name.toUtf8());
-		shader_desc->setResourcePrefix("ocio_");
 
-		// Generate shader
-		color_job.GetColorProcessor()
-			->GetProcessor()
-			->getDefaultGPUProcessor()
-			->extractGpuShaderInfo(shader_desc);
+		ColorShaderCache::ShaderPtr shader = ColorShaderCache::Get(
+			color_job.GetColorProcessor(), ocio_func_name);
+
+		if (!shader) {
+			return false;
+		}
 
 		ShaderCode code;
 		if (const Node *shader_src = color_job.CustomShaderSource()) {
 			// Use shader code from associated node
 			code = shader_src->GetShaderCode(
-				{ color_job.CustomShaderID(), shader_desc->getShaderText() });
+				{ color_job.CustomShaderID(), shader->text });
 		} else {
 			// Generate shader code using OCIO stub and our auto-generated name
 			code = FileFunctions::ReadFileAsString(
 				QStringLiteral(":shaders/colormanage.frag"));
-			code.set_frag_code(
-				code.frag_code().arg(shader_desc->getShaderText()));
+			code.set_frag_code(code.frag_code().arg(shader->text));
 		}
 
 		// Try to compile shader
@@ -242,78 +238,32 @@ bool Renderer::GetColorContext(const ColorTransformJob &color_job,
 			return false;
 		}
 
-		color_ctx.lut3d_textures.resize(shader_desc->getNum3DTextures());
-		for (unsigned int i = 0; i < shader_desc->getNum3DTextures(); i++) {
-			const char *tex_name = nullptr;
-			const char *sampler_name = nullptr;
-			unsigned int edge_len = 0;
-			OCIO::Interpolation interpolation = OCIO::INTERP_LINEAR;
-
-			shader_desc->get3DTexture(i, tex_name, sampler_name, edge_len,
-									  interpolation);
-
-			if (!tex_name || !*tex_name || !sampler_name || !*sampler_name ||
-				!edge_len) {
-				qCritical() << "3D LUT texture data is corrupted";
-				return false;
-			}
-
-			const float *values = nullptr;
-			shader_desc->get3DTextureValues(i, values);
-			if (!values) {
-				qCritical() << "3D LUT texture values are missing";
-				return false;
-			}
+		color_ctx.lut3d_textures.resize(shader->lut3d.size());
+		for (int i = 0; i < shader->lut3d.size(); i++) {
+			const ColorShaderCache::LUT &lut = shader->lut3d.at(i);
 
 			// Allocate 3D LUT
 			color_ctx.lut3d_textures[i].texture = CreateTexture(
-				VideoParams(edge_len, edge_len, edge_len, PixelFormat::F32,
-							VideoParams::kRGBChannelCount),
-				values);
-			color_ctx.lut3d_textures[i].name = sampler_name;
+				VideoParams(lut.width, lut.height, lut.depth, PixelFormat::F32,
+							lut.channel_count),
+				lut.values.constData());
+			color_ctx.lut3d_textures[i].name = lut.sampler_name;
 			color_ctx.lut3d_textures[i].interpolation =
-				(interpolation == OCIO::INTERP_NEAREST) ? Texture::kNearest :
-														  Texture::kLinear;
+				lut.nearest ? Texture::kNearest : Texture::kLinear;
 		}
 
-		color_ctx.lut1d_textures.resize(shader_desc->getNumTextures());
-		for (unsigned int i = 0; i < shader_desc->getNumTextures(); i++) {
-			const char *tex_name = nullptr;
-			const char *sampler_name = nullptr;
-			unsigned int width = 0, height = 0;
-			OCIO::GpuShaderDesc::TextureType channel =
-				OCIO::GpuShaderDesc::TEXTURE_RGB_CHANNEL;
-			OCIO::Interpolation interpolation = OCIO::INTERP_LINEAR;
-			OCIO::GpuShaderDesc::TextureDimensions dimensions =
-				OCIO::GpuShaderDesc::TEXTURE_2D;
-			shader_desc->getTexture(i, tex_name, sampler_name, width, height,
-									channel, dimensions, interpolation);
-
-			if (!tex_name || !*tex_name || !sampler_name || !*sampler_name ||
-				!width) {
-				qCritical() << "1D LUT texture data is corrupted";
-				return false;
-			}
-
-			const float *values = nullptr;
-			shader_desc->getTextureValues(i, values);
-			if (!values) {
-				qCritical() << "1D LUT texture values are missing";
-				return false;
-			}
+		color_ctx.lut1d_textures.resize(shader->lut1d.size());
+		for (int i = 0; i < shader->lut1d.size(); i++) {
+			const ColorShaderCache::LUT &lut = shader->lut1d.at(i);
 
 			// Allocate 1D LUT
 			color_ctx.lut1d_textures[i].texture = CreateTexture(
-				VideoParams(width, height, PixelFormat::F32,
-							(channel ==
-							 OCIO::GpuShaderDesc::TEXTURE_RED_CHANNEL) ?
-								1 :
-								VideoParams::kRGBChannelCount),
-				values);
-			color_ctx.lut1d_textures[i].name = sampler_name;
+				VideoParams(lut.width, lut.height, PixelFormat::F32,
+							lut.channel_count),
+				lut.values.constData());
+			color_ctx.lut1d_textures[i].name = lut.sampler_name;
 			color_ctx.lut1d_textures[i].interpolation =
-				(interpolation == OCIO::INTERP_NEAREST) ? Texture::kNearest :
-														  Texture::kLinear;
+				lut.nearest ? Texture::kNearest : Texture::kLinear;
 		}
 
 		color_cache_.insert(proc_id, color_ctx);
@@ -324,16 +274,17 @@ bool Renderer::GetColorContext(const ColorTransformJob &color_job,
 
 void Renderer::ClearOldTextures()
 {
-	QMutexLocker locker(&texture_cache_lock_);
+	texture_pool_.ExpireOlderThan(QDateTime::currentMSecsSinceEpoch() -
+								  MAX_TEXTURE_LIFE);
 
-	for (auto it = texture_cache_.begin(); it != texture_cache_.end();) {
-		if (it->accessed <
-			QDateTime::currentMSecsSinceEpoch() - MAX_TEXTURE_LIFE) {
-			DestroyNativeTexture(it->handle);
-			it = texture_cache_.erase(it);
-		} else {
-			it++;
-		}
+	DestroyPendingTextures();
+}
+
+void Renderer::DestroyPendingTextures()
+{
+	const QVector<QVariant> handles = texture_pool_.TakePendingDestroy();
+	for (const QVariant &h : handles) {
+		DestroyNativeTexture(h);
 	}
 }
 
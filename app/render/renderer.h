@@ -32,6 +32,7 @@
 #include "node/node.h"
 #include "render/colorprocessor.h"
 #include "render/job/colortransformjob.h"
+#include "render/texturepool.h"
 #include "render/videoparams.h"
 #include "texture.h"
 #include "job/pluginjob.h"
@@ -54,6 +55,14 @@ public:
 
 	void DestroyTexture(Texture *texture);
 
+	/**
+   * @brief Reuse counts for this renderer's texture pool and usage of the budget shared by every renderer
+   */
+	TexturePool::Stats GetTextureCacheStats() const
+	{
+		return texture_pool_.GetStats();
+	}
+
 	virtual void BlitToTexture(QVariant shader, olive::AcceleratedJob& job,
 					   olive::Texture *destination,
 					   bool clear_destination = true)
@@ -110,6 +119,14 @@ public:
 
 	virtual void Flush() = 0;
 
+	/**
+   * @brief Block until every command issued so far has completed
+   *
+   * Unlike Flush(), this is unconditional. Use it before handing a texture to other render threads, their
+   * contexts share the texture but not this context's command stream.
+   */
+	virtual void Finish() = 0;
+
 	virtual Color GetPixelFromTexture(olive::Texture *texture,
 									  const QPointF &pt) = 0;
 	std::shared_ptr<RendererLifetime> GetLifetime() const
@@ -153,29 +170,19 @@ private:
 
 	void ClearOldTextures();
 
-	QHash<QString, ColorContext> color_cache_;
+	void DestroyPendingTextures();
 
-	struct CachedTexture {
-		int width;
-		int height;
-		int depth;
-		PixelFormat format;
-		int channel_count;
-		QVariant handle;
-		qint64 accessed;
-	};
+	QHash<QString, ColorContext> color_cache_;
 
 	static const int MAX_TEXTURE_LIFE = 5000;
 	static const bool USE_TEXTURE_CACHE = true;
-	std::list<CachedTexture> texture_cache_;
+	TexturePool texture_pool_;
 
 	QMutex color_cache_mutex_;
 
 	QVariant default_shader_;
 
 	QVariant interlace_texture_;
-
-	QMutex texture_cache_lock_;
 };
 
 }
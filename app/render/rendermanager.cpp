@@ -25,6 +25,7 @@
 #include <QMatrix4x4>
 #include <QThread>
 
+#include "codec/oiio/oiiosequencereader.h"
 #include "config/config.h"
 #include "core.h"
 #include "render/opengl/openglrenderer.h"
@@ -45,12 +46,17 @@ RenderManager::RenderManager(QObject *parent)
 {
 	if (backend_ == kOpenGL) {
 		context_ = new OpenGLRenderer();
-		decoder_cache_ = new DecoderCache();
+		decoder_pool_ = new DecoderPool(
+			OLIVE_CONFIG("DecoderMaximumInstances").toInt());
+		decoder_warmer_ = new DecoderWarmer(decoder_pool_);
 		shader_cache_ = new ShaderCache();
+		still_cache_ = new StillImageCache();
 	} else {
 		qCritical() << "Tried to initialize unknown graphics backend";
 		context_ = nullptr;
-		decoder_cache_ = nullptr;
+		decoder_pool_ = nullptr;
+		decoder_warmer_ = nullptr;
+		still_cache_ = nullptr;
 	}
 
 	if (context_) {
@@ -64,6 +70,7 @@ RenderManager::RenderManager(QObject *parent)
 		}
 
 		auto_cacher_ = new PreviewAutoCacher(this);
+		auto_cacher_->SetDecoderWarmer(decoder_warmer_);
 	}
 
 	decoder_clear_timer_ = new QTimer(this);
@@ -76,14 +83,20 @@ RenderManager::RenderManager(QObject *parent)
 RenderManager::~RenderManager()
 {
 	if (context_) {
-		delete shader_cache_;
-		delete decoder_cache_;
+		auto_cacher_->SetDecoderWarmer(nullptr);
+		delete decoder_warmer_;
 
 		for (RenderThread *rt : render_threads_) {
 			rt->quit();
 			rt->wait();
 		}
 
+		// Deleted after the threads have stopped since they may still be using them, and the decoder pool is
+		// waiting for their leases to be returned
+		delete shader_cache_;
+		delete still_cache_;
+		delete decoder_pool_;
+
 		context_->PostDestroy();
 		delete context_;
 	}
@@ -91,7 +104,8 @@ RenderManager::~RenderManager()
 
 RenderThread *RenderManager::CreateThread(Renderer *renderer)
 {
-	auto t = new RenderThread(renderer, decoder_cache_, shader_cache_, this);
+	auto t = new RenderThread(renderer, decoder_pool_, shader_cache_,
+							  still_cache_, this);
 	render_threads_.push_back(t);
 	t->start(QThread::NormalPriority);
 	return t;
@@ -125,6 +139,15 @@ RenderTicketPtr RenderManager::RenderFrame(const RenderVideoParams &params)
 						QVariant::fromValue(params.cache_timebase));
 	ticket->setProperty("cacheid", QVariant::fromValue(params.cache_id));
 	ticket->setProperty("multicam", QtUtils::PtrToValue(params.multicam));
+	ticket->setProperty("interactive", params.interactive);
+	if (!params.additional_outputs.isEmpty()) {
+		ticket->setProperty("additionaloutputs",
+							QVariant::fromValue(params.additional_outputs));
+	}
+	if (!params.sequence_range.length().isNull()) {
+		ticket->setProperty("sequencerange",
+							QVariant::fromValue(params.sequence_range));
+	}
 
 	if (params.return_type == ReturnType::kNull) {
 		dry_run_thread_->AddTicket(ticket);
@@ -184,30 +207,28 @@ void RenderManager::SetAggressiveGarbageCollection(bool enabled)
 
 void RenderManager::ClearOldDecoders()
 {
-	QMutexLocker locker(decoder_cache_->mutex());
-
 	qint64 min_age =
 		QDateTime::currentMSecsSinceEpoch() - kDecoderMaximumInactivity;
 
-	for (auto it = decoder_cache_->begin(); it != decoder_cache_->end();) {
-		DecoderPair decoder = it.value();
+	// Picks up changes from the preferences, pools over the new limit shrink as instances time out
+	decoder_pool_->SetMaximumInstances(
+		OLIVE_CONFIG("DecoderMaximumInstances").toInt());
+	decoder_pool_->ClearUnusedSince(min_age);
 
-		if (decoder.decoder->GetLastAccessedTime() < min_age) {
-			decoder.decoder->Close();
-			it = decoder_cache_->erase(it);
-		} else {
-			it++;
-		}
-	}
+	// Stills and sequence readers are released on the same schedule as the decoders
+	still_cache_->ClearUnusedSince(min_age);
+	OIIOSequenceReader::ClearInactive(min_age);
 }
 
-RenderThread::RenderThread(Renderer *renderer, DecoderCache *decoder_cache,
-						   ShaderCache *shader_cache, QObject *parent)
+RenderThread::RenderThread(Renderer *renderer, DecoderPool *decoder_pool,
+						   ShaderCache *shader_cache,
+						   StillImageCache *still_cache, QObject *parent)
 	: QThread(parent)
 	, cancelled_(false)
 	, context_(renderer)
-	, decoder_cache_(decoder_cache)
+	, decoder_pool_(decoder_pool)
 	, shader_cache_(shader_cache)
+	, still_cache_(still_cache)
 {
 	if (context_) {
 		context_->Init();
@@ -272,8 +293,8 @@ void RenderThread::run()
 			if (ticket->IsCancelled()) {
 				ticket->Finish();
 			} else {
-				RenderProcessor::Process(ticket, context_, decoder_cache_,
-										 shader_cache_);
+				RenderProcessor::Process(ticket, context_, decoder_pool_,
+										 shader_cache_, still_cache_);
 			}
 
 			locker.relock();
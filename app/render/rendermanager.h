@@ -26,6 +26,7 @@
 
 #include "config/config.h"
 #include "colorprocessorcache.h"
+#include "decoderpool.h"
 #include "dialog/rendercancel/rendercancel.h"
 #include "node/output/viewer/viewer.h"
 #include "node/project.h"
@@ -34,6 +35,7 @@
 #include "render/renderer.h"
 #include "render/renderticket.h"
 #include "rendercache.h"
+#include "stillimagecache.h"
 
 namespace olive
 {
@@ -41,8 +43,9 @@ namespace olive
 class RenderThread : public QThread {
 	Q_OBJECT
 public:
-	RenderThread(Renderer *renderer, DecoderCache *decoder_cache,
-				 ShaderCache *shader_cache, QObject *parent = nullptr);
+	RenderThread(Renderer *renderer, DecoderPool *decoder_pool,
+				 ShaderCache *shader_cache, StillImageCache *still_cache,
+				 QObject *parent = nullptr);
 
 	void AddTicket(RenderTicketPtr ticket);
 
@@ -64,9 +67,11 @@ private:
 
 	Renderer *context_;
 
-	DecoderCache *decoder_cache_;
+	DecoderPool *decoder_pool_;
 
 	ShaderCache *shader_cache_;
+
+	StillImageCache *still_cache_;
 };
 
 class RenderManager : public QObject {
@@ -98,6 +103,20 @@ public:
 
 	enum ReturnType { kTexture, kFrame, kNull };
 
+	/**
+   * @brief How a rendered frame is converted before being downloaded
+   *
+   * Each output is a cheap branch off the same rendered texture, so one render can feed several
+   * deliverables with different sizes, formats and color transforms.
+   */
+	struct FrameOutput {
+		QSize size = QSize(0, 0);
+		QMatrix4x4 matrix;
+		PixelFormat format = PixelFormat::INVALID;
+		int channel_count = 0;
+		ColorProcessorPtr color_output = nullptr;
+	};
+
 	struct RenderVideoParams {
 		RenderVideoParams(Node *n, const VideoParams &vparam,
 						  const AudioParams &aparam, const rational &t,
@@ -116,6 +135,7 @@ public:
 			force_channel_count = 0;
 			mode = m;
 			multicam = nullptr;
+			interactive = false;
 		}
 
 		void AddCache(FrameHashCache *cache)
@@ -144,6 +164,16 @@ public:
 		QMatrix4x4 force_matrix;
 		PixelFormat force_format;
 		ColorProcessorPtr force_color_output;
+
+		/// Also download the frame through each of these, returned in the ticket's "additionalframes" property
+		QVector<FrameOutput> additional_outputs;
+
+		/// Run of frames (e.g. an export or a viewer's playback) this frame is part of, passed on to OFX
+		/// plugins so they can keep one sequence render open for all of them. Empty for one-off frames.
+		TimeRange sequence_range;
+
+		/// Someone is waiting to see this frame (e.g. the viewer), passed on to OFX plugins
+		bool interactive;
 	};
 
 	static const rational kDryRunInterval;
@@ -201,6 +231,14 @@ public:
 		return auto_cacher_;
 	}
 
+	/**
+   * @brief Number of open decoders and the memory they're holding onto
+   */
+	DecoderPool::Stats GetDecoderPoolStats() const
+	{
+		return decoder_pool_ ? decoder_pool_->GetStats() : DecoderPool::Stats();
+	}
+
 	void SetProject(Project *p)
 	{
 		auto_cacher_->SetProject(p);
@@ -224,10 +262,14 @@ private:
 
 	Backend backend_;
 
-	DecoderCache *decoder_cache_;
+	DecoderPool *decoder_pool_;
+
+	DecoderWarmer *decoder_warmer_;
 
 	ShaderCache *shader_cache_;
 
+	StillImageCache *still_cache_;
+
 	static constexpr auto kDecoderMaximumInactivityAggressive = 1000;
 	static constexpr auto kDecoderMaximumInactivity = 5000;
 
@@ -253,5 +295,6 @@ private slots:
 }
 
 Q_DECLARE_METATYPE(olive::RenderManager::TicketType)
+Q_DECLARE_METATYPE(olive::RenderManager::FrameOutput)
 
 #endif // RENDERBACKEND_H
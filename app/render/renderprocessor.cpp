@@ -21,15 +21,18 @@
 
 #include "renderprocessor.h"
 
+#include <QDateTime>
 #include <QOpenGLContext>
 #include <QVector2D>
 #include <QVector3D>
 #include <QVector4D>
 
 #include "audio/audioprocessor.h"
+#include "codec/oiio/oiiosequencereader.h"
 #include "node/block/clip/clip.h"
 #include "node/block/transition/transition.h"
 #include "node/project.h"
+#include "node/project/footage/footage.h"
 #include "rendermanager.h"
 #include "render/opengl/openglrenderer.h"
 #include "render/plugin/pluginrenderer.h"
@@ -42,12 +45,14 @@ namespace olive
 #define super NodeTraverser
 
 RenderProcessor::RenderProcessor(RenderTicketPtr ticket, Renderer *render_ctx,
-								 DecoderCache *decoder_cache,
-								 ShaderCache *shader_cache)
+								 DecoderPool *decoder_pool,
+								 ShaderCache *shader_cache,
+								 StillImageCache *still_cache)
 	: ticket_(ticket)
 	, render_ctx_(render_ctx)
-	, decoder_cache_(decoder_cache)
+	, decoder_pool_(decoder_pool)
 	, shader_cache_(shader_cache)
+	, still_cache_(still_cache)
 {
 }
 
@@ -69,26 +74,23 @@ TexturePtr RenderProcessor::GenerateTexture(const rational &time,
 }
 
 FramePtr RenderProcessor::GenerateFrame(TexturePtr texture,
-										const rational &time)
+										const rational &time,
+										const RenderManager::FrameOutput &output)
 {
 	// Set up output frame parameters
 	VideoParams frame_params = GetCacheVideoParams();
 
-	QSize frame_size = ticket_->property("size").value<QSize>();
-	if (!frame_size.isNull()) {
-		frame_params.set_width(frame_size.width());
-		frame_params.set_height(frame_size.height());
+	if (!output.size.isNull()) {
+		frame_params.set_width(output.size.width());
+		frame_params.set_height(output.size.height());
 	}
 
-	PixelFormat frame_format =
-		static_cast<PixelFormat::Format>(ticket_->property("format").toInt());
-	if (frame_format != PixelFormat::INVALID) {
-		frame_params.set_format(frame_format);
+	if (output.format != PixelFormat::INVALID) {
+		frame_params.set_format(output.format);
 	}
 
-	int force_channel_count = ticket_->property("channelcount").toInt();
-	if (force_channel_count != 0) {
-		frame_params.set_channel_count(force_channel_count);
+	if (output.channel_count != 0) {
+		frame_params.set_channel_count(output.channel_count);
 	} else {
 		frame_params.set_channel_count(texture ?
 										   texture->channel_count() :
@@ -105,8 +107,7 @@ FramePtr RenderProcessor::GenerateFrame(TexturePtr texture,
 		memset(frame->data(), 0, frame->allocated_size());
 	} else {
 		// Dump texture contents to frame
-		ColorProcessorPtr output_color_transform =
-			ticket_->property("coloroutput").value<ColorProcessorPtr>();
+		const ColorProcessorPtr &output_color_transform = output.color_output;
 		const VideoParams &tex_params = texture->params();
 
 		if (output_color_transform) {
@@ -129,15 +130,13 @@ FramePtr RenderProcessor::GenerateFrame(TexturePtr texture,
 			tex_params.format() != frame_params.format()) {
 			TexturePtr blit_tex = render_ctx_->CreateTexture(frame_params);
 
-			QMatrix4x4 matrix = ticket_->property("matrix").value<QMatrix4x4>();
-
 			// No color transform, just blit
 			ShaderJob job;
 			job.Insert(QStringLiteral("ove_maintex"),
 					   NodeValue(NodeValue::kTexture,
 								 QVariant::fromValue(texture)));
 			job.Insert(QStringLiteral("ove_mvpmat"),
-					   NodeValue(NodeValue::kMatrix, matrix));
+					   NodeValue(NodeValue::kMatrix, output.matrix));
 
 			render_ctx_->BlitToTexture(render_ctx_->GetDefaultShader(), job,
 									   blit_tex.get());
@@ -228,7 +227,33 @@ void RenderProcessor::Run()
 
 				if (return_type == RenderManager::kFrame || !cache.isEmpty()) {
 					// Convert to CPU frame
-					frame = GenerateFrame(texture, time);
+					RenderManager::FrameOutput output;
+					output.size = ticket_->property("size").value<QSize>();
+					output.matrix =
+						ticket_->property("matrix").value<QMatrix4x4>();
+					output.format = static_cast<PixelFormat::Format>(
+						ticket_->property("format").toInt());
+					output.channel_count =
+						ticket_->property("channelcount").toInt();
+					output.color_output = ticket_->property("coloroutput")
+											  .value<ColorProcessorPtr>();
+
+					frame = GenerateFrame(texture, time, output);
+
+					// Branch off any other outputs from the same texture rather than rendering it again
+					QVector<RenderManager::FrameOutput> additional =
+						ticket_->property("additionaloutputs")
+							.value<QVector<RenderManager::FrameOutput>>();
+					if (!additional.isEmpty()) {
+						QVector<FramePtr> additional_frames(additional.size());
+						for (int i = 0; i < additional.size(); i++) {
+							additional_frames[i] =
+								GenerateFrame(texture, time, additional.at(i));
+						}
+						ticket_->setProperty(
+							"additionalframes",
+							QVariant::fromValue(additional_frames));
+					}
 
 					// Save to cache if requested
 					if (!cache.isEmpty()) {
@@ -264,12 +289,21 @@ void RenderProcessor::Run()
 		TimeRange time = ticket_->property("time").value<TimeRange>();
 
 		NodeValueTable table;
-		if (Node *node = QtUtils::ValueToPtr<Node>(ticket_->property("node"))) {
+		Node *node = QtUtils::ValueToPtr<Node>(ticket_->property("node"));
+		if (node) {
 			table = GenerateTable(node, time);
 		}
 
 		NodeValue sample_val = table.Get(NodeValue::kSamples);
 
+		// Footage's audio is exactly what was conformed, so its waveform was already generated then
+		if (ticket_->property("enablewaveforms").toBool() &&
+			dynamic_cast<Footage *>(node) &&
+			sample_val.canConvert<FootageJob>() &&
+			ProcessFootageWaveform(sample_val.value<FootageJob>())) {
+			break;
+		}
+
 		ResolveJobs(sample_val);
 
 		SampleBuffer samples = sample_val.toSamples();
@@ -303,42 +337,21 @@ void RenderProcessor::Run()
 
 DecoderPtr
 RenderProcessor::ResolveDecoderFromInput(const QString &decoder_id,
-										 const Decoder::CodecStream &stream)
+										 const Decoder::CodecStream &stream,
+										 const rational &time)
 {
 	if (!stream.IsValid()) {
 		qWarning() << "Attempted to resolve the decoder of a null stream";
 		return nullptr;
 	}
 
-	QMutexLocker locker(decoder_cache_->mutex());
-
-	DecoderPair decoder = decoder_cache_->value(stream);
-
-	qint64 file_last_modified =
-		QFileInfo(stream.filename()).lastModified().toMSecsSinceEpoch();
+	bool created;
+	DecoderPtr dec = decoder_pool_->Lease(decoder_id, stream, time, &created);
 
-	DecoderPtr dec = nullptr;
-
-	if (decoder.decoder && decoder.last_modified == file_last_modified) {
-		dec = decoder.decoder;
-	} else {
-		// No decoder
-		decoder.decoder = dec = Decoder::CreateFromID(decoder_id);
-		decoder.last_modified = file_last_modified;
-		decoder_cache_->insert(stream, decoder);
-		locker.unlock();
-
-		if (!dec->Open(stream)) {
-			qWarning() << "Failed to open decoder for" << stream.filename()
-					   << "::" << stream.stream();
-			return nullptr;
-		}
-
-		if (!render_ctx_) {
-			// Assume dry run and increment access time
-			decoder.decoder->IncrementAccessTime(
-				RenderManager::kDryRunInterval.toDouble() * 1000);
-		}
+	if (dec && created && !render_ctx_) {
+		// Assume dry run and increment access time
+		dec->IncrementAccessTime(
+			RenderManager::kDryRunInterval.toDouble() * 1000);
 	}
 
 	return dec;
@@ -375,10 +388,12 @@ NodeValueDatabase RenderProcessor::GenerateDatabase(const Node *node,
 }
 
 void RenderProcessor::Process(RenderTicketPtr ticket, Renderer *render_ctx,
-							  DecoderCache *decoder_cache,
-							  ShaderCache *shader_cache)
+							  DecoderPool *decoder_pool,
+							  ShaderCache *shader_cache,
+							  StillImageCache *still_cache)
 {
-	RenderProcessor p(ticket, render_ctx, decoder_cache, shader_cache);
+	RenderProcessor p(ticket, render_ctx, decoder_pool, shader_cache,
+					  still_cache);
 	p.Run();
 }
 
@@ -407,28 +422,65 @@ void RenderProcessor::ProcessVideoFootage(TexturePtr destination,
 		qWarning() << "HAVEN'T GOTTEN DEFAULT INPUT COLORSPACE";
 	}
 
+	AlphaAssociated input_alpha;
+	if (stream_data.channel_count() != VideoParams::kRGBAChannelCount ||
+		stream_data.colorspace() == color_manager->GetReferenceColorSpace()) {
+		input_alpha = kAlphaNone;
+	} else if (stream_data.premultiplied_alpha()) {
+		input_alpha = kAlphaAssociated;
+	} else {
+		input_alpha = kAlphaUnassociated;
+	}
+
+	QString still_key;
+	if (stream_data.video_type() == VideoParams::kVideoTypeStill &&
+		render_ctx_ && still_cache_) {
+		still_key = StillImageCache::CreateKey(
+			stream->filename(),
+			decoder_pool_->GetLastModified(stream->filename()),
+			stream_data.stream_index(), stream_data.divider(),
+			using_colorspace, input_alpha,
+			color_manager->GetReferenceColorSpace(), destination->format());
+
+		if (TexturePtr cached = still_cache_->Get(
+				still_key, QDateTime::currentMSecsSinceEpoch())) {
+			CopyTexture(cached, destination.get());
+			return;
+		}
+	}
+
 	Decoder::CodecStream default_codec_stream(
 		stream->filename(), stream_data.stream_index(), GetCurrentBlock());
 
 	QString decoder_id = stream->decoder();
 
 	DecoderPtr decoder = nullptr;
+	FramePtr sequence_frame = nullptr;
 
 	switch (stream_data.video_type()) {
 	case VideoParams::kVideoTypeVideo:
 	case VideoParams::kVideoTypeStill:
-		decoder = ResolveDecoderFromInput(decoder_id, default_codec_stream);
+		decoder = ResolveDecoderFromInput(decoder_id, default_codec_stream,
+										  input_time);
 		break;
 	case VideoParams::kVideoTypeImageSequence: {
 		if (render_ctx_) {
+			int64_t frame_number =
+				stream_data.get_time_in_timebase_units(input_time);
+
+			if (decoder_id == QStringLiteral("oiio")) {
+				// Read through the shared sequence reader, which also prefetches the frames after this one
+				sequence_frame =
+					OIIOSequenceReader::Get(stream->filename(),
+											stream_data.stream_index())
+						->ReadFrame(frame_number, stream_data.divider());
+				break;
+			}
+
 			// Since image sequences involve multiple files, we don't engage the decoder cache
 			decoder = Decoder::CreateFromID(decoder_id);
 
-			QString frame_filename;
-
-			int64_t frame_number =
-				stream_data.get_time_in_timebase_units(input_time);
-			frame_filename = Decoder::TransformImageSequenceFileName(
+			QString frame_filename = Decoder::TransformImageSequenceFileName(
 				stream->filename(), frame_number);
 
 			// Decoder will close automatically since it's a stream_ptr
@@ -439,7 +491,7 @@ void RenderProcessor::ProcessVideoFootage(TexturePtr destination,
 	}
 	}
 
-	if (decoder && render_ctx_) {
+	if ((decoder || sequence_frame) && render_ctx_) {
 		Decoder::RetrieveVideoParams p;
 		p.divider = stream->video_params().divider();
 		p.maximum_format = destination->format();
@@ -459,7 +511,13 @@ void RenderProcessor::ProcessVideoFootage(TexturePtr destination,
 				p.force_range = stream_data.color_range();
 				p.src_interlacing = stream_data.interlacing();
 
-				unmanaged_texture = decoder->RetrieveVideo(p);
+				if (sequence_frame) {
+					unmanaged_texture = render_ctx_->CreateTexture(
+						sequence_frame->video_params(), sequence_frame->data(),
+						sequence_frame->linesize_pixels());
+				} else {
+					unmanaged_texture = decoder->RetrieveVideo(p);
+				}
 
 				if (!IsCancelled() && unmanaged_texture) {
 					// We convert to our rendering pixel format, since that will always be float-based which
@@ -472,19 +530,26 @@ void RenderProcessor::ProcessVideoFootage(TexturePtr destination,
 
 					job.SetColorProcessor(processor);
 					job.SetInputTexture(unmanaged_texture);
+					job.SetInputAlphaAssociation(input_alpha);
 
-					if (stream_data.channel_count() !=
-							VideoParams::kRGBAChannelCount ||
-						stream_data.colorspace() ==
-							color_manager->GetReferenceColorSpace()) {
-						job.SetInputAlphaAssociation(kAlphaNone);
-					} else if (stream_data.premultiplied_alpha()) {
-						job.SetInputAlphaAssociation(kAlphaAssociated);
+					if (still_key.isEmpty()) {
+						render_ctx_->BlitColorManaged(job, destination.get());
 					} else {
-						job.SetInputAlphaAssociation(kAlphaUnassociated);
+						// Keep our own copy, `destination` is handed on to the rest of the graph
+						TexturePtr managed =
+							render_ctx_->CreateTexture(destination->params());
+						render_ctx_->BlitColorManaged(job, managed.get());
+
+						if (!IsCancelled()) {
+							// Other threads' contexts may copy this as soon as it's in the cache
+							render_ctx_->Finish();
+							still_cache_->Insert(
+								still_key, managed,
+								QDateTime::currentMSecsSinceEpoch());
+						}
+
+						CopyTexture(managed, destination.get());
 					}
-
-					render_ctx_->BlitColorManaged(job, destination.get());
 				}
 			}
 		}
@@ -498,7 +563,8 @@ void RenderProcessor::ProcessAudioFootage(SampleBuffer &destination,
 	DecoderPtr decoder = ResolveDecoderFromInput(
 		stream->decoder(),
 		Decoder::CodecStream(stream->filename(),
-							 stream->audio_params().stream_index(), nullptr));
+							 stream->audio_params().stream_index(), nullptr),
+		input_time.in());
 
 	if (decoder) {
 		const AudioParams &audio_params = GetCacheAudioParams();
@@ -514,6 +580,46 @@ void RenderProcessor::ProcessAudioFootage(SampleBuffer &destination,
 	}
 }
 
+bool RenderProcessor::ProcessFootageWaveform(const FootageJob &job)
+{
+	if (loop_mode() != LoopMode::kLoopModeOff) {
+		return false;
+	}
+
+	DecoderPtr decoder = ResolveDecoderFromInput(
+		job.decoder(),
+		Decoder::CodecStream(job.filename(),
+							 job.audio_params().stream_index(), nullptr),
+		job.time().in());
+	if (!decoder) {
+		return false;
+	}
+
+	AudioVisualWaveform waveform;
+	Decoder::RetrieveAudioStatus status = decoder->RetrieveWaveform(
+		waveform, job.time(), GetCacheAudioParams(), job.cache_path());
+
+	if (status == Decoder::kWaitingForConform) {
+		ticket_->setProperty("incomplete", true);
+	} else if (status != Decoder::kOK) {
+		return false;
+	}
+
+	ticket_->setProperty("waveform", QVariant::fromValue(waveform));
+
+	// Waveform caches only use the buffer for its parameters
+	SampleBuffer samples;
+	samples.set_audio_params(GetCacheAudioParams());
+
+	if (HeardCancel()) {
+		ticket_->Finish();
+	} else {
+		ticket_->Finish(QVariant::fromValue(samples));
+	}
+
+	return true;
+}
+
 void RenderProcessor::ProcessShader(TexturePtr destination, const Node *node,
 									const ShaderJob *job)
 {
@@ -547,6 +653,39 @@ void RenderProcessor::ProcessShader(TexturePtr destination, const Node *node,
 	render_ctx_->BlitToTexture(shader, const_cast<ShaderJob&>(*job), destination.get());
 }
 
+bool RenderProcessor::ProcessFusedShader(
+	TexturePtr destination, const QVector<ShaderFusion::Stage> &stages,
+	const ShaderJob *job)
+{
+	if (!render_ctx_) {
+		return false;
+	}
+
+	QString fused_shader_id = ShaderFusion::GetID(stages);
+
+	QMutexLocker locker(shader_cache_->mutex());
+
+	QVariant shader = shader_cache_->value(fused_shader_id);
+
+	if (shader.isNull()) {
+		shader = render_ctx_->CreateNativeShader(ShaderFusion::Generate(stages));
+
+		// Failures are cached too so we don't try compiling this chain every frame
+		shader_cache_->insert(fused_shader_id, shader);
+	}
+
+	locker.unlock();
+
+	if (!shader.toBool()) {
+		return false;
+	}
+
+	render_ctx_->BlitToTexture(shader, const_cast<ShaderJob &>(*job),
+							   destination.get());
+
+	return true;
+}
+
 void RenderProcessor::ProcessSamples(SampleBuffer &destination,
 									 const Node *node, const TimeRange &range,
 									 const SampleJob &job)
@@ -559,6 +698,34 @@ void RenderProcessor::ProcessSamples(SampleBuffer &destination,
 
 	const AudioParams &audio_params = GetCacheAudioParams();
 
+	// Unconnected float inputs (e.g. volume automation) can be evaluated for the whole buffer in one pass over
+	// their compiled keyframes rather than traversing the input once per sample
+	const rational sample_step(1, audio_params.sample_rate());
+	const TimeRange sample_range(
+		range.in(),
+		range.in() + sample_step * int64_t(job.samples().sample_count()));
+	QHash<QString, std::vector<float> > precomputed;
+
+	for (auto j = job.GetValues().constBegin(); j != job.GetValues().constEnd();
+		 j++) {
+		const QString &input = j.key();
+
+		if (node->HasInputWithID(input) &&
+			node->GetInputDataType(input) == NodeValue::kFloat &&
+			!node->InputIsArray(input) &&
+			!node->IsInputConnectedForRender(input)) {
+			TimeRange adjusted =
+				node->InputTimeAdjustment(input, -1, sample_range, true);
+
+			if (adjusted.length() == sample_range.length()) {
+				std::vector<float> &buf = precomputed[input];
+				buf.resize(KeyframeCurve::GetSampleCount(adjusted, sample_step));
+				node->GetSplitValuesOverRangeOnTrack(input, adjusted,
+													 sample_step, buf.data());
+			}
+		}
+	}
+
 	for (size_t i = 0; i < job.samples().sample_count(); i++) {
 		// Calculate the exact rational time at this sample
 		double sample_to_second =
@@ -571,6 +738,13 @@ void RenderProcessor::ProcessSamples(SampleBuffer &destination,
 		// Update all non-sample and non-footage inputs
 		for (auto j = job.GetValues().constBegin();
 			 j != job.GetValues().constEnd(); j++) {
+			auto pre = precomputed.constFind(j.key());
+			if (pre != precomputed.constEnd() && i < pre->size()) {
+				value_db.insert(j.key(), NodeValue(NodeValue::kFloat,
+												   double(pre->at(i)), node));
+				continue;
+			}
+
 			TimeRange r = TimeRange(this_sample_time, this_sample_time);
 			NodeValueTable value = ProcessInput(node, j.key(), r);
 
@@ -601,6 +775,18 @@ void RenderProcessor::ProcessFrameGeneration(TexturePtr destination,
 		return;
 	}
 
+	QString still_key;
+	if (still_cache_ && !job->GetCacheKey().isEmpty()) {
+		still_key = StillImageCache::CreateKey(node->id(), job->GetCacheKey(),
+											   destination->params());
+
+		if (TexturePtr cached = still_cache_->Get(
+				still_key, QDateTime::currentMSecsSinceEpoch())) {
+			CopyTexture(cached, destination.get());
+			return;
+		}
+	}
+
 	FramePtr frame = Frame::Create();
 
 	frame->set_video_params(destination->params());
@@ -608,7 +794,23 @@ void RenderProcessor::ProcessFrameGeneration(TexturePtr destination,
 
 	node->GenerateFrame(frame, *job);
 
-	destination->Upload(frame->data(), frame->linesize_pixels());
+	if (still_key.isEmpty()) {
+		destination->Upload(frame->data(), frame->linesize_pixels());
+		return;
+	}
+
+	// Keep our own texture, the destination may be reused once this frame is done
+	TexturePtr generated = CreateTexture(destination->params());
+	generated->Upload(frame->data(), frame->linesize_pixels());
+
+	if (!IsCancelled()) {
+		// Other threads' contexts may copy this as soon as it's in the cache
+		render_ctx_->Finish();
+		still_cache_->Insert(still_key, generated,
+							 QDateTime::currentMSecsSinceEpoch());
+	}
+
+	CopyTexture(generated, destination.get());
 }
 
 TexturePtr RenderProcessor::ProcessPluginJob(TexturePtr texture,
@@ -686,13 +888,24 @@ TexturePtr RenderProcessor::ProcessPluginJob(TexturePtr texture,
 		}
 	}
 
+	plugin::SequenceRange sequence;
+	if (ticket_->property("sequencerange").isValid()) {
+		TimeRange range = ticket_->property("sequencerange").value<TimeRange>();
+		const rational step = GetCacheVideoParams().frame_rate_as_time_base();
+		sequence.start = range.in().toDouble();
+		// OFX frame ranges include their last frame, the range's out point is just past it
+		sequence.end = (range.out() - step).toDouble();
+		sequence.step = step.toDouble();
+	}
+
 	plugin_renderer_->RenderPlugin(
 		src,
 		*plugin_job,
 		destination,
 		destination->params(),
 		true,
-		false);
+		ticket_->property("interactive").toBool(),
+		sequence);
 
 	return destination;
 }
@@ -746,6 +959,18 @@ void RenderProcessor::ConvertToReferenceSpace(TexturePtr destination,
 	render_ctx_->BlitColorManaged(ctj, destination.get());
 }
 
+void RenderProcessor::CopyTexture(TexturePtr source, Texture *destination)
+{
+	ShaderJob job;
+	job.Insert(QStringLiteral("ove_maintex"),
+			   NodeValue(NodeValue::kTexture, QVariant::fromValue(source)));
+	job.Insert(QStringLiteral("ove_mvpmat"),
+			   NodeValue(NodeValue::kMatrix, QMatrix4x4()));
+
+	render_ctx_->BlitToTexture(render_ctx_->GetDefaultShader(), job,
+							   destination);
+}
+
 bool RenderProcessor::UseCache() const
 {
 	return static_cast<RenderMode::Mode>(ticket_->property("mode").toInt()) ==
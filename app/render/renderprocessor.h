@@ -26,8 +26,11 @@
 #include <memory>
 #include "node/traverser.h"
 #include "render/renderer.h"
+#include "decoderpool.h"
 #include "rendercache.h"
+#include "rendermanager.h"
 #include "renderticket.h"
+#include "stillimagecache.h"
 
 namespace olive
 {
@@ -42,7 +45,8 @@ public:
 											   const TimeRange &range) override;
 
 	static void Process(RenderTicketPtr ticket, Renderer *render_ctx,
-						DecoderCache *decoder_cache, ShaderCache *shader_cache);
+						DecoderPool *decoder_pool, ShaderCache *shader_cache,
+						StillImageCache *still_cache);
 
 	struct RenderedWaveform {
 		const ClipBlock *block;
@@ -63,6 +67,10 @@ protected:
 	virtual void ProcessShader(TexturePtr destination, const Node *node,
 							   const ShaderJob *job) override;
 
+	virtual bool ProcessFusedShader(TexturePtr destination,
+									const QVector<ShaderFusion::Stage> &stages,
+									const ShaderJob *job) override;
+
 	virtual void ProcessSamples(SampleBuffer &destination, const Node *node,
 								const TimeRange &range,
 								const SampleJob &job) override;
@@ -94,19 +102,36 @@ protected:
 
 	virtual bool UseCache() const override;
 
+	virtual bool UseShaderFusion() const override
+	{
+		return render_ctx_ != nullptr;
+	}
+
 private:
 	RenderProcessor(RenderTicketPtr ticket, Renderer *render_ctx,
-					DecoderCache *decoder_cache, ShaderCache *shader_cache);
+					DecoderPool *decoder_pool, ShaderCache *shader_cache,
+					StillImageCache *still_cache);
 
 	TexturePtr GenerateTexture(const rational &time,
 							   const rational &frame_length);
 
-	FramePtr GenerateFrame(TexturePtr texture, const rational &time);
+	FramePtr GenerateFrame(TexturePtr texture, const rational &time,
+						   const RenderManager::FrameOutput &output);
 
 	void Run();
 
+	void CopyTexture(TexturePtr source, Texture *destination);
+
+	/**
+   * @brief Finish the ticket with the waveform stored alongside footage's audio conform
+   *
+   * Returns FALSE if there isn't one, in which case the audio has to be rendered to get its waveform.
+   */
+	bool ProcessFootageWaveform(const FootageJob &job);
+
 	DecoderPtr ResolveDecoderFromInput(const QString &decoder_id,
-									   const Decoder::CodecStream &stream);
+									   const Decoder::CodecStream &stream,
+									   const rational &time);
 
 	RenderTicketPtr ticket_;
 
@@ -114,9 +139,11 @@ private:
 
 	std::unique_ptr<olive::plugin::PluginRenderer> plugin_renderer_;
 
-	DecoderCache *decoder_cache_;
+	DecoderPool *decoder_pool_;
 
 	ShaderCache *shader_cache_;
+
+	StillImageCache *still_cache_;
 };
 
 }
@@ -0,0 +1,461 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "shaderfusion.h"
+
+#include <QRegularExpression>
+
+#include "node/node.h"
+
+namespace olive
+{
+
+QMutex ShaderFusion::lock_;
+QHash<QString, ShaderFusion::Analysis> ShaderFusion::analyses_;
+
+namespace
+{
+
+struct Uniform {
+	QString type;
+	QString name;
+	QString array;
+};
+
+struct ParsedShader {
+	bool valid = false;
+	QVector<Uniform> uniforms;
+	QString body;
+};
+
+struct TextureRead {
+	int start;
+	int end;
+	QString coord;
+};
+
+QRegularExpression IdentifierRegex(const QString &name)
+{
+	return QRegularExpression(QStringLiteral("(?<![\\.\\w])%1\\b").arg(
+		QRegularExpression::escape(name)));
+}
+
+int CountIdentifier(const QString &code, const QString &name)
+{
+	int count = 0;
+	QRegularExpressionMatchIterator it =
+		IdentifierRegex(name).globalMatch(code);
+	while (it.hasNext()) {
+		it.next();
+		count++;
+	}
+	return count;
+}
+
+ParsedShader Parse(const QString &frag_code)
+{
+	static const QRegularExpression comment_regex(
+		QStringLiteral("//[^\\n]*|/\\*.*?\\*/"),
+		QRegularExpression::DotMatchesEverythingOption);
+	static const QRegularExpression main_regex(
+		QStringLiteral("\\bvoid\\s+main\\s*\\(\\s*(void)?\\s*\\)\\s*\\{"));
+	static const QRegularExpression uniform_regex(QStringLiteral(
+		"^uniform\\s+(\\w+)\\s+(\\w+)\\s*(\\[\\s*\\w+\\s*\\])?$"));
+	static const QRegularExpression texcoord_regex(
+		QStringLiteral("^in\\s+vec2\\s+ove_texcoord$"));
+	static const QRegularExpression color_regex(
+		QStringLiteral("^out\\s+vec4\\s+frag_color$"));
+	static const QRegularExpression precision_regex(
+		QStringLiteral("^precision\\s+\\w+\\s+\\w+$"));
+	static const QRegularExpression unsupported_regex(QStringLiteral(
+		"\\b(discard|dFdx|dFdy|fwidth|gl_FragCoord|gl_FragColor|ove_(?!texcoord\\b)\\w+)\\b"));
+
+	ParsedShader p;
+
+	QString code = frag_code;
+	code.replace(comment_regex, QStringLiteral(" "));
+
+	// Preprocessor directives could change the meaning of anything we look at
+	if (code.contains('#')) {
+		return p;
+	}
+
+	QRegularExpressionMatch main_match = main_regex.match(code);
+	if (!main_match.hasMatch()) {
+		return p;
+	}
+
+	int body_start = main_match.capturedEnd();
+	int body_end = body_start;
+	for (int depth = 1; depth > 0; body_end++) {
+		if (body_end == code.size()) {
+			return p;
+		}
+
+		if (code.at(body_end) == '{') {
+			depth++;
+		} else if (code.at(body_end) == '}') {
+			depth--;
+		}
+	}
+
+	// Helper functions or declarations after main() aren't supported
+	if (!code.mid(body_end).trimmed().isEmpty()) {
+		return p;
+	}
+
+	const QStringList declarations =
+		code.left(main_match.capturedStart()).split(';');
+	for (int i = 0; i < declarations.size(); i++) {
+		const QString d = declarations.at(i).simplified();
+		if (d.isEmpty()) {
+			continue;
+		}
+
+		if (i == declarations.size() - 1) {
+			// Not terminated by a semicolon, so not a declaration we understand
+			return p;
+		}
+
+		QRegularExpressionMatch uniform_match = uniform_regex.match(d);
+		if (uniform_match.hasMatch()) {
+			// Uniforms the renderer sets itself (matrices, iterations) mean this shader isn't a simple pixel op
+			if (uniform_match.captured(2).startsWith(QStringLiteral("ove_"))) {
+				return p;
+			}
+
+			p.uniforms.append({ uniform_match.captured(1),
+								uniform_match.captured(2),
+								uniform_match.captured(3) });
+		} else if (!texcoord_regex.match(d).hasMatch() &&
+				   !color_regex.match(d).hasMatch() &&
+				   !precision_regex.match(d).hasMatch()) {
+			return p;
+		}
+	}
+
+	p.body = code.mid(body_start, body_end - 1 - body_start);
+
+	if (unsupported_regex.match(p.body).hasMatch()) {
+		return p;
+	}
+
+	p.valid = true;
+	return p;
+}
+
+bool FindTextureReads(const QString &body, const QString &input,
+					  QVector<TextureRead> *reads)
+{
+	QRegularExpression read_regex(
+		QStringLiteral("\\btexture\\s*\\(\\s*%1\\s*,")
+			.arg(QRegularExpression::escape(input)));
+
+	int pos = 0;
+	QRegularExpressionMatch m;
+	while ((m = read_regex.match(body, pos)).hasMatch()) {
+		int coord_start = m.capturedEnd();
+		int coord_end = coord_start;
+		for (int depth = 1;; coord_end++) {
+			if (coord_end == body.size()) {
+				return false;
+			}
+
+			QChar c = body.at(coord_end);
+			if (c == '(') {
+				depth++;
+			} else if (c == ')') {
+				depth--;
+				if (depth == 0) {
+					break;
+				}
+			} else if (c == ',' && depth == 1) {
+				// Bias or other extra arguments
+				return false;
+			}
+		}
+
+		reads->append(
+			{ int(m.capturedStart()), coord_end + 1,
+			  body.mid(coord_start, coord_end - coord_start).trimmed() });
+		pos = coord_end + 1;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Whether `coord` reads the same texel the stage is writing
+ *
+ * That's `ove_texcoord` itself, or a vec2 copied from it that's only ever mirrored with `v.x = 1.0 - v.x` (or
+ * `.y`), which is what flip does. Anything else (offsets, scaling, quantizing) reads neighboring texels that
+ * the previous stage would have to compute at those positions too.
+ */
+bool IsPointCoordinate(const QString &body, const QString &coord,
+					   const QVector<TextureRead> &reads)
+{
+	static const QRegularExpression identifier_regex(
+		QStringLiteral("^[A-Za-z_]\\w*$"));
+
+	if (coord == QStringLiteral("ove_texcoord")) {
+		return true;
+	}
+
+	if (!identifier_regex.match(coord).hasMatch() ||
+		coord.startsWith(QStringLiteral("ove_"))) {
+		return false;
+	}
+
+	const QString escaped = QRegularExpression::escape(coord);
+
+	QRegularExpression declaration_regex(
+		QStringLiteral("(?<![\\.\\w])vec2\\s+%1\\s*=\\s*ove_texcoord\\s*;")
+			.arg(escaped));
+	QRegularExpression mirror_regex(
+		QStringLiteral("(?<![\\.\\w])%1\\s*\\.\\s*([xy])\\s*=\\s*1\\.0\\s*-\\s*%1\\s*\\.\\s*\\1\\s*;")
+			.arg(escaped));
+
+	int declarations = 0;
+	QRegularExpressionMatchIterator it = declaration_regex.globalMatch(body);
+	while (it.hasNext()) {
+		it.next();
+		declarations++;
+	}
+	if (declarations != 1) {
+		return false;
+	}
+
+	int mirrors = 0;
+	it = mirror_regex.globalMatch(body);
+	while (it.hasNext()) {
+		it.next();
+		mirrors++;
+	}
+
+	int coord_reads = 0;
+	for (const TextureRead &r : reads) {
+		if (r.coord == coord) {
+			coord_reads++;
+		}
+	}
+
+	// Every other use of the variable could change it in ways we can't follow
+	return CountIdentifier(body, coord) == 1 + mirrors * 2 + coord_reads;
+}
+
+}
+
+ShaderFusion::Analysis ShaderFusion::Analyze(const QString &frag_code)
+{
+	Analysis a;
+	a.frag_code = frag_code;
+
+	ParsedShader p = Parse(frag_code);
+	if (!p.valid) {
+		return a;
+	}
+
+	a.fusible = true;
+
+	for (const Uniform &u : p.uniforms) {
+		if (u.type != QStringLiteral("sampler2D") || !u.array.isEmpty()) {
+			continue;
+		}
+
+		// Every use of the sampler must be a plain read we can swap for a function call, and every read
+		// must be of the texel being written
+		QVector<TextureRead> reads;
+		if (!FindTextureReads(p.body, u.name, &reads) || reads.isEmpty() ||
+			reads.size() != CountIdentifier(p.body, u.name)) {
+			continue;
+		}
+
+		bool point = true;
+		for (const TextureRead &r : reads) {
+			if (!IsPointCoordinate(p.body, r.coord, reads)) {
+				point = false;
+				break;
+			}
+		}
+
+		if (point) {
+			a.chainable_inputs.append(u.name);
+		}
+	}
+
+	return a;
+}
+
+ShaderFusion::Analysis ShaderFusion::Analyze(const Node *node,
+											 const ShaderJob *job)
+{
+	const QString key =
+		QStringLiteral("%1:%2").arg(node->id(), job->GetShaderID());
+
+	{
+		QMutexLocker locker(&lock_);
+		auto it = analyses_.constFind(key);
+		if (it != analyses_.constEnd()) {
+			return it.value();
+		}
+	}
+
+	ShaderCode code = node->GetShaderCode(job->GetShaderID());
+
+	Analysis a;
+	if (code.vert_code().isEmpty()) {
+		a = Analyze(code.frag_code());
+	}
+
+	QMutexLocker locker(&lock_);
+	analyses_.insert(key, a);
+	return a;
+}
+
+bool ShaderFusion::CanFuse(const Node *node, const ShaderJob *job)
+{
+	return job->GetIterationCount() == 1 &&
+		   job->GetVertexCoordinates().isEmpty() &&
+		   !job->GetValues().contains(QStringLiteral("ove_mvpmat")) &&
+		   Analyze(node, job).fusible;
+}
+
+QString ShaderFusion::Generate(const QStringList &frag_codes,
+							   const QStringList &inputs)
+{
+	static const QRegularExpression return_regex(
+		QStringLiteral("\\breturn\\s*;"));
+
+	QString uniforms;
+	QString functions;
+
+	for (int i = 0; i < frag_codes.size(); i++) {
+		ParsedShader p = Parse(frag_codes.at(i));
+		const QString prefix = GetStagePrefix(i);
+		const QString input = (i > 0) ? inputs.at(i) : QString();
+		const QString input_enabled = QStringLiteral("%1_enabled").arg(input);
+
+		QString body = p.body;
+
+		if (!input.isEmpty()) {
+			// Swap reads of the chained input for the previous stage, back to front so offsets stay valid.
+			// Coordinates are clamped the same way the texture would be.
+			QVector<TextureRead> reads;
+			FindTextureReads(body, input, &reads);
+			for (int j = reads.size() - 1; j >= 0; j--) {
+				const TextureRead &r = reads.at(j);
+				body.replace(r.start, r.end - r.start,
+							 QStringLiteral("%1main(clamp(%2, 0.0, 1.0))")
+								 .arg(GetStagePrefix(i - 1), r.coord));
+			}
+
+			body.replace(IdentifierRegex(input_enabled), QStringLiteral("true"));
+		}
+
+		for (const Uniform &u : p.uniforms) {
+			if (!input.isEmpty() &&
+				(u.name == input || u.name == input_enabled)) {
+				continue;
+			}
+
+			body.replace(IdentifierRegex(u.name), prefix + u.name);
+			uniforms.append(QStringLiteral("uniform %1 %2%3%4;\n")
+								.arg(u.type, prefix, u.name, u.array));
+		}
+
+		body.replace(IdentifierRegex(QStringLiteral("ove_texcoord")),
+					 prefix + QStringLiteral("texcoord"));
+		body.replace(IdentifierRegex(QStringLiteral("frag_color")),
+					 prefix + QStringLiteral("color"));
+		body.replace(return_regex, QStringLiteral("return %1color;").arg(prefix));
+
+		functions.append(QStringLiteral("vec4 %1main(vec2 %1texcoord)\n"
+										"{\n"
+										"\tvec4 %1color = vec4(0.0);\n"
+										"%2\n"
+										"\treturn %1color;\n"
+										"}\n\n")
+							 .arg(prefix, body));
+	}
+
+	return QStringLiteral("in vec2 ove_texcoord;\n"
+						  "out vec4 frag_color;\n\n"
+						  "%1\n"
+						  "%2"
+						  "void main()\n"
+						  "{\n"
+						  "\tfrag_color = %3main(ove_texcoord);\n"
+						  "}\n")
+		.arg(uniforms, functions, GetStagePrefix(frag_codes.size() - 1));
+}
+
+ShaderCode ShaderFusion::Generate(const QVector<Stage> &stages)
+{
+	QStringList frag_codes;
+	QStringList inputs;
+
+	for (const Stage &s : stages) {
+		frag_codes.append(Analyze(s.node, s.job).frag_code);
+		inputs.append(s.input);
+	}
+
+	return ShaderCode(Generate(frag_codes, inputs));
+}
+
+QString ShaderFusion::GetID(const QVector<Stage> &stages)
+{
+	QStringList parts;
+
+	for (const Stage &s : stages) {
+		parts.append(QStringLiteral("%1:%2:%3").arg(
+			s.node->id(), s.job->GetShaderID(), s.input));
+	}
+
+	return parts.join('|');
+}
+
+ShaderJob ShaderFusion::CreateJob(const QVector<Stage> &stages)
+{
+	ShaderJob job;
+
+	for (int i = 0; i < stages.size(); i++) {
+		const Stage &s = stages.at(i);
+		const QString prefix = GetStagePrefix(i);
+
+		for (auto it = s.job->GetValues().cbegin();
+			 it != s.job->GetValues().cend(); it++) {
+			if (it.key() != s.input) {
+				job.Insert(prefix + it.key(), it.value());
+			}
+		}
+
+		for (auto it = s.job->GetInterpolationMap().cbegin();
+			 it != s.job->GetInterpolationMap().cend(); it++) {
+			if (it.key() != s.input) {
+				job.SetInterpolation(prefix + it.key(), it.value());
+			}
+		}
+	}
+
+	return job;
+}
+
+}
@@ -0,0 +1,127 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef SHADERFUSION_H
+#define SHADERFUSION_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "render/job/shaderjob.h"
+#include "render/shadercode.h"
+
+namespace olive
+{
+
+class Node;
+
+/**
+ * @brief Combines chains of simple per-pixel shaders into one shader so the chain renders in a single pass
+ *
+ * Each ShaderJob is normally drawn into its own texture, which the next node then samples. For nodes that only
+ * read their input at the pixel they're writing (opacity, invert, channel multiply, crop, flip, etc.) that
+ * round trip through video memory is pure overhead. A fusible shader's main() is turned into a function
+ * returning the color it would have written, and every `texture(input, coord)` read of the chained input
+ * becomes a call to the previous stage's function at `coord`.
+ *
+ * A shader is fusible if, once comments are stripped, it declares nothing but uniforms, `in vec2 ove_texcoord`,
+ * `out vec4 frag_color` and main(), uses the default vertex shader and doesn't rely on derivatives, discard or
+ * gl_FragCoord. A sampler input can be chained if it's only ever read through texture() at `ove_texcoord`, or at
+ * a copy of it that's only mirrored like flip does. Shaders reading other texels (swirl, mosaic, offsets) can
+ * still start a chain but never take another stage's output.
+ */
+class ShaderFusion {
+public:
+	struct Analysis {
+		bool fusible = false;
+
+		/// Sampler uniforms that may take the output of another stage
+		QStringList chainable_inputs;
+
+		QString frag_code;
+	};
+
+	struct Stage {
+		const Node *node = nullptr;
+		ShaderJob *job = nullptr;
+
+		/// Input of this stage that reads the previous stage, empty for the first stage
+		QString input;
+	};
+
+	static const int kMaximumStages = 16;
+
+	static Analysis Analyze(const QString &frag_code);
+
+	/**
+   * @brief Analyze the shader `node` provides for `job`
+   *
+   * Results are cached for the lifetime of the process. This function is thread-safe.
+   */
+	static Analysis Analyze(const Node *node, const ShaderJob *job);
+
+	/**
+   * @brief Whether `job` can be part of a fused shader at all
+   *
+   * Besides the shader itself, the job mustn't be iterative or override the vertex coordinates or matrix.
+   */
+	static bool CanFuse(const Node *node, const ShaderJob *job);
+
+	/**
+   * @brief Generate a fragment shader running `frag_codes` in order
+   *
+   * `inputs` holds the chained input of each stage and must be the same size as `frag_codes`, the first entry
+   * is ignored. Every uniform of stage `i` is renamed with GetStagePrefix(i). All shaders must be fusible.
+   */
+	static QString Generate(const QStringList &frag_codes,
+							const QStringList &inputs);
+
+	static ShaderCode Generate(const QVector<Stage> &stages);
+
+	/**
+   * @brief Unique ID for the shader Generate() produces for `stages`
+   */
+	static QString GetID(const QVector<Stage> &stages);
+
+	/**
+   * @brief Create the job running the fused shader, with every value of every stage renamed to match Generate()
+   *
+   * Chained inputs are left out, they're computed in the shader.
+   */
+	static ShaderJob CreateJob(const QVector<Stage> &stages);
+
+	static QString GetStagePrefix(int stage)
+	{
+		return QStringLiteral("s%1_").arg(stage);
+	}
+
+private:
+	static QMutex lock_;
+
+	static QHash<QString, Analysis> analyses_;
+};
+
+}
+
+#endif // SHADERFUSION_H
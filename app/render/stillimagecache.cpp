@@ -0,0 +1,143 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "stillimagecache.h"
+
+namespace olive
+{
+
+StillImageCache::StillImageCache(qint64 budget)
+	: budget_(budget)
+	, cached_bytes_(0)
+{
+}
+
+QString StillImageCache::CreateKey(const QString &filename,
+								   qint64 last_modified, int stream,
+								   int divider, const QString &colorspace,
+								   int alpha_association,
+								   const QString &reference_space, int format)
+{
+	return QStringLiteral("%1:%2:%3:%4:%5:%6:%7:%8")
+		.arg(filename, QString::number(last_modified),
+			 QString::number(stream), QString::number(divider), colorspace,
+			 QString::number(alpha_association), reference_space,
+			 QString::number(format));
+}
+
+QString StillImageCache::CreateKey(const QString &node_id,
+								   const QString &job_key,
+								   const VideoParams &params)
+{
+	return QStringLiteral("%1:%2:%3:%4:%5:%6")
+		.arg(node_id, job_key, QString::number(params.width()),
+			 QString::number(params.height()),
+			 QString::number(params.divider()),
+			 QString::number(static_cast<int>(params.format())));
+}
+
+TexturePtr StillImageCache::Get(const QString &key, qint64 now)
+{
+	QMutexLocker locker(&mutex_);
+
+	auto it = entries_.find(key);
+	if (it == entries_.end()) {
+		return nullptr;
+	}
+
+	it->last_used = now;
+	return it->texture;
+}
+
+void StillImageCache::Insert(const QString &key, TexturePtr texture,
+							 qint64 now)
+{
+	qint64 bytes = GetTextureBytes(texture);
+	if (!texture || bytes > budget_) {
+		return;
+	}
+
+	QMutexLocker locker(&mutex_);
+
+	auto existing = entries_.find(key);
+	if (existing != entries_.end()) {
+		cached_bytes_ -= existing->bytes;
+		entries_.erase(existing);
+	}
+
+	while (!entries_.isEmpty() && cached_bytes_ + bytes > budget_) {
+		// Only a handful of stills fit in the budget, so a linear scan for the oldest is fine
+		auto oldest = entries_.begin();
+		for (auto it = entries_.begin(); it != entries_.end(); it++) {
+			if (it->last_used < oldest->last_used) {
+				oldest = it;
+			}
+		}
+
+		cached_bytes_ -= oldest->bytes;
+		entries_.erase(oldest);
+	}
+
+	entries_.insert(key, { texture, bytes, now });
+	cached_bytes_ += bytes;
+}
+
+void StillImageCache::ClearUnusedSince(qint64 time)
+{
+	QMutexLocker locker(&mutex_);
+
+	for (auto it = entries_.begin(); it != entries_.end();) {
+		if (it->last_used < time) {
+			cached_bytes_ -= it->bytes;
+			it = entries_.erase(it);
+		} else {
+			it++;
+		}
+	}
+}
+
+void StillImageCache::Clear()
+{
+	QMutexLocker locker(&mutex_);
+
+	entries_.clear();
+	cached_bytes_ = 0;
+}
+
+qint64 StillImageCache::GetCachedBytes() const
+{
+	QMutexLocker locker(&mutex_);
+
+	return cached_bytes_;
+}
+
+qint64 StillImageCache::GetTextureBytes(const TexturePtr &texture)
+{
+	if (!texture) {
+		return 0;
+	}
+
+	const VideoParams &p = texture->params();
+	return qint64(p.effective_width()) * p.effective_height() *
+		   p.effective_depth() * p.GetBytesPerPixel();
+}
+
+}
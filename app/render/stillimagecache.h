@@ -0,0 +1,104 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef STILLIMAGECACHE_H
+#define STILLIMAGECACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include "render/texture.h"
+
+namespace olive
+{
+
+/**
+ * @brief Cache of still images that have already been decoded and converted to the reference space
+ *
+ * Large stills (photos, 8K renders, overlays) look the same on every frame, so re-uploading and color managing
+ * them for each one is wasted work. RenderProcessor stores the color managed texture here, keyed by everything
+ * that affects the result (see CreateKey()), and copies it out on later frames. Generated frames that don't
+ * change over time, such as text, are kept here too.
+ *
+ * The cache is shared by every render thread and is limited to a byte budget, evicting the least recently used
+ * image when it's exceeded. All functions are thread-safe.
+ */
+class StillImageCache {
+public:
+	static const qint64 kDefaultBudget = 512LL * 1024LL * 1024LL;
+
+	explicit StillImageCache(qint64 budget = kDefaultBudget);
+
+	static QString CreateKey(const QString &filename, qint64 last_modified,
+							 int stream, int divider, const QString &colorspace,
+							 int alpha_association,
+							 const QString &reference_space, int format);
+
+	/**
+   * @brief Key for a frame `node_id` generated for a GenerateJob with the cache key `job_key`
+   */
+	static QString CreateKey(const QString &node_id, const QString &job_key,
+							 const VideoParams &params);
+
+	/**
+   * @brief Get the texture for `key`, or nullptr if it isn't cached
+   */
+	TexturePtr Get(const QString &key, qint64 now);
+
+	/**
+   * @brief Add a texture to the cache, evicting older images if necessary
+   *
+   * Textures larger than the whole budget are not cached. The texture is read by other render threads, so
+   * every command writing it must have completed (see Renderer::Finish()) before it's inserted.
+   */
+	void Insert(const QString &key, TexturePtr texture, qint64 now);
+
+	/**
+   * @brief Remove every image that hasn't been used since `time`
+   */
+	void ClearUnusedSince(qint64 time);
+
+	void Clear();
+
+	qint64 GetCachedBytes() const;
+
+private:
+	struct Entry {
+		TexturePtr texture;
+		qint64 bytes;
+		qint64 last_used;
+	};
+
+	static qint64 GetTextureBytes(const TexturePtr &texture);
+
+	QHash<QString, Entry> entries_;
+
+	qint64 budget_;
+
+	qint64 cached_bytes_;
+
+	mutable QMutex mutex_;
+};
+
+}
+
+#endif // STILLIMAGECACHE_H
@@ -0,0 +1,203 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "texturepool.h"
+
+namespace olive
+{
+
+TexturePool::TexturePool(qint64 budget)
+	: TexturePool(std::make_shared<Budget>(budget))
+{
+}
+
+TexturePool::TexturePool(BudgetPtr budget)
+	: budget_(budget)
+	, trim_requests_seen_(budget->trim_requests_)
+{
+	budget_->pools_++;
+}
+
+TexturePool::~TexturePool()
+{
+	// Whatever's left is destroyed along with the renderer's context, it no longer counts against the budget
+	budget_->used_ -= stats_.cached_bytes;
+	budget_->pools_--;
+}
+
+TexturePool::BudgetPtr TexturePool::GetSharedBudget()
+{
+	static BudgetPtr budget = std::make_shared<Budget>(qint64(kDefaultBudget));
+	return budget;
+}
+
+quint64 TexturePool::MakeKey(int width, int height, int depth,
+							 PixelFormat format, int channel_count)
+{
+	// 20 bits each for width and height, 12 for depth, 6 each for format and channel count. Format is offset by
+	// one so that INVALID still packs to a distinct value.
+	return (quint64(width) & 0xFFFFF) | ((quint64(height) & 0xFFFFF) << 20) |
+		   ((quint64(depth) & 0xFFF) << 40) |
+		   ((quint64(int(format) + 1) & 0x3F) << 52) |
+		   ((quint64(channel_count) & 0x3F) << 58);
+}
+
+QVariant TexturePool::Acquire(quint64 key)
+{
+	QMutexLocker locker(&lock_);
+
+	HandleTrimRequest();
+
+	auto bucket = buckets_.find(key);
+	if (bucket == buckets_.end()) {
+		stats_.misses++;
+		return QVariant();
+	}
+
+	EntryList::iterator it = bucket->back();
+	bucket->pop_back();
+	if (bucket->empty()) {
+		buckets_.erase(bucket);
+	}
+
+	QVariant handle = it->handle;
+	stats_.cached_bytes -= it->bytes;
+	budget_->used_ -= it->bytes;
+	stats_.cached_count--;
+	stats_.hits++;
+	lru_.erase(it);
+
+	return handle;
+}
+
+void TexturePool::Release(quint64 key, const QVariant &handle, qint64 bytes,
+						  qint64 released)
+{
+	QMutexLocker locker(&lock_);
+
+	HandleTrimRequest();
+
+	lru_.push_back({ key, handle, bytes, released });
+	buckets_[key].push_back(std::prev(lru_.end()));
+
+	stats_.cached_bytes += bytes;
+	budget_->used_ += bytes;
+	stats_.cached_count++;
+
+	TrimToBudget();
+}
+
+void TexturePool::ExpireOlderThan(qint64 time)
+{
+	QMutexLocker locker(&lock_);
+
+	HandleTrimRequest();
+
+	while (!lru_.empty() && lru_.front().released < time) {
+		EvictOldest();
+	}
+}
+
+void TexturePool::Clear()
+{
+	QMutexLocker locker(&lock_);
+
+	while (!lru_.empty()) {
+		EvictOldest();
+	}
+}
+
+QVector<QVariant> TexturePool::TakePendingDestroy()
+{
+	QMutexLocker locker(&lock_);
+
+	QVector<QVariant> handles;
+	handles.swap(pending_destroy_);
+	return handles;
+}
+
+void TexturePool::SetBudget(qint64 bytes)
+{
+	QMutexLocker locker(&lock_);
+
+	budget_->limit_ = bytes;
+	TrimToBudget();
+}
+
+TexturePool::Stats TexturePool::GetStats() const
+{
+	QMutexLocker locker(&lock_);
+
+	Stats stats = stats_;
+	stats.budget = budget_->limit();
+	stats.budget_used = budget_->used();
+	return stats;
+}
+
+void TexturePool::EvictOldest()
+{
+	EntryList::iterator it = lru_.begin();
+
+	// Releases are appended to both lists in the same order, so the globally oldest entry is always the oldest
+	// entry in its own bucket
+	auto bucket = buckets_.find(it->key);
+	Q_ASSERT(bucket != buckets_.end() && bucket->front() == it);
+	bucket->pop_front();
+	if (bucket->empty()) {
+		buckets_.erase(bucket);
+	}
+
+	pending_destroy_.append(it->handle);
+	stats_.cached_bytes -= it->bytes;
+	budget_->used_ -= it->bytes;
+	stats_.cached_count--;
+	stats_.evictions++;
+	lru_.erase(it);
+}
+
+void TexturePool::TrimToBudget()
+{
+	if (budget_->used() <= budget_->limit()) {
+		return;
+	}
+
+	// Only give up textures beyond our share, the pools holding more than theirs are asked to do the same
+	qint64 share = budget_->limit() / qMax(1, budget_->pools_.load());
+	while (!lru_.empty() && budget_->used() > budget_->limit() &&
+		   stats_.cached_bytes > share) {
+		EvictOldest();
+	}
+
+	if (budget_->used() > budget_->limit()) {
+		trim_requests_seen_ = ++budget_->trim_requests_;
+	}
+}
+
+void TexturePool::HandleTrimRequest()
+{
+	quint64 requests = budget_->trim_requests_;
+	if (requests != trim_requests_seen_) {
+		trim_requests_seen_ = requests;
+		TrimToBudget();
+	}
+}
+
+}
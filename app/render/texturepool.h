@@ -0,0 +1,205 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef TEXTUREPOOL_H
+#define TEXTUREPOOL_H
+
+#include <QHash>
+#include <QMutex>
+#include <QVariant>
+#include <QVector>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <memory>
+#include <olive/core/core.h>
+
+namespace olive
+{
+
+using namespace core;
+
+/**
+ * @brief Pool of released native texture handles for reuse by Renderer
+ *
+ * Free textures are grouped into buckets by a packed descriptor of their dimensions and format so that lookups
+ * don't depend on how many textures are cached. All free textures are also kept in a single least recently
+ * released list, which is trimmed whenever the total size of the pool exceeds its byte budget.
+ *
+ * Each Renderer has its own pool, but they can share one Budget so that the memory held doesn't grow with the
+ * number of renderers. A pool can only evict its own textures, so a pool that goes over the shared budget gives
+ * up its oldest ones until it's back within its share (the limit divided between the pools). If that isn't
+ * enough, it raises a trim request that every other pool handles on its next call.
+ *
+ * The pool never destroys native textures itself since that has to happen on the renderer's thread. Evicted
+ * handles are queued and collected with TakePendingDestroy(). All functions are thread-safe.
+ */
+class TexturePool {
+public:
+	/**
+   * @brief Byte limit and count of cached bytes, shared by every pool it's given to
+   */
+	class Budget {
+	public:
+		explicit Budget(qint64 limit)
+			: limit_(limit)
+			, used_(0)
+			, pools_(0)
+			, trim_requests_(0)
+		{
+		}
+
+		qint64 limit() const
+		{
+			return limit_;
+		}
+
+		qint64 used() const
+		{
+			return used_;
+		}
+
+	private:
+		friend class TexturePool;
+
+		std::atomic<qint64> limit_;
+		std::atomic<qint64> used_;
+
+		/// Number of pools sharing this budget
+		std::atomic<int> pools_;
+
+		/// Incremented when a pool can't get back under the limit on its own
+		std::atomic<quint64> trim_requests_;
+	};
+
+	using BudgetPtr = std::shared_ptr<Budget>;
+
+	struct Stats {
+		quint64 hits = 0;
+		quint64 misses = 0;
+		quint64 evictions = 0;
+		qint64 cached_bytes = 0;
+		int cached_count = 0;
+		qint64 budget = 0;
+
+		/// Bytes cached by every pool sharing the budget, including this one
+		qint64 budget_used = 0;
+	};
+
+	static const qint64 kDefaultBudget = 1024LL * 1024LL * 1024LL;
+
+	/**
+   * @brief Create a pool with a budget of its own
+   */
+	explicit TexturePool(qint64 budget = kDefaultBudget);
+
+	/**
+   * @brief Create a pool drawing from a budget shared with other pools
+   */
+	explicit TexturePool(BudgetPtr budget);
+
+	~TexturePool();
+
+	/**
+   * @brief The budget all renderers' pools share
+   */
+	static BudgetPtr GetSharedBudget();
+
+	/**
+   * @brief Pack texture dimensions and format into a bucket key
+   */
+	static quint64 MakeKey(int width, int height, int depth,
+						   PixelFormat format, int channel_count);
+
+	/**
+   * @brief Take a free texture matching `key`, or a null QVariant if there isn't one
+   *
+   * The most recently released texture is returned since it's the most likely to still be resident.
+   */
+	QVariant Acquire(quint64 key);
+
+	/**
+   * @brief Return a texture to the pool
+   *
+   * `released` is the time in milliseconds, used by ExpireOlderThan(). If this puts the pool over budget, the
+   * least recently released textures (from any bucket) are evicted.
+   */
+	void Release(quint64 key, const QVariant &handle, qint64 bytes,
+				 qint64 released);
+
+	/**
+   * @brief Evict every texture released before `time`
+   */
+	void ExpireOlderThan(qint64 time);
+
+	/**
+   * @brief Evict every texture in the pool
+   */
+	void Clear();
+
+	/**
+   * @brief Take the handles that have been evicted and need to be destroyed by the renderer
+   */
+	QVector<QVariant> TakePendingDestroy();
+
+	/**
+   * @brief Set the limit of this pool's budget, which applies to every pool sharing it
+   */
+	void SetBudget(qint64 bytes);
+
+	Stats GetStats() const;
+
+private:
+	struct Entry {
+		quint64 key;
+		QVariant handle;
+		qint64 bytes;
+		qint64 released;
+	};
+
+	using EntryList = std::list<Entry>;
+
+	void EvictOldest();
+
+	void TrimToBudget();
+
+	void HandleTrimRequest();
+
+	// Oldest release at the front
+	EntryList lru_;
+
+	// Per-descriptor free stacks, newest release at the back
+	QHash<quint64, std::deque<EntryList::iterator>> buckets_;
+
+	QVector<QVariant> pending_destroy_;
+
+	BudgetPtr budget_;
+
+	quint64 trim_requests_seen_;
+
+	Stats stats_;
+
+	mutable QMutex lock_;
+};
+
+}
+
+#endif // TEXTUREPOOL_H
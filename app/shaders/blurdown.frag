@@ -0,0 +1,34 @@
+// Halves tex_in along direction_in, first step of BlurFilterNode's pyramid
+uniform sampler2D tex_in;
+uniform vec2 texel_in;
+uniform vec2 direction_in;
+uniform bool repeat_edge_pixels_in;
+
+in vec2 ove_texcoord;
+out vec4 frag_color;
+
+vec4 sample_input(vec2 coord) {
+    if (repeat_edge_pixels_in
+        || (coord.x >= 0.0
+            && coord.x < 1.0
+            && coord.y >= 0.0
+            && coord.y < 1.0)) {
+        return texture(tex_in, coord);
+    }
+
+    return vec4(0.0);
+}
+
+void main(void) {
+    // Each sample lands between four source pixels so the texture unit averages them. Together they cover 4x4
+    // source pixels with a tent falloff ("dual filter" downsample).
+    vec2 o = texel_in * direction_in;
+
+    vec4 composite = sample_input(ove_texcoord) * 4.0;
+    composite += sample_input(ove_texcoord - o);
+    composite += sample_input(ove_texcoord + o);
+    composite += sample_input(ove_texcoord + vec2(o.x, -o.y));
+    composite += sample_input(ove_texcoord - vec2(o.x, -o.y));
+
+    frag_color = composite / 8.0;
+}
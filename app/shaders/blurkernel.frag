@@ -0,0 +1,52 @@
+// Separable box/gaussian kernel with weights precomputed by BlurFilterNode
+uniform sampler2D tex_in;
+uniform vec2 resolution_in;
+uniform bool horiz_in;
+uniform bool vert_in;
+uniform bool repeat_edge_pixels_in;
+
+// Taps either side of the center, each placed between two pixels so one texture read covers both. Size must
+// match BlurFilterNode::kMaximumTaps.
+uniform int tap_count_in;
+uniform float offsets_in[8];
+uniform float weights_in[8];
+
+uniform int ove_iteration;
+
+in vec2 ove_texcoord;
+out vec4 frag_color;
+
+vec4 sample_input(vec2 coord) {
+    if (repeat_edge_pixels_in
+        || (coord.x >= 0.0
+            && coord.x < 1.0
+            && coord.y >= 0.0
+            && coord.y < 1.0)) {
+        return texture(tex_in, coord);
+    }
+
+    return vec4(0.0);
+}
+
+void main(void) {
+    // Horizontal first if we're blurring both ways
+    vec2 direction;
+    if (horiz_in && (!vert_in || ove_iteration == 0)) {
+        direction = vec2(1.0 / resolution_in.x, 0.0);
+    } else {
+        direction = vec2(0.0, 1.0 / resolution_in.y);
+    }
+
+    vec4 composite = sample_input(ove_texcoord) * weights_in[0];
+
+    for (int i = 1; i < 8; i++) {
+        if (i >= tap_count_in) {
+            break;
+        }
+
+        vec2 o = direction * offsets_in[i];
+        composite += (sample_input(ove_texcoord + o) + sample_input(ove_texcoord - o)) * weights_in[i];
+    }
+
+    frag_color = composite;
+}
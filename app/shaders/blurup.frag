@@ -0,0 +1,36 @@
+// Doubles tex_in along direction_in, last step of BlurFilterNode's pyramid
+uniform sampler2D tex_in;
+uniform vec2 texel_in;
+uniform vec2 direction_in;
+uniform bool repeat_edge_pixels_in;
+
+in vec2 ove_texcoord;
+out vec4 frag_color;
+
+vec4 sample_input(vec2 coord) {
+    if (repeat_edge_pixels_in
+        || (coord.x >= 0.0
+            && coord.x < 1.0
+            && coord.y >= 0.0
+            && coord.y < 1.0)) {
+        return texture(tex_in, coord);
+    }
+
+    return vec4(0.0);
+}
+
+void main(void) {
+    // Tent filter over the neighboring source pixels so the upscale doesn't show the lower resolution
+    vec2 h = texel_in * direction_in * 0.5;
+
+    vec4 composite = sample_input(ove_texcoord + vec2(-h.x * 2.0, 0.0));
+    composite += sample_input(ove_texcoord + vec2(-h.x, h.y)) * 2.0;
+    composite += sample_input(ove_texcoord + vec2(0.0, h.y * 2.0));
+    composite += sample_input(ove_texcoord + vec2(h.x, h.y)) * 2.0;
+    composite += sample_input(ove_texcoord + vec2(h.x * 2.0, 0.0));
+    composite += sample_input(ove_texcoord + vec2(h.x, -h.y)) * 2.0;
+    composite += sample_input(ove_texcoord + vec2(0.0, -h.y * 2.0));
+    composite += sample_input(ove_texcoord + vec2(-h.x, -h.y)) * 2.0;
+
+    frag_color = composite / 12.0;
+}
@@ -0,0 +1,18 @@
+// Places tex_in into the frame with its top-left corner at offset_in
+uniform sampler2D tex_in;
+uniform vec2 offset_in;
+uniform vec2 size_in;
+uniform vec2 resolution_in;
+
+in vec2 ove_texcoord;
+out vec4 frag_color;
+
+void main() {
+    vec2 coord = (ove_texcoord * resolution_in - offset_in) / size_in;
+
+    if (coord.x < 0.0 || coord.x > 1.0 || coord.y < 0.0 || coord.y > 1.0) {
+        frag_color = vec4(0.0);
+    } else {
+        frag_color = texture(tex_in, coord);
+    }
+}
@@ -21,26 +21,64 @@
 
 #include "conform.h"
 
+#include "codec/conformmanager.h"
+
 namespace olive
 {
 
 ConformTask::ConformTask(const QString &decoder_id,
 						 const Decoder::CodecStream &stream,
-						 const AudioParams &params,
-						 const QVector<QString> &output_filenames)
+						 const AudioParams &params, const QString &cache_path)
 	: decoder_id_(decoder_id)
 	, stream_(stream)
 	, params_(params)
-	, output_filenames_(output_filenames)
+	, cache_path_(cache_path)
 {
-	SetTitle(tr("Conforming Audio %1:%2")
-				 .arg(stream.filename(), QString::number(stream.stream())));
+	SetTitle(tr("Conforming Audio %1").arg(stream.filename()));
 }
 
 bool ConformTask::Run()
 {
 	DecoderPtr decoder = Decoder::CreateFromID(decoder_id_);
 
+	// Find every other audio stream in the file
+	QVector<int> streams = { stream_.stream() };
+	FootageDescription desc =
+		decoder->Probe(stream_.filename(), GetCancelAtom());
+	for (const AudioParams &ap : desc.GetAudioStreams()) {
+		if (!streams.contains(ap.stream_index())) {
+			streams.append(ap.stream_index());
+		}
+	}
+
+	outputs_.clear();
+	QVector<Decoder::ConformOutput> working;
+	for (int index : streams) {
+		Decoder::CodecStream s(stream_.filename(), index, nullptr);
+
+		Decoder::ConformOutput output;
+		output.stream = index;
+		output.filenames =
+			ConformManager::GetConformedFilename(cache_path_, s, params_);
+		output.waveform_filename =
+			ConformManager::GetWaveformFilename(cache_path_, s, params_);
+
+		if (index != stream_.stream() &&
+			ConformManager::AllConformsExist(output.filenames)) {
+			// Conformed previously, no need to do it again
+			continue;
+		}
+
+		outputs_.append(output);
+
+		for (QString &fn : output.filenames) {
+			fn = ConformManager::GetWorkingFilename(fn);
+		}
+		output.waveform_filename =
+			ConformManager::GetWorkingFilename(output.waveform_filename);
+		working.append(output);
+	}
+
 	if (!decoder->Open(stream_)) {
 		SetError(tr("Failed to open decoder for audio conform"));
 		return false;
@@ -49,10 +87,9 @@ bool ConformTask::Run()
 	connect(decoder.get(), &Decoder::IndexProgress, this,
 			&ConformTask::ProgressChanged);
 
-	qDebug() << "Starting conform of" << stream_.filename() << stream_.stream();
+	qDebug() << "Starting conform of" << stream_.filename() << streams;
 
-	bool ret =
-		decoder->ConformAudio(output_filenames_, params_, GetCancelAtom());
+	bool ret = decoder->ConformAudio(working, params_, GetCancelAtom());
 
 	decoder->Close();
 
@@ -29,12 +29,28 @@
 namespace olive
 {
 
+/**
+ * @brief Conforms every audio stream of a file to a set of parameters in one pass
+ *
+ * `stream` is the stream that was requested and is always conformed. Other audio streams in the file are
+ * conformed alongside it unless a conform for them already exists, so a file with several audio streams is only
+ * read once. A visual waveform is generated for each stream at the same time.
+ */
 class ConformTask : public Task {
 	Q_OBJECT
 public:
 	ConformTask(const QString &decoder_id, const Decoder::CodecStream &stream,
-				const AudioParams &params,
-				const QVector<QString> &output_filenames);
+				const AudioParams &params, const QString &cache_path);
+
+	/**
+   * @brief The finished filenames of everything this task writes
+   *
+   * Only valid once the task has run. Files are written to ConformManager::GetWorkingFilename() of these.
+   */
+	const QVector<Decoder::ConformOutput> &outputs() const
+	{
+		return outputs_;
+	}
 
 protected:
 	virtual bool Run() override;
@@ -46,7 +62,9 @@ private:
 
 	AudioParams params_;
 
-	QVector<QString> output_filenames_;
+	QString cache_path_;
+
+	QVector<Decoder::ConformOutput> outputs_;
 };
 
 }
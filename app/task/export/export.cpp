@@ -28,8 +28,17 @@ namespace olive
 
 ExportTask::ExportTask(ViewerOutput *viewer_node, ColorManager *color_manager,
 					   const EncodingParams &params)
-	: params_(params)
+	: ExportTask(viewer_node, color_manager, QVector<EncodingParams>({ params }))
 {
+}
+
+ExportTask::ExportTask(ViewerOutput *viewer_node, ColorManager *color_manager,
+					   const QVector<EncodingParams> &params)
+{
+	Q_ASSERT(!params.isEmpty());
+
+	output_failed_ = false;
+
 	// Create a copy of the project
 	copier_ = new ProjectCopier(this);
 	copier_->SetProject(viewer_node->project());
@@ -37,11 +46,22 @@ ExportTask::ExportTask(ViewerOutput *viewer_node, ColorManager *color_manager,
 	set_viewer(copier_->GetCopy(viewer_node));
 	color_manager_ = copier_->GetCopiedProject()->color_manager();
 
-	// Adjust video params to have no divider
+	outputs_.resize(params.size());
+	for (int i = 0; i < params.size(); i++) {
+		outputs_[i].params = params.at(i);
+		if (params.at(i).video_enabled()) {
+			video_outputs_.append(i);
+		}
+	}
+
+	// Adjust video params to have no divider, the first output with video decides the timing
+	const EncodingParams &timing_params =
+		video_outputs_.isEmpty() ? params.first() :
+								   params.at(video_outputs_.first());
 	VideoParams vp = viewer_node->GetVideoParams();
 	vp.set_divider(1);
-	vp.set_time_base(params.video_params().time_base());
-	vp.set_frame_rate(params.video_params().frame_rate());
+	vp.set_time_base(timing_params.video_params().time_base());
+	vp.set_frame_rate(timing_params.video_params().frame_rate());
 	set_video_params(vp);
 
 	set_audio_params(viewer_node->GetAudioParams());
@@ -50,44 +70,47 @@ ExportTask::ExportTask(ViewerOutput *viewer_node, ColorManager *color_manager,
 	SetNativeProgressSignallingEnabled(false);
 }
 
-bool ExportTask::Run()
+bool ExportTask::OpenOutput(Output &output)
 {
+	EncodingParams &params = output.params;
+
 	// For safety, if we're overwriting, we save to a temporary filename and then only overwrite it
 	// at the end
-	QString real_filename = params_.filename();
-	if (QFileInfo::exists(params_.filename())) {
+	output.real_filename = params.filename();
+	if (QFileInfo::exists(params.filename())) {
 		// Generate a filename that definitely doesn't exist
-		params_.SetFilename(
-			FileFunctions::GetSafeTemporaryFilename(real_filename));
+		params.SetFilename(
+			FileFunctions::GetSafeTemporaryFilename(output.real_filename));
 	}
 
 	// If we're exporting to a sidecar subtitle file, disable the subtitles in the main encoder
-	bool subtitles_enabled = params_.subtitles_enabled();
-	EncodingParams sidecar_params = params_;
-	if (subtitles_enabled && params_.subtitles_are_sidecar()) {
-		params_.DisableSubtitles();
+	bool sidecar = params.subtitles_enabled() && params.subtitles_are_sidecar();
+	EncodingParams sidecar_params = params;
+	if (sidecar) {
+		params.DisableSubtitles();
 	}
 
-	encoder_ = std::shared_ptr<Encoder>(Encoder::CreateFromParams(params_));
+	output.encoder = std::shared_ptr<Encoder>(CreateEncoder(params));
 
-	if (!encoder_) {
-		SetError(tr("Failed to create encoder"));
+	if (!output.encoder) {
+		SetOutputError(output, tr("Failed to create encoder"));
 		return false;
 	}
 
-	if (!encoder_->Open()) {
-		SetError(tr("Failed to open file: %1").arg(encoder_->GetError()));
+	if (!output.encoder->Open()) {
+		SetOutputError(output, tr("Failed to open file: %1")
+								   .arg(output.encoder->GetError()));
 		return false;
 	}
 
-	if (subtitles_enabled && params_.subtitles_are_sidecar()) {
+	if (sidecar) {
 		// Construct sidecar params
 		sidecar_params.DisableVideo();
 		sidecar_params.DisableAudio();
 
 		QString sidecar_filename;
 		{
-			QFileInfo fi(real_filename);
+			QFileInfo fi(output.real_filename);
 			sidecar_filename = fi.completeBaseName();
 			sidecar_filename.append('.');
 			sidecar_filename.append(ExportFormat::GetExtension(
@@ -96,25 +119,100 @@ bool ExportTask::Run()
 		}
 		sidecar_params.SetFilename(sidecar_filename);
 
-		subtitle_encoder_ = std::shared_ptr<Encoder>(Encoder::CreateFromFormat(
-			sidecar_params.subtitle_sidecar_fmt(), sidecar_params));
-		if (!subtitle_encoder_) {
-			SetError(tr("Failed to create subtitle encoder"));
+		output.subtitle_encoder =
+			std::shared_ptr<Encoder>(Encoder::CreateFromFormat(
+				sidecar_params.subtitle_sidecar_fmt(), sidecar_params));
+		if (!output.subtitle_encoder) {
+			SetOutputError(output, tr("Failed to create subtitle encoder"));
 			return false;
 		}
 
-		if (!subtitle_encoder_->Open()) {
-			SetError(tr("Failed to open subtitle sidecar file: %1")
-						 .arg(sidecar_filename));
+		if (!output.subtitle_encoder->Open()) {
+			SetOutputError(output,
+						   tr("Failed to open subtitle sidecar file: %1")
+							   .arg(sidecar_filename));
 			return false;
 		}
+	} else if (params.subtitles_enabled()) {
+		output.subtitle_encoder = output.encoder;
+	}
+
+	if (params.video_enabled()) {
+		// Create color processor
+		output.color_processor = ColorProcessor::Create(
+			color_manager_, color_manager_->GetReferenceColorSpace(),
+			params.color_transform());
+	}
+
+	return true;
+}
+
+void ExportTask::SetOutputError(const Output &output, const QString &error)
+{
+	// The first failure stops the export, anything the other outputs report while closing is a consequence of it
+	if (output_failed_) {
+		return;
+	}
+	output_failed_ = true;
+
+	if (outputs_.size() > 1) {
+		// Say which of the files went wrong
+		SetError(tr("%1: %2").arg(QFileInfo(output.real_filename).fileName(),
+								  error));
 	} else {
-		subtitle_encoder_ = encoder_;
+		SetError(error);
 	}
+}
+
+Encoder *ExportTask::CreateEncoder(const EncodingParams &params)
+{
+	return Encoder::CreateFromParams(params);
+}
 
-	if (params_.has_custom_range()) {
+bool ExportTask::RenderOutputs(
+	const TimeRangeList &video_range, const TimeRangeList &audio_range,
+	const TimeRange &subtitle_range, const RenderManager::FrameOutput &primary,
+	const QVector<RenderManager::FrameOutput> &additional)
+{
+	return Render(color_manager_, video_range, audio_range, subtitle_range,
+				  RenderMode::kOnline, nullptr, primary.size, primary.matrix,
+				  primary.format, primary.channel_count, primary.color_output,
+				  additional);
+}
+
+bool ExportTask::Run()
+{
+	// Every output gets the same frames, so they have to agree on when those frames are
+	foreach (int i, video_outputs_) {
+		if (outputs_.at(i).params.video_params().frame_rate() !=
+			video_params().frame_rate()) {
+			SetError(tr("All outputs must have the same frame rate"));
+			return false;
+		}
+	}
+
+	bool success = true;
+	bool subtitles_enabled = false;
+	bool audio_enabled = false;
+
+	for (Output &output : outputs_) {
+		subtitles_enabled |= output.params.subtitles_enabled();
+		audio_enabled |= output.params.audio_enabled();
+
+		if (!OpenOutput(output)) {
+			success = false;
+			break;
+		}
+	}
+
+	// Nothing was rendered if any output failed to open, so none of the files are worth keeping. The same goes
+	// for a render that stopped part way, which mustn't replace a file that was already there.
+	bool complete = success;
+
+	const EncodingParams &first_params = outputs_.first().params;
+	if (first_params.has_custom_range()) {
 		// Render custom range only
-		export_range_ = params_.custom_range();
+		export_range_ = first_params.custom_range();
 	} else {
 		// Render entire sequence
 		export_range_ = TimeRange(0, viewer()->GetLength());
@@ -122,87 +220,110 @@ bool ExportTask::Run()
 
 	frame_time_ = 0;
 
-	QSize video_force_size;
-	QMatrix4x4 video_force_matrix;
+	// Each video output downloads the rendered frame at its own size, format and color transform
+	QVector<RenderManager::FrameOutput> frame_outputs;
+
+	foreach (int i, video_outputs_) {
+		const Output &output = outputs_.at(i);
+		const EncodingParams &params = output.params;
+		RenderManager::FrameOutput fo;
 
-	if (params_.video_enabled()) {
 		// If a transformation matrix is applied to this video, create it here
-		if (video_params().width() != params_.video_params().width() ||
-			video_params().height() != params_.video_params().height()) {
-			video_force_size = QSize(params_.video_params().width(),
-									 params_.video_params().height());
-
-			if (params_.video_scaling_method() != EncodingParams::kStretch) {
-				video_force_matrix = EncodingParams::GenerateMatrix(
-					params_.video_scaling_method(), video_params().width(),
-					video_params().height(), params_.video_params().width(),
-					params_.video_params().height());
+		if (video_params().width() != params.video_params().width() ||
+			video_params().height() != params.video_params().height()) {
+			fo.size = QSize(params.video_params().width(),
+							params.video_params().height());
+
+			if (params.video_scaling_method() != EncodingParams::kStretch) {
+				fo.matrix = EncodingParams::GenerateMatrix(
+					params.video_scaling_method(), video_params().width(),
+					video_params().height(), params.video_params().width(),
+					params.video_params().height());
 			}
 		} else {
 			// Disables forcing size in the renderer
-			video_force_size = QSize(0, 0);
+			fo.size = QSize(0, 0);
 		}
 
-		// Create color processor
-		color_processor_ = ColorProcessor::Create(
-			color_manager_, color_manager_->GetReferenceColorSpace(),
-			params_.color_transform());
+		fo.format = output.encoder ? output.encoder->GetDesiredPixelFormat() :
+									 PixelFormat::INVALID;
+		fo.channel_count = VideoParams::kRGBAChannelCount;
+		fo.color_output = output.color_processor;
+
+		frame_outputs.append(fo);
 	}
 
-	// Start render process
-	TimeRangeList video_range, audio_range;
-	TimeRange subtitle_range;
+	if (success) {
+		// Start render process
+		TimeRangeList video_range, audio_range;
+		TimeRange subtitle_range;
+
+		if (!frame_outputs.isEmpty()) {
+			if (export_range_.in() > 0) {
+				export_range_.set_in(Timecode::snap_time_to_timebase(
+					export_range_.in(),
+					video_params().frame_rate_as_time_base()));
+			}
 
-	if (params_.video_enabled()) {
-		if (export_range_.in() > 0) {
-			export_range_.set_in(Timecode::snap_time_to_timebase(
-				export_range_.in(), video_params().frame_rate_as_time_base()));
+			video_range = { export_range_ };
 		}
 
-		video_range = { export_range_ };
-	}
+		if (audio_enabled) {
+			audio_range = { export_range_ };
+		}
 
-	if (params_.audio_enabled()) {
-		audio_range = { export_range_ };
-	}
+		if (subtitles_enabled) {
+			subtitle_range = export_range_;
+		}
 
-	if (subtitles_enabled) {
-		subtitle_range = export_range_;
-	}
+		RenderManager::FrameOutput primary;
+		if (!frame_outputs.isEmpty()) {
+			primary = frame_outputs.takeFirst();
+		}
 
-	Render(color_manager_, video_range, audio_range, subtitle_range,
-		   RenderMode::kOnline, nullptr, video_force_size, video_force_matrix,
-		   encoder_->GetDesiredPixelFormat(), VideoParams::kRGBAChannelCount,
-		   color_processor_);
+		if (!RenderOutputs(video_range, audio_range, subtitle_range, primary,
+						   frame_outputs)) {
+			complete = false;
+			success = false;
+		}
+	}
 
-	bool success = true;
+	for (Output &output : outputs_) {
+		if (output.encoder) {
+			output.encoder->Close();
+			if (!output.encoder->GetError().isEmpty()) {
+				SetOutputError(output, output.encoder->GetError());
+				success = false;
+			}
+		}
 
-	encoder_->Close();
-	if (!encoder_->GetError().isEmpty()) {
-		SetError(encoder_->GetError());
-		success = false;
-	}
+		if (output.subtitle_encoder &&
+			output.subtitle_encoder != output.encoder) {
+			output.subtitle_encoder->Close();
+			if (!output.subtitle_encoder->GetError().isEmpty()) {
+				SetOutputError(output, output.subtitle_encoder->GetError());
+				success = false;
+			}
+		}
 
-	if (subtitle_encoder_ != encoder_) {
-		subtitle_encoder_->Close();
-		if (!subtitle_encoder_->GetError().isEmpty()) {
-			SetError(subtitle_encoder_->GetError());
-			success = false;
+		if (output.real_filename.isEmpty()) {
+			// Never got as far as opening this one
+			continue;
 		}
-	}
 
-	// If cancelled, delete the file we made, which is always a file we created since we write to a
-	// temp file during the actual encoding process
-	if (IsCancelled()) {
-		QFile::remove(params_.filename());
-	} else if (params_.filename() != real_filename) {
-		// If we were writing to a temp file, overwrite now
-		if (!FileFunctions::RenameFileAllowOverwrite(params_.filename(),
-													 real_filename)) {
-			SetError(
-				tr("Failed to overwrite \"%1\". Export has been saved as \"%2\" instead.")
-					.arg(real_filename, params_.filename()));
-			success = false;
+		// If cancelled, delete the file we made, which is always a file we created since we write to a
+		// temp file during the actual encoding process
+		if (IsCancelled() || !complete) {
+			QFile::remove(output.params.filename());
+		} else if (output.params.filename() != output.real_filename) {
+			// If we were writing to a temp file, overwrite now
+			if (!FileFunctions::RenameFileAllowOverwrite(
+					output.params.filename(), output.real_filename)) {
+				SetError(
+					tr("Failed to overwrite \"%1\". Export has been saved as \"%2\" instead.")
+						.arg(output.real_filename, output.params.filename()));
+				success = false;
+			}
 		}
 	}
 
@@ -210,10 +331,37 @@ bool ExportTask::Run()
 }
 
 bool ExportTask::FrameDownloaded(FramePtr f, const rational &time)
+{
+	return FramesDownloaded({ f }, time);
+}
+
+bool ExportTask::FramesDownloaded(const QVector<FramePtr> &frames,
+								  const rational &time)
 {
 	rational actual_time = time - export_range_.in();
 
-	time_map_.insert(actual_time, f);
+	bool any_order = true;
+	foreach (int i, video_outputs_) {
+		if (!outputs_.at(i).encoder->WritesFramesInAnyOrder()) {
+			any_order = false;
+			break;
+		}
+	}
+
+	if (any_order) {
+		// No need to wait for earlier frames, write this one right away
+		if (!WriteFrames(frames, actual_time)) {
+			return false;
+		}
+
+		frame_time_++;
+		emit ProgressChanged(double(frame_time_) /
+							 double(GetTotalNumberOfFrames()));
+
+		return true;
+	}
+
+	time_map_.insert(actual_time, frames);
 
 	while (!IsCancelled()) {
 		rational real_time = Timecode::timestamp_to_time(
@@ -224,9 +372,8 @@ bool ExportTask::FrameDownloaded(FramePtr f, const rational &time)
 		}
 
 		// Unfortunately this can't be done in another thread since the frames need to be sent
-		// one after the other chronologically.
-		if (!encoder_->WriteFrame(time_map_.take(real_time), real_time)) {
-			SetError(encoder_->GetError());
+		// one after the other chronologically (except for image sequences, see above).
+		if (!WriteFrames(time_map_.take(real_time), real_time)) {
 			return false;
 		}
 
@@ -238,6 +385,20 @@ bool ExportTask::FrameDownloaded(FramePtr f, const rational &time)
 	return true;
 }
 
+bool ExportTask::WriteFrames(const QVector<FramePtr> &frames,
+							 const rational &time)
+{
+	for (int i = 0; i < video_outputs_.size() && i < frames.size(); i++) {
+		const Output &output = outputs_.at(video_outputs_.at(i));
+		if (!output.encoder->WriteFrame(frames.at(i), time)) {
+			SetOutputError(output, output.encoder->GetError());
+			return false;
+		}
+	}
+
+	return true;
+}
+
 bool ExportTask::AudioDownloaded(const TimeRange &range,
 								 const SampleBuffer &samples)
 {
@@ -256,20 +417,26 @@ bool ExportTask::AudioDownloaded(const TimeRange &range,
 
 bool ExportTask::EncodeSubtitle(const SubtitleBlock *sub)
 {
-	if (!subtitle_encoder_->WriteSubtitle(sub)) {
-		SetError(subtitle_encoder_->GetError());
-		return false;
-	} else {
-		return true;
+	for (const Output &output : outputs_) {
+		if (output.subtitle_encoder &&
+			!output.subtitle_encoder->WriteSubtitle(sub)) {
+			SetOutputError(output, output.subtitle_encoder->GetError());
+			return false;
+		}
 	}
+
+	return true;
 }
 
 bool ExportTask::WriteAudioLoop(const TimeRange &time,
 								const SampleBuffer &samples)
 {
-	if (!encoder_->WriteAudio(samples)) {
-		SetError(encoder_->GetError());
-		return false;
+	for (const Output &output : outputs_) {
+		if (output.params.audio_enabled() &&
+			!output.encoder->WriteAudio(samples)) {
+			SetOutputError(output, output.encoder->GetError());
+			return false;
+		}
 	}
 
 	audio_time_ = time.out();
@@ -32,17 +32,33 @@
 namespace olive
 {
 
+/**
+ * @brief Renders a sequence and encodes it to one or more files
+ *
+ * When given several EncodingParams, each frame is rendered once and converted for every output (see
+ * RenderManager::FrameOutput), so e.g. a master and a proxy can be exported for the cost of one render.
+ * All outputs with video must share a frame rate, and the range of the first output is used for all of them.
+ *
+ * If any output fails to open or write, the whole export stops and every output's partial file is removed rather
+ * than replacing an existing file. The error names the output it came from when there's more than one.
+ */
 class ExportTask : public RenderTask {
 	Q_OBJECT
 public:
 	ExportTask(ViewerOutput *viewer_node, ColorManager *color_manager,
 			   const EncodingParams &params);
 
+	ExportTask(ViewerOutput *viewer_node, ColorManager *color_manager,
+			   const QVector<EncodingParams> &params);
+
 protected:
 	virtual bool Run() override;
 
 	virtual bool FrameDownloaded(FramePtr frame, const rational &time) override;
 
+	virtual bool FramesDownloaded(const QVector<FramePtr> &frames,
+								  const rational &time) override;
+
 	virtual bool AudioDownloaded(const TimeRange &range,
 								 const SampleBuffer &samples) override;
 
@@ -53,30 +69,65 @@ protected:
 		return false;
 	}
 
+	/**
+   * @brief Create the encoder for one output, the default creates it from the params' format
+   */
+	virtual Encoder *CreateEncoder(const EncodingParams &params);
+
+	/**
+   * @brief Render the ranges once, downloading a frame for `primary` and each of `additional` per time
+   *
+   * The default passes everything on to Render().
+   */
+	virtual bool RenderOutputs(const TimeRangeList &video_range,
+							   const TimeRangeList &audio_range,
+							   const TimeRange &subtitle_range,
+							   const RenderManager::FrameOutput &primary,
+							   const QVector<RenderManager::FrameOutput> &additional);
+
 private:
-	bool WriteAudioLoop(const TimeRange &time, const SampleBuffer &samples);
+	struct Output {
+		EncodingParams params;
 
-	ProjectCopier *copier_;
+		/// Filename the user asked for, `params` may point at a temporary file until the export finishes
+		QString real_filename;
 
-	QHash<rational, FramePtr> time_map_;
+		std::shared_ptr<Encoder> encoder;
 
-	QHash<TimeRange, SampleBuffer> audio_map_;
+		std::shared_ptr<Encoder> subtitle_encoder;
 
-	ColorManager *color_manager_;
+		ColorProcessorPtr color_processor;
+	};
 
-	EncodingParams params_;
+	bool OpenOutput(Output &output);
 
-	std::shared_ptr<Encoder> encoder_;
+	void SetOutputError(const Output &output, const QString &error);
 
-	std::shared_ptr<Encoder> subtitle_encoder_;
+	bool WriteFrames(const QVector<FramePtr> &frames, const rational &time);
 
-	ColorProcessorPtr color_processor_;
+	bool WriteAudioLoop(const TimeRange &time, const SampleBuffer &samples);
+
+	ProjectCopier *copier_;
+
+	QVector<Output> outputs_;
+
+	/// Indexes into outputs_ of the outputs with video, in the order their frames are rendered
+	QVector<int> video_outputs_;
+
+	QHash<rational, QVector<FramePtr>> time_map_;
+
+	QHash<TimeRange, SampleBuffer> audio_map_;
+
+	ColorManager *color_manager_;
 
 	int64_t frame_time_;
 
 	rational audio_time_;
 
 	TimeRange export_range_;
+
+	/// An output has already reported an error, see SetOutputError()
+	bool output_failed_;
 };
 
 }
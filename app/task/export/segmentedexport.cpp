@@ -0,0 +1,429 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "segmentedexport.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QFile>
+#include <QProcess>
+#include <QThread>
+#include <QTimer>
+#include <cstdio>
+
+#include "codec/ffmpeg/ffmpegremuxer.h"
+#include "common/filefunctions.h"
+#include "node/project/sequence/sequence.h"
+#include "task/project/save/save.h"
+
+namespace olive
+{
+
+SegmentedExportTask::SegmentedExportTask(ViewerOutput *viewer_node,
+										 const EncodingParams &params,
+										 int worker_count)
+	: project_(viewer_node->project())
+	, params_(params)
+	, worker_count_(worker_count)
+{
+	// Workers find the sequence again by its position in the saved copy
+	sequence_index_ =
+		project_->root()->ListChildrenOfType<Sequence>().indexOf(
+			static_cast<Sequence *>(viewer_node));
+
+	if (params_.has_custom_range()) {
+		range_ = params_.custom_range();
+	} else {
+		range_ = TimeRange(0, viewer_node->GetLength());
+	}
+
+	if (range_.in() > 0) {
+		range_.set_in(Timecode::snap_time_to_timebase(
+			range_.in(), params_.video_params().frame_rate_as_time_base()));
+	}
+
+	SetTitle(tr("Exporting \"%1\"").arg(viewer_node->GetLabel()));
+}
+
+bool SegmentedExportTask::CanSegment(ViewerOutput *viewer_node,
+									 const EncodingParams &params)
+{
+	if (!dynamic_cast<Sequence *>(viewer_node) || !params.video_enabled() ||
+		params.video_is_image_sequence()) {
+		return false;
+	}
+
+	// Sidecar files are named after the output, which workers don't know
+	if (params.subtitles_enabled() && params.subtitles_are_sidecar()) {
+		return false;
+	}
+
+	switch (params.format()) {
+	case ExportFormat::kFormatDNxHD:
+	case ExportFormat::kFormatMatroska:
+	case ExportFormat::kFormatQuickTime:
+	case ExportFormat::kFormatMPEG4Video:
+	case ExportFormat::kFormatWebM:
+		return true;
+	default:
+		return false;
+	}
+}
+
+QVector<TimeRange> SegmentedExportTask::SplitRange(const TimeRange &range,
+												   const rational &timebase,
+												   int gop_length, int count)
+{
+	int64_t total = Timecode::time_to_timestamp(range.length(), timebase,
+												Timecode::kCeil);
+	gop_length = std::max(1, gop_length);
+	count = std::max(1, count);
+
+	// Round each segment up to whole GOPs so keyframes land where a single encode would put them
+	int64_t gops = (total + gop_length - 1) / gop_length;
+	int64_t segment_length =
+		((gops + count - 1) / count) * int64_t(gop_length);
+
+	QVector<TimeRange> ranges;
+	for (int64_t start = 0; start < total; start += segment_length) {
+		rational in =
+			range.in() + Timecode::timestamp_to_time(start, timebase);
+		rational out = (start + segment_length >= total) ?
+						   range.out() :
+						   range.in() + Timecode::timestamp_to_time(
+											start + segment_length, timebase);
+		ranges.append(TimeRange(in, out));
+	}
+
+	return ranges;
+}
+
+int SegmentedExportTask::GetGOPLength(const EncodingParams &params)
+{
+	bool ok;
+	int g = params.video_option(QStringLiteral("g")).toInt(&ok);
+	return (ok && g > 0) ? g : kDefaultGOPLength;
+}
+
+void SegmentedExportTask::WriteWorkerProgress(double progress)
+{
+	printf("progress %f\n", progress);
+	fflush(stdout);
+}
+
+bool SegmentedExportTask::ReadWorkerProgress(const QByteArray &line,
+											 double *progress)
+{
+	QByteArray l = line.trimmed();
+	if (!l.startsWith("progress ")) {
+		return false;
+	}
+
+	bool ok;
+	double d = l.mid(9).toDouble(&ok);
+	if (ok) {
+		*progress = d;
+	}
+
+	return ok;
+}
+
+QStringList
+SegmentedExportTask::GetWorkerArguments(const QString &params_file,
+										int sequence_index,
+										const QString &project_file)
+{
+	return { QStringLiteral("--export"),
+			 QStringLiteral("--export-params"),
+			 params_file,
+			 QStringLiteral("--export-sequence"),
+			 QString::number(sequence_index),
+			 QStringLiteral("--export-report"),
+			 project_file };
+}
+
+QProcessEnvironment SegmentedExportTask::GetWorkerEnvironment()
+{
+	QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+	env.insert(QStringLiteral("QT_QPA_PLATFORM"), QStringLiteral("offscreen"));
+	return env;
+}
+
+bool SegmentedExportTask::Run()
+{
+	if (sequence_index_ == -1) {
+		SetError(tr("Only sequences can be exported in segments"));
+		return false;
+	}
+
+	if (!SaveProject()) {
+		return false;
+	}
+
+	const QString ext = ExportFormat::GetExtension(params_.format());
+	QVector<Worker> workers;
+
+	// Fixed GOPs so every segment is encoded with the same cadence a single encode would have had
+	const int gop = GetGOPLength(params_);
+	QVector<TimeRange> ranges =
+		SplitRange(range_, params_.video_params().frame_rate_as_time_base(),
+				   gop, worker_count_);
+
+	for (int i = 0; i < ranges.size(); i++) {
+		EncodingParams p = params_;
+		p.DisableAudio();
+		p.DisableSubtitles();
+		p.set_custom_range(ranges.at(i));
+		p.set_video_option(QStringLiteral("g"), QString::number(gop));
+
+		// Split the encoder's threads between workers rather than having each of them use every core
+		if (p.video_threads() == 0) {
+			p.set_video_threads(
+				std::max(1, QThread::idealThreadCount() / ranges.size()));
+		}
+
+		Worker w;
+		w.output = dir_.filePath(QStringLiteral("segment%1.%2").arg(i).arg(ext));
+		p.SetFilename(w.output);
+		w.params_file = WriteParams(p, QStringLiteral("segment%1.xml").arg(i));
+		w.video = true;
+		workers.append(w);
+	}
+
+	// Audio and subtitles are cheap next to video, so one worker encodes all of them
+	QString streams_file;
+	if (params_.audio_enabled() || params_.subtitles_enabled()) {
+		EncodingParams p = params_;
+		p.DisableVideo();
+		p.set_custom_range(range_);
+
+		Worker w;
+		w.output = dir_.filePath(QStringLiteral("streams.%1").arg(ext));
+		p.SetFilename(w.output);
+		w.params_file = WriteParams(p, QStringLiteral("streams.xml"));
+		w.video = false;
+		workers.append(w);
+
+		streams_file = w.output;
+	}
+
+	for (const Worker &w : workers) {
+		if (w.params_file.isEmpty()) {
+			SetError(tr("Failed to write export parameters"));
+			return false;
+		}
+	}
+
+	if (!RunWorkers(workers)) {
+		return false;
+	}
+
+	QStringList segments;
+	for (const Worker &w : workers) {
+		if (w.video) {
+			segments.append(w.output);
+		}
+	}
+
+	// For safety, if we're overwriting, we save to a temporary filename and then only overwrite it
+	// at the end
+	QString real_filename = params_.filename();
+	QString write_filename = real_filename;
+	if (QFileInfo::exists(real_filename)) {
+		write_filename = FileFunctions::GetSafeTemporaryFilename(real_filename);
+	}
+
+	QString error;
+	if (!FFmpegRemuxer::Concat(segments, streams_file, write_filename,
+							   &error)) {
+		QFile::remove(write_filename);
+		SetError(tr("Failed to join segments: %1").arg(error));
+		return false;
+	}
+
+	if (write_filename != real_filename &&
+		!FileFunctions::RenameFileAllowOverwrite(write_filename,
+												 real_filename)) {
+		SetError(
+			tr("Failed to overwrite \"%1\". Export has been saved as \"%2\" instead.")
+				.arg(real_filename, write_filename));
+		return false;
+	}
+
+	emit ProgressChanged(1.0);
+
+	return true;
+}
+
+bool SegmentedExportTask::SaveProject()
+{
+	if (!project_) {
+		SetError(tr("Project was closed before it could be exported."));
+		return false;
+	}
+
+	// Workers load the project from disk, so give them a copy of its current state
+	project_file_ = dir_.filePath(QStringLiteral("project.ove"));
+
+	ProjectSaveTask save(project_, ProjectSerializer::kUncompressed);
+	save.SetOverrideFilename(project_file_);
+
+	// Nothing may modify the project while it's serialized, so that has to happen on its thread
+	bool snapshot = false;
+	auto take_snapshot = [&save, &snapshot] { snapshot = save.TakeSnapshot(); };
+	if (QThread::currentThread() == project_->thread()) {
+		take_snapshot();
+	} else {
+		QMetaObject::invokeMethod(project_, take_snapshot,
+								  Qt::BlockingQueuedConnection);
+	}
+
+	if (!snapshot || !save.Start()) {
+		SetError(save.GetError());
+		return false;
+	}
+
+	return true;
+}
+
+bool SegmentedExportTask::RunWorkers(QVector<Worker> &workers)
+{
+	QEventLoop loop;
+	QVector<QProcess *> processes(workers.size());
+	int running = workers.size();
+	int video_workers = 0;
+	bool failed = false;
+
+	for (const Worker &w : workers) {
+		if (w.video) {
+			video_workers++;
+		}
+	}
+
+	auto stop_all = [&] {
+		for (QProcess *p : processes) {
+			if (p->state() != QProcess::NotRunning) {
+				p->kill();
+			}
+		}
+	};
+
+	for (int i = 0; i < workers.size(); i++) {
+		QProcess *p = new QProcess();
+		processes[i] = p;
+
+		// Progress is reported on stdout, anything else the worker logs goes to stderr
+		connect(p, &QProcess::readyReadStandardOutput, p, [&, i, p] {
+			while (p->canReadLine()) {
+				double progress;
+				if (!ReadWorkerProgress(p->readLine(), &progress) ||
+					!workers.at(i).video) {
+					continue;
+				}
+
+				workers[i].progress = progress;
+
+				double total = 0;
+				for (const Worker &w : workers) {
+					if (w.video) {
+						total += w.progress;
+					}
+				}
+
+				// Save the last little bit for joining the segments
+				emit ProgressChanged(total / video_workers * 0.95);
+			}
+		});
+
+		connect(p,
+				QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), p,
+				[&, p](int code, QProcess::ExitStatus status) {
+					if (!failed &&
+						(status != QProcess::NormalExit || code != 0)) {
+						failed = true;
+
+						QString err = QString::fromUtf8(p->readAllStandardError())
+										  .trimmed();
+						SetError(tr("Export worker failed: %1")
+									 .arg(err.section('\n', -1)));
+
+						// No point finishing the others
+						stop_all();
+					}
+
+					running--;
+					if (running == 0) {
+						loop.quit();
+					}
+				});
+
+		connect(p, &QProcess::errorOccurred, p,
+				[&, p](QProcess::ProcessError e) {
+					if (e == QProcess::FailedToStart) {
+						failed = true;
+						SetError(tr("Failed to start export worker: %1")
+									 .arg(p->errorString()));
+						running--;
+						if (running == 0) {
+							loop.quit();
+						}
+					}
+				});
+	}
+
+	QTimer cancel_timer;
+	cancel_timer.setInterval(100);
+	connect(&cancel_timer, &QTimer::timeout, &loop, [&] {
+		if (IsCancelled()) {
+			stop_all();
+		}
+	});
+	cancel_timer.start();
+
+	for (int i = 0; i < workers.size(); i++) {
+		processes[i]->setProcessEnvironment(GetWorkerEnvironment());
+		processes[i]->start(QCoreApplication::applicationFilePath(),
+							GetWorkerArguments(workers.at(i).params_file,
+											   sequence_index_, project_file_));
+	}
+
+	loop.exec();
+
+	qDeleteAll(processes);
+
+	return !failed && !IsCancelled();
+}
+
+QString SegmentedExportTask::WriteParams(const EncodingParams &params,
+										 const QString &name)
+{
+	QString filename = dir_.filePath(name);
+
+	QFile f(filename);
+	if (!f.open(QFile::WriteOnly)) {
+		return QString();
+	}
+
+	params.Save(&f);
+	return filename;
+}
+
+}
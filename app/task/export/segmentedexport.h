@@ -0,0 +1,135 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef SEGMENTEDEXPORTTASK_H
+#define SEGMENTEDEXPORTTASK_H
+
+#include <QPointer>
+#include <QProcessEnvironment>
+#include <QTemporaryDir>
+
+#include "codec/encoder.h"
+#include "node/output/viewer/viewer.h"
+#include "task/task.h"
+
+namespace olive
+{
+
+/**
+ * @brief Exports a sequence by splitting it between several headless worker processes
+ *
+ * One process only has one video render thread and one encoder, so a single export can't use every core of a
+ * machine. This task saves a copy of the project, splits the export range at GOP boundaries and launches one
+ * `--export` worker per segment (plus one for audio and subtitles), each encoding its part to an intermediate
+ * file. Once they've all finished, the segments are concatenated without re-encoding and the audio is muxed
+ * in alongside them (see FFmpegRemuxer).
+ *
+ * Workers report their progress on stdout (see WriteWorkerProgress()).
+ */
+class SegmentedExportTask : public Task {
+	Q_OBJECT
+public:
+	SegmentedExportTask(ViewerOutput *viewer_node, const EncodingParams &params,
+						int worker_count);
+
+	/// Length (in frames) of GOPs when the params don't specify one with the "g" option
+	static const int kDefaultGOPLength = 250;
+
+	/**
+   * @brief Whether an export with these params can be split
+   *
+   * Only single file video exports from sequences can, image sequences are already written in parallel.
+   */
+	static bool CanSegment(ViewerOutput *viewer_node,
+						   const EncodingParams &params);
+
+	/**
+   * @brief Split `range` into at most `count` segments that each start on a GOP boundary
+   */
+	static QVector<TimeRange> SplitRange(const TimeRange &range,
+										 const rational &timebase,
+										 int gop_length, int count);
+
+	static int GetGOPLength(const EncodingParams &params);
+
+	/**
+   * @brief Used by workers to report progress to the coordinating task
+   */
+	static void WriteWorkerProgress(double progress);
+
+	/**
+   * @brief Parse a line a worker wrote with WriteWorkerProgress()
+   *
+   * Returns false if the line isn't a progress report.
+   */
+	static bool ReadWorkerProgress(const QByteArray &line, double *progress);
+
+	static QStringList GetWorkerArguments(const QString &params_file,
+										  int sequence_index,
+										  const QString &project_file);
+
+	/**
+   * @brief Environment workers are started with
+   *
+   * Workers never show a window, so they use the offscreen platform and don't need a display.
+   */
+	static QProcessEnvironment GetWorkerEnvironment();
+
+protected:
+	virtual bool Run() override;
+
+private:
+	struct Worker {
+		QString params_file;
+		QString output;
+		bool video;
+		double progress = 0;
+	};
+
+	/**
+   * @brief Save a copy of the project for the workers to load
+   *
+   * The project is serialized on its own thread, the file is written on this one.
+   */
+	bool SaveProject();
+
+	bool RunWorkers(QVector<Worker> &workers);
+
+	QString WriteParams(const EncodingParams &params, const QString &name);
+
+	QTemporaryDir dir_;
+
+	QPointer<Project> project_;
+
+	QString project_file_;
+
+	int sequence_index_;
+
+	EncodingParams params_;
+
+	TimeRange range_;
+
+	int worker_count_;
+};
+
+}
+
+#endif // SEGMENTEDEXPORTTASK_H
@@ -39,10 +39,13 @@ bool ProjectLoadTask::Run()
 
 	project_->set_filename(GetFilename());
 
+	// Reading the file is most of the work, connecting nodes afterwards is the rest
 	ProjectSerializer::Result result = ProjectSerializer::Load(
-		project_, GetFilename(), ProjectSerializer::kProject);
+		project_, GetFilename(), ProjectSerializer::kProject,
+		[this](double d) { emit ProgressChanged(d * 0.9); });
 
 	layout_ = result.GetLoadData().layout;
+	timings_ = result.GetLoadData().timings;
 
 	switch (result.code()) {
 	case ProjectSerializer::kSuccess:
@@ -78,6 +81,7 @@ bool ProjectLoadTask::Run()
 	}
 
 	if (result == ProjectSerializer::kSuccess) {
+		emit ProgressChanged(1.0);
 		project_->moveToThread(qApp->thread());
 		return true;
 	} else {
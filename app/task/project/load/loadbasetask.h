@@ -48,11 +48,23 @@ public:
 		return layout_;
 	}
 
+	/**
+   * @brief How long each phase of loading took in milliseconds, in the order they ran
+   *
+   * Empty if the loader doesn't measure its phases.
+   */
+	const QVector<QPair<QString, qint64>> &GetLoadTimings() const
+	{
+		return timings_;
+	}
+
 protected:
 	Project *project_;
 
 	MainWindowLayoutInfo layout_;
 
+	QVector<QPair<QString, qint64>> timings_;
+
 private:
 	QString filename_;
 };
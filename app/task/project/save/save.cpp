@@ -27,33 +27,80 @@
 
 #include "common/filefunctions.h"
 #include "core.h"
-#include "node/project/serializer/serializer.h"
 
 namespace olive
 {
 
-ProjectSaveTask::ProjectSaveTask(Project *project, bool use_compression)
+ProjectSaveTask::ProjectSaveTask(Project *project,
+								 ProjectSerializer::Compression compression)
 	: project_(project)
-	, use_compression_(use_compression)
+	, compression_(compression)
+	, has_snapshot_(false)
 {
 	SetTitle(tr("Saving '%1'").arg(project->filename()));
 }
 
-bool ProjectSaveTask::Run()
+bool ProjectSaveTask::TakeSnapshot()
 {
-	QString using_filename = override_filename_.isEmpty() ?
-								 project_->filename() :
-								 override_filename_;
+	if (!project_) {
+		SetError(tr("Project was closed before it could be saved."));
+		return false;
+	}
+
+	filename_ = override_filename_.isEmpty() ? project_->filename() :
+											   override_filename_;
 
 	ProjectSerializer::SaveData data(ProjectSerializer::kProject);
 
-	data.SetFilename(using_filename);
+	data.SetFilename(filename_);
 	data.SetProject(project_);
 	data.SetLayout(layout_);
 
+	snapshot_.clear();
+	QXmlStreamWriter writer(&snapshot_);
+
+	ProjectSerializer::Result result = ProjectSerializer::Save(&writer, data);
+	if (writer.hasError()) {
+		result = ProjectSerializer::kXmlError;
+	}
+
+	has_snapshot_ = (result.code() == ProjectSerializer::kSuccess);
+	if (!has_snapshot_) {
+		snapshot_.clear();
+		return HandleResult(result);
+	}
+
+	return true;
+}
+
+void ProjectSaveTask::StartInBackground()
+{
+	GetSaveThread()->start([this] { Start(); });
+}
+
+void ProjectSaveTask::WaitForBackgroundSaves()
+{
+	GetSaveThread()->waitForDone();
+}
+
+bool ProjectSaveTask::Run()
+{
+	if (!has_snapshot_ && !TakeSnapshot()) {
+		return false;
+	}
+
 	ProjectSerializer::Result result =
-		ProjectSerializer::Save(data, use_compression_);
+		ProjectSerializer::Write(filename_, snapshot_, compression_);
+
+	// Large projects can take a lot of memory, don't hold onto it until the task is deleted
+	snapshot_.clear();
+	has_snapshot_ = false;
 
+	return HandleResult(result);
+}
+
+bool ProjectSaveTask::HandleResult(const ProjectSerializer::Result &result)
+{
 	bool success = false;
 
 	switch (result.code()) {
@@ -70,7 +117,7 @@ bool ProjectSaveTask::Run()
 	case ProjectSerializer::kOverwriteError:
 		SetError(
 			tr("Failed to overwrite \"%1\". Project has been saved as \"%2\" instead.")
-				.arg(using_filename, result.GetDetails()));
+				.arg(filename_, result.GetDetails()));
 		success = true;
 		break;
 
@@ -86,4 +133,16 @@ bool ProjectSaveTask::Run()
 	return success;
 }
 
+QThreadPool *ProjectSaveTask::GetSaveThread()
+{
+	// One thread, so saves are written in the order they're started
+	static QThreadPool *pool = [] {
+		QThreadPool *p = new QThreadPool();
+		p->setMaxThreadCount(1);
+		return p;
+	}();
+
+	return pool;
+}
+
 }
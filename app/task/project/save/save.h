@@ -22,17 +22,34 @@
 #ifndef PROJECTSAVEMANAGER_H
 #define PROJECTSAVEMANAGER_H
 
+#include <QPointer>
+#include <QThreadPool>
+
 #include "node/project.h"
+#include "node/project/serializer/serializer.h"
 #include "task/task.h"
 
 namespace olive
 {
 
+/**
+ * @brief Saves a project in two steps: a snapshot and a write
+ *
+ * TakeSnapshot() serializes the project to XML in memory. That has to happen on the project's
+ * thread while nothing can modify it, but Project::Save() reuses the XML of every node that hasn't
+ * changed since the last save, so after the first save it only costs as much as what was edited.
+ * Run() then compresses the snapshot and writes it to disk. It doesn't touch the project, so
+ * StartInBackground() can do it while editing continues.
+ */
 class ProjectSaveTask : public Task {
 	Q_OBJECT
 public:
-	ProjectSaveTask(Project *project, bool use_compression);
+	ProjectSaveTask(Project *project,
+					ProjectSerializer::Compression compression);
 
+	/**
+   * @brief The project being saved, or nullptr if it was closed before the save finished
+   */
 	Project *GetProject() const
 	{
 		return project_;
@@ -48,17 +65,47 @@ public:
 		layout_ = layout;
 	}
 
+	/**
+   * @brief Serialize the project into memory
+   *
+   * If this isn't called before the task starts, Run() takes the snapshot itself.
+   */
+	bool TakeSnapshot();
+
+	/**
+   * @brief Write the snapshot on the save thread
+   *
+   * Saves are written one at a time in the order they were started, so an older snapshot never
+   * overwrites a newer one. Finished() is emitted from the save thread.
+   */
+	void StartInBackground();
+
+	/**
+   * @brief Block until every save started with StartInBackground() has been written
+   */
+	static void WaitForBackgroundSaves();
+
 protected:
 	virtual bool Run() override;
 
 private:
-	Project *project_;
+	bool HandleResult(const ProjectSerializer::Result &result);
+
+	static QThreadPool *GetSaveThread();
+
+	QPointer<Project> project_;
 
 	QString override_filename_;
 
-	bool use_compression_;
+	QString filename_;
+
+	ProjectSerializer::Compression compression_;
 
 	MainWindowLayoutInfo layout_;
+
+	QByteArray snapshot_;
+
+	bool has_snapshot_;
 };
 
 }
@@ -43,7 +43,8 @@ bool RenderTask::Render(ColorManager *manager, const TimeRangeList &video_range,
 						FrameHashCache *cache, const QSize &force_size,
 						const QMatrix4x4 &force_matrix,
 						PixelFormat force_format, int force_channel_count,
-						ColorProcessorPtr force_color_output)
+						ColorProcessorPtr force_color_output,
+						const QVector<RenderManager::FrameOutput> &additional_outputs)
 {
 	QMetaObject::invokeMethod(RenderManager::instance(),
 							  "SetAggressiveGarbageCollection",
@@ -74,6 +75,19 @@ bool RenderTask::Render(ColorManager *manager, const TimeRangeList &video_range,
 		watcher->SetTicket(RenderManager::instance()->RenderAudio(rap));
 	}
 
+	// Plugins see the whole render as one sequence, from the first frame to the last
+	sequence_range_ = TimeRange();
+	bool first_range = true;
+	for (const TimeRange &r : video_range) {
+		if (first_range) {
+			sequence_range_ = r;
+			first_range = false;
+		} else {
+			sequence_range_ = TimeRange(std::min(sequence_range_.in(), r.in()),
+										std::max(sequence_range_.out(), r.out()));
+		}
+	}
+
 	// Look up hashes
 	TimeRangeListFrameIterator iterator(
 		video_range, video_params().frame_rate_as_time_base());
@@ -91,7 +105,7 @@ bool RenderTask::Render(ColorManager *manager, const TimeRangeList &video_range,
 		 i < maximum_rendered_frames && iterator.GetNext(&next_frame); i++) {
 		StartTicket(&watcher_thread, manager, next_frame, mode, cache,
 					force_size, force_matrix, force_format, force_channel_count,
-					force_color_output);
+					force_color_output, additional_outputs);
 	}
 
 	bool result = true;
@@ -205,9 +219,20 @@ bool RenderTask::Render(ColorManager *manager, const TimeRangeList &video_range,
 
 			} else {
 				// Assume single-step video or video download ticket
-				if (!FrameDownloaded(
-						watcher->Get().value<FramePtr>(),
-						watcher->property("time").value<rational>())) {
+				rational time = watcher->property("time").value<rational>();
+				bool downloaded;
+				if (additional_outputs.isEmpty()) {
+					downloaded =
+						FrameDownloaded(watcher->Get().value<FramePtr>(), time);
+				} else {
+					QVector<FramePtr> frames = { watcher->Get().value<FramePtr>() };
+					frames.append(watcher->GetTicket()
+									  ->property("additionalframes")
+									  .value<QVector<FramePtr>>());
+					downloaded = FramesDownloaded(frames, time);
+				}
+
+				if (!downloaded) {
 					result = false;
 				}
 
@@ -224,7 +249,8 @@ bool RenderTask::Render(ColorManager *manager, const TimeRangeList &video_range,
 				if (iterator.GetNext(&next_frame)) {
 					StartTicket(&watcher_thread, manager, next_frame, mode,
 								cache, force_size, force_matrix, force_format,
-								force_channel_count, force_color_output);
+								force_channel_count, force_color_output,
+								additional_outputs);
 				}
 			}
 
@@ -287,6 +313,12 @@ bool RenderTask::DownloadFrame(QThread *thread, FramePtr frame,
 	return true;
 }
 
+bool RenderTask::FramesDownloaded(const QVector<FramePtr> &frames,
+								  const rational &time)
+{
+	return FrameDownloaded(frames.first(), time);
+}
+
 bool RenderTask::EncodeSubtitle(const SubtitleBlock *subtitle)
 {
 	Q_UNUSED(subtitle)
@@ -313,7 +345,8 @@ void RenderTask::StartTicket(QThread *watcher_thread, ColorManager *manager,
 							 FrameHashCache *cache, const QSize &force_size,
 							 const QMatrix4x4 &force_matrix,
 							 PixelFormat force_format, int force_channel_count,
-							 ColorProcessorPtr force_color_output)
+							 ColorProcessorPtr force_color_output,
+							 const QVector<RenderManager::FrameOutput> &additional_outputs)
 {
 	RenderManager::RenderVideoParams rvp(viewer_->GetConnectedTextureOutput(),
 										 video_params_, audio_params_, time,
@@ -324,6 +357,8 @@ void RenderTask::StartTicket(QThread *watcher_thread, ColorManager *manager,
 	rvp.force_format = force_format;
 	rvp.force_color_output = force_color_output;
 	rvp.force_channel_count = force_channel_count;
+	rvp.additional_outputs = additional_outputs;
+	rvp.sequence_range = sequence_range_;
 
 	if (cache) {
 		rvp.AddCache(cache);
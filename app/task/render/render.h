@@ -28,6 +28,7 @@
 #include "node/color/colormanager/colormanager.h"
 #include "node/output/viewer/viewer.h"
 #include "task/task.h"
+#include "render/rendermanager.h"
 #include "render/renderticket.h"
 
 namespace olive
@@ -48,13 +49,24 @@ protected:
 				const QMatrix4x4 &force_matrix = QMatrix4x4(),
 				PixelFormat force_format = PixelFormat::INVALID,
 				int force_channel_count = 0,
-				ColorProcessorPtr force_color_output = nullptr);
+				ColorProcessorPtr force_color_output = nullptr,
+				const QVector<RenderManager::FrameOutput> &additional_outputs =
+					QVector<RenderManager::FrameOutput>());
 
 	virtual bool DownloadFrame(QThread *thread, FramePtr frame,
 							   const rational &time);
 
 	virtual bool FrameDownloaded(FramePtr frame, const rational &time) = 0;
 
+	/**
+   * @brief Called instead of FrameDownloaded() with the frame for each output passed to Render()
+   *
+   * `frames` starts with the frame for the forced parameters, followed by one per additional output in order.
+   * The default implementation only passes the first on to FrameDownloaded().
+   */
+	virtual bool FramesDownloaded(const QVector<FramePtr> &frames,
+								  const rational &time);
+
 	virtual bool AudioDownloaded(const TimeRange &range,
 								 const SampleBuffer &samples) = 0;
 
@@ -125,7 +137,8 @@ private:
 					 FrameHashCache *cache, const QSize &force_size,
 					 const QMatrix4x4 &force_matrix, PixelFormat force_format,
 					 int force_channel_count,
-					 ColorProcessorPtr force_color_output);
+					 ColorProcessorPtr force_color_output,
+					 const QVector<RenderManager::FrameOutput> &additional_outputs);
 
 	ViewerOutput *viewer_;
 
@@ -143,6 +156,8 @@ private:
 
 	int64_t total_number_of_frames_;
 
+	TimeRange sequence_range_;
+
 private slots:
 	void TicketDone(RenderTicketWatcher *watcher);
 };
@@ -70,6 +70,13 @@ TimeBasedWidget::TimeBasedWidget(bool ruler_text_visible,
 			&TimeBasedWidget::CatchUpTimerTimeout);
 }
 
+TimeBasedWidget::~TimeBasedWidget()
+{
+	if (viewer_node_) {
+		viewer_node_->ReleaseCaches();
+	}
+}
+
 void TimeBasedWidget::SetScaleAndCenterOnPlayhead(const double &scale)
 {
 	SetScale(scale);
@@ -107,6 +114,9 @@ void TimeBasedWidget::ConnectViewerNode(ViewerOutput *node)
 		// Call potential derivative functions for disconnecting the viewer node
 		DisconnectNodeEvent(old);
 
+		// Frees the node's cache memory if no other panel is showing it
+		old->ReleaseCaches();
+
 		// Disconnect length changed signal
 		disconnect(old, &ViewerOutput::LengthChanged, this,
 				   &TimeBasedWidget::UpdateMaximumScroll);
@@ -136,6 +146,8 @@ void TimeBasedWidget::ConnectViewerNode(ViewerOutput *node)
 	ConnectedNodeChangeEvent(viewer_node_.data());
 
 	if (viewer_node_) {
+		viewer_node_->RetainCaches();
+
 		// Connect length changed signal
 		connect(viewer_node_.data(), &ViewerOutput::LengthChanged, this,
 				&TimeBasedWidget::UpdateMaximumScroll);
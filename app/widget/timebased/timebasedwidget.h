@@ -45,6 +45,8 @@ public:
 					bool ruler_cache_status_visible = false,
 					QWidget *parent = nullptr);
 
+	virtual ~TimeBasedWidget() override;
+
 	void ZoomIn();
 
 	void ZoomOut();
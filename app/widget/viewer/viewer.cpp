@@ -364,8 +364,42 @@ void ViewerWidget::resizeEvent(QResizeEvent *event)
 
 RenderTicketPtr ViewerWidget::GetSingleFrame(const rational &t, bool dry)
 {
+	int divider = 0;
+
+	if ((IsPlaying() || prequeuing_video_) &&
+		playback_scheduler_.divider_multiplier() > 1) {
+		// Playback can't keep up at the sequence's preview resolution, drop it further
+		divider = GetConnectedNode()->GetVideoParams().divider() *
+				  playback_scheduler_.divider_multiplier();
+	}
+
+	// Plugins keep one sequence render open for the range playback runs through. A paused viewer renders frames
+	// in any order, so each one is a range of its own.
+	TimeRange sequence_range;
+	if (IsPlaying() || prequeuing_video_) {
+		sequence_range = GetPlaybackRange();
+	} else {
+		sequence_range = TimeRange(t, t + timebase());
+	}
+
 	return RenderManager::instance()->GetCacher()->GetSingleFrame(
-		this->GetConnectedNode(), t, dry);
+		this->GetConnectedNode(), t, dry, divider, sequence_range);
+}
+
+TimeRange ViewerWidget::GetPlaybackRange() const
+{
+	if (recording_ && recording_range_.out() != recording_range_.in()) {
+		// Limit recording range if applicable
+		return recording_range_;
+	}
+
+	if (play_in_to_out_only_ && GetConnectedNode()->GetWorkArea()->enabled()) {
+		// If "play in to out" is enabled or we're looping AND we have a workarea, only play the workarea
+		return GetConnectedNode()->GetWorkArea()->range();
+	}
+
+	// Otherwise set the bounds to the range of the sequence
+	return TimeRange(0, GetConnectedNode()->GetLength());
 }
 
 void ViewerWidget::TogglePlayPause()
@@ -1072,6 +1106,13 @@ void ViewerWidget::PlayInternal(int speed, bool in_to_out_only)
 	playback_speed_ = speed;
 	play_in_to_out_only_ = in_to_out_only;
 
+	// Open decoders for upcoming clips before the playhead reaches them
+	RenderManager::instance()->GetCacher()->SetPlaybackState(
+		GetConnectedNode(), playback_speed_);
+
+	playback_scheduler_.Reset(timebase().toDouble() * 1000.0 / qAbs(speed));
+	sequence_stats_start_ = OIIOSequenceReader::GetStats();
+
 	playback_queue_next_frame_ = GetTimestamp() + playback_speed_;
 
 	controls_->ShowPauseButton();
@@ -1153,6 +1194,7 @@ void ViewerWidget::PauseInternal()
 		UpdateAudioProcessor();
 
 		RenderManager::instance()->GetCacher()->SetThumbnailsPaused(false);
+		RenderManager::instance()->GetCacher()->SetPlaybackState(nullptr, 0);
 
 		UpdateTextureFromNode();
 
@@ -1269,7 +1311,8 @@ RenderTicketWatcher *ViewerWidget::RequestNextFrameForQueue(bool increment)
 
 	if (FrameExistsAtTime(next_time) || ViewerMightBeAStill()) {
 		if (increment) {
-			playback_queue_next_frame_ += playback_speed_;
+			playback_queue_next_frame_ +=
+				playback_speed_ * playback_scheduler_.frame_step();
 		}
 
 		watcher = new RenderTicketWatcher();
@@ -1371,9 +1414,10 @@ int ViewerWidget::DeterminePlaybackQueueSize()
 
 	int remaining_frames = (end_ts - GetTimestamp() - 1) / playback_speed_;
 
-	// Generate maximum queue
-	int max_frames =
+	// Until render latency has been measured, queue a fixed interval's worth of frames
+	int default_frames =
 		qCeil(kVideoPlaybackInterval.toDouble() / timebase().toDouble());
+	int max_frames = playback_scheduler_.GetQueueSize(default_frames);
 
 	return qMin(max_frames, remaining_frames);
 }
@@ -1463,18 +1507,37 @@ void ViewerWidget::RendererGeneratedFrameForQueue()
 					watcher->property("start").toLongLong();
 				const qint64 now_ms =
 					QDateTime::currentMSecsSinceEpoch();
-				const int playback_step = qMax(1, qAbs(playback_speed_));
-				const double frame_interval_ms = qMax(
-					1.0,
-					timebase().toDouble() * 1000.0 /
-						static_cast<double>(playback_step));
-				if (start_ms > 0 &&
-					(now_ms - start_ms) > frame_interval_ms) {
-					drop_frame = true;
-				}
 
 				rational ts = watcher->property("time").value<rational>();
 
+				if (start_ms > 0) {
+					// Quality changes show up in the playback stats overlay
+					playback_scheduler_.AddSample(start_ms, now_ms);
+
+					ViewerPlaybackScheduler::Stats stats =
+						playback_scheduler_.GetStats(prequeue_length_);
+
+					OIIOSequenceReader::Stats seq =
+						OIIOSequenceReader::GetStats();
+					seq.prefetch_used -= sequence_stats_start_.prefetch_used;
+					seq.prefetch_wasted -=
+						sequence_stats_start_.prefetch_wasted;
+					seq.synchronous -= sequence_stats_start_.synchronous;
+
+					foreach (ViewerDisplayWidget *dw, playback_devices_) {
+						dw->SetPlaybackStats(stats);
+						dw->SetSequenceStats(seq);
+					}
+				}
+
+				// Frames are requested ahead of time, so a frame is only late if playback has
+				// already passed it
+				if (IsPlaying() && !prequeuing_video_) {
+					rational playhead = GetConnectedNode()->GetPlayhead();
+					drop_frame = (playback_speed_ > 0) ? (ts < playhead) :
+														 (ts > playhead);
+				}
+
 				if (!drop_frame) {
 					foreach (ViewerDisplayWidget *dw, playback_devices_) {
 						const bool is_multicam =
@@ -1895,24 +1958,9 @@ void ViewerWidget::PlaybackTimerUpdate()
 	rational current_time = Timecode::timestamp_to_time(
 		display_widget_->timer()->GetTimestampNow(), timebase());
 
-	rational min_time, max_time;
-
-	if (recording_ && recording_range_.out() != recording_range_.in()) {
-		// Limit recording range if applicable
-		min_time = recording_range_.in();
-		max_time = recording_range_.out();
-
-	} else if (play_in_to_out_only_ &&
-			   GetConnectedNode()->GetWorkArea()->enabled()) {
-		// If "play in to out" is enabled or we're looping AND we have a workarea, only play the workarea
-		min_time = GetConnectedNode()->GetWorkArea()->in();
-		max_time = GetConnectedNode()->GetWorkArea()->out();
-
-	} else {
-		// Otherwise set the bounds to the range of the sequence
-		min_time = 0;
-		max_time = GetConnectedNode()->GetLength();
-	}
+	const TimeRange playback_range = GetPlaybackRange();
+	rational min_time = playback_range.in();
+	rational max_time = playback_range.out();
 
 	// If we're stopping playback on the last frame rather than after it, subtract our max time
 	// by one timebase unit
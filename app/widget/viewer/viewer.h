@@ -35,6 +35,7 @@
 #include "render/previewaudiodevice.h"
 #include "render/previewautocacher.h"
 #include "viewerdisplay.h"
+#include "viewerplaybackscheduler.h"
 #include "viewersizer.h"
 #include "viewerwindow.h"
 #include "widget/playbackcontrols/playbackcontrols.h"
@@ -255,6 +256,11 @@ private:
 
 	RenderTicketPtr GetFrame(const rational &t);
 
+	/**
+   * @brief Range playback runs through: the recording range, the workarea when playing in to out, or the sequence
+   */
+	TimeRange GetPlaybackRange() const;
+
 	void FinishPlayPreprocess();
 
 	int DeterminePlaybackQueueSize();
@@ -321,6 +327,10 @@ private:
 	int prequeue_length_;
 	int prequeue_count_;
 
+	ViewerPlaybackScheduler playback_scheduler_;
+
+	OIIOSequenceReader::Stats sequence_stats_start_;
+
 	QVector<RenderTicketWatcher *> queue_watchers_;
 
 	std::list<RenderTicketWatcher *> audio_playback_queue_;
@@ -66,6 +66,7 @@ ViewerDisplayWidget::ViewerDisplayWidget(QWidget *parent)
 	, deinterlace_(false)
 	, show_fps_(false)
 	, frames_skipped_(0)
+	, has_playback_stats_(false)
 	, show_widget_background_(false)
 	, playback_speed_(0)
 	, push_mode_(kPushNull)
@@ -253,6 +254,8 @@ void ViewerDisplayWidget::ResetFPSTimer()
 	fps_timer_update_count_ = 0;
 	frames_skipped_ = 0;
 	frame_rate_average_count_ = 0;
+	has_playback_stats_ = false;
+	sequence_stats_ = OIIOSequenceReader::Stats();
 
 	Core::instance()->ClearStatusBarMessage();
 }
@@ -594,11 +597,75 @@ void ViewerDisplayWidget::OnPaint()
 				&p, GetInnerRect(),
 				tr("%1 FPS").arg(QString::number(average, 'f', 1)));
 
+			int line = 1;
+
 			if (frames_skipped_ > 0) {
 				DrawTextWithCrudeShadow(
 					&p,
-					GetInnerRect().adjusted(0, p.fontMetrics().height(), 0, 0),
+					GetInnerRect().adjusted(
+						0, p.fontMetrics().height() * line, 0, 0),
 					tr("%1 frames skipped").arg(frames_skipped_));
+				line++;
+			}
+
+			if (has_playback_stats_) {
+				const ViewerPlaybackScheduler::Stats &st = playback_stats_;
+
+				QString stats =
+					tr("Render %1 ms (worst %2 ms), %3/%4 FPS, queue %5")
+						.arg(QString::number(st.mean_latency_ms, 'f', 0),
+							 QString::number(st.quantile_latency_ms, 'f', 0),
+							 QString::number(st.throughput_fps, 'f', 1),
+							 QString::number(st.target_fps, 'f', 1),
+							 QString::number(st.queue_size));
+
+				if (st.divider_multiplier > 1) {
+					stats.append(
+						tr(", resolution reduced %1x").arg(st.divider_multiplier));
+				}
+
+				if (st.frame_step > 1) {
+					stats.append(tr(", rendering every %1 frames")
+									 .arg(st.frame_step));
+				}
+
+				DrawTextWithCrudeShadow(
+					&p,
+					GetInnerRect().adjusted(
+						0, p.fontMetrics().height() * line, 0, 0),
+					stats);
+				line++;
+			}
+
+			const OIIOSequenceReader::Stats &seq = sequence_stats_;
+			if (seq.prefetch_used + seq.prefetch_wasted + seq.synchronous >
+				0) {
+				DrawTextWithCrudeShadow(
+					&p,
+					GetInnerRect().adjusted(
+						0, p.fontMetrics().height() * line, 0, 0),
+					tr("Image sequence: %1 frames read ahead, %2 wasted, "
+					   "%3 read on demand")
+						.arg(QString::number(seq.prefetch_used),
+							 QString::number(seq.prefetch_wasted),
+							 QString::number(seq.synchronous)));
+				line++;
+			}
+
+			if (renderer()) {
+				TexturePool::Stats tex = renderer()->GetTextureCacheStats();
+				quint64 requests = tex.hits + tex.misses;
+				if (requests > 0) {
+					DrawTextWithCrudeShadow(
+						&p,
+						GetInnerRect().adjusted(
+							0, p.fontMetrics().height() * line, 0, 0),
+						tr("Texture cache: %1% reused, %2/%3 MB held by all "
+						   "renderers")
+							.arg(QString::number(tex.hits * 100 / requests),
+								 QString::number(tex.budget_used / 1048576),
+								 QString::number(tex.budget / 1048576)));
+				}
 			}
 		}
 	}
@@ -1358,6 +1425,19 @@ void ViewerDisplayWidget::DrawBlank(const VideoParams &device_params)
 	renderer()->Blit(blank_shader_, job, device_params, false);
 }
 
+void ViewerDisplayWidget::SetPlaybackStats(
+	const ViewerPlaybackScheduler::Stats &stats)
+{
+	playback_stats_ = stats;
+	has_playback_stats_ = true;
+}
+
+void ViewerDisplayWidget::SetSequenceStats(
+	const OIIOSequenceReader::Stats &stats)
+{
+	sequence_stats_ = stats;
+}
+
 void ViewerDisplayWidget::SetShowFPS(bool e)
 {
 	show_fps_ = e;
@@ -25,12 +25,14 @@
 #include <QMatrix4x4>
 #include <QRubberBand>
 
+#include "codec/oiio/oiiosequencereader.h"
 #include "node/color/colormanager/colormanager.h"
 #include "node/gizmo/text.h"
 #include "node/node.h"
 #include "node/output/track/tracklist.h"
 #include "node/traverser.h"
 #include "tool/tool.h"
+#include "viewerplaybackscheduler.h"
 #include "viewerplaybacktimer.h"
 #include "viewerqueue.h"
 #include "viewersafemargininfo.h"
@@ -199,6 +201,16 @@ public slots:
 
 	void SetShowFPS(bool e);
 
+	/**
+   * @brief Set playback scheduler statistics to show alongside the FPS overlay
+   */
+	void SetPlaybackStats(const ViewerPlaybackScheduler::Stats &stats);
+
+	/**
+   * @brief Set image sequence read-ahead statistics since playback started
+   */
+	void SetSequenceStats(const OIIOSequenceReader::Stats &stats);
+
 	void RequestStartEditingText();
 
 signals:
@@ -403,6 +415,11 @@ private:
 	bool show_fps_;
 	int frames_skipped_;
 
+	ViewerPlaybackScheduler::Stats playback_stats_;
+	bool has_playback_stats_;
+
+	OIIOSequenceReader::Stats sequence_stats_;
+
 	QVector<double> frame_rate_averages_;
 	int frame_rate_average_count_;
 
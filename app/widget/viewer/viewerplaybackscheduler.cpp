@@ -0,0 +1,222 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#include "viewerplaybackscheduler.h"
+
+#include <algorithm>
+#include <QtMath>
+#include <vector>
+
+namespace olive
+{
+
+const int ViewerPlaybackScheduler::kWindowSize = 32;
+const int ViewerPlaybackScheduler::kMinimumQueueSize = 2;
+const int ViewerPlaybackScheduler::kMaximumQueueSize = 120;
+const int ViewerPlaybackScheduler::kMaximumDividerMultiplier = 4;
+const double ViewerPlaybackScheduler::kRecoveryHeadroom = 2.0;
+const int ViewerPlaybackScheduler::kMinimumRecoveryWindows = 2;
+const int ViewerPlaybackScheduler::kMaximumRecoveryWindows = 16;
+
+ViewerPlaybackScheduler::ViewerPlaybackScheduler()
+	: last_finish_ms_(0)
+	, frame_interval_ms_(0)
+	, target_underrun_probability_(0.05)
+	, divider_multiplier_(1)
+	, frame_step_(1)
+	, good_samples_(0)
+	, recovery_windows_(kMinimumRecoveryWindows)
+	, probing_(false)
+{
+}
+
+void ViewerPlaybackScheduler::Reset(double frame_interval_ms)
+{
+	ClearSamples();
+	frame_interval_ms_ = frame_interval_ms;
+	divider_multiplier_ = 1;
+	frame_step_ = 1;
+	recovery_windows_ = kMinimumRecoveryWindows;
+	probing_ = false;
+}
+
+bool ViewerPlaybackScheduler::AddSample(qint64 started_ms, qint64 finished_ms)
+{
+	// Only the part of this render that didn't overlap the previous one adds to the time spent rendering. If
+	// nothing was in flight between the last result and this request (paused, or the queue was full), that gap
+	// isn't counted at all.
+	qint64 busy_ms = finished_ms - std::max(started_ms, last_finish_ms_);
+	last_finish_ms_ = std::max(last_finish_ms_, finished_ms);
+
+	latencies_.push_back(finished_ms - started_ms);
+	// Frames straight from the cache take no measurable time, count them as a millisecond so they still add up
+	busy_times_.push_back(std::max(qint64(1), busy_ms));
+
+	while (int(latencies_.size()) > kWindowSize) {
+		latencies_.pop_front();
+		busy_times_.pop_front();
+	}
+
+	if (int(latencies_.size()) < kWindowSize || frame_interval_ms_ <= 0) {
+		// Not enough data to judge throughput yet
+		return false;
+	}
+
+	// Allow some slack for timer jitter before giving up quality
+	double target_fps = 1000.0 / (frame_interval_ms_ * frame_step_);
+	double throughput = GetThroughput();
+	if (throughput < target_fps * 0.9) {
+		return Degrade();
+	}
+
+	// A full window at this level kept up, so the last step up held
+	probing_ = false;
+
+	if (throughput >= target_fps * kRecoveryHeadroom) {
+		good_samples_++;
+		if (good_samples_ >= recovery_windows_ * kWindowSize) {
+			return Recover();
+		}
+	} else {
+		good_samples_ = 0;
+	}
+
+	return false;
+}
+
+bool ViewerPlaybackScheduler::Degrade()
+{
+	if (divider_multiplier_ < kMaximumDividerMultiplier) {
+		divider_multiplier_ *= 2;
+	} else if (frame_step_ == 1) {
+		frame_step_ = 2;
+	} else {
+		// Nothing left to give up
+		return false;
+	}
+
+	if (probing_) {
+		// Stepping up didn't hold, wait longer before trying again
+		recovery_windows_ =
+			std::min(recovery_windows_ * 2, kMaximumRecoveryWindows);
+		probing_ = false;
+	}
+
+	// Measurements taken at the previous quality level no longer apply
+	ClearSamples();
+
+	return true;
+}
+
+bool ViewerPlaybackScheduler::Recover()
+{
+	// Undo the fallbacks in the reverse order they were taken
+	if (frame_step_ > 1) {
+		frame_step_ = 1;
+	} else if (divider_multiplier_ > 1) {
+		divider_multiplier_ /= 2;
+	} else {
+		good_samples_ = 0;
+		return false;
+	}
+
+	probing_ = true;
+	ClearSamples();
+
+	return true;
+}
+
+void ViewerPlaybackScheduler::ClearSamples()
+{
+	latencies_.clear();
+	busy_times_.clear();
+	good_samples_ = 0;
+}
+
+int ViewerPlaybackScheduler::GetQueueSize(int fallback) const
+{
+	if (latencies_.empty() || frame_interval_ms_ <= 0) {
+		return fallback;
+	}
+
+	// Enough frames must be in flight to cover the latency of all but the slowest renders
+	double latency = GetLatencyQuantile(1.0 - target_underrun_probability_);
+	int sz = qCeil(latency / (frame_interval_ms_ * frame_step_)) + 1;
+
+	return std::clamp(sz, kMinimumQueueSize, kMaximumQueueSize);
+}
+
+ViewerPlaybackScheduler::Stats
+ViewerPlaybackScheduler::GetStats(int fallback_queue_size) const
+{
+	Stats s;
+
+	double sum = 0;
+	for (qint64 l : latencies_) {
+		sum += l;
+	}
+
+	s.mean_latency_ms = latencies_.empty() ? 0 : sum / latencies_.size();
+	s.quantile_latency_ms =
+		GetLatencyQuantile(1.0 - target_underrun_probability_);
+	s.throughput_fps = GetThroughput();
+	s.target_fps = (frame_interval_ms_ > 0) ?
+					   1000.0 / (frame_interval_ms_ * frame_step_) :
+					   0;
+	s.queue_size = GetQueueSize(fallback_queue_size);
+	s.divider_multiplier = divider_multiplier_;
+	s.frame_step = frame_step_;
+
+	return s;
+}
+
+double ViewerPlaybackScheduler::GetLatencyQuantile(double q) const
+{
+	if (latencies_.empty()) {
+		return 0;
+	}
+
+	std::vector<qint64> sorted(latencies_.cbegin(), latencies_.cend());
+	int rank = qMax(0, qCeil(q * double(sorted.size())) - 1);
+	size_t index = std::min(sorted.size() - 1, size_t(rank));
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+
+	return sorted.at(index);
+}
+
+double ViewerPlaybackScheduler::GetThroughput() const
+{
+	if (busy_times_.size() < 2) {
+		return 0;
+	}
+
+	qint64 busy = 0;
+	for (qint64 t : busy_times_) {
+		busy += t;
+	}
+	if (busy <= 0) {
+		return 0;
+	}
+
+	return double(busy_times_.size()) * 1000.0 / double(busy);
+}
+
+}
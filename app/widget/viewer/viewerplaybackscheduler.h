@@ -0,0 +1,149 @@
+/***
+
+  Olive - Non-Linear Video Editor
+  Copyright (C) 2022 Olive Team
+  Modifications Copyright (C) 2025 mikesolar
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+***/
+
+#ifndef VIEWERPLAYBACKSCHEDULER_H
+#define VIEWERPLAYBACKSCHEDULER_H
+
+#include <deque>
+#include <QtGlobal>
+
+namespace olive
+{
+
+/**
+ * @brief Sizes the viewer's playback queue from measured render latency
+ *
+ * Keeps a moving window of how long each queued frame took from request to result. The queue is sized so that a
+ * frame requested now has a high probability (1 - target underrun probability) of arriving before it's due. If the
+ * measured throughput can't keep up with the playback rate even with a deep queue, the scheduler steps down preview
+ * quality: first by raising the resolution divider, then by skipping every other frame.
+ *
+ * Throughput only counts time a render was in flight, so a paused or stalled queue doesn't look like a slow renderer.
+ * When there's comfortably more throughput than playback needs, quality is stepped back up one level at a time. A
+ * step up that has to be undone straight away doubles how long the scheduler waits before trying again.
+ */
+class ViewerPlaybackScheduler {
+public:
+	struct Stats {
+		double mean_latency_ms;
+		double quantile_latency_ms;
+		double throughput_fps;
+		double target_fps;
+		int queue_size;
+		int divider_multiplier;
+		int frame_step;
+	};
+
+	ViewerPlaybackScheduler();
+
+	/**
+   * @brief Clear all measurements and restore full quality, call when playback starts
+   */
+	void Reset(double frame_interval_ms);
+
+	/**
+   * @brief Record a finished render
+   *
+   * @param started_ms
+   *
+   * Wall clock time (in msecs since epoch) the frame was requested.
+   *
+   * @param finished_ms
+   *
+   * Wall clock time (in msecs since epoch) the frame arrived.
+   *
+   * @return True if the quality level changed as a result of this sample.
+   */
+	bool AddSample(qint64 started_ms, qint64 finished_ms);
+
+	/**
+   * @brief Number of frames that should be in flight, or `fallback` if nothing has been measured yet
+   */
+	int GetQueueSize(int fallback) const;
+
+	/**
+   * @brief Factor to multiply the sequence's preview divider by while playing
+   */
+	int divider_multiplier() const
+	{
+		return divider_multiplier_;
+	}
+
+	/**
+   * @brief How many frames to advance per rendered frame (1 = render every frame)
+   */
+	int frame_step() const
+	{
+		return frame_step_;
+	}
+
+	Stats GetStats(int fallback_queue_size) const;
+
+	void set_target_underrun_probability(double p)
+	{
+		target_underrun_probability_ = p;
+	}
+
+	static const int kWindowSize;
+	static const int kMinimumQueueSize;
+	static const int kMaximumQueueSize;
+	static const int kMaximumDividerMultiplier;
+	static const double kRecoveryHeadroom;
+	static const int kMinimumRecoveryWindows;
+	static const int kMaximumRecoveryWindows;
+
+private:
+	bool Degrade();
+
+	bool Recover();
+
+	void ClearSamples();
+
+	double GetLatencyQuantile(double q) const;
+
+	double GetThroughput() const;
+
+	std::deque<qint64> latencies_;
+	std::deque<qint64> busy_times_;
+
+	qint64 last_finish_ms_;
+
+	double frame_interval_ms_;
+
+	double target_underrun_probability_;
+
+	int divider_multiplier_;
+
+	int frame_step_;
+
+	/// Consecutive samples with enough headroom to step quality back up
+	int good_samples_;
+
+	/// Full windows of headroom needed before stepping up, doubled whenever a step up doesn't hold
+	int recovery_windows_;
+
+	/// Quality was just stepped up and no full window has been measured at it yet
+	bool probing_;
+};
+
+}
+
+#endif // VIEWERPLAYBACKSCHEDULER_H
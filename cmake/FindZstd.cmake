@@ -0,0 +1,50 @@
+# Olive - Non-Linear Video Editor
+# Copyright (C) 2022 Olive Team
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+find_path(ZSTD_INCLUDE_DIR
+        zstd.h
+    HINTS
+        "${ZSTD_LOCATION}"
+        "$ENV{ZSTD_LOCATION}"
+    PATH_SUFFIXES
+        include/
+    DOC
+        "Zstandard headers path"
+)
+
+find_library(ZSTD_LIBRARY
+    NAMES
+        zstd
+        zstd_static
+    HINTS
+        "${ZSTD_LOCATION}"
+        "$ENV{ZSTD_LOCATION}"
+    PATH_SUFFIXES
+        lib/
+    DOC
+        "Zstandard library path"
+)
+
+set(ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR})
+set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+
+include(FindPackageHandleStandardArgs)
+
+find_package_handle_standard_args(Zstd
+    REQUIRED_VARS
+        ZSTD_LIBRARIES
+        ZSTD_INCLUDE_DIRS
+)
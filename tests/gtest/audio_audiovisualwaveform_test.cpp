@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+}
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <vector>
+
+#include "audio/audiovisualwaveform.h"
+
+namespace
+{
+
+olive::SampleBuffer CreateRamp(const olive::AudioParams &params, int count)
+{
+	olive::SampleBuffer buffer(params, count);
+
+	for (int i = 0; i < params.channel_count(); i++) {
+		for (int j = 0; j < count; j++) {
+			buffer.data(i)[j] = float(j) / count * (i ? -1.0f : 1.0f);
+		}
+	}
+
+	return buffer;
+}
+
+}
+
+TEST(AudioVisualWaveform, SaveLoadRoundTrip)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	QString fn = QDir(dir.path()).filePath(QStringLiteral("test.waveform"));
+
+	olive::AudioParams params(48000, AV_CH_LAYOUT_STEREO,
+							  olive::SampleFormat::F32P);
+
+	olive::AudioVisualWaveform waveform;
+	waveform.set_channel_count(params.channel_count());
+	waveform.OverwriteSamples(CreateRamp(params, 48000 * 8),
+							  params.sample_rate());
+	ASSERT_TRUE(waveform.Save(fn));
+
+	olive::AudioVisualWaveform loaded;
+	ASSERT_TRUE(loaded.Load(fn));
+
+	EXPECT_EQ(loaded.channel_count(), waveform.channel_count());
+	EXPECT_EQ(loaded.length(), waveform.length());
+
+	// Check a few summaries at different mipmap levels
+	for (const olive::core::rational &length :
+		 { olive::core::rational(1, 1000), olive::core::rational(1, 10),
+		   olive::core::rational(8) }) {
+		olive::AudioVisualWaveform::Sample a =
+			waveform.GetSummaryFromTime(olive::core::rational(1), length);
+		olive::AudioVisualWaveform::Sample b =
+			loaded.GetSummaryFromTime(olive::core::rational(1), length);
+
+		// Quantizing to 16-bit rounds outwards, so loaded sums can only be slightly louder
+		ASSERT_EQ(a.size(), b.size());
+		for (size_t i = 0; i < a.size(); i++) {
+			EXPECT_LE(b[i].min, a[i].min);
+			EXPECT_GE(b[i].max, a[i].max);
+			EXPECT_NEAR(a[i].min, b[i].min, 2.0f / 32767.0f);
+			EXPECT_NEAR(a[i].max, b[i].max, 2.0f / 32767.0f);
+		}
+	}
+}
+
+TEST(AudioVisualWaveform, ReSumMatchesScalar)
+{
+	// Cover channel counts whose interleaving does and doesn't line up with SIMD vectors, and lengths
+	// that leave a remainder
+	for (int channels : { 1, 2, 3, 6, 17 }) {
+		for (size_t count : { size_t(1), size_t(3), size_t(7), size_t(64) }) {
+			std::vector<olive::AudioVisualWaveform::SamplePerChannel> sums(
+				count * channels);
+			for (size_t i = 0; i < sums.size(); i++) {
+				float v = float((i * 7919) % 101) / 50.0f - 1.0f;
+				sums[i] = { std::min(v, -v * 0.5f), std::max(v, -v * 0.5f) };
+			}
+
+			std::vector<olive::AudioVisualWaveform::SamplePerChannel> expected(
+				channels, { 0, 0 });
+			for (size_t i = 0; i < sums.size(); i++) {
+				auto &e = expected[i % channels];
+				e.min = std::min(e.min, sums[i].min);
+				e.max = std::max(e.max, sums[i].max);
+			}
+
+			std::vector<olive::AudioVisualWaveform::SamplePerChannel> out(
+				channels);
+			olive::AudioVisualWaveform::ReSumSamples(
+				sums.data(), sums.size(), channels, out.data());
+
+			for (int c = 0; c < channels; c++) {
+				EXPECT_FLOAT_EQ(out[c].min, expected[c].min)
+					<< channels << " channels, " << count << " samples";
+				EXPECT_FLOAT_EQ(out[c].max, expected[c].max)
+					<< channels << " channels, " << count << " samples";
+			}
+		}
+	}
+}
+
+TEST(AudioVisualWaveform, SumShortBuffers)
+{
+	olive::AudioParams params(48000, AV_CH_LAYOUT_STEREO,
+							  olive::SampleFormat::F32P);
+
+	// Fewer samples than fit in one SIMD vector
+	olive::SampleBuffer buffer = CreateRamp(params, 3);
+	olive::AudioVisualWaveform::SamplePerChannel out[2];
+
+	olive::AudioVisualWaveform::SumSamples(buffer, 1, 2, out);
+	EXPECT_FLOAT_EQ(out[0].min, 0.0f);
+	EXPECT_FLOAT_EQ(out[0].max, 2.0f / 3.0f);
+	EXPECT_FLOAT_EQ(out[1].min, -2.0f / 3.0f);
+	EXPECT_FLOAT_EQ(out[1].max, 0.0f);
+
+	olive::AudioVisualWaveform::SumSamples(buffer, 0, 0, out);
+	EXPECT_FLOAT_EQ(out[0].min, 0.0f);
+	EXPECT_FLOAT_EQ(out[0].max, 0.0f);
+}
+
+TEST(AudioVisualWaveform, LoadRejectsCorruptFile)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	QString fn = QDir(dir.path()).filePath(QStringLiteral("bad.waveform"));
+
+	QFile file(fn);
+	ASSERT_TRUE(file.open(QFile::WriteOnly));
+	file.write("not a waveform");
+	file.close();
+
+	olive::AudioVisualWaveform waveform;
+	EXPECT_FALSE(waveform.Load(fn));
+	EXPECT_FALSE(waveform.Load(QDir(dir.path()).filePath(
+		QStringLiteral("missing.waveform"))));
+}
+
+TEST(AudioVisualWaveform, SavedPlanesAreLittleEndian)
+{
+	olive::AudioParams params(48000, AV_CH_LAYOUT_STEREO,
+							  olive::SampleFormat::F32P);
+
+	// Long enough for the coarsest mipmap to have a sum
+	const int count = 48000 * 8;
+	olive::SampleBuffer buffer(params, count);
+	for (int j = 0; j < count; j++) {
+		buffer.data(0)[j] = 0.5f;
+		buffer.data(1)[j] = -0.25f;
+	}
+
+	olive::AudioVisualWaveform waveform;
+	waveform.set_channel_count(params.channel_count());
+	waveform.OverwriteSamples(buffer, params.sample_rate());
+
+	QByteArray bytes;
+	{
+		QBuffer device(&bytes);
+		ASSERT_TRUE(device.open(QIODevice::WriteOnly));
+		QDataStream stream(&device);
+		ASSERT_TRUE(waveform.Save(stream));
+	}
+
+	QBuffer device(&bytes);
+	ASSERT_TRUE(device.open(QIODevice::ReadOnly));
+	QDataStream stream(&device);
+
+	// Skip the header and the first mipmap's rate and count
+	quint32 version, mipmap_count;
+	qint32 channels;
+	qint64 length_num, length_den, start_num, start_den, rate_num, rate_den;
+	quint64 mipmap_length;
+	float peak;
+	stream >> version >> channels >> length_num >> length_den >> start_num >>
+		start_den >> mipmap_count >> peak >> rate_num >> rate_den >>
+		mipmap_length;
+	ASSERT_EQ(stream.status(), QDataStream::Ok);
+	ASSERT_GT(mipmap_length, quint64(0));
+
+	// 0.5 at a peak of 1.0 is 16383 rounded down for the minimum, 0x3FFF
+	char first[2];
+	ASSERT_EQ(stream.readRawData(first, 2), 2);
+	EXPECT_EQ(quint8(first[0]), 0xFF);
+	EXPECT_EQ(quint8(first[1]), 0x3F);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <OpenImageIO/imageio.h>
+#include <QDir>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <vector>
+
+#include "codec/frame.h"
+#include "codec/oiio/oiiodecoder.h"
+
+namespace
+{
+
+const int kImageSize = 1024;
+const int kMipLevelCount = 4;
+
+// Writes a tiled TIFF where every MIP level is filled with a different value so tests can tell which one was read
+bool WriteMipmappedImage(const QString &filename)
+{
+	std::string fn = filename.toStdString();
+	auto out = OIIO::ImageOutput::create(fn);
+	if (!out || !out->supports("mipmap")) {
+		return false;
+	}
+
+	OIIO::ImageSpec spec(kImageSize, kImageSize, 4, OIIO::TypeDesc::UINT8);
+	spec.tile_width = 64;
+	spec.tile_height = 64;
+
+	for (int level = 0; level < kMipLevelCount; level++) {
+		std::vector<uint8_t> pixels(size_t(spec.width) * spec.height * 4,
+									uint8_t((level + 1) * 10));
+
+		OIIO::ImageOutput::OpenMode mode =
+			level ? OIIO::ImageOutput::AppendMIPLevel :
+					OIIO::ImageOutput::Create;
+		if (!out->open(fn, spec, mode) ||
+			!out->write_image(OIIO::TypeDesc::UINT8, pixels.data())) {
+			return false;
+		}
+
+		spec.width /= 2;
+		spec.height /= 2;
+	}
+
+	return out->close();
+}
+
+// Writes a plain TIFF with alternating black and grey pixels, so a downsampled copy should be an even mid grey
+bool WriteCheckerboardImage(const QString &filename, int size)
+{
+	std::string fn = filename.toStdString();
+	auto out = OIIO::ImageOutput::create(fn);
+	if (!out) {
+		return false;
+	}
+
+	std::vector<uint8_t> pixels(size_t(size) * size * 4);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			uint8_t value = ((x + y) % 2) ? 200 : 0;
+			std::fill_n(pixels.begin() + (size_t(y) * size + x) * 4, 4, value);
+		}
+	}
+
+	OIIO::ImageSpec spec(size, size, 4, OIIO::TypeDesc::UINT8);
+	return out->open(fn, spec) &&
+		   out->write_image(OIIO::TypeDesc::UINT8, pixels.data()) &&
+		   out->close();
+}
+
+}
+
+TEST(OIIODecoder, ReadsMipLevelForDivider)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+
+	QString fn = QDir(dir.path()).filePath(QStringLiteral("mipmapped.tif"));
+	if (!WriteMipmappedImage(fn)) {
+		GTEST_SKIP() << "OIIO can't write MIP-mapped TIFFs";
+	}
+
+	auto in = OIIO::ImageInput::open(fn.toStdString());
+	ASSERT_TRUE(in);
+
+	// Divider 3 has no exact level so it should read level 1 and downsample that
+	const struct {
+		int divider;
+		uint8_t value;
+	} cases[] = { { 1, 10 }, { 2, 20 }, { 3, 20 }, { 4, 30 }, { 8, 40 } };
+
+	for (const auto &c : cases) {
+		olive::Frame frame;
+		ASSERT_TRUE(olive::OIIODecoder::ReadImage(in.get(), c.divider, &frame));
+
+		EXPECT_EQ(frame.width(), olive::VideoParams::GetScaledDimension(
+									 kImageSize, c.divider));
+		EXPECT_EQ(uint8_t(frame.data()[0]), c.value) << "divider" << c.divider;
+
+		// Input should be left at full resolution
+		EXPECT_EQ(in->spec().width, kImageSize);
+	}
+}
+
+TEST(OIIODecoder, AveragesPixelsForDividerWithoutMipLevels)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+
+	const int size = 64;
+	QString fn = QDir(dir.path()).filePath(QStringLiteral("checkerboard.tif"));
+	ASSERT_TRUE(WriteCheckerboardImage(fn, size));
+
+	auto in = OIIO::ImageInput::open(fn.toStdString());
+	ASSERT_TRUE(in);
+
+	for (int divider : { 1, 2, 4, 8 }) {
+		olive::Frame frame;
+		ASSERT_TRUE(olive::OIIODecoder::ReadImage(in.get(), divider, &frame));
+
+		int expected_size =
+			olive::VideoParams::GetScaledDimension(size, divider);
+		ASSERT_EQ(frame.width(), expected_size) << "divider" << divider;
+		ASSERT_EQ(frame.height(), expected_size) << "divider" << divider;
+
+		for (int y = 0; y < frame.height(); y++) {
+			const uint8_t *row = reinterpret_cast<const uint8_t *>(
+				frame.data() + frame.linesize_bytes() * y);
+
+			for (int x = 0; x < frame.width(); x++) {
+				int value = row[x * 4];
+				if (divider == 1) {
+					ASSERT_EQ(value, ((x + y) % 2) ? 200 : 0);
+				} else {
+					// Picking single pixels would give all black or all grey
+					ASSERT_NEAR(value, 100, 1)
+						<< "divider" << divider << "at" << x << y;
+				}
+			}
+		}
+	}
+}
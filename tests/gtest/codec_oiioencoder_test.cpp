@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <OpenImageIO/imageio.h>
+#include <QDir>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <cstring>
+
+#include "codec/frame.h"
+#include "codec/oiio/oiioencoder.h"
+
+namespace
+{
+
+const int kFrameCount = 8;
+
+olive::FramePtr CreateFrame(int value)
+{
+	olive::FramePtr frame = olive::Frame::Create();
+	frame->set_video_params(olive::VideoParams(
+		64, 32, olive::core::PixelFormat::U8, 4));
+	frame->allocate();
+	memset(frame->data(), value, frame->allocated_size());
+	return frame;
+}
+
+}
+
+TEST(OIIOEncoder, WritesSequenceOutOfOrder)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+
+	olive::EncodingParams params;
+	params.SetFilename(QDir(dir.path()).filePath(QStringLiteral("f_[##].png")));
+	params.set_video_is_image_sequence(true);
+	params.set_video_threads(4);
+	params.set_video_option(QStringLiteral("compression"),
+							QStringLiteral("zip:9"));
+
+	olive::VideoParams video_params;
+	video_params.set_frame_rate(olive::core::rational(24, 1));
+	params.EnableVideo(video_params, olive::ExportCodec::kCodecPNG);
+
+	olive::OIIOEncoder encoder(params);
+	ASSERT_TRUE(encoder.WritesFramesInAnyOrder());
+	ASSERT_TRUE(encoder.Open());
+
+	// Reverse order, as if later frames finished rendering first
+	for (int i = kFrameCount - 1; i >= 0; i--) {
+		ASSERT_TRUE(encoder.WriteFrame(CreateFrame(i * 10),
+									   olive::core::rational(i, 24)));
+	}
+
+	encoder.Close();
+	EXPECT_TRUE(encoder.GetError().isEmpty());
+	EXPECT_EQ(encoder.GetWriteStats().frames, kFrameCount);
+
+	for (int i = 0; i < kFrameCount; i++) {
+		QString fn = QDir(dir.path()).filePath(
+			QStringLiteral("f_%1.png").arg(i, 2, 10, QChar('0')));
+		ASSERT_TRUE(QFileInfo::exists(fn)) << fn.toStdString();
+
+		auto in = OIIO::ImageInput::open(fn.toStdString());
+		ASSERT_TRUE(in);
+
+		unsigned char pixel[4];
+		ASSERT_TRUE(in->read_scanline(0, 0, OIIO::TypeDesc::UINT8, pixel));
+		EXPECT_EQ(pixel[0], i * 10);
+	}
+}
+
+TEST(OIIOEncoder, ReportsWriteErrors)
+{
+	olive::EncodingParams params;
+	params.SetFilename(
+		QStringLiteral("/nonexistent-directory/olive/f_[##].png"));
+	params.set_video_is_image_sequence(true);
+
+	olive::VideoParams video_params;
+	video_params.set_frame_rate(olive::core::rational(24, 1));
+	params.EnableVideo(video_params, olive::ExportCodec::kCodecPNG);
+
+	olive::OIIOEncoder encoder(params);
+	ASSERT_TRUE(encoder.Open());
+
+	encoder.WriteFrame(CreateFrame(0), 0);
+	encoder.Close();
+
+	EXPECT_FALSE(encoder.GetError().isEmpty());
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <OpenImageIO/imageio.h>
+#include <QDir>
+#include <QTemporaryDir>
+#include <vector>
+
+#include "codec/oiio/oiiosequencereader.h"
+
+namespace
+{
+
+bool WriteFrame(const QString &filename, uint8_t value)
+{
+	const int size = 8;
+	std::vector<uint8_t> pixels(size * size * 4, value);
+
+	auto out = OIIO::ImageOutput::create(filename.toStdString());
+	if (!out) {
+		return false;
+	}
+
+	OIIO::ImageSpec spec(size, size, 4, OIIO::TypeDesc::UINT8);
+	return out->open(filename.toStdString(), spec) &&
+		   out->write_image(OIIO::TypeDesc::UINT8, pixels.data()) &&
+		   out->close();
+}
+
+}
+
+TEST(OIIOSequenceReader, ReadsAheadInPlaybackDirection)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+
+	for (int i = 0; i < 20; i++) {
+		ASSERT_TRUE(WriteFrame(
+			QDir(dir.path()).filePath(QStringLiteral("frame.%1.tif")
+										  .arg(i, 4, 10, QChar('0'))),
+			uint8_t(i * 10)));
+	}
+
+	olive::OIIOSequenceReaderPtr reader = olive::OIIOSequenceReader::Get(
+		QDir(dir.path()).filePath(QStringLiteral("frame.0000.tif")), 0);
+	olive::OIIOSequenceReader::Stats before =
+		olive::OIIOSequenceReader::GetStats();
+
+	// First frame can't have been predicted
+	olive::FramePtr frame = reader->ReadFrame(0, 1);
+	ASSERT_TRUE(frame);
+	EXPECT_EQ(frame->width(), 8);
+	EXPECT_EQ(uint8_t(frame->data()[0]), 0);
+
+	for (int i = 1; i < 5; i++) {
+		frame = reader->ReadFrame(i, 1);
+		ASSERT_TRUE(frame);
+		EXPECT_EQ(uint8_t(frame->data()[0]), uint8_t(i * 10));
+	}
+
+	olive::OIIOSequenceReader::Stats after =
+		olive::OIIOSequenceReader::GetStats();
+	EXPECT_EQ(after.synchronous - before.synchronous, quint64(1));
+	EXPECT_EQ(after.prefetch_used - before.prefetch_used, quint64(4));
+
+	// Playing backwards by two frames at a time is picked up after one step
+	reader->ReadFrame(18, 1);
+	reader->ReadFrame(16, 1);
+	before = olive::OIIOSequenceReader::GetStats();
+
+	frame = reader->ReadFrame(14, 1);
+	ASSERT_TRUE(frame);
+	EXPECT_EQ(uint8_t(frame->data()[0]), 140);
+
+	after = olive::OIIOSequenceReader::GetStats();
+	EXPECT_EQ(after.synchronous, before.synchronous);
+	EXPECT_EQ(after.prefetch_used - before.prefetch_used, quint64(1));
+}
+
+TEST(OIIOSequenceReader, OutOfOrderRequestsKeepPrefetchedFrames)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+
+	for (int i = 0; i < 20; i++) {
+		ASSERT_TRUE(WriteFrame(
+			QDir(dir.path()).filePath(QStringLiteral("frame.%1.tif")
+										  .arg(i, 4, 10, QChar('0'))),
+			uint8_t(i * 10)));
+	}
+
+	olive::OIIOSequenceReaderPtr reader = olive::OIIOSequenceReader::Get(
+		QDir(dir.path()).filePath(QStringLiteral("frame.0000.tif")), 0);
+
+	// Several render threads finishing in a different order than playback
+	olive::OIIOSequenceReader::SetPlaybackSpeed(1);
+	olive::OIIOSequenceReader::Stats before =
+		olive::OIIOSequenceReader::GetStats();
+
+	const int order[] = { 0, 2, 1, 3, 5, 4, 6, 8, 7 };
+	for (int i : order) {
+		olive::FramePtr frame = reader->ReadFrame(i, 1);
+		ASSERT_TRUE(frame);
+		EXPECT_EQ(uint8_t(frame->data()[0]), uint8_t(i * 10));
+	}
+
+	olive::OIIOSequenceReader::Stats after =
+		olive::OIIOSequenceReader::GetStats();
+	olive::OIIOSequenceReader::SetPlaybackSpeed(0);
+
+	// Only the first frame had to be read on demand
+	EXPECT_EQ(after.synchronous - before.synchronous, quint64(1));
+	EXPECT_EQ(after.prefetch_used - before.prefetch_used, quint64(8));
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "node/filter/blur/blur.h"
+
+namespace
+{
+
+double TotalWeight(const olive::BlurFilterNode::SeparableKernel &kernel)
+{
+	double total = kernel.weights.first();
+	for (int i = 1; i < kernel.weights.size(); i++) {
+		total += 2.0 * kernel.weights.at(i);
+	}
+	return total;
+}
+
+}
+
+TEST(BlurFilterNode, SeparableKernelIsNormalized)
+{
+	for (auto method :
+		 { olive::BlurFilterNode::kBox, olive::BlurFilterNode::kGaussian }) {
+		for (double radius : { 0.25, 1.0, 3.5, 10.0, 64.0, 500.0 }) {
+			olive::BlurFilterNode::SeparableKernel kernel =
+				olive::BlurFilterNode::CalculateSeparableKernel(method, radius,
+																8);
+
+			ASSERT_EQ(kernel.offsets.size(), kernel.weights.size());
+			EXPECT_LE(kernel.offsets.size(),
+					  olive::BlurFilterNode::kMaximumTaps);
+			EXPECT_NEAR(TotalWeight(kernel), 1.0, 1e-5) << radius;
+
+			// Merged taps sit between the two pixels they read
+			for (int i = 1; i < kernel.offsets.size(); i++) {
+				EXPECT_GE(kernel.offsets.at(i), 2 * i - 1);
+				EXPECT_LE(kernel.offsets.at(i), 2 * i);
+			}
+		}
+	}
+}
+
+TEST(BlurFilterNode, LargeRadiiUsePyramid)
+{
+	// Small blurs run at full resolution
+	EXPECT_EQ(olive::BlurFilterNode::CalculateSeparableKernel(
+				  olive::BlurFilterNode::kGaussian, 3.0, 8)
+				  .levels,
+			  0);
+
+	// Every doubling of the radius adds about one level instead of doubling the taps
+	int previous = 0;
+	for (double radius : { 16.0, 32.0, 64.0, 128.0 }) {
+		int levels = olive::BlurFilterNode::CalculateSeparableKernel(
+						 olive::BlurFilterNode::kGaussian, radius, 8)
+						 .levels;
+		EXPECT_GT(levels, previous) << radius;
+		EXPECT_LE(levels, previous + 2) << radius;
+		previous = levels;
+	}
+
+	// Never more levels than the texture allows
+	olive::BlurFilterNode::SeparableKernel capped =
+		olive::BlurFilterNode::CalculateSeparableKernel(
+			olive::BlurFilterNode::kBox, 1000.0, 2);
+	EXPECT_EQ(capped.levels, 2);
+	EXPECT_LE(capped.offsets.size(), olive::BlurFilterNode::kMaximumTaps);
+}
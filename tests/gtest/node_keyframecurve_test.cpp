@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "common/lerp.h"
+#include "node/inputimmediate.h"
+#include "node/keyframecurve.h"
+
+namespace
+{
+
+using olive::NodeKeyframe;
+using olive::NodeKeyframeTrack;
+using olive::core::rational;
+
+// Per-time evaluation as Node::GetSplitValueAtTimeOnTrack did it before curves were compiled
+double ReferenceValueAtTime(const NodeKeyframeTrack &track,
+							const rational &time)
+{
+	if (track.first()->time() >= time) {
+		return track.first()->value().toDouble();
+	}
+
+	if (track.last()->time() <= time) {
+		return track.last()->value().toDouble();
+	}
+
+	NodeKeyframe *before = nullptr, *after = nullptr;
+	for (int i = 0; i < track.size() - 1; i++) {
+		if (track.at(i)->time() <= time && track.at(i + 1)->time() > time) {
+			before = track.at(i);
+			after = track.at(i + 1);
+			break;
+		}
+	}
+
+	double before_val = before->value().toDouble();
+	double after_val = after->value().toDouble();
+
+	if (before->time() == time || before->type() == NodeKeyframe::kHold) {
+		return before_val;
+	}
+
+	if (before->type() == NodeKeyframe::kBezier &&
+		after->type() == NodeKeyframe::kBezier) {
+		return olive::core::Bezier::CubicXtoY(
+			time.toDouble(),
+			Imath::V2d(before->time().toDouble(), before_val),
+			Imath::V2d(before->time().toDouble() +
+						   before->valid_bezier_control_out().x(),
+					   before_val + before->valid_bezier_control_out().y()),
+			Imath::V2d(after->time().toDouble() +
+						   after->valid_bezier_control_in().x(),
+					   after_val + after->valid_bezier_control_in().y()),
+			Imath::V2d(after->time().toDouble(), after_val));
+	} else if (before->type() == NodeKeyframe::kBezier ||
+			   after->type() == NodeKeyframe::kBezier) {
+		Imath::V2d control_point;
+		if (before->type() == NodeKeyframe::kBezier) {
+			control_point.x = before->valid_bezier_control_out().x() +
+							  before->time().toDouble();
+			control_point.y = before->valid_bezier_control_out().y() + before_val;
+		} else {
+			control_point.x = after->valid_bezier_control_in().x() +
+							  after->time().toDouble();
+			control_point.y = after->valid_bezier_control_in().y() + after_val;
+		}
+		return olive::core::Bezier::QuadraticXtoY(
+			time.toDouble(), Imath::V2d(before->time().toDouble(), before_val),
+			control_point, Imath::V2d(after->time().toDouble(), after_val));
+	}
+
+	double progress = (time.toDouble() - before->time().toDouble()) /
+					  (after->time().toDouble() - before->time().toDouble());
+	return lerp(before_val, after_val, progress);
+}
+
+class KeyframeCurveTest : public ::testing::Test {
+protected:
+	KeyframeCurveTest()
+		: immediate_(olive::NodeValue::kFloat, olive::SplitValue({ 0.0 }))
+	{
+		immediate_.set_is_keyframing(true);
+	}
+
+	~KeyframeCurveTest() override
+	{
+		// Keys have no parent node to unlink them, so remove them by hand
+		const NodeKeyframeTrack keys = track();
+		for (NodeKeyframe *key : keys) {
+			immediate_.remove_keyframe(key);
+			delete key;
+		}
+	}
+
+	void AddKey(const rational &time, double value, NodeKeyframe::Type type)
+	{
+		NodeKeyframe *key =
+			new NodeKeyframe(time, value, type, 0, -1, QStringLiteral("test"));
+		key->set_bezier_control_in(QPointF(-0.25, -3.0));
+		key->set_bezier_control_out(QPointF(0.25, 5.0));
+		immediate_.insert_keyframe(key);
+	}
+
+	const NodeKeyframeTrack &track() const
+	{
+		return immediate_.keyframe_tracks().first();
+	}
+
+	olive::NodeInputImmediate immediate_;
+};
+
+}
+
+TEST_F(KeyframeCurveTest, SingleValuesMatchReference)
+{
+	AddKey(rational(0), 0.0, NodeKeyframe::kLinear);
+	AddKey(rational(1), 10.0, NodeKeyframe::kBezier);
+	AddKey(rational(2), -4.0, NodeKeyframe::kBezier);
+	AddKey(rational(3), 7.0, NodeKeyframe::kHold);
+	AddKey(rational(4), 1.0, NodeKeyframe::kLinear);
+
+	auto curve = immediate_.get_compiled_curve(0);
+	ASSERT_EQ(curve->key_count(), 5);
+
+	for (int i = -24; i <= 120; i++) {
+		rational t(i, 24);
+		EXPECT_DOUBLE_EQ(curve->ValueAt(t.toDouble()),
+						 ReferenceValueAtTime(track(), t))
+			<< "at " << t.toDouble();
+	}
+}
+
+TEST_F(KeyframeCurveTest, RangeMatchesReference)
+{
+	AddKey(rational(0), 1.0, NodeKeyframe::kLinear);
+	AddKey(rational(1, 2), 0.0, NodeKeyframe::kLinear);
+	AddKey(rational(1), 2.0, NodeKeyframe::kBezier);
+	AddKey(rational(2), 0.5, NodeKeyframe::kHold);
+	AddKey(rational(5, 2), 3.0, NodeKeyframe::kLinear);
+
+	const rational step(1, 48000);
+	const olive::core::TimeRange range(rational(-1, 10), rational(3));
+	size_t count = olive::KeyframeCurve::GetSampleCount(range, step);
+	ASSERT_EQ(count, size_t(148800));
+
+	std::vector<float> out(count);
+	immediate_.get_compiled_curve(0)->Evaluate(range, step, out.data());
+
+	for (size_t i = 0; i < count; i += 37) {
+		rational t = range.in() + step * int64_t(i);
+		EXPECT_NEAR(out[i], ReferenceValueAtTime(track(), t), 1e-4)
+			<< "at " << t.toDouble();
+	}
+}
+
+TEST_F(KeyframeCurveTest, InvalidatedOnEdit)
+{
+	AddKey(rational(0), 0.0, NodeKeyframe::kLinear);
+	AddKey(rational(1), 10.0, NodeKeyframe::kLinear);
+
+	auto before = immediate_.get_compiled_curve(0);
+	EXPECT_EQ(before, immediate_.get_compiled_curve(0));
+	EXPECT_DOUBLE_EQ(before->ValueAt(0.5), 5.0);
+
+	AddKey(rational(2), 0.0, NodeKeyframe::kLinear);
+
+	auto after = immediate_.get_compiled_curve(0);
+	EXPECT_NE(before, after);
+	EXPECT_EQ(after->key_count(), 3);
+	EXPECT_DOUBLE_EQ(after->ValueAt(1.5), 5.0);
+}
+
+TEST(KeyframeCurve, FillLinear)
+{
+	std::vector<float> out(11);
+	olive::KeyframeCurve::FillLinear(out.data(), out.size(), 1.0, 0.5);
+
+	for (size_t i = 0; i < out.size(); i++) {
+		EXPECT_FLOAT_EQ(out[i], 1.0f + 0.5f * float(i));
+	}
+}
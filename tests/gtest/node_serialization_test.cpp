@@ -93,3 +93,54 @@ TEST(NodeSerialization, SaveAndLoadInput)
 		olive::DiskManager::DestroyInstance();
 	}
 }
+
+TEST(NodeSerialization, CacheIdsRoundTripWithoutCreatingCaches)
+{
+	const bool created_disk_manager = (olive::DiskManager::instance() == nullptr);
+	if (created_disk_manager) {
+		olive::DiskManager::CreateInstance();
+	}
+
+	TestNode node;
+	EXPECT_FALSE(node.HasCaches());
+
+	QUuid video_id = node.GetCacheUuid(olive::Node::kVideoCache);
+	QUuid waveform_id = node.GetCacheUuid(olive::Node::kWaveformCache);
+	EXPECT_FALSE(video_id.isNull());
+	EXPECT_NE(video_id, waveform_id);
+
+	QByteArray xml;
+	QBuffer buffer(&xml);
+	buffer.open(QIODevice::WriteOnly);
+	QXmlStreamWriter writer(&buffer);
+	writer.writeStartDocument();
+	writer.writeStartElement(QStringLiteral("node"));
+	node.Save(&writer);
+	writer.writeEndElement();
+	writer.writeEndDocument();
+	buffer.close();
+
+	// Saving only needs the IDs
+	EXPECT_FALSE(node.HasCaches());
+
+	TestNode loaded;
+	olive::SerializedData data;
+	QBuffer read_buffer(&xml);
+	read_buffer.open(QIODevice::ReadOnly);
+	QXmlStreamReader reader(&read_buffer);
+	ASSERT_TRUE(reader.readNextStartElement());
+	ASSERT_TRUE(loaded.Load(&reader, &data));
+
+	EXPECT_FALSE(loaded.HasCaches());
+	EXPECT_EQ(loaded.GetCacheUuid(olive::Node::kVideoCache), video_id);
+
+	// First use creates the caches with the loaded IDs
+	ASSERT_TRUE(loaded.video_frame_cache());
+	EXPECT_TRUE(loaded.HasCaches());
+	EXPECT_EQ(loaded.video_frame_cache()->GetUuid(), video_id);
+	EXPECT_EQ(loaded.waveform_cache()->GetUuid(), waveform_id);
+
+	if (created_disk_manager) {
+		olive::DiskManager::DestroyInstance();
+	}
+}
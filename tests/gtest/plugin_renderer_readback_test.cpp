@@ -17,3 +17,19 @@ TEST(PluginRendererReadback, BytesToPixels)
 	EXPECT_EQ(olive::plugin::detail::BytesToPixels(0, params), 0);
 	EXPECT_EQ(olive::plugin::detail::BytesToPixels(-1, params), 0);
 }
+
+TEST(PluginRendererReadback, SequenceRangeIncludesLastFrame)
+{
+	// A default range is no range, frames rendered with it are bracketed on their own
+	EXPECT_FALSE(olive::plugin::SequenceRange().IsValid());
+
+	// A lone frame scrubbed to in the viewer is a range of its own
+	olive::plugin::SequenceRange frame;
+	frame.start = frame.end = 2.0;
+	frame.step = 1.0 / 24.0;
+	EXPECT_TRUE(frame.IsValid());
+
+	olive::plugin::SequenceRange backwards = frame;
+	backwards.end = 1.0;
+	EXPECT_FALSE(backwards.IsValid());
+}
@@ -3,6 +3,10 @@
 #include "ofxImageEffect.h"
 #include "ofxhClip.h"
 #include "pluginSupport/OliveClip.h"
+#include "render/texture.h"
+
+#include <cstring>
+#include <thread>
 
 namespace {
 olive::VideoParams MakeParams(int width, int height,
@@ -18,6 +22,24 @@ olive::VideoParams MakeParams(int width, int height,
 	params.set_premultiplied_alpha(premultiplied);
 	return params;
 }
+
+olive::TexturePtr MakeCPUTexture(const olive::VideoParams &params,
+								 uint8_t value)
+{
+	olive::AVFramePtr frame = olive::CreateAVFramePtr();
+	frame->format = AV_PIX_FMT_RGBA;
+	frame->width = params.width();
+	frame->height = params.height();
+	av_frame_get_buffer(frame.get(), 0);
+	for (int y = 0; y < frame->height; y++) {
+		memset(frame->data[0] + y * frame->linesize[0], value,
+			   frame->width * 4);
+	}
+
+	auto texture = std::make_shared<olive::Texture>(params);
+	texture->handleFrame(frame);
+	return texture;
+}
 }
 
 TEST(PluginSupportClip, PropertyGetters)
@@ -94,3 +116,133 @@ TEST(PluginSupportClip, GetImageReturnsNewImageForNonOutput)
 	first->releaseReference();
 	second->releaseReference();
 }
+
+TEST(PluginSupportClip, InputImageIsMaterializedOnFetch)
+{
+	OFX::Host::ImageEffect::ClipDescriptor desc("Source");
+	olive::VideoParams params =
+		MakeParams(16, 8, olive::core::PixelFormat::U8, 4, false);
+	olive::plugin::OliveClipInstance clip(nullptr, desc, params);
+
+	clip.setInputTexture(MakeCPUTexture(params, 200), 0.0);
+	EXPECT_TRUE(clip.getConnected());
+
+	OFX::Host::ImageEffect::Image *first = clip.getImage(0.0, nullptr);
+	ASSERT_NE(first, nullptr);
+	auto *image = static_cast<olive::plugin::Image *>(first);
+	EXPECT_EQ(image->width(), 16);
+	EXPECT_EQ(image->data()[0], 200);
+
+	// Fetching again returns the same image without downloading again
+	OFX::Host::ImageEffect::Image *second = clip.getImage(0.0, nullptr);
+	EXPECT_EQ(first, second);
+
+	first->releaseReference();
+	second->releaseReference();
+
+	// A new texture for the same time replaces the contents on the next fetch
+	clip.setInputTexture(MakeCPUTexture(params, 10), 0.0);
+	OFX::Host::ImageEffect::Image *third = clip.getImage(0.0, nullptr);
+	EXPECT_EQ(static_cast<olive::plugin::Image *>(third)->data()[0], 10);
+	third->releaseReference();
+}
+
+TEST(PluginSupportClip, InputImageCanBeFetchedFromPluginThreads)
+{
+	OFX::Host::ImageEffect::ClipDescriptor desc("Source");
+	olive::VideoParams params =
+		MakeParams(16, 8, olive::core::PixelFormat::U8, 4, false);
+	olive::plugin::OliveClipInstance clip(nullptr, desc, params);
+
+	clip.setInputTexture(MakeCPUTexture(params, 120), 0.0);
+	clip.ReadbackInputTexture(0.0);
+
+	// Plugins using the multithread suite fetch from threads without the render thread's GL context
+	uint8_t value = 0;
+	std::thread worker([&clip, &value]() {
+		OFX::Host::ImageEffect::Image *image = clip.getImage(0.0, nullptr);
+		if (image) {
+			value = static_cast<olive::plugin::Image *>(image)->data()[0];
+			image->releaseReference();
+		}
+	});
+	worker.join();
+
+	EXPECT_EQ(value, 120);
+}
+
+TEST(PluginSupportClip, CachedFramesAreBounded)
+{
+	OFX::Host::ImageEffect::ClipDescriptor desc(kOfxImageEffectOutputClipName);
+	olive::VideoParams params =
+		MakeParams(8, 8, olive::core::PixelFormat::U8, 4, false);
+	olive::plugin::OliveClipInstance clip(nullptr, desc, params);
+
+	OFX::Host::ImageEffect::Image *first = clip.getOutputImage(0.0);
+
+	// Hold on to it like a plugin would so it outlives being dropped from the cache
+	first->addReference();
+
+	for (int i = 1; i < 20; i++) {
+		clip.getOutputImage(i);
+	}
+
+	EXPECT_EQ(clip.getOutputImage(19.0), clip.getOutputImage(19.0));
+
+	// The oldest frame was dropped, so asking for it again makes a new image
+	EXPECT_NE(clip.getOutputImage(0.0), first);
+
+	first->releaseReference();
+}
+
+TEST(PluginSupportClip, InputImageFollowsRenderScale)
+{
+	OFX::Host::ImageEffect::ClipDescriptor desc("Source");
+	olive::VideoParams params =
+		MakeParams(16, 8, olive::core::PixelFormat::U8, 4, false);
+	olive::plugin::OliveClipInstance clip(nullptr, desc, params);
+
+	clip.setRenderScale({ 0.5, 0.5 });
+	clip.setInputTexture(MakeCPUTexture(params, 200), 0.0);
+
+	OFX::Host::ImageEffect::Image *fetched = clip.getImage(0.0, nullptr);
+	ASSERT_NE(fetched, nullptr);
+	auto *image = static_cast<olive::plugin::Image *>(fetched);
+	EXPECT_EQ(image->width(), 8);
+	EXPECT_EQ(image->height(), 4);
+	EXPECT_EQ(image->data()[0], 200);
+	EXPECT_DOUBLE_EQ(
+		fetched->getDoubleProperty(kOfxImageEffectPropRenderScale, 0), 0.5);
+
+	fetched->releaseReference();
+}
+
+TEST(PluginSupportClip, InputImageCoversRegionOfInterest)
+{
+	OFX::Host::ImageEffect::ClipDescriptor desc("Source");
+	olive::VideoParams params =
+		MakeParams(16, 8, olive::core::PixelFormat::U8, 4, false);
+	olive::plugin::OliveClipInstance clip(nullptr, desc, params);
+
+	clip.setInputTexture(MakeCPUTexture(params, 50), 0.0);
+	clip.setRegionOfInterest({ 4.0, 2.0, 12.0, 6.0 }, 0.0);
+
+	OFX::Host::ImageEffect::Image *first = clip.getImage(0.0, nullptr);
+	ASSERT_NE(first, nullptr);
+	auto *image = static_cast<olive::plugin::Image *>(first);
+	EXPECT_EQ(image->width(), 8);
+	EXPECT_EQ(image->height(), 4);
+	EXPECT_EQ(first->getIntProperty(kOfxImagePropBounds, 0), 4);
+	EXPECT_EQ(first->getIntProperty(kOfxImagePropBounds, 1), 2);
+	EXPECT_EQ(image->data()[0], 50);
+
+	// Asking for more than the region of interest gets an image covering both
+	OfxRectD everything = { 0.0, 0.0, 16.0, 8.0 };
+	OFX::Host::ImageEffect::Image *second = clip.getImage(0.0, &everything);
+	ASSERT_NE(second, nullptr);
+	EXPECT_EQ(static_cast<olive::plugin::Image *>(second)->width(), 16);
+	EXPECT_EQ(static_cast<olive::plugin::Image *>(second)->height(), 8);
+
+	first->releaseReference();
+	second->releaseReference();
+}
@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "ofxImageEffect.h"
+#include "pluginSupport/instancepool.h"
+
+TEST(PluginSupportInstancePool, ParsesRenderThreadSafety)
+{
+	using olive::plugin::InstancePool;
+
+	EXPECT_EQ(InstancePool::ThreadSafetyFromString(kOfxImageEffectRenderUnsafe),
+			  InstancePool::kUnsafe);
+	EXPECT_EQ(InstancePool::ThreadSafetyFromString(
+				  kOfxImageEffectRenderInstanceSafe),
+			  InstancePool::kInstanceSafe);
+	EXPECT_EQ(InstancePool::ThreadSafetyFromString(
+				  kOfxImageEffectRenderFullySafe),
+			  InstancePool::kFullySafe);
+
+	// Plugins that don't set the property get the spec's default
+	EXPECT_EQ(InstancePool::ThreadSafetyFromString(std::string()),
+			  InstancePool::kInstanceSafe);
+}
+
+TEST(PluginSupportInstancePool, UnsafePluginsShareOneLock)
+{
+	using olive::plugin::InstancePool;
+
+	QMutex *a = InstancePool::GetPluginLock(QStringLiteral("test.unsafe.a"));
+	EXPECT_EQ(a, InstancePool::GetPluginLock(QStringLiteral("test.unsafe.a")));
+	EXPECT_NE(a, InstancePool::GetPluginLock(QStringLiteral("test.unsafe.b")));
+}
+
+TEST(PluginSupportInstancePool, FailedCreateReleasesPluginLock)
+{
+	using olive::plugin::InstancePool;
+
+	int created = 0;
+	InstancePool pool(QStringLiteral("test.unsafe.failing"),
+					  InstancePool::kUnsafe, [&created] {
+						  created++;
+						  return nullptr;
+					  });
+
+	{
+		InstancePool::Lease lease = pool.Acquire();
+		EXPECT_FALSE(lease);
+	}
+
+	EXPECT_EQ(created, 1);
+	EXPECT_EQ(pool.count(), 0);
+
+	QMutex *lock =
+		InstancePool::GetPluginLock(QStringLiteral("test.unsafe.failing"));
+	ASSERT_TRUE(lock->tryLock());
+	lock->unlock();
+}
@@ -22,3 +22,58 @@ TEST(PluginSupportParam, IntegerInstanceNullNodeRoundTrip)
 	EXPECT_EQ(instance.get(1.0, time_value), kOfxStatOK);
 	EXPECT_EQ(time_value, 7);
 }
+
+TEST(PluginSupportParam, NullNodeKeepsValuesPerTime)
+{
+	OFX::Host::Param::Descriptor descriptor(kOfxParamTypeInteger,
+											"TestInteger");
+	olive::plugin::IntegerInstance instance(nullptr, descriptor);
+
+	EXPECT_EQ(instance.set(1.0, 3), kOfxStatOK);
+	EXPECT_EQ(instance.set(2.0, 5), kOfxStatOK);
+
+	// Plugins reading neighbouring frames get the value copied in for that frame
+	int value = -1;
+	EXPECT_EQ(instance.get(1.0, value), kOfxStatOK);
+	EXPECT_EQ(value, 3);
+	EXPECT_EQ(instance.get(2.0, value), kOfxStatOK);
+	EXPECT_EQ(value, 5);
+
+	// Times that were never set fall back to the last value
+	EXPECT_EQ(instance.get(3.0, value), kOfxStatOK);
+	EXPECT_EQ(value, 5);
+	EXPECT_EQ(instance.get(value), kOfxStatOK);
+	EXPECT_EQ(value, 5);
+
+	// A value that doesn't vary with time replaces them all
+	EXPECT_EQ(instance.set(9), kOfxStatOK);
+	EXPECT_EQ(instance.get(1.0, value), kOfxStatOK);
+	EXPECT_EQ(value, 9);
+}
+
+TEST(PluginSupportParam, NullNodeStartsAtDescriptorDefault)
+{
+	OFX::Host::Param::Descriptor int_descriptor(kOfxParamTypeInteger,
+												"TestInteger");
+	int_descriptor.getProperties().setIntProperty(kOfxParamPropDefault, 4);
+	olive::plugin::IntegerInstance int_instance(nullptr, int_descriptor);
+
+	int int_value = -1;
+	EXPECT_EQ(int_instance.get(int_value), kOfxStatOK);
+	EXPECT_EQ(int_value, 4);
+	EXPECT_EQ(int_instance.get(1.0, int_value), kOfxStatOK);
+	EXPECT_EQ(int_value, 4);
+
+	OFX::Host::Param::Descriptor double_descriptor(kOfxParamTypeDouble,
+												   "TestDouble");
+	double_descriptor.getProperties().setDoubleProperty(kOfxParamPropDefault,
+														0.5);
+	olive::plugin::DoubleInstance double_instance(nullptr, "TestDouble",
+												  double_descriptor);
+
+	double double_value = -1.0;
+	EXPECT_EQ(double_instance.get(double_value), kOfxStatOK);
+	EXPECT_DOUBLE_EQ(double_value, 0.5);
+	EXPECT_EQ(double_instance.get(1.0, double_value), kOfxStatOK);
+	EXPECT_DOUBLE_EQ(double_value, 0.5);
+}
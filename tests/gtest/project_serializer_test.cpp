@@ -1,12 +1,16 @@
 #include <gtest/gtest.h>
 
 #include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
 #include "node/factory.h"
 #include "node/project.h"
 #include "node/input/time/timeinput.h"
+#include "node/project/serializer/parallelnodeloader.h"
 #include "node/project/serializer/serializer.h"
 #include "node/color/colormanager/colormanager.h"
 #include "render/diskmanager.h"
@@ -56,3 +60,262 @@ TEST(ProjectSerializer, SaveLoadProjectRoundTrip)
 		olive::DiskManager::DestroyInstance();
 	}
 }
+
+TEST(ProjectSerializer, WriteCompressedRoundTrip)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	QString fn = QDir(dir.path()).filePath(QStringLiteral("test.ove"));
+
+	QByteArray xml;
+	for (int i = 0; i < 10000; i++) {
+		xml.append(QStringLiteral("<node id=\"%1\"/>\n").arg(i).toUtf8());
+	}
+
+	olive::ProjectSerializer::Result result =
+		olive::ProjectSerializer::Write(fn, xml,
+										olive::ProjectSerializer::kCompressedZlib);
+	ASSERT_EQ(result.code(), olive::ProjectSerializer::kSuccess);
+
+	QFile file(fn);
+	ASSERT_TRUE(file.open(QFile::ReadOnly));
+	EXPECT_LT(file.size(), xml.size());
+
+	olive::ProjectSerializer::Compression compression =
+		olive::ProjectSerializer::GetCompression(&file);
+	EXPECT_NE(compression, olive::ProjectSerializer::kUncompressed);
+
+	QByteArray decompressed;
+	ASSERT_TRUE(olive::ProjectSerializer::Decompress(&file, compression,
+													 &decompressed));
+	EXPECT_EQ(decompressed, xml);
+}
+
+TEST(ProjectSerializer, WritesZstdOnlyWhenSupported)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	QString fn = QDir(dir.path()).filePath(QStringLiteral("zstd.ove"));
+
+	QByteArray xml("<olive version=\"230220\"/>");
+
+	ASSERT_EQ(olive::ProjectSerializer::Write(
+				  fn, xml, olive::ProjectSerializer::kCompressedZstd)
+				  .code(),
+			  olive::ProjectSerializer::kSuccess);
+
+	QFile file(fn);
+	ASSERT_TRUE(file.open(QFile::ReadOnly));
+
+	// Builds without Zstandard write the legacy format rather than a file they couldn't read
+	olive::ProjectSerializer::Compression compression =
+		olive::ProjectSerializer::GetCompression(&file);
+	EXPECT_EQ(compression, olive::ProjectSerializer::IsCompressionSupported(
+							   olive::ProjectSerializer::kCompressedZstd) ?
+							   olive::ProjectSerializer::kCompressedZstd :
+							   olive::ProjectSerializer::kCompressedZlib);
+
+	QByteArray decompressed;
+	ASSERT_TRUE(olive::ProjectSerializer::Decompress(&file, compression,
+													 &decompressed));
+	EXPECT_EQ(decompressed, xml);
+}
+
+TEST(ProjectSerializer, ReadsLegacyZlibProjects)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	QString fn = QDir(dir.path()).filePath(QStringLiteral("legacy.ove"));
+
+	QByteArray xml("<olive version=\"230220\"/>");
+
+	QFile out(fn);
+	ASSERT_TRUE(out.open(QFile::WriteOnly));
+	out.write("OVEC");
+	out.write(qCompress(xml));
+	out.close();
+
+	QFile file(fn);
+	ASSERT_TRUE(file.open(QFile::ReadOnly));
+	ASSERT_EQ(olive::ProjectSerializer::GetCompression(&file),
+			  olive::ProjectSerializer::kCompressedZlib);
+
+	QByteArray decompressed;
+	ASSERT_TRUE(olive::ProjectSerializer::Decompress(
+		&file, olive::ProjectSerializer::kCompressedZlib, &decompressed));
+	EXPECT_EQ(decompressed, xml);
+}
+
+TEST(ProjectSerializer, LoadFileInParallelKeepsNodeOrder)
+{
+	const bool created_disk_manager = (olive::DiskManager::instance() == nullptr);
+	if (created_disk_manager) {
+		olive::DiskManager::CreateInstance();
+	}
+
+	olive::ColorManager::SetUpDefaultConfig();
+	olive::NodeFactory::Initialize();
+	olive::ProjectSerializer::Initialize();
+
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	QString fn = QDir(dir.path()).filePath(QStringLiteral("nodes.ove"));
+
+	const int node_count = 64;
+
+	// Long labels make the nodes span several loader batches
+	const int label_padding =
+		olive::ParallelNodeLoader::kBatchSize * 3 / node_count;
+	auto label = [label_padding](int i) {
+		return QString::number(i) + QString(label_padding, QLatin1Char('.'));
+	};
+
+	{
+		olive::Project project;
+		project.Initialize();
+
+		for (int i = 0; i < node_count; i++) {
+			auto *node = new olive::TimeInput();
+			node->SetLabel(label(i));
+			node->setParent(&project);
+		}
+
+		olive::ProjectSerializer::SaveData save_data(
+			olive::ProjectSerializer::kProject, &project, QString());
+
+		QByteArray xml;
+		QBuffer buffer(&xml);
+		buffer.open(QIODevice::WriteOnly);
+		QXmlStreamWriter writer(&buffer);
+		ASSERT_EQ(olive::ProjectSerializer::Save(&writer, save_data).code(),
+				  olive::ProjectSerializer::kSuccess);
+		buffer.close();
+
+		ASSERT_GT(xml.size(), olive::ParallelNodeLoader::kBatchSize * 2);
+
+		ASSERT_EQ(olive::ProjectSerializer::Write(
+					  fn, xml, olive::ProjectSerializer::kCompressedZlib)
+					  .code(),
+				  olive::ProjectSerializer::kSuccess);
+	}
+
+	QVector<double> progress;
+
+	olive::Project loaded_project;
+	olive::ProjectSerializer::Result result = olive::ProjectSerializer::Load(
+		&loaded_project, fn, olive::ProjectSerializer::kProject,
+		[&progress](double d) { progress.append(d); });
+	ASSERT_EQ(result.code(), olive::ProjectSerializer::kSuccess);
+
+	QStringList labels;
+	for (olive::Node *n : loaded_project.nodes()) {
+		if (dynamic_cast<olive::TimeInput *>(n)) {
+			labels.append(n->GetLabel());
+		}
+	}
+	ASSERT_EQ(labels.size(), node_count);
+	for (int i = 0; i < node_count; i++) {
+		EXPECT_EQ(labels.at(i), label(i));
+	}
+
+	ASSERT_FALSE(progress.isEmpty());
+	for (int i = 1; i < progress.size(); i++) {
+		EXPECT_GE(progress.at(i), progress.at(i - 1));
+	}
+	EXPECT_GT(progress.last(), 0.0);
+	EXPECT_LE(progress.last(), 1.0);
+
+	EXPECT_FALSE(result.GetLoadData().timings.isEmpty());
+
+	olive::ProjectSerializer::Destroy();
+	if (created_disk_manager) {
+		olive::DiskManager::DestroyInstance();
+	}
+}
+
+TEST(ProjectSerializer, SaveReusesUnchangedNodes)
+{
+	const bool created_disk_manager = (olive::DiskManager::instance() == nullptr);
+	if (created_disk_manager) {
+		olive::DiskManager::CreateInstance();
+	}
+
+	olive::ColorManager::SetUpDefaultConfig();
+	olive::NodeFactory::Initialize();
+	olive::ProjectSerializer::Initialize();
+
+	olive::Project project;
+	project.Initialize();
+
+	auto *unchanged = new olive::TimeInput();
+	unchanged->SetLabel(QStringLiteral("unchanged"));
+	unchanged->setParent(&project);
+
+	auto *edited = new olive::TimeInput();
+	edited->SetLabel(QStringLiteral("before"));
+	edited->setParent(&project);
+
+	olive::ProjectSerializer::SaveData save_data(
+		olive::ProjectSerializer::kProject, &project, QString());
+
+	auto save = [&save_data](bool auto_formatting = false) {
+		QByteArray xml;
+		QXmlStreamWriter writer(&xml);
+		writer.setAutoFormatting(auto_formatting);
+		EXPECT_EQ(olive::ProjectSerializer::Save(&writer, save_data).code(),
+				  olive::ProjectSerializer::kSuccess);
+		return xml;
+	};
+
+	QByteArray first = save();
+	EXPECT_TRUE(first.contains("<label>before</label>"));
+
+	// Saving again without changes writes the same document from the saved elements
+	EXPECT_EQ(save(), first);
+
+	edited->SetLabel(QStringLiteral("after"));
+
+	QByteArray second = save();
+	EXPECT_FALSE(second.contains("<label>before</label>"));
+	EXPECT_TRUE(second.contains("<label>after</label>"));
+	EXPECT_TRUE(second.contains("<label>unchanged</label>"));
+
+	// Kept elements are formatted like the rest of the document
+	QByteArray reformatted;
+	{
+		QXmlStreamReader unformatted(second);
+		QXmlStreamWriter writer(&reformatted);
+		writer.setAutoFormatting(true);
+		while (!unformatted.atEnd()) {
+			unformatted.readNext();
+			if (unformatted.isStartDocument()) {
+				writer.writeStartDocument();
+			} else if (!unformatted.hasError()) {
+				writer.writeCurrentToken(unformatted);
+			}
+		}
+	}
+	EXPECT_EQ(save(true), reformatted);
+
+	// Kept elements still have to make a valid project
+	olive::Project loaded_project;
+	QXmlStreamReader reader(second);
+	ASSERT_EQ(olive::ProjectSerializer::Load(&loaded_project, &reader,
+											 olive::ProjectSerializer::kProject)
+				  .code(),
+			  olive::ProjectSerializer::kSuccess);
+
+	QStringList labels;
+	for (olive::Node *n : loaded_project.nodes()) {
+		if (dynamic_cast<olive::TimeInput *>(n)) {
+			labels.append(n->GetLabel());
+		}
+	}
+	EXPECT_EQ(labels, QStringList({ QStringLiteral("unchanged"),
+									QStringLiteral("after") }));
+
+	olive::ProjectSerializer::Destroy();
+	if (created_disk_manager) {
+		olive::DiskManager::DestroyInstance();
+	}
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "render/colorshadercache.h"
+
+namespace
+{
+
+olive::ColorShaderCache::Shader CreateShader()
+{
+	olive::ColorShaderCache::Shader shader;
+	shader.text = QStringLiteral("vec4 OCIODisplay(vec4 c) { return c; }");
+
+	olive::ColorShaderCache::LUT lut3d;
+	lut3d.sampler_name = QStringLiteral("ocio_lut3d_0Sampler");
+	lut3d.width = lut3d.height = lut3d.depth = 2;
+	lut3d.channel_count = 3;
+	for (int i = 0; i < 2 * 2 * 2 * 3; i++) {
+		lut3d.values.append(float(i) / 23.0f);
+	}
+	shader.lut3d.append(lut3d);
+
+	olive::ColorShaderCache::LUT lut1d;
+	lut1d.sampler_name = QStringLiteral("ocio_lut1d_0Sampler");
+	lut1d.width = 4;
+	lut1d.height = 1;
+	lut1d.depth = 1;
+	lut1d.channel_count = 1;
+	lut1d.nearest = true;
+	lut1d.values = { 0.0f, 0.25f, 0.5f, 1.0f };
+	shader.lut1d.append(lut1d);
+
+	return shader;
+}
+
+}
+
+TEST(ColorShaderCache, RoundTrip)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+
+	QString filename = dir.filePath(QStringLiteral("sub/shader"));
+	olive::ColorShaderCache::Shader in = CreateShader();
+
+	ASSERT_TRUE(
+		olive::ColorShaderCache::Save(filename, QStringLiteral("key"), in));
+
+	olive::ColorShaderCache::Shader out;
+	ASSERT_TRUE(
+		olive::ColorShaderCache::Load(filename, QStringLiteral("key"), &out));
+
+	EXPECT_EQ(out.text, in.text);
+	ASSERT_EQ(out.lut3d.size(), 1);
+	EXPECT_EQ(out.lut3d.first().sampler_name, in.lut3d.first().sampler_name);
+	EXPECT_EQ(out.lut3d.first().depth, 2);
+	EXPECT_EQ(out.lut3d.first().values, in.lut3d.first().values);
+	ASSERT_EQ(out.lut1d.size(), 1);
+	EXPECT_TRUE(out.lut1d.first().nearest);
+	EXPECT_EQ(out.lut1d.first().channel_count, 1);
+	EXPECT_EQ(out.lut1d.first().values, in.lut1d.first().values);
+}
+
+TEST(ColorShaderCache, RejectsMismatchedOrCorruptFiles)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+
+	QString filename = dir.filePath(QStringLiteral("shader"));
+	ASSERT_TRUE(olive::ColorShaderCache::Save(filename, QStringLiteral("a"),
+											  CreateShader()));
+
+	olive::ColorShaderCache::Shader out;
+	EXPECT_FALSE(
+		olive::ColorShaderCache::Load(filename, QStringLiteral("b"), &out));
+
+	// Truncate the file partway through the LUT data
+	QFile file(filename);
+	ASSERT_TRUE(file.open(QFile::ReadWrite));
+	ASSERT_TRUE(file.resize(file.size() - 8));
+	file.close();
+
+	EXPECT_FALSE(
+		olive::ColorShaderCache::Load(filename, QStringLiteral("a"), &out));
+	EXPECT_FALSE(olive::ColorShaderCache::Load(
+		dir.filePath(QStringLiteral("missing")), QStringLiteral("a"), &out));
+}
+
+TEST(ColorShaderCache, TrimRemovesLeastRecentlyUsed)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+
+	// Three 100 byte files, "b" is the oldest and "c" the newest
+	const QDateTime now = QDateTime::currentDateTime();
+	const QStringList names = { QStringLiteral("a"), QStringLiteral("b"),
+								QStringLiteral("c") };
+	const int ages[] = { 20, 30, 10 };
+	for (int i = 0; i < names.size(); i++) {
+		QFile file(dir.filePath(names.at(i)));
+		ASSERT_TRUE(file.open(QFile::WriteOnly));
+		file.write(QByteArray(100, 'x'));
+
+		// Flush first, otherwise writing on close would update the time again
+		ASSERT_TRUE(file.flush());
+		ASSERT_TRUE(file.setFileTime(now.addSecs(-ages[i]),
+									 QFileDevice::FileModificationTime));
+	}
+
+	olive::ColorShaderCache::TrimDirectory(dir.path(), 300);
+	EXPECT_EQ(QDir(dir.path()).entryList(QDir::Files).size(), 3);
+
+	olive::ColorShaderCache::TrimDirectory(dir.path(), 250);
+	EXPECT_FALSE(QFile::exists(dir.filePath(QStringLiteral("b"))));
+	EXPECT_TRUE(QFile::exists(dir.filePath(QStringLiteral("a"))));
+	EXPECT_TRUE(QFile::exists(dir.filePath(QStringLiteral("c"))));
+
+	olive::ColorShaderCache::TrimDirectory(dir.path(), 100);
+	EXPECT_FALSE(QFile::exists(dir.filePath(QStringLiteral("a"))));
+	EXPECT_TRUE(QFile::exists(dir.filePath(QStringLiteral("c"))));
+}
@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+
+#include <QDateTime>
+#include <QTemporaryFile>
+#include <atomic>
+#include <limits>
+
+#include "render/decoderpool.h"
+
+namespace
+{
+
+std::atomic_int open_count{ 0 };
+
+class FakeDecoder : public olive::Decoder {
+public:
+	virtual QString id() const override
+	{
+		return QStringLiteral("fake");
+	}
+
+	virtual olive::FootageDescription Probe(const QString &,
+											olive::CancelAtom *) const override
+	{
+		return olive::FootageDescription();
+	}
+
+protected:
+	virtual bool OpenInternal() override
+	{
+		open_count++;
+		return true;
+	}
+
+	virtual void CloseInternal() override
+	{
+	}
+
+	virtual qint64 GetMemoryUsageInternal() const override
+	{
+		return 100;
+	}
+};
+
+olive::DecoderPtr CreateFakeDecoder(const QString &)
+{
+	return std::make_shared<FakeDecoder>();
+}
+
+}
+
+TEST(DecoderPool, SharesInstancesBetweenBlocks)
+{
+	QTemporaryFile file;
+	ASSERT_TRUE(file.open());
+
+	open_count = 0;
+	olive::DecoderPool pool(4, CreateFakeDecoder);
+
+	// Two different blocks reading the same position of the same file get the same decoder
+	olive::Block *a = reinterpret_cast<olive::Block *>(0x1);
+	olive::Block *b = reinterpret_cast<olive::Block *>(0x2);
+
+	olive::Decoder *first;
+	{
+		bool created;
+		olive::DecoderPtr d = pool.Lease(
+			QStringLiteral("fake"),
+			olive::Decoder::CodecStream(file.fileName(), 0, a), 10, &created);
+		ASSERT_TRUE(d);
+		EXPECT_TRUE(created);
+		first = d.get();
+	}
+
+	{
+		bool created;
+		olive::DecoderPtr d = pool.Lease(
+			QStringLiteral("fake"),
+			olive::Decoder::CodecStream(file.fileName(), 0, b), 11, &created);
+		ASSERT_TRUE(d);
+		EXPECT_FALSE(created);
+		EXPECT_EQ(d.get(), first);
+	}
+
+	EXPECT_EQ(open_count, 1);
+	EXPECT_EQ(pool.GetStats().instances, 1);
+}
+
+TEST(DecoderPool, LeasesNearestInstance)
+{
+	QTemporaryFile file;
+	ASSERT_TRUE(file.open());
+
+	olive::DecoderPool pool(2, CreateFakeDecoder);
+	olive::Decoder::CodecStream stream(file.fileName(), 0, nullptr);
+
+	olive::DecoderPtr near_start = pool.Lease(QStringLiteral("fake"), stream, 0);
+	olive::DecoderPtr near_end = pool.Lease(QStringLiteral("fake"), stream, 100);
+	ASSERT_TRUE(near_start);
+	ASSERT_TRUE(near_end);
+
+	// Too far from the first to reuse it, so a second instance was opened
+	EXPECT_NE(near_start.get(), near_end.get());
+
+	olive::Decoder *start_ptr = near_start.get();
+	olive::Decoder *end_ptr = near_end.get();
+	near_start = nullptr;
+	near_end = nullptr;
+
+	EXPECT_EQ(pool.Lease(QStringLiteral("fake"), stream, 99).get(), end_ptr);
+	EXPECT_EQ(pool.Lease(QStringLiteral("fake"), stream, 1).get(), start_ptr);
+
+	// At the maximum, a distant request still reuses the nearest instance rather than opening a third
+	EXPECT_EQ(pool.Lease(QStringLiteral("fake"), stream, 80).get(), end_ptr);
+	EXPECT_EQ(pool.GetStats().instances, 2);
+}
+
+TEST(DecoderPool, SharesBusyInstancesAtMaximum)
+{
+	QTemporaryFile file;
+	ASSERT_TRUE(file.open());
+
+	olive::DecoderPool pool(1, CreateFakeDecoder);
+	olive::Decoder::CodecStream stream(file.fileName(), 0, nullptr);
+
+	olive::DecoderPtr a = pool.Lease(QStringLiteral("fake"), stream, 0);
+	olive::DecoderPtr b = pool.Lease(QStringLiteral("fake"), stream, 50);
+	ASSERT_TRUE(a);
+	EXPECT_EQ(a.get(), b.get());
+
+	olive::DecoderPool::Stats stats = pool.GetStats();
+	EXPECT_EQ(stats.instances, 1);
+	EXPECT_EQ(stats.leased, 1);
+	EXPECT_EQ(stats.memory_usage, 100);
+}
+
+TEST(DecoderPool, ClearsIdleInstances)
+{
+	QTemporaryFile file;
+	ASSERT_TRUE(file.open());
+
+	olive::DecoderPool pool(4, CreateFakeDecoder);
+	olive::Decoder::CodecStream stream(file.fileName(), 0, nullptr);
+
+	olive::DecoderPtr leased = pool.Lease(QStringLiteral("fake"), stream, 0);
+	pool.Lease(QStringLiteral("fake"), stream, 100);
+	ASSERT_EQ(pool.GetStats().instances, 2);
+
+	// Leased instances stay open no matter how old they are
+	pool.ClearUnusedSince(std::numeric_limits<qint64>::max());
+	EXPECT_EQ(pool.GetStats().instances, 1);
+	EXPECT_EQ(pool.GetStats().leased, 1);
+}
+
+TEST(DecoderPool, ThrottlesModifiedCheck)
+{
+	QTemporaryFile file;
+	ASSERT_TRUE(file.open());
+
+	olive::DecoderPool pool;
+
+	qint64 before = pool.GetLastModified(file.fileName());
+
+	file.write("changed");
+	file.flush();
+	file.setFileTime(QDateTime::fromMSecsSinceEpoch(before + 60000),
+					 QFileDevice::FileModificationTime);
+
+	// Still inside the check interval, so the cached time is returned
+	EXPECT_EQ(pool.GetLastModified(file.fileName()), before);
+
+	// Forgetting the file forces the next call to check again
+	pool.Clear();
+	EXPECT_EQ(pool.GetLastModified(file.fileName()), before + 60000);
+}
+
+TEST(DecoderPool, WarmUpNeverMovesLeasedInstances)
+{
+	QTemporaryFile file;
+	ASSERT_TRUE(file.open());
+
+	olive::DecoderPool pool(1, CreateFakeDecoder);
+	olive::Decoder::CodecStream stream(file.fileName(), 0, nullptr);
+
+	olive::DecoderPtr playing = pool.Lease(QStringLiteral("fake"), stream, 0);
+	ASSERT_TRUE(playing);
+
+	// The only instance is in use, so there's nothing to warm up with
+	EXPECT_FALSE(pool.LeaseForWarmUp(QStringLiteral("fake"), stream, 50,
+									 std::numeric_limits<qint64>::max()));
+	EXPECT_EQ(pool.GetStats().instances, 1);
+}
+
+TEST(DecoderPool, WarmUpOnlyMovesInstancesIdleLongEnough)
+{
+	QTemporaryFile file;
+	ASSERT_TRUE(file.open());
+
+	olive::DecoderPool pool(1, CreateFakeDecoder);
+	olive::Decoder::CodecStream stream(file.fileName(), 0, nullptr);
+
+	olive::Decoder *instance;
+	{
+		olive::DecoderPtr d = pool.Lease(QStringLiteral("fake"), stream, 0);
+		ASSERT_TRUE(d);
+		instance = d.get();
+	}
+
+	// Released, but used more recently than the threshold
+	qint64 opened = instance->GetLastAccessedTime();
+	EXPECT_FALSE(
+		pool.LeaseForWarmUp(QStringLiteral("fake"), stream, 50, opened));
+
+	olive::DecoderPtr warmed = pool.LeaseForWarmUp(QStringLiteral("fake"),
+												   stream, 50, opened + 1);
+	EXPECT_EQ(warmed.get(), instance);
+}
+
+TEST(DecoderPool, WarmUpOpensNewInstancesBelowMaximum)
+{
+	QTemporaryFile file;
+	ASSERT_TRUE(file.open());
+
+	olive::DecoderPool pool(2, CreateFakeDecoder);
+	olive::Decoder::CodecStream stream(file.fileName(), 0, nullptr);
+
+	olive::DecoderPtr playing = pool.Lease(QStringLiteral("fake"), stream, 0);
+	ASSERT_TRUE(playing);
+
+	olive::DecoderPtr warmed =
+		pool.LeaseForWarmUp(QStringLiteral("fake"), stream, 50, 0);
+	ASSERT_TRUE(warmed);
+	EXPECT_NE(warmed.get(), playing.get());
+
+	olive::Decoder *warmed_ptr = warmed.get();
+	warmed = nullptr;
+
+	// An idle instance is already there, nothing more to warm up
+	EXPECT_FALSE(pool.LeaseForWarmUp(QStringLiteral("fake"), stream, 51, 0));
+
+	// Playback reaching that time gets the warmed instance
+	EXPECT_EQ(pool.Lease(QStringLiteral("fake"), stream, 50).get(), warmed_ptr);
+}
@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include "render/decoderwarmer.h"
+
+using olive::core::rational;
+using olive::core::TimeRange;
+
+TEST(DecoderWarmer, ReversedClipsStartAtTheirLastFrame)
+{
+	TimeRange media(rational(10), rational(20));
+	rational frame(1, 25);
+
+	EXPECT_EQ(olive::DecoderWarmer::GetFirstFrameTime(media, false, frame),
+			  rational(10));
+
+	// The media range's out point is exclusive, the first frame shown is the one before it
+	EXPECT_EQ(olive::DecoderWarmer::GetFirstFrameTime(media, true, frame),
+			  rational(20) - frame);
+
+	// Never before the clip's own media
+	TimeRange tiny(rational(10), rational(10) + rational(1, 100));
+	EXPECT_EQ(olive::DecoderWarmer::GetFirstFrameTime(tiny, true, frame),
+			  rational(10));
+}
+
+TEST(DecoderWarmer, DividerMatchesPlayback)
+{
+	olive::VideoParams footage(3840, 2160, olive::core::PixelFormat::U8, 4,
+							   rational(1, 1), olive::VideoParams::kInterlaceNone,
+							   1);
+	olive::VideoParams sequence(1920, 1080, olive::core::PixelFormat::F16, 4,
+								rational(1, 1), olive::VideoParams::kInterlaceNone,
+								1);
+
+	// Full resolution sequences decode at full resolution
+	EXPECT_EQ(olive::DecoderWarmer::GetFootageDivider(footage, sequence, 0), 1);
+
+	// Playback dropping to a quarter resolution decodes at a quarter too, like Footage asks for
+	EXPECT_EQ(olive::DecoderWarmer::GetFootageDivider(footage, sequence, 4), 4);
+
+	// A lower playback divider than the sequence's own doesn't override it
+	sequence.set_divider(2);
+	EXPECT_EQ(olive::DecoderWarmer::GetFootageDivider(footage, sequence, 1),
+			  olive::DecoderWarmer::GetFootageDivider(footage, sequence, 0));
+}
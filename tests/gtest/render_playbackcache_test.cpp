@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+
+#include <QCoreApplication>
+#include <vector>
+
+#include "render/playbackcache.h"
+
+TEST(PlaybackCache, InvalidationsAreBatched)
+{
+	olive::PlaybackCache cache;
+	cache.SetSavingEnabled(false);
+
+	std::vector<olive::core::TimeRange> signalled;
+	QObject::connect(&cache, &olive::PlaybackCache::Invalidated,
+					 [&signalled](const olive::core::TimeRange &r) {
+						 signalled.push_back(r);
+					 });
+
+	using olive::core::rational;
+	cache.Invalidate(olive::core::TimeRange(rational(0), rational(2)));
+	cache.Invalidate(olive::core::TimeRange(rational(1), rational(3)));
+	cache.Invalidate(olive::core::TimeRange(rational(2), rational(4)));
+
+	// Nothing is signalled until control returns to the event loop
+	EXPECT_TRUE(signalled.empty());
+
+	QCoreApplication::processEvents();
+
+	ASSERT_EQ(signalled.size(), size_t(1));
+	EXPECT_EQ(signalled.front().in(), rational(0));
+	EXPECT_EQ(signalled.front().out(), rational(4));
+
+	// A later edit starts a new batch
+	cache.Invalidate(olive::core::TimeRange(rational(10), rational(11)));
+	QCoreApplication::processEvents();
+	EXPECT_EQ(signalled.size(), size_t(2));
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <QFile>
+
+#include "render/shaderfusion.h"
+
+namespace
+{
+
+QString ReadShader(const QString &name)
+{
+	QFile f(QStringLiteral(":/shaders/%1.frag").arg(name));
+	EXPECT_TRUE(f.open(QIODevice::ReadOnly)) << name.toStdString();
+	return QString::fromUtf8(f.readAll());
+}
+
+}
+
+TEST(ShaderFusion, PixelShadersAreFusible)
+{
+	const QStringList names = { QStringLiteral("opacity"),
+								QStringLiteral("invertrgb"),
+								QStringLiteral("rgb"),
+								QStringLiteral("crop"),
+								QStringLiteral("flip") };
+
+	for (const QString &name : names) {
+		olive::ShaderFusion::Analysis a =
+			olive::ShaderFusion::Analyze(ReadShader(name));
+		EXPECT_TRUE(a.fusible) << name.toStdString();
+		EXPECT_EQ(a.chainable_inputs.size(), 1) << name.toStdString();
+	}
+
+	EXPECT_EQ(olive::ShaderFusion::Analyze(ReadShader(QStringLiteral("rgb")))
+				  .chainable_inputs.first(),
+			  QStringLiteral("texture_in"));
+}
+
+TEST(ShaderFusion, RejectsUnsupportedShaders)
+{
+	const QString header = QStringLiteral("uniform sampler2D tex_in;\n"
+										  "in vec2 ove_texcoord;\n"
+										  "out vec4 frag_color;\n");
+
+	EXPECT_FALSE(olive::ShaderFusion::Analyze(QString()).fusible);
+
+	EXPECT_FALSE(olive::ShaderFusion::Analyze(
+					 header + QStringLiteral("void main() {\n"
+											 "  if (ove_texcoord.x > 0.5) discard;\n"
+											 "  frag_color = texture(tex_in, ove_texcoord);\n"
+											 "}\n"))
+					 .fusible);
+
+	EXPECT_FALSE(olive::ShaderFusion::Analyze(
+					 header + QStringLiteral("vec4 helper() { return vec4(1.0); }\n"
+											 "void main() { frag_color = helper(); }\n"))
+					 .fusible);
+
+	EXPECT_FALSE(olive::ShaderFusion::Analyze(
+					 QStringLiteral("uniform int ove_iteration;\n") + header +
+					 QStringLiteral("void main() { frag_color = texture(tex_in, ove_texcoord); }\n"))
+					 .fusible);
+
+	// Fusible, but the input is read at other texels so it can't take another stage's output
+	olive::ShaderFusion::Analysis a = olive::ShaderFusion::Analyze(
+		QStringLiteral("uniform vec2 offset_in;\n") + header +
+		QStringLiteral("void main() {\n"
+					   "  frag_color = texture(tex_in, ove_texcoord + offset_in);\n"
+					   "}\n"));
+	EXPECT_TRUE(a.fusible);
+	EXPECT_TRUE(a.chainable_inputs.isEmpty());
+
+	// A copy of the coordinate that's changed in any way other than mirroring isn't the same texel either
+	a = olive::ShaderFusion::Analyze(
+		QStringLiteral("uniform vec2 offset_in;\n") + header +
+		QStringLiteral("void main() {\n"
+					   "  vec2 coord = ove_texcoord;\n"
+					   "  coord.x = 1.0 - coord.x;\n"
+					   "  coord += offset_in;\n"
+					   "  frag_color = texture(tex_in, coord);\n"
+					   "}\n"));
+	EXPECT_TRUE(a.fusible);
+	EXPECT_TRUE(a.chainable_inputs.isEmpty());
+}
+
+TEST(ShaderFusion, DistortionsAreNotChainable)
+{
+	const QStringList names = { QStringLiteral("swirl"),
+								QStringLiteral("mosaic") };
+
+	for (const QString &name : names) {
+		EXPECT_TRUE(olive::ShaderFusion::Analyze(ReadShader(name))
+						.chainable_inputs.isEmpty())
+			<< name.toStdString();
+	}
+}
+
+TEST(ShaderFusion, GeneratesOnePassForChain)
+{
+	const QStringList cycle = { QStringLiteral("opacity"),
+								QStringLiteral("invertrgb"),
+								QStringLiteral("flip"),
+								QStringLiteral("crop"),
+								QStringLiteral("rgb") };
+
+	QStringList codes;
+	QStringList inputs;
+	for (int i = 0; i < 10; i++) {
+		const QString &name = cycle.at(i % cycle.size());
+		codes.append(ReadShader(name));
+		inputs.append(name == QStringLiteral("rgb") ? QStringLiteral("texture_in") :
+													  QStringLiteral("tex_in"));
+	}
+
+	QString fused = olive::ShaderFusion::Generate(codes, inputs);
+
+	EXPECT_EQ(fused.count(QStringLiteral("void main")), 1);
+	EXPECT_TRUE(fused.contains(QStringLiteral("frag_color = s9_main(ove_texcoord);")));
+
+	// Only the first stage still samples a texture
+	EXPECT_TRUE(fused.contains(QStringLiteral("uniform sampler2D s0_tex_in;")));
+	EXPECT_EQ(fused.count(QStringLiteral("sampler2D")), 1);
+	EXPECT_TRUE(fused.contains(QStringLiteral("uniform float s0_opacity_in;")));
+	EXPECT_TRUE(fused.contains(QStringLiteral("uniform vec4 s9_color_in;")));
+
+	// Flip's early return now returns its color and reads the previous stage instead of its texture
+	EXPECT_TRUE(fused.contains(QStringLiteral("return s2_color;")));
+	EXPECT_TRUE(fused.contains(QStringLiteral("s1_main(clamp(new_coord, 0.0, 1.0))")));
+	EXPECT_FALSE(fused.contains(QStringLiteral("texture(tex_in")));
+}
+
+TEST(ShaderFusion, TenNodeChainBenchmark)
+{
+	// A 1080p half-float RGBA frame, the format previews render in by default
+	const qint64 frame_bytes = qint64(1920) * 1080 * 4 * 2;
+	const int chain_length = 10;
+
+	const QStringList cycle = { QStringLiteral("opacity"),
+								QStringLiteral("invertrgb"),
+								QStringLiteral("flip"),
+								QStringLiteral("crop"),
+								QStringLiteral("rgb") };
+
+	QStringList codes;
+	QStringList inputs;
+	for (int i = 0; i < chain_length; i++) {
+		const QString &name = cycle.at(i % cycle.size());
+		QString code = ReadShader(name);
+		olive::ShaderFusion::Analysis a = olive::ShaderFusion::Analyze(code);
+		ASSERT_EQ(a.chainable_inputs.size(), 1) << name.toStdString();
+		codes.append(code);
+		inputs.append(a.chainable_inputs.first());
+	}
+
+	// Unfused, every node is its own pass reading its input frame and writing a new one
+	const int separate_passes = chain_length;
+	const qint64 separate_traffic = separate_passes * frame_bytes * 2;
+
+	// Fused, there's one pass per shader generated, reading each remaining sampler once
+	const QString fused = olive::ShaderFusion::Generate(codes, inputs);
+	const int fused_passes = fused.count(QStringLiteral("void main"));
+	const int fused_samplers = fused.count(QStringLiteral("sampler2D"));
+	const qint64 fused_traffic = fused_passes * frame_bytes + fused_samplers * frame_bytes;
+
+	RecordProperty("separate_passes", separate_passes);
+	RecordProperty("fused_passes", fused_passes);
+	RecordProperty("separate_traffic_mib", int(separate_traffic >> 20));
+	RecordProperty("fused_traffic_mib", int(fused_traffic >> 20));
+
+	EXPECT_EQ(fused_passes, 1);
+	EXPECT_EQ(fused_samplers, 1);
+	EXPECT_EQ(separate_traffic / fused_traffic, chain_length);
+}
+
+TEST(ShaderFusion, RenamesJobValues)
+{
+	olive::ShaderJob first;
+	first.Insert(QStringLiteral("tex_in"), olive::NodeValue(olive::NodeValue::kFloat, 1.0));
+	first.Insert(QStringLiteral("opacity_in"), olive::NodeValue(olive::NodeValue::kFloat, 0.5));
+	first.SetInterpolation(QStringLiteral("tex_in"), olive::Texture::kNearest);
+
+	olive::ShaderJob second;
+	second.Insert(QStringLiteral("tex_in"), olive::NodeValue(olive::NodeValue::kFloat, 2.0));
+	second.Insert(QStringLiteral("horiz_in"), olive::NodeValue(olive::NodeValue::kBoolean, true));
+
+	QVector<olive::ShaderFusion::Stage> stages;
+	stages.append({ nullptr, &first, QString() });
+	stages.append({ nullptr, &second, QStringLiteral("tex_in") });
+
+	olive::ShaderJob fused = olive::ShaderFusion::CreateJob(stages);
+
+	EXPECT_EQ(fused.GetValues().size(), 3);
+	EXPECT_TRUE(fused.GetValues().contains(QStringLiteral("s0_tex_in")));
+	EXPECT_DOUBLE_EQ(fused.Get(QStringLiteral("s0_opacity_in")).toDouble(), 0.5);
+	EXPECT_TRUE(fused.Get(QStringLiteral("s1_horiz_in")).toBool());
+	EXPECT_FALSE(fused.GetValues().contains(QStringLiteral("s1_tex_in")));
+	EXPECT_EQ(fused.GetInterpolation(QStringLiteral("s0_tex_in")),
+			  olive::Texture::kNearest);
+}
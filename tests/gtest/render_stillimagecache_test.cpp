@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "render/stillimagecache.h"
+
+namespace
+{
+
+olive::TexturePtr CreateTexture(int width, int height)
+{
+	return std::make_shared<olive::Texture>(olive::VideoParams(
+		width, height, olive::core::PixelFormat::U8,
+		olive::VideoParams::kRGBAChannelCount));
+}
+
+QString CreateKey(const QString &filename, qint64 last_modified = 0)
+{
+	return olive::StillImageCache::CreateKey(filename, last_modified, 0, 1,
+											 QStringLiteral("sRGB"), 0,
+											 QStringLiteral("ACEScg"), 3);
+}
+
+}
+
+TEST(StillImageCache, KeyCoversSourceAndColor)
+{
+	QString key = CreateKey(QStringLiteral("a.png"));
+
+	EXPECT_EQ(key, CreateKey(QStringLiteral("a.png")));
+	EXPECT_NE(key, CreateKey(QStringLiteral("b.png")));
+	EXPECT_NE(key, CreateKey(QStringLiteral("a.png"), 1));
+	EXPECT_NE(key, olive::StillImageCache::CreateKey(
+					   QStringLiteral("a.png"), 0, 0, 2, QStringLiteral("sRGB"),
+					   0, QStringLiteral("ACEScg"), 3));
+	EXPECT_NE(key, olive::StillImageCache::CreateKey(
+					   QStringLiteral("a.png"), 0, 0, 1,
+					   QStringLiteral("Linear"), 0, QStringLiteral("ACEScg"),
+					   3));
+}
+
+TEST(StillImageCache, GeneratedKeyCoversJobAndSize)
+{
+	olive::VideoParams params(1920, 1080, olive::core::PixelFormat::U8,
+							  olive::VideoParams::kRGBAChannelCount);
+	const QString node_id = QStringLiteral("org.olivevideoeditor.Olive.text3");
+
+	QString key = olive::StillImageCache::CreateKey(
+		node_id, QStringLiteral("abc"), params);
+
+	EXPECT_EQ(key, olive::StillImageCache::CreateKey(
+					   node_id, QStringLiteral("abc"), params));
+	EXPECT_NE(key, olive::StillImageCache::CreateKey(
+					   node_id, QStringLiteral("abd"), params));
+	EXPECT_NE(key, olive::StillImageCache::CreateKey(
+					   QStringLiteral("org.olivevideoeditor.Olive.shape"),
+					   QStringLiteral("abc"), params));
+
+	olive::VideoParams proxy = params;
+	proxy.set_divider(2);
+	EXPECT_NE(key, olive::StillImageCache::CreateKey(
+					   node_id, QStringLiteral("abc"), proxy));
+
+	olive::VideoParams smaller = params;
+	smaller.set_height(540);
+	EXPECT_NE(key, olive::StillImageCache::CreateKey(
+					   node_id, QStringLiteral("abc"), smaller));
+}
+
+TEST(StillImageCache, EvictsLeastRecentlyUsed)
+{
+	// Room for two 10x10 RGBA8 textures
+	olive::StillImageCache cache(800);
+
+	QString a = CreateKey(QStringLiteral("a.png"));
+	QString b = CreateKey(QStringLiteral("b.png"));
+	QString c = CreateKey(QStringLiteral("c.png"));
+
+	olive::TexturePtr tex_a = CreateTexture(10, 10);
+	cache.Insert(a, tex_a, 0);
+	cache.Insert(b, CreateTexture(10, 10), 1);
+	EXPECT_EQ(cache.GetCachedBytes(), 800);
+
+	// Touch `a` so `b` is the oldest
+	EXPECT_EQ(cache.Get(a, 2), tex_a);
+
+	cache.Insert(c, CreateTexture(10, 10), 3);
+	EXPECT_EQ(cache.Get(a, 4), tex_a);
+	EXPECT_EQ(cache.Get(b, 4), nullptr);
+	EXPECT_NE(cache.Get(c, 4), nullptr);
+	EXPECT_EQ(cache.GetCachedBytes(), 800);
+
+	// Too large to ever fit
+	cache.Insert(b, CreateTexture(100, 100), 5);
+	EXPECT_EQ(cache.Get(b, 5), nullptr);
+
+	cache.ClearUnusedSince(5);
+	EXPECT_EQ(cache.GetCachedBytes(), 0);
+}
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include "render/texturepool.h"
+
+using olive::TexturePool;
+using olive::core::PixelFormat;
+
+TEST(TexturePool, KeysAreDistinctPerDescriptor)
+{
+	quint64 a = TexturePool::MakeKey(1920, 1080, 1, PixelFormat::F16, 4);
+
+	EXPECT_EQ(a, TexturePool::MakeKey(1920, 1080, 1, PixelFormat::F16, 4));
+	EXPECT_NE(a, TexturePool::MakeKey(1080, 1920, 1, PixelFormat::F16, 4));
+	EXPECT_NE(a, TexturePool::MakeKey(1920, 1080, 2, PixelFormat::F16, 4));
+	EXPECT_NE(a, TexturePool::MakeKey(1920, 1080, 1, PixelFormat::F32, 4));
+	EXPECT_NE(a, TexturePool::MakeKey(1920, 1080, 1, PixelFormat::F16, 3));
+}
+
+TEST(TexturePool, ReusesMatchingTexture)
+{
+	TexturePool pool;
+	quint64 hd = TexturePool::MakeKey(1920, 1080, 1, PixelFormat::F16, 4);
+	quint64 uhd = TexturePool::MakeKey(3840, 2160, 1, PixelFormat::F16, 4);
+
+	EXPECT_TRUE(pool.Acquire(hd).isNull());
+
+	pool.Release(hd, 1, 100, 0);
+	pool.Release(hd, 2, 100, 1);
+	pool.Release(uhd, 3, 400, 2);
+
+	EXPECT_TRUE(pool.Acquire(TexturePool::MakeKey(1280, 720, 1,
+												  PixelFormat::F16, 4))
+					.isNull());
+
+	// Most recently released first
+	EXPECT_EQ(pool.Acquire(hd).toInt(), 2);
+	EXPECT_EQ(pool.Acquire(hd).toInt(), 1);
+	EXPECT_TRUE(pool.Acquire(hd).isNull());
+	EXPECT_EQ(pool.Acquire(uhd).toInt(), 3);
+
+	TexturePool::Stats stats = pool.GetStats();
+	EXPECT_EQ(stats.hits, quint64(3));
+	EXPECT_EQ(stats.misses, quint64(3));
+	EXPECT_EQ(stats.cached_bytes, 0);
+	EXPECT_EQ(stats.cached_count, 0);
+	EXPECT_TRUE(pool.TakePendingDestroy().isEmpty());
+}
+
+TEST(TexturePool, EvictsLeastRecentlyReleasedOverBudget)
+{
+	TexturePool pool(300);
+	quint64 a = TexturePool::MakeKey(10, 10, 1, PixelFormat::U8, 4);
+	quint64 b = TexturePool::MakeKey(20, 20, 1, PixelFormat::U8, 4);
+
+	pool.Release(a, 1, 100, 0);
+	pool.Release(b, 2, 100, 1);
+	pool.Release(a, 3, 100, 2);
+	EXPECT_TRUE(pool.TakePendingDestroy().isEmpty());
+
+	// Goes over budget, oldest texture in any bucket is evicted
+	pool.Release(b, 4, 100, 3);
+
+	QVector<QVariant> evicted = pool.TakePendingDestroy();
+	ASSERT_EQ(evicted.size(), 1);
+	EXPECT_EQ(evicted.first().toInt(), 1);
+	EXPECT_EQ(pool.GetStats().cached_bytes, 300);
+	EXPECT_EQ(pool.GetStats().evictions, quint64(1));
+
+	EXPECT_EQ(pool.Acquire(a).toInt(), 3);
+	EXPECT_TRUE(pool.Acquire(a).isNull());
+
+	pool.SetBudget(100);
+	evicted = pool.TakePendingDestroy();
+	ASSERT_EQ(evicted.size(), 1);
+	EXPECT_EQ(evicted.first().toInt(), 2);
+	EXPECT_EQ(pool.Acquire(b).toInt(), 4);
+}
+
+TEST(TexturePool, ExpiresOldTextures)
+{
+	TexturePool pool;
+	quint64 key = TexturePool::MakeKey(10, 10, 1, PixelFormat::U8, 4);
+
+	pool.Release(key, 1, 100, 1000);
+	pool.Release(key, 2, 100, 2000);
+	pool.Release(key, 3, 100, 3000);
+
+	pool.ExpireOlderThan(2500);
+
+	QVector<QVariant> evicted = pool.TakePendingDestroy();
+	ASSERT_EQ(evicted.size(), 2);
+	EXPECT_EQ(evicted.at(0).toInt(), 1);
+	EXPECT_EQ(evicted.at(1).toInt(), 2);
+	EXPECT_EQ(pool.GetStats().cached_count, 1);
+
+	pool.Clear();
+	EXPECT_EQ(pool.TakePendingDestroy().size(), 1);
+	EXPECT_TRUE(pool.Acquire(key).isNull());
+}
+
+TEST(TexturePool, PoolsShareBudget)
+{
+	TexturePool::BudgetPtr budget = std::make_shared<TexturePool::Budget>(300);
+	quint64 key = TexturePool::MakeKey(10, 10, 1, PixelFormat::U8, 4);
+
+	{
+		TexturePool first(budget);
+		TexturePool second(budget);
+
+		first.Release(key, 1, 100, 0);
+		first.Release(key, 2, 100, 1);
+		second.Release(key, 3, 100, 2);
+		EXPECT_EQ(budget->used(), 300);
+		EXPECT_TRUE(first.TakePendingDestroy().isEmpty());
+
+		// The pool that goes over the shared budget evicts its own oldest texture
+		second.Release(key, 4, 100, 3);
+		EXPECT_TRUE(first.TakePendingDestroy().isEmpty());
+		QVector<QVariant> evicted = second.TakePendingDestroy();
+		ASSERT_EQ(evicted.size(), 1);
+		EXPECT_EQ(evicted.first().toInt(), 3);
+		EXPECT_EQ(budget->used(), 300);
+
+		// Taking a texture back out makes room for the other pool
+		EXPECT_EQ(first.Acquire(key).toInt(), 2);
+		EXPECT_EQ(budget->used(), 200);
+
+		TexturePool::Stats stats = second.GetStats();
+		EXPECT_EQ(stats.cached_bytes, 100);
+		EXPECT_EQ(stats.budget, 300);
+		EXPECT_EQ(stats.budget_used, 200);
+
+		// A limit set through one pool applies to both
+		first.SetBudget(100);
+		EXPECT_EQ(budget->limit(), 100);
+		EXPECT_EQ(first.TakePendingDestroy().size(), 1);
+		EXPECT_EQ(budget->used(), 100);
+	}
+
+	// Destroyed pools stop counting against the budget
+	EXPECT_EQ(budget->used(), 0);
+}
+
+TEST(TexturePool, OverBudgetPoolAsksOthersToTrim)
+{
+	TexturePool::BudgetPtr budget = std::make_shared<TexturePool::Budget>(300);
+	quint64 key = TexturePool::MakeKey(10, 10, 1, PixelFormat::U8, 4);
+	quint64 other_key = TexturePool::MakeKey(20, 20, 1, PixelFormat::U8, 4);
+
+	TexturePool first(budget);
+	TexturePool second(budget);
+
+	first.Release(key, 1, 100, 0);
+	first.Release(key, 2, 100, 1);
+	first.Release(key, 3, 100, 2);
+
+	// Second is within its share, so it keeps its texture and the budget stays over until first trims
+	second.Release(key, 4, 100, 3);
+	EXPECT_TRUE(second.TakePendingDestroy().isEmpty());
+	EXPECT_EQ(budget->used(), 400);
+
+	// First handles the request on its next call
+	EXPECT_TRUE(first.Acquire(other_key).isNull());
+	QVector<QVariant> evicted = first.TakePendingDestroy();
+	ASSERT_EQ(evicted.size(), 1);
+	EXPECT_EQ(evicted.first().toInt(), 1);
+	EXPECT_EQ(budget->used(), 300);
+	EXPECT_EQ(second.GetStats().cached_bytes, 100);
+}
@@ -0,0 +1,290 @@
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "node/color/colormanager/colormanager.h"
+#include "node/factory.h"
+#include "node/project.h"
+#include "node/project/sequence/sequence.h"
+#include "task/export/export.h"
+
+namespace {
+/// What an encoder was given, kept after the task has closed and released it
+struct EncoderLog {
+	QVector<olive::FramePtr> frames;
+	QVector<olive::core::rational> times;
+	int audio_writes = 0;
+	bool closed = false;
+};
+
+class RecordingEncoder final : public olive::Encoder {
+public:
+	RecordingEncoder(const olive::EncodingParams &params, EncoderLog *log,
+					 bool fail_open, bool fail_write)
+		: olive::Encoder(params)
+		, log_(log)
+		, fail_open_(fail_open)
+		, fail_write_(fail_write)
+	{
+	}
+
+	bool Open() override
+	{
+		if (fail_open_) {
+			SetError(QStringLiteral("open failed"));
+			return false;
+		}
+
+		// Leave a file behind like a real encoder would, so cleanup can be checked
+		QFile f(params().filename());
+		return f.open(QFile::WriteOnly);
+	}
+
+	bool WriteFrame(olive::FramePtr frame, olive::core::rational time) override
+	{
+		if (fail_write_) {
+			SetError(QStringLiteral("write failed"));
+			return false;
+		}
+		log_->frames.append(frame);
+		log_->times.append(time);
+		return true;
+	}
+
+	bool WriteAudio(const olive::SampleBuffer &) override
+	{
+		log_->audio_writes++;
+		return true;
+	}
+
+	bool WriteSubtitle(const olive::SubtitleBlock *) override
+	{
+		return true;
+	}
+
+	void Close() override
+	{
+		log_->closed = true;
+	}
+
+private:
+	EncoderLog *log_;
+	bool fail_open_;
+	bool fail_write_;
+};
+
+/**
+ * Stands in for the renderer, delivering two frames and two audio buffers out of order
+ */
+class FanOutExportTask : public olive::ExportTask {
+public:
+	FanOutExportTask(olive::ViewerOutput *viewer,
+					 const QVector<olive::EncodingParams> &params)
+		: olive::ExportTask(viewer, nullptr, params)
+		, logs_(params.size())
+	{
+	}
+
+	QVector<EncoderLog> &logs()
+	{
+		return logs_;
+	}
+
+	int fail_open = -1;
+	int fail_write = -1;
+	bool rendered = false;
+
+	/// Frames handed out per render, in the order they were delivered
+	QVector<QVector<olive::FramePtr>> delivered;
+
+protected:
+	olive::Encoder *CreateEncoder(const olive::EncodingParams &params) override
+	{
+		int index = created_++;
+		return new RecordingEncoder(params, &logs_[index], index == fail_open,
+									index == fail_write);
+	}
+
+	bool RenderOutputs(
+		const olive::TimeRangeList &, const olive::TimeRangeList &audio_range,
+		const olive::TimeRange &, const olive::RenderManager::FrameOutput &,
+		const QVector<olive::RenderManager::FrameOutput> &additional) override
+	{
+		rendered = true;
+
+		const olive::core::rational frame_length(1, 24);
+		for (int t : { 1, 0 }) {
+			QVector<olive::FramePtr> frames;
+			for (int i = 0; i <= additional.size(); i++) {
+				frames.append(olive::Frame::Create());
+			}
+			delivered.append(frames);
+			if (!FramesDownloaded(frames, frame_length * t)) {
+				return false;
+			}
+		}
+
+		if (!audio_range.isEmpty()) {
+			for (int t : { 1, 0 }) {
+				if (!AudioDownloaded(olive::TimeRange(frame_length * t,
+													  frame_length * (t + 1)),
+									 olive::SampleBuffer())) {
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+private:
+	QVector<EncoderLog> logs_;
+	int created_ = 0;
+};
+
+olive::EncodingParams MakeParams(const QString &filename, bool video,
+								 bool audio)
+{
+	olive::EncodingParams params;
+	params.SetFilename(filename);
+
+	if (video) {
+		olive::VideoParams vp(16, 16, olive::core::PixelFormat::U8, 4);
+		vp.set_time_base(olive::core::rational(1, 24));
+		vp.set_frame_rate(olive::core::rational(24));
+		params.EnableVideo(vp, olive::ExportCodec::kCodecH264);
+	}
+
+	if (audio) {
+		params.EnableAudio(olive::AudioParams(), olive::ExportCodec::kCodecPCM);
+	}
+
+	params.set_custom_range(
+		olive::TimeRange(0, olive::core::rational(2, 24)));
+
+	return params;
+}
+
+class ExportTaskTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		olive::ColorManager::SetUpDefaultConfig();
+		olive::NodeFactory::Initialize();
+
+		project_.Initialize();
+		sequence_ = new olive::Sequence();
+		sequence_->setParent(&project_);
+		sequence_->set_default_parameters();
+
+		ASSERT_TRUE(dir_.isValid());
+	}
+
+	QString File(const QString &name) const
+	{
+		return QDir(dir_.path()).filePath(name);
+	}
+
+	olive::Project project_;
+	olive::Sequence *sequence_ = nullptr;
+	QTemporaryDir dir_;
+};
+}
+
+TEST_F(ExportTaskTest, FansOutOneRenderToEveryOutput)
+{
+	FanOutExportTask task(sequence_, { MakeParams(File("master.mov"), true, true),
+									   MakeParams(File("proxy.mov"), true, false),
+									   MakeParams(File("audio.wav"), false, true) });
+	ASSERT_TRUE(task.Start()) << task.GetError().toStdString();
+	ASSERT_TRUE(task.rendered);
+
+	auto &logs = task.logs();
+
+	// Both video outputs get their own frame of each render, written in order despite arriving out of order
+	ASSERT_EQ(task.delivered.size(), 2);
+	ASSERT_EQ(logs[0].frames.size(), 2);
+	ASSERT_EQ(logs[1].frames.size(), 2);
+	EXPECT_EQ(logs[0].frames[0], task.delivered[1][0]);
+	EXPECT_EQ(logs[0].frames[1], task.delivered[0][0]);
+	EXPECT_EQ(logs[1].frames[0], task.delivered[1][1]);
+	EXPECT_EQ(logs[1].frames[1], task.delivered[0][1]);
+	EXPECT_LT(logs[0].times[0], logs[0].times[1]);
+	EXPECT_TRUE(logs[2].frames.isEmpty());
+
+	// Audio goes to every output that has it
+	EXPECT_EQ(logs[0].audio_writes, 2);
+	EXPECT_EQ(logs[1].audio_writes, 0);
+	EXPECT_EQ(logs[2].audio_writes, 2);
+
+	for (const EncoderLog &log : logs) {
+		EXPECT_TRUE(log.closed);
+	}
+	EXPECT_TRUE(QFile::exists(File("master.mov")));
+	EXPECT_TRUE(QFile::exists(File("proxy.mov")));
+	EXPECT_TRUE(QFile::exists(File("audio.wav")));
+}
+
+TEST_F(ExportTaskTest, FailedOpenStopsEveryOutput)
+{
+	FanOutExportTask task(sequence_, { MakeParams(File("master.mov"), true, true),
+									   MakeParams(File("proxy.mov"), true, false) });
+	task.fail_open = 1;
+
+	EXPECT_FALSE(task.Start());
+	EXPECT_FALSE(task.rendered);
+
+	// The error says which output it came from
+	EXPECT_TRUE(task.GetError().startsWith(QStringLiteral("proxy.mov: ")))
+		<< task.GetError().toStdString();
+
+	// The output that did open is closed and its empty file removed
+	EXPECT_TRUE(task.logs()[0].closed);
+	EXPECT_FALSE(QFile::exists(File("master.mov")));
+	EXPECT_FALSE(QFile::exists(File("proxy.mov")));
+}
+
+TEST_F(ExportTaskTest, FailedWriteKeepsExistingFiles)
+{
+	// A previous export is never replaced by a partial one
+	{
+		QFile existing(File("master.mov"));
+		ASSERT_TRUE(existing.open(QFile::WriteOnly));
+		existing.write("previous");
+	}
+
+	FanOutExportTask task(sequence_, { MakeParams(File("master.mov"), true, true),
+									   MakeParams(File("proxy.mov"), true, false) });
+	task.fail_write = 1;
+
+	EXPECT_FALSE(task.Start());
+	EXPECT_TRUE(task.rendered);
+	EXPECT_EQ(task.GetError(), QStringLiteral("proxy.mov: write failed"));
+
+	EXPECT_TRUE(task.logs()[0].closed);
+	EXPECT_TRUE(task.logs()[1].closed);
+
+	QFile existing(File("master.mov"));
+	ASSERT_TRUE(existing.open(QFile::ReadOnly));
+	EXPECT_EQ(existing.readAll(), QByteArray("previous"));
+	EXPECT_FALSE(QFile::exists(File("proxy.mov")));
+	EXPECT_EQ(QDir(dir_.path()).entryList(QDir::Files).size(), 1);
+}
+
+TEST_F(ExportTaskTest, OutputsMustShareFrameRate)
+{
+	olive::EncodingParams proxy = MakeParams(File("proxy.mov"), true, false);
+	olive::VideoParams vp = proxy.video_params();
+	vp.set_time_base(olive::core::rational(1, 30));
+	vp.set_frame_rate(olive::core::rational(30));
+	proxy.EnableVideo(vp, olive::ExportCodec::kCodecH264);
+
+	FanOutExportTask task(sequence_,
+						  { MakeParams(File("master.mov"), true, false), proxy });
+
+	EXPECT_FALSE(task.Start());
+	EXPECT_FALSE(task.rendered);
+	EXPECT_FALSE(QFile::exists(File("master.mov")));
+}
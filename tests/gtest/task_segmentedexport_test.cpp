@@ -0,0 +1,253 @@
+#include <gtest/gtest.h>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+#include <QDir>
+#include <QTemporaryDir>
+
+#include "codec/ffmpeg/ffmpegremuxer.h"
+#include "task/export/segmentedexport.h"
+
+using olive::SegmentedExportTask;
+using olive::core::rational;
+using olive::core::TimeRange;
+
+namespace
+{
+
+const AVRational kVideoTimeBase = { 1, 25 };
+const AVRational kAudioTimeBase = { 1, 8000 };
+
+// Writes `frames` tiny raw video frames, timestamped from `first_pts`, as a worker's segment would be
+bool WriteVideoSegment(const QString &filename, int frames, int64_t first_pts)
+{
+	AVFormatContext *ctx = nullptr;
+	if (avformat_alloc_output_context2(&ctx, nullptr, "nut",
+									   filename.toUtf8()) < 0) {
+		return false;
+	}
+
+	AVStream *s = avformat_new_stream(ctx, nullptr);
+	s->time_base = kVideoTimeBase;
+	s->codecpar->codec_type = AVMEDIA_TYPE_VIDEO;
+	s->codecpar->codec_id = AV_CODEC_ID_RAWVIDEO;
+	s->codecpar->format = AV_PIX_FMT_GRAY8;
+	s->codecpar->width = 16;
+	s->codecpar->height = 16;
+
+	bool ok = avio_open(&ctx->pb, filename.toUtf8(), AVIO_FLAG_WRITE) >= 0 &&
+			  avformat_write_header(ctx, nullptr) >= 0;
+
+	AVPacket *pkt = av_packet_alloc();
+	for (int i = 0; ok && i < frames; i++) {
+		ok = av_new_packet(pkt, 16 * 16) >= 0;
+		if (ok) {
+			memset(pkt->data, i, pkt->size);
+			pkt->pts = pkt->dts = first_pts + i;
+			pkt->duration = 1;
+			pkt->flags |= AV_PKT_FLAG_KEY;
+			av_packet_rescale_ts(pkt, kVideoTimeBase, s->time_base);
+			ok = av_interleaved_write_frame(ctx, pkt) >= 0;
+		}
+	}
+	av_packet_free(&pkt);
+
+	if (ok) {
+		ok = av_write_trailer(ctx) >= 0;
+	}
+
+	avio_closep(&ctx->pb);
+	avformat_free_context(ctx);
+	return ok;
+}
+
+// Writes `packets` packets of silent PCM, 800 samples each, like the audio worker's file
+bool WriteAudioStreams(const QString &filename, int packets)
+{
+	AVFormatContext *ctx = nullptr;
+	if (avformat_alloc_output_context2(&ctx, nullptr, "nut",
+									   filename.toUtf8()) < 0) {
+		return false;
+	}
+
+	AVStream *s = avformat_new_stream(ctx, nullptr);
+	s->time_base = kAudioTimeBase;
+	s->codecpar->codec_type = AVMEDIA_TYPE_AUDIO;
+	s->codecpar->codec_id = AV_CODEC_ID_PCM_S16LE;
+	s->codecpar->format = AV_SAMPLE_FMT_S16;
+	s->codecpar->sample_rate = 8000;
+	s->codecpar->block_align = 2;
+	s->codecpar->bits_per_coded_sample = 16;
+	av_channel_layout_default(&s->codecpar->ch_layout, 1);
+
+	bool ok = avio_open(&ctx->pb, filename.toUtf8(), AVIO_FLAG_WRITE) >= 0 &&
+			  avformat_write_header(ctx, nullptr) >= 0;
+
+	AVPacket *pkt = av_packet_alloc();
+	for (int i = 0; ok && i < packets; i++) {
+		ok = av_new_packet(pkt, 800 * 2) >= 0;
+		if (ok) {
+			memset(pkt->data, 0, pkt->size);
+			pkt->pts = pkt->dts = int64_t(i) * 800;
+			pkt->duration = 800;
+			pkt->flags |= AV_PKT_FLAG_KEY;
+			av_packet_rescale_ts(pkt, kAudioTimeBase, s->time_base);
+			ok = av_interleaved_write_frame(ctx, pkt) >= 0;
+		}
+	}
+	av_packet_free(&pkt);
+
+	if (ok) {
+		ok = av_write_trailer(ctx) >= 0;
+	}
+
+	avio_closep(&ctx->pb);
+	avformat_free_context(ctx);
+	return ok;
+}
+
+}
+
+TEST(SegmentedExport, SplitsOnGOPBoundaries)
+{
+	const rational timebase(1, 25);
+
+	// 1000 frames, GOPs of 50 frames, 3 segments -> 7 GOPs (350 frames) per segment
+	QVector<TimeRange> ranges =
+		SegmentedExportTask::SplitRange(TimeRange(0, 40), timebase, 50, 3);
+
+	ASSERT_EQ(ranges.size(), 3);
+	EXPECT_EQ(ranges.at(0), TimeRange(0, 14));
+	EXPECT_EQ(ranges.at(1), TimeRange(14, 28));
+	EXPECT_EQ(ranges.at(2), TimeRange(28, 40));
+}
+
+TEST(SegmentedExport, SplitKeepsRangeOffset)
+{
+	const rational timebase(1, 25);
+
+	QVector<TimeRange> ranges =
+		SegmentedExportTask::SplitRange(TimeRange(10, 14), timebase, 25, 2);
+
+	ASSERT_EQ(ranges.size(), 2);
+	EXPECT_EQ(ranges.first().in(), rational(10));
+	EXPECT_EQ(ranges.at(1).in(), rational(12));
+	EXPECT_EQ(ranges.last().out(), rational(14));
+}
+
+TEST(SegmentedExport, ShortRangeUsesFewerSegments)
+{
+	const rational timebase(1, 25);
+
+	// Shorter than one GOP, so there's nothing to split
+	QVector<TimeRange> ranges =
+		SegmentedExportTask::SplitRange(TimeRange(0, 1), timebase, 250, 8);
+
+	ASSERT_EQ(ranges.size(), 1);
+	EXPECT_EQ(ranges.first(), TimeRange(0, 1));
+}
+
+TEST(SegmentedExport, GOPLengthFromOptions)
+{
+	olive::EncodingParams params;
+	EXPECT_EQ(SegmentedExportTask::GetGOPLength(params),
+			  SegmentedExportTask::kDefaultGOPLength);
+
+	params.set_video_option(QStringLiteral("g"), QStringLiteral("48"));
+	EXPECT_EQ(SegmentedExportTask::GetGOPLength(params), 48);
+}
+
+TEST(SegmentedExport, WorkerProgressRoundTrip)
+{
+	testing::internal::CaptureStdout();
+	SegmentedExportTask::WriteWorkerProgress(0.25);
+	SegmentedExportTask::WriteWorkerProgress(1.0);
+	QByteArray out =
+		QByteArray::fromStdString(testing::internal::GetCapturedStdout());
+
+	QList<QByteArray> lines = out.split('\n');
+	ASSERT_GE(lines.size(), 2);
+
+	double progress = 0;
+	ASSERT_TRUE(SegmentedExportTask::ReadWorkerProgress(lines.at(0), &progress));
+	EXPECT_DOUBLE_EQ(progress, 0.25);
+	ASSERT_TRUE(SegmentedExportTask::ReadWorkerProgress(lines.at(1), &progress));
+	EXPECT_DOUBLE_EQ(progress, 1.0);
+
+	// Anything else a worker prints is ignored
+	progress = -1;
+	EXPECT_FALSE(SegmentedExportTask::ReadWorkerProgress(
+		QByteArrayLiteral("Loading project"), &progress));
+	EXPECT_FALSE(SegmentedExportTask::ReadWorkerProgress(
+		QByteArrayLiteral("progress abc"), &progress));
+	EXPECT_EQ(progress, -1);
+}
+
+TEST(SegmentedExport, WorkersRunHeadless)
+{
+	QStringList args = SegmentedExportTask::GetWorkerArguments(
+		QStringLiteral("segment0.xml"), 2, QStringLiteral("project.ove"));
+
+	EXPECT_EQ(args.first(), QStringLiteral("--export"));
+	EXPECT_EQ(args.at(args.indexOf(QStringLiteral("--export-params")) + 1),
+			  QStringLiteral("segment0.xml"));
+	EXPECT_EQ(args.at(args.indexOf(QStringLiteral("--export-sequence")) + 1),
+			  QStringLiteral("2"));
+	EXPECT_EQ(args.last(), QStringLiteral("project.ove"));
+
+	EXPECT_EQ(SegmentedExportTask::GetWorkerEnvironment().value(
+				  QStringLiteral("QT_QPA_PLATFORM")),
+			  QStringLiteral("offscreen"));
+}
+
+TEST(SegmentedExport, ConcatJoinsSegmentsAndStreams)
+{
+	QTemporaryDir dir;
+	ASSERT_TRUE(dir.isValid());
+	QDir d(dir.path());
+
+	// The second worker's timestamps start where its range did, the join has to make them follow on
+	const QStringList segments = { d.filePath(QStringLiteral("segment0.nut")),
+								   d.filePath(QStringLiteral("segment1.nut")) };
+	ASSERT_TRUE(WriteVideoSegment(segments.at(0), 10, 0));
+	ASSERT_TRUE(WriteVideoSegment(segments.at(1), 10, 100));
+
+	const QString streams = d.filePath(QStringLiteral("streams.nut"));
+	ASSERT_TRUE(WriteAudioStreams(streams, 8));
+
+	const QString output = d.filePath(QStringLiteral("output.nut"));
+	QString error;
+	ASSERT_TRUE(olive::FFmpegRemuxer::Concat(segments, streams, output, &error))
+		<< error.toStdString();
+
+	AVFormatContext *ctx = nullptr;
+	ASSERT_GE(avformat_open_input(&ctx, output.toUtf8(), nullptr, nullptr), 0);
+	ASSERT_GE(avformat_find_stream_info(ctx, nullptr), 0);
+	ASSERT_EQ(ctx->nb_streams, 2u);
+
+	int video = av_find_best_stream(ctx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+	ASSERT_GE(video, 0);
+
+	QVector<int64_t> video_pts;
+	int audio_packets = 0;
+	AVPacket *pkt = av_packet_alloc();
+	while (av_read_frame(ctx, pkt) >= 0) {
+		if (pkt->stream_index == video) {
+			video_pts.append(av_rescale_q(
+				pkt->pts, ctx->streams[video]->time_base, kVideoTimeBase));
+		} else {
+			audio_packets++;
+		}
+		av_packet_unref(pkt);
+	}
+	av_packet_free(&pkt);
+	avformat_close_input(&ctx);
+
+	ASSERT_EQ(video_pts.size(), 20);
+	for (int i = 0; i < video_pts.size(); i++) {
+		EXPECT_EQ(video_pts.at(i), i);
+	}
+	EXPECT_EQ(audio_packets, 8);
+}
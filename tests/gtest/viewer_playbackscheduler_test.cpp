@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include "widget/viewer/viewerplaybackscheduler.h"
+
+#include <algorithm>
+
+TEST(ViewerPlaybackScheduler, FallbackUntilMeasured)
+{
+	olive::ViewerPlaybackScheduler s;
+	s.Reset(1000.0 / 24.0);
+	EXPECT_EQ(s.GetQueueSize(12), 12);
+}
+
+TEST(ViewerPlaybackScheduler, QueueCoversLatency)
+{
+	olive::ViewerPlaybackScheduler s;
+	const double interval = 40.0;
+	s.Reset(interval);
+
+	// Renders take 200ms but finish at the playback rate, so playback keeps up with a deep queue
+	qint64 now = 0;
+	for (int i = 0; i < olive::ViewerPlaybackScheduler::kWindowSize; i++) {
+		now += 40;
+		EXPECT_FALSE(s.AddSample(now - 200, now));
+	}
+
+	EXPECT_EQ(s.GetQueueSize(12), 6);
+	EXPECT_EQ(s.divider_multiplier(), 1);
+	EXPECT_EQ(s.frame_step(), 1);
+}
+
+TEST(ViewerPlaybackScheduler, DegradesWhenFallingBehind)
+{
+	olive::ViewerPlaybackScheduler s;
+	s.Reset(40.0);
+
+	qint64 now = 0;
+	auto fill = [&]() {
+		bool changed = false;
+		for (int i = 0; i < olive::ViewerPlaybackScheduler::kWindowSize; i++) {
+			// Only managing half the required frame rate
+			now += 80;
+			changed |= s.AddSample(now - 80, now);
+		}
+		return changed;
+	};
+
+	EXPECT_TRUE(fill());
+	EXPECT_EQ(s.divider_multiplier(), 2);
+
+	EXPECT_TRUE(fill());
+	EXPECT_EQ(s.divider_multiplier(), 4);
+
+	EXPECT_TRUE(fill());
+	EXPECT_EQ(s.frame_step(), 2);
+
+	// At every other frame, 80ms per render keeps up
+	EXPECT_FALSE(fill());
+
+	s.Reset(40.0);
+	EXPECT_EQ(s.divider_multiplier(), 1);
+	EXPECT_EQ(s.frame_step(), 1);
+}
+
+TEST(ViewerPlaybackScheduler, IdleGapsDontCount)
+{
+	olive::ViewerPlaybackScheduler s;
+	s.Reset(40.0);
+
+	// Each render takes 20ms, but requests only come in at the playback rate and once stall for two seconds
+	qint64 now = 0;
+	for (int i = 0; i < olive::ViewerPlaybackScheduler::kWindowSize * 2; i++) {
+		now += (i == 10) ? 2000 : 40;
+		EXPECT_FALSE(s.AddSample(now, now + 20));
+	}
+
+	EXPECT_EQ(s.divider_multiplier(), 1);
+	EXPECT_EQ(s.frame_step(), 1);
+	EXPECT_NEAR(s.GetStats(12).throughput_fps, 50.0, 0.1);
+}
+
+TEST(ViewerPlaybackScheduler, RecoversWithHysteresis)
+{
+	olive::ViewerPlaybackScheduler s;
+	s.Reset(40.0);
+
+	qint64 now = 0;
+	auto run = [&](int samples, qint64 render_ms) {
+		bool changed = false;
+		for (int i = 0; i < samples; i++) {
+			now += std::max(qint64(40), render_ms);
+			changed |= s.AddSample(now - render_ms, now);
+		}
+		return changed;
+	};
+	const int window = olive::ViewerPlaybackScheduler::kWindowSize;
+	const int recover_after =
+		olive::ViewerPlaybackScheduler::kMinimumRecoveryWindows * window;
+
+	EXPECT_TRUE(run(window, 80));
+	EXPECT_EQ(s.divider_multiplier(), 2);
+
+	// Renders got fast, so quality comes back once the window has shown enough headroom for long enough
+	EXPECT_FALSE(run(window + recover_after - 2, 10));
+	EXPECT_TRUE(run(1, 10));
+	EXPECT_EQ(s.divider_multiplier(), 1);
+
+	// Full quality is too slow after all, which doubles the wait before the next try
+	EXPECT_TRUE(run(window, 80));
+	EXPECT_EQ(s.divider_multiplier(), 2);
+	EXPECT_FALSE(run(window + recover_after * 2 - 2, 10));
+	EXPECT_TRUE(run(1, 10));
+	EXPECT_EQ(s.divider_multiplier(), 1);
+}
+
+TEST(ViewerPlaybackScheduler, KeepsFallbackWithoutHeadroom)
+{
+	olive::ViewerPlaybackScheduler s;
+	s.Reset(40.0);
+
+	qint64 now = 0;
+	for (int i = 0; i < olive::ViewerPlaybackScheduler::kWindowSize; i++) {
+		now += 80;
+		s.AddSample(now - 80, now);
+	}
+	ASSERT_EQ(s.divider_multiplier(), 2);
+
+	// Just keeping up isn't enough to risk full quality again
+	for (int i = 0; i < olive::ViewerPlaybackScheduler::kWindowSize * 16; i++) {
+		now += 40;
+		EXPECT_FALSE(s.AddSample(now - 30, now));
+	}
+	EXPECT_EQ(s.divider_multiplier(), 2);
+}